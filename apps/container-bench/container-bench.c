@@ -0,0 +1,790 @@
+/* container-bench.c */
+
+/* Container microbenchmark.
+ *
+ * Times each icontainer operation for every container type under a set of
+ * workloads and key counts. Reports throughput and latency percentiles as
+ * JSON on stdout so that results can be compared between releases.
+ *
+ * Workloads:
+ * - uniform:    random keys, accessed uniformly
+ * - zipf:       random keys, accessed with a Zipfian distribution
+ * - sequential: increasing keys, inserted and accessed in order
+ * - prefix:     hierarchical keys sharing long prefixes, accessed uniformly
+ *
+ * Operations, in order: insert every key, look up every key, look up
+ * missing keys, query prefixes, churn (remove then reinsert every key),
+ * remove every key.
+ *
+ * Throughput is measured over the whole of each phase. Latency is measured
+ * by timing a sample of individual operations. When the library is built
+ * with 'make instrument=yes' the average key comparisons and nodes visited
+ * per operation are reported too. When built with 'make memento=yes' the
+ * allocations made by each run are listed by call site on stderr.
+ *
+ * The insert results also give the shape of the filled container: the
+ * depths of its elements, or its chain lengths and load factor for hashes.
+ * They also give the container's own count of the bytes it uses and the
+ * growth in the process's resident set size since the container was made.
+ * The churn results repeat these so that growth under turnover shows.
+ * Use -only to run a single container when comparing resident sizes, as
+ * memory freed by one run may be reused by the next.
+ *
+ * The header records whether the trie family of data structures was built
+ * with the compact node layout ('make compact=yes') so that runs of the
+ * two layouts can be told apart.
+ */
+
+/* clock_gettime is not part of C99 */
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "base/memento/memento.h"
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "keyval/string.h"
+
+#include "container/interface/container.h"
+#include "container/interface/key.h"
+#include "container/interface/value.h"
+#include "container/interface/maker.h"
+
+#include "container/orderedarray.h"
+#include "container/linkedlist.h"
+#include "container/hash.h"
+#include "container/bstree.h"
+#include "container/dstree.h"
+#include "container/trie.h"
+#include "container/critbit.h"
+#include "container/patricia.h"
+
+/* ----------------------------------------------------------------------- */
+
+static const struct
+{
+  icontainer_maker *maker;
+  const char       *name;
+}
+makers[] =
+{
+  { container_create_orderedarray, "orderedarray" },
+  { container_create_linkedlist,   "linkedlist"   },
+  { container_create_hash,         "hash"         },
+  { container_create_bstree,       "bstree"       },
+  { container_create_dstree,       "dstree"       },
+  { container_create_trie,         "trie"         },
+  { container_create_critbit,      "critbit"      },
+  { container_create_patricia,     "patricia"     },
+  { container_create_hash_inline_keys,     "hash-inline"     },
+  { container_create_critbit_inline_keys,  "critbit-inline"  },
+  { container_create_patricia_inline_keys, "patricia-inline" },
+};
+
+typedef enum workload
+{
+  workload_UNIFORM,
+  workload_ZIPF,
+  workload_SEQUENTIAL,
+  workload_PREFIX,
+}
+workload_t;
+
+static const char *workload_names[] =
+{
+  "uniform", "zipf", "sequential", "prefix",
+};
+
+/* Keys and values live in the benchmark's own storage. */
+static const icontainer_key_t bench_key =
+{
+  stringkv_len, stringkv_compare, stringkv_hash,
+  { stringkv_nodestroy, stringkv_fmt, stringkv_fmt_nodestroy }
+};
+
+static const icontainer_value_t bench_value =
+{
+  NULL /* default value */,
+  { stringkv_nodestroy, stringkv_fmt, stringkv_fmt_nodestroy }
+};
+
+/* ----------------------------------------------------------------------- */
+
+#define KEYLEN      40       /* storage per key, including terminator */
+#define MAXSAMPLES  100000   /* latency samples per operation */
+#define MAXPREFIXES 1000     /* prefix queries per run */
+
+/* Keys for a single run. */
+typedef struct keyset
+{
+  int    nkeys;
+  char  *hits;    /* nkeys keys of KEYLEN bytes */
+  char  *misses;  /* nkeys keys which are not present */
+  int   *insert;  /* order in which to insert keys */
+  int   *access;  /* order in which to look up and remove keys */
+}
+keyset_t;
+
+#define HIT(ks, i)  ((ks)->hits   + (size_t) (i) * KEYLEN)
+#define MISS(ks, i) ((ks)->misses + (size_t) (i) * KEYLEN)
+
+static unsigned int bench_rand(unsigned int *state)
+{
+  unsigned int x = *state;
+
+  /* xorshift32 */
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+
+  return *state = x;
+}
+
+static void shuffle(int *a, int n, unsigned int *seed)
+{
+  int i;
+
+  for (i = n - 1; i > 0; i--)
+  {
+    int j = bench_rand(seed) % (i + 1);
+    int t = a[i];
+
+    a[i] = a[j];
+    a[j] = t;
+  }
+}
+
+static void keyset_destroy(keyset_t *ks)
+{
+  free(ks->access);
+  free(ks->insert);
+  free(ks->misses);
+  free(ks->hits);
+}
+
+static error keyset_create(keyset_t *ks, workload_t workload, int nkeys)
+{
+  unsigned int seed = 0x2545f491;
+  int          i;
+
+  ks->nkeys  = nkeys;
+  ks->hits   = malloc((size_t) nkeys * KEYLEN);
+  ks->misses = malloc((size_t) nkeys * KEYLEN);
+  ks->insert = malloc(nkeys * sizeof(*ks->insert));
+  ks->access = malloc(nkeys * sizeof(*ks->access));
+  if (!ks->hits || !ks->misses || !ks->insert || !ks->access)
+  {
+    keyset_destroy(ks);
+    return error_OOM;
+  }
+
+  for (i = 0; i < nkeys; i++)
+  {
+    char *k = HIT(ks, i);
+
+    switch (workload)
+    {
+    case workload_UNIFORM:
+    case workload_ZIPF:
+      /* the index keeps keys distinct, the random part spreads them */
+      sprintf(k, "%08x%08x", bench_rand(&seed), (unsigned int) i);
+      break;
+
+    case workload_SEQUENTIAL:
+      sprintf(k, "%012d", i);
+      break;
+
+    case workload_PREFIX:
+      sprintf(k, "/srv/data/volume%02d/dir%03d/file%08d",
+              i % 7, (i / 7) % 500, i);
+      break;
+    }
+
+    /* misses share all but their final character with a hit */
+    strcpy(MISS(ks, i), k);
+    MISS(ks, i)[strlen(k) - 1] = '!';
+
+    ks->insert[i] = i;
+  }
+
+  if (workload != workload_SEQUENTIAL)
+    shuffle(ks->insert, nkeys, &seed);
+
+  switch (workload)
+  {
+  case workload_UNIFORM:
+  case workload_PREFIX:
+    for (i = 0; i < nkeys; i++)
+      ks->access[i] = bench_rand(&seed) % nkeys;
+    break;
+
+  case workload_ZIPF:
+    {
+      double *cdf;
+      double  total;
+
+      cdf = malloc(nkeys * sizeof(*cdf));
+      if (cdf == NULL)
+      {
+        keyset_destroy(ks);
+        return error_OOM;
+      }
+
+      total = 0.0;
+      for (i = 0; i < nkeys; i++)
+      {
+        total += 1.0 / (i + 1);
+        cdf[i] = total;
+      }
+
+      /* the insert order is a random permutation, so use it to scatter the
+       * popular ranks across the key space */
+      for (i = 0; i < nkeys; i++)
+      {
+        double r = bench_rand(&seed) / 4294967296.0 * total;
+        int    lo = 0, hi = nkeys - 1;
+
+        while (lo < hi)
+        {
+          int mid = (lo + hi) / 2;
+
+          if (cdf[mid] < r)
+            lo = mid + 1;
+          else
+            hi = mid;
+        }
+
+        ks->access[i] = ks->insert[lo];
+      }
+
+      free(cdf);
+    }
+    break;
+
+  case workload_SEQUENTIAL:
+    for (i = 0; i < nkeys; i++)
+      ks->access[i] = i;
+    break;
+  }
+
+  return error_OK;
+}
+
+/* ----------------------------------------------------------------------- */
+
+static double timer_overhead; /* nanoseconds */
+
+static double now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void timer_calibrate(void)
+{
+  double best;
+  int    i;
+
+  best = 1e9;
+  for (i = 0; i < 1000; i++)
+  {
+    double t0 = now_ns();
+    double t1 = now_ns();
+
+    if (t1 - t0 < best)
+      best = t1 - t0;
+  }
+
+  timer_overhead = best;
+}
+
+/* Latency samples and throughput for one operation. */
+typedef struct stats
+{
+  double                 *samples;
+  int                     nsamples;
+  int                     stride;    /* time every stride'th operation */
+  int                     nops;
+  double                  start;
+  double                  elapsed;   /* nanoseconds */
+
+  icontainer_t           *c;
+  int                     instrumented;
+  datastruct_instrument_t before;    /* counters at start of phase */
+  long                    rss_before; /* resident bytes before 'c' was made */
+  int                     memory;     /* report memory use with results */
+}
+stats_t;
+
+/* Returns the resident set size in bytes, or zero if it's unavailable. */
+static long rss_bytes(void)
+{
+  FILE *f;
+  long  size;
+  long  resident;
+
+  f = fopen("/proc/self/statm", "r");
+  if (f == NULL)
+    return 0;
+
+  if (fscanf(f, "%ld %ld", &size, &resident) != 2)
+    resident = 0;
+
+  fclose(f);
+
+  return resident * sysconf(_SC_PAGESIZE);
+}
+
+static void stats_begin(stats_t *st, int nops)
+{
+  st->instrumented = st->c->instrument(st->c, &st->before) == error_OK;
+
+  st->nsamples = 0;
+  st->stride   = nops > MAXSAMPLES ? (nops + MAXSAMPLES - 1) / MAXSAMPLES : 1;
+  st->nops     = nops;
+  st->start    = now_ns();
+}
+
+static void stats_end(stats_t *st)
+{
+  st->elapsed = now_ns() - st->start;
+}
+
+static int compare_doubles(const void *a, const void *b)
+{
+  double da = *(const double *) a;
+  double db = *(const double *) b;
+
+  return (da > db) - (da < db);
+}
+
+static double percentile(const stats_t *st, double p)
+{
+  int i;
+
+  i = (int) (p * st->nsamples);
+  if (i >= st->nsamples)
+    i = st->nsamples - 1;
+
+  return st->samples[i];
+}
+
+static int first_result = 1;
+
+/* 'dsop' is the kind of data structure operation timed, or -1 if it's not
+ * one which is instrumented. */
+static void stats_emit(stats_t    *st,
+                       const char *container,
+                       workload_t  workload,
+                       int         nkeys,
+                       const char *op,
+                       int         dsop)
+{
+  datastruct_instrument_t  after;
+  datastruct_depth_stats_t depth;
+  datastruct_stats_t       mem;
+
+  if (st->nsamples == 0)
+    return;
+
+  qsort(st->samples, st->nsamples, sizeof(*st->samples), compare_doubles);
+
+  printf("%s\n    { \"container\": \"%s\", \"workload\": \"%s\", "
+         "\"keys\": %d, \"op\": \"%s\", \"ops\": %d, "
+         "\"mops_per_sec\": %.4f, "
+         "\"p50_ns\": %.0f, \"p99_ns\": %.0f, \"p999_ns\": %.0f",
+         first_result ? "" : ",",
+         container, workload_names[workload], nkeys, op, st->nops,
+         st->elapsed > 0 ? st->nops / st->elapsed * 1e3 : 0.0,
+         percentile(st, 0.50), percentile(st, 0.99), percentile(st, 0.999));
+
+  if (st->instrumented && dsop >= 0 &&
+      st->c->instrument(st->c, &after) == error_OK)
+  {
+    const datastruct_op_counts_t *b = &st->before.op[dsop];
+    const datastruct_op_counts_t *a = &after.op[dsop];
+    double                        calls;
+
+    calls = (double) (a->calls - b->calls);
+    if (calls > 0)
+      printf(", \"compares_per_op\": %.2f, \"visits_per_op\": %.2f",
+             (a->compares - b->compares) / calls,
+             (a->visits - b->visits) / calls);
+  }
+
+  /* after inserting or churning, report the memory used */
+  if (st->memory)
+  {
+    st->c->stats(st->c, NULL, NULL, &mem);
+    printf(", \"node_bytes\": %lu, \"total_bytes\": %lu, \"rss_bytes\": %ld",
+           (unsigned long) mem.node_bytes, (unsigned long) mem.total_bytes,
+           rss_bytes() - st->rss_before);
+  }
+
+  /* after inserting, report the shape the container has grown into */
+  if (dsop == datastruct_OP_INSERT &&
+      st->c->depth_stats(st->c, &depth) == error_OK)
+  {
+    printf(", \"min_depth\": %d, \"avg_depth\": %.2f, \"max_depth\": %d",
+           depth.min_depth, depth.avg_depth, depth.max_depth);
+    if (depth.bins)
+      printf(", \"load_factor\": %.2f, \"empty_bins\": %d",
+             depth.load_factor, depth.empty_bins);
+    else
+      printf(", \"imbalance\": %.2f, \"chains\": %d",
+             depth.imbalance, depth.chains);
+  }
+
+  printf(" }");
+
+  first_result = 0;
+
+  fflush(stdout);
+}
+
+/* Time 'STMT' for every stride'th operation 'I'. */
+#define TIMED(st, I, STMT)                                      \
+  do                                                            \
+  {                                                             \
+    if ((I) % (st)->stride == 0 && (st)->nsamples < MAXSAMPLES) \
+    {                                                           \
+      double t0 = now_ns();                                     \
+      STMT;                                                     \
+      (st)->samples[(st)->nsamples++] =                         \
+        now_ns() - t0 - timer_overhead;                         \
+    }                                                           \
+    else                                                        \
+    {                                                           \
+      STMT;                                                     \
+    }                                                           \
+  }                                                             \
+  while (0)
+
+/* ----------------------------------------------------------------------- */
+
+/* Returns a stride, near 7919, which is coprime to 'n' so that stepping
+ * by it modulo 'n' visits every index once. */
+static long bench_stride(long n)
+{
+  long stride;
+
+  for (stride = 7919; ; stride++)
+  {
+    long a = stride;
+    long b = n;
+
+    while (b) /* Euclid */
+    {
+      long t = a % b;
+
+      a = b;
+      b = t;
+    }
+
+    if (a == 1)
+      return stride;
+  }
+}
+
+static error bench_count_found(const item_t *item, void *opaque)
+{
+  NOT_USED(item);
+
+  ++*(int *) opaque;
+
+  return error_OK;
+}
+
+static error bench_run(icontainer_maker *maker,
+                       const char       *name,
+                       workload_t        workload,
+                       const keyset_t   *ks,
+                       stats_t          *st)
+{
+  error         err;
+  icontainer_t *c;
+  int           n = ks->nkeys;
+  int           i;
+  int           misses;
+  long          stride;
+
+  memento_reset();
+
+  st->rss_before = rss_bytes();
+
+  err = maker(&c, &bench_key, &bench_value);
+  if (err)
+    return err;
+
+  st->c = c;
+
+  /* insert */
+
+  stats_begin(st, n);
+  for (i = 0; i < n && !err; i++)
+  {
+    const char *k = HIT(ks, ks->insert[i]);
+
+    TIMED(st, i, err = c->insert(c, k, k));
+  }
+  stats_end(st);
+  if (err)
+    goto exit;
+  st->memory = 1;
+  stats_emit(st, name, workload, n, "insert", datastruct_OP_INSERT);
+  st->memory = 0;
+
+  /* lookup present keys */
+
+  misses = 0;
+  stats_begin(st, n);
+  for (i = 0; i < n; i++)
+  {
+    const char *k = HIT(ks, ks->access[i]);
+    const void *v;
+
+    TIMED(st, i, v = c->lookup(c, k));
+    misses += (v != k);
+  }
+  stats_end(st);
+  if (misses)
+  {
+    fprintf(stderr, "%s: %d keys not found\n", name, misses);
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+  stats_emit(st, name, workload, n, "lookup", datastruct_OP_LOOKUP);
+
+  /* lookup absent keys */
+
+  stats_begin(st, n);
+  for (i = 0; i < n; i++)
+  {
+    const char *k = MISS(ks, ks->access[i]);
+    const void *v;
+
+    TIMED(st, i, v = c->lookup(c, k));
+    misses += (v != NULL);
+  }
+  stats_end(st);
+  if (misses)
+  {
+    fprintf(stderr, "%s: %d absent keys found\n", name, misses);
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+  stats_emit(st, name, workload, n, "lookup_miss", datastruct_OP_LOOKUP);
+
+  /* prefix queries: half the length of an existing key */
+
+  {
+    int nqueries = MIN(n, MAXPREFIXES);
+    int found    = 0;
+
+    stats_begin(st, nqueries);
+    for (i = 0; i < nqueries && !err; i++)
+    {
+      const char *k = HIT(ks, ks->access[i]);
+      char        prefix[KEYLEN];
+      size_t      len;
+
+      len = strlen(k) / 2;
+      memcpy(prefix, k, len);
+      prefix[len] = '\0';
+
+      TIMED(st, i, err = c->lookup_prefix(c, prefix, bench_count_found,
+                                          &found));
+      if (err == error_NOT_FOUND)
+        err = error_OK; /* a query which matched nothing */
+    }
+    stats_end(st);
+    if (err == error_OK)
+      stats_emit(st, name, workload, n, "lookup_prefix", -1);
+    else if (err == error_NOT_IMPLEMENTED)
+      err = error_OK;
+    else
+      goto exit;
+  }
+
+  /* churn: remove then reinsert every key. memory should hold steady. */
+
+  stats_begin(st, n);
+  for (i = 0; i < n && !err; i++)
+  {
+    const char *k = HIT(ks, ks->access[i]);
+
+    TIMED(st, i, (c->remove(c, k), err = c->insert(c, k, k)));
+  }
+  stats_end(st);
+  if (err)
+    goto exit;
+  st->memory = 1;
+  stats_emit(st, name, workload, n, "churn", -1);
+  st->memory = 0;
+
+  /* remove every key, in a different order to insertion */
+
+  stride = bench_stride(n);
+
+  stats_begin(st, n);
+  for (i = 0; i < n; i++)
+  {
+    const char *k = HIT(ks, ks->insert[(i * stride) % n]);
+
+    TIMED(st, i, c->remove(c, k));
+  }
+  stats_end(st);
+  if (c->count(c) != 0)
+  {
+    fprintf(stderr, "%s: %d left after removing every key\n",
+            name, c->count(c));
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+  stats_emit(st, name, workload, n, "remove", datastruct_OP_REMOVE);
+
+exit:
+
+  c->destroy(c);
+
+#ifdef MEMENTO
+  fprintf(stderr, "%s, %s, %d keys:\n", name, workload_names[workload], n);
+  memento_dump(stderr);
+#endif
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+/* Returns non-zero if 'name' appears in the comma separated 'list'. */
+static int in_list(const char *list, const char *name)
+{
+  const char *p;
+  size_t      len = strlen(name);
+
+  for (p = strstr(list, name); p; p = strstr(p + 1, name))
+    if ((p == list || p[-1] == ',') && (p[len] == ',' || p[len] == '\0'))
+      return 1;
+
+  return 0;
+}
+
+static void usage(void)
+{
+  fprintf(stderr,
+          "Usage: container-bench [options]\n"
+          "  -keys <n,...>      key counts to run (default 1000,10000)\n"
+          "  -workload <w,...>  uniform, zipf, sequential, prefix (default all)\n"
+          "  -only <name,...>   benchmark only the named containers\n");
+  exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[])
+{
+  const char *keys      = "1000,10000";
+  const char *workloads = NULL;
+  const char *only      = NULL;
+  stats_t     st;
+  int         failures;
+  int         w;
+
+  while (++argv, --argc)
+  {
+    if (argc < 2)
+      usage();
+
+    if (strcmp(argv[0], "-keys") == 0)
+      keys = argv[1];
+    else if (strcmp(argv[0], "-workload") == 0)
+      workloads = argv[1];
+    else if (strcmp(argv[0], "-only") == 0)
+      only = argv[1];
+    else
+      usage();
+
+    ++argv, --argc;
+  }
+
+  st.samples = malloc(MAXSAMPLES * sizeof(*st.samples));
+  if (st.samples == NULL)
+    exit(EXIT_FAILURE);
+
+  st.memory = 0;
+
+  timer_calibrate();
+
+  printf("{\n  \"benchmark\": \"container-bench\",\n"
+         "  \"layout\": \"%s\",\n"
+         "  \"timer_overhead_ns\": %.0f,\n  \"results\": [",
+#ifdef DATASTRUCT_COMPACT
+         "compact",
+#else
+         "pointer",
+#endif
+         timer_overhead);
+
+  failures = 0;
+  for (w = 0; w < NELEMS(workload_names); w++)
+  {
+    const char *p;
+
+    if (workloads && !in_list(workloads, workload_names[w]))
+      continue;
+
+    for (p = keys; *p; )
+    {
+      keyset_t ks;
+      int      nkeys;
+      int      i;
+
+      nkeys = atoi(p);
+      p += strcspn(p, ",");
+      if (*p)
+        p++;
+
+      if (nkeys < 1)
+        usage();
+
+      if (keyset_create(&ks, (workload_t) w, nkeys))
+      {
+        fprintf(stderr, "Out of memory creating %d keys\n", nkeys);
+        failures++;
+        continue;
+      }
+
+      for (i = 0; i < NELEMS(makers); i++)
+      {
+        error err;
+
+        if (only && !in_list(only, makers[i].name))
+          continue;
+
+        err = bench_run(makers[i].maker, makers[i].name, (workload_t) w,
+                        &ks, &st);
+        if (err)
+        {
+          fprintf(stderr, "%s: %s, %d keys: error %lu\n", makers[i].name,
+                  workload_names[w], nkeys, err);
+          failures++;
+        }
+      }
+
+      keyset_destroy(&ks);
+    }
+  }
+
+  printf("\n  ]\n}\n");
+
+  free(st.samples);
+
+  exit(failures ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -12,6 +12,14 @@
 #include "test.h"
 
 error queuetest(void);
+error chunkqueuetest(void);
+error pooltest(void);
+error critbittest(void);
+error hashtest(void);
+error flattest(void);
+error cachetest(void);
+error perfecthashtest(void);
+error filtertest(void);
 
 int main(int argc, char *argv[])
 {
@@ -34,6 +42,14 @@ int main(int argc, char *argv[])
     }
 
   (void) queuetest();
+  (void) chunkqueuetest();
+  (void) pooltest();
+  (void) critbittest();
+  (void) hashtest();
+  (void) flattest();
+  (void) cachetest();
+  (void) perfecthashtest();
+  (void) filtertest();
 
   test_container(viz);
 
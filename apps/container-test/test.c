@@ -12,6 +12,7 @@
 
 #include "keyval/char.h"
 #include "keyval/int.h"
+#include "keyval/sizedstring.h"
 #include "keyval/string.h"
 
 #include "container/interface/container.h"
@@ -27,6 +28,9 @@
 #include "container/trie.h"
 #include "container/critbit.h"
 #include "container/patricia.h"
+#include "container/sharded.h"
+#include "container/cache.h"
+#include "container/filtered.h"
 
 #include "test.h"
 
@@ -41,6 +45,13 @@ static const icontainer_key_t static_string_key =
   { stringkv_nodestroy, stringkv_fmt, stringkv_fmt_nodestroy }
 };
 
+/* A sized string key, owned by the container. */
+static const icontainer_key_t sized_string_key =
+{
+  sizedstringkv_len, sizedstringkv_compare, sizedstringkv_hash,
+  { sizedstringkv_destroy, sizedstringkv_fmt, sizedstringkv_fmt_nodestroy }
+};
+
 /* A statically allocated int key. */
 static const icontainer_key_t static_int_key =
 {
@@ -708,6 +719,420 @@ static error chartest(icontainer_maker *maker, const char *testname)
   return error_OK;
 
 
+failure:
+
+  LOG1("error %lu\n", err);
+
+  return err;
+}
+
+#undef NAME
+
+/* ----------------------------------------------------------------------- */
+
+#define NAME "sizedstringtest"
+
+static error sizedstringtest_lookup_prefix_callback(const item_t *item,
+                                                   void         *opaque)
+{
+  int *count = opaque;
+
+  NOT_USED(item);
+
+  (*count)++;
+
+  return error_OK;
+}
+
+/* Insert sized string keys, alternately by insert and insert_n, then look
+ * up prefixes and look up and remove keys by plain strings of known length.
+ * Keys are measured by the caller, or by sizedstringkv_len, never by strlen
+ * in the container. */
+static error sizedstringtest(icontainer_maker *maker, const char *testname)
+{
+  const int     max = NELEMS(testdata);
+  error         err;
+  icontainer_t *cont;
+  int           i;
+  char         *key;
+  size_t        keylen;
+  int           failures;
+
+  NOT_USED(testname);
+
+  LOG("Create cont");
+
+  err = maker(&cont, &sized_string_key, &static_string_value);
+  if (err)
+    goto failure;
+
+  LOG("Insert");
+
+  for (i = 0; i < max; i++)
+  {
+    keylen = strlen(testdata[i].key);
+    key    = sizedstring_create(testdata[i].key, keylen);
+    if (key == NULL)
+    {
+      err = error_OOM;
+      goto failure;
+    }
+
+    if (i & 1)
+      err = cont->insert_n(cont, key, keylen, testdata[i].value);
+    else
+      err = cont->insert(cont, key, testdata[i].value);
+    if (err)
+    {
+      sizedstring_destroy(key);
+      goto failure;
+    }
+  }
+
+  LOG("Look up prefixes");
+
+  /* plain one character strings, as stringtest uses */
+
+  failures = 0;
+
+  for (i = 'A'; i <= 'Z'; i++)
+  {
+    char prefix[2];
+    int  count;
+    int  expected;
+    int  j;
+
+    prefix[0] = (char) i;
+    prefix[1] = '\0';
+
+    expected = 0;
+    for (j = 0; j < max; j++)
+      if (testdata[j].key[0] == i)
+        expected++;
+
+    count = 0;
+    err = cont->lookup_prefix_n(cont, prefix, 1,
+                                sizedstringtest_lookup_prefix_callback,
+                                &count);
+    if (err == error_NOT_IMPLEMENTED)
+    {
+      LOG("not implemented - skipping test");
+      break;
+    }
+    if (err && err != error_NOT_FOUND)
+      goto failure;
+
+    if (count != expected)
+      failures++;
+  }
+
+  if (failures)
+    LOG1("*** %d prefix lookups failed!", failures);
+
+  LOG("Lookup and remove");
+
+  failures = 0;
+
+  for (i = 0; i < max; i++)
+  {
+    keylen = strlen(testdata[i].key);
+
+    if (cont->lookup_n(cont, testdata[i].key, keylen) != testdata[i].value)
+      failures++;
+
+    if (i & 1)
+      cont->remove_n(cont, testdata[i].key, keylen);
+  }
+
+  for (i = 0; i < max; i++)
+    if ((cont->lookup_n(cont, testdata[i].key, strlen(testdata[i].key)) ==
+         NULL) != (i & 1))
+      failures++;
+
+  if (failures)
+    LOG1("*** %d lookups failed!", failures);
+
+  for (i = 0; i < max; i += 2)
+    cont->remove_n(cont, testdata[i].key, strlen(testdata[i].key));
+
+  if (cont->count(cont) != 0)
+    LOG1("*** %d nodes counted but expected 0", cont->count(cont));
+
+  LOG("Destroy");
+
+  cont->destroy(cont);
+
+  return error_OK;
+
+
+failure:
+
+  LOG1("error %lu\n", err);
+
+  return err;
+}
+
+#undef NAME
+
+/* ----------------------------------------------------------------------- */
+
+#define NAME "statstest"
+
+static error statstest(icontainer_maker *maker, const char *testname)
+{
+  const int          max = NELEMS(commonprefixstrings);
+  error              err;
+  icontainer_t      *cont;
+  int                i;
+  size_t             keybytes;
+  size_t             valuebytes;
+  datastruct_stats_t stats;
+  size_t             emptybytes;
+
+  NOT_USED(testname);
+
+  LOG("Create cont");
+
+  err = maker(&cont, &static_string_key, &static_string_value);
+  if (err)
+    goto failure;
+
+  cont->stats(cont, NULL, NULL, &stats);
+  emptybytes = stats.node_bytes;
+
+  LOG("Insert test values");
+
+  keybytes   = 0;
+  valuebytes = 0;
+  for (i = 0; i < max; i++)
+  {
+    err = cont->insert(cont, commonprefixstrings[i].key, commonprefixstrings[i].value);
+    if (err)
+      goto failure;
+
+    keybytes   += strlen(commonprefixstrings[i].key);
+    valuebytes += strlen(commonprefixstrings[i].value);
+  }
+
+  LOG("Stats");
+
+  cont->stats(cont, NULL, NULL, &stats);
+
+  LOG3("%d elements, %d branches, %d leaves",
+       stats.elements, stats.branches, stats.leaves);
+  LOG3("%lu node bytes, %lu table bytes, %lu other bytes",
+       (unsigned long) stats.node_bytes,
+       (unsigned long) stats.table_bytes,
+       (unsigned long) stats.other_bytes);
+
+  if (stats.elements != max)
+    LOG2("*** Incorrect number of elements! (got %d but expected %d)",
+         stats.elements, max);
+  if (stats.key_bytes != 0 || stats.value_bytes != 0)
+    LOG("*** Key or value bytes counted when not requested!");
+  if (stats.total_bytes != stats.node_bytes + stats.table_bytes +
+                           stats.other_bytes)
+    LOG("*** Total bytes is not the sum of its parts!");
+  if (stats.slack_bytes > stats.table_bytes)
+    LOG("*** More slack than table!");
+
+  LOG("Stats with keys and values");
+
+  cont->stats(cont, stringkv_len, stringkv_len, &stats);
+
+  if (stats.key_bytes != keybytes || stats.value_bytes != valuebytes)
+    LOG2("*** Incorrect key or value bytes! (got %lu but expected %lu)",
+         (unsigned long) (stats.key_bytes + stats.value_bytes),
+         (unsigned long) (keybytes + valuebytes));
+
+  LOG("Remove test values");
+
+  for (i = 0; i < max; i++)
+    cont->remove(cont, commonprefixstrings[i].key);
+
+  cont->stats(cont, NULL, NULL, &stats);
+
+  if (stats.elements != 0 || stats.leaves != 0)
+    LOG2("*** Elements remain! (got %d elements and %d leaves)",
+         stats.elements, stats.leaves);
+  /* this catches any drift in containers which count inline key bytes */
+  if (stats.node_bytes != emptybytes)
+    LOG2("*** Node bytes remain! (got %lu but expected %lu)",
+         (unsigned long) stats.node_bytes, (unsigned long) emptybytes);
+
+  LOG("Destroy");
+
+  cont->destroy(cont);
+
+  return error_OK;
+
+
+failure:
+
+  LOG1("error %lu\n", err);
+
+  return err;
+}
+
+#undef NAME
+
+/* ----------------------------------------------------------------------- */
+
+#define NAME "instrumenttest"
+
+static error instrumenttest(icontainer_maker *maker, const char *testname)
+{
+  const int               max = NELEMS(commonprefixstrings);
+  error                   err;
+  icontainer_t           *cont;
+  int                     i;
+  datastruct_instrument_t counts;
+  int                     op;
+
+  NOT_USED(testname);
+
+  LOG("Create cont");
+
+  err = maker(&cont, &static_string_key, &static_string_value);
+  if (err)
+    goto failure;
+
+  LOG("Insert and look up test values");
+
+  for (i = 0; i < max; i++)
+  {
+    err = cont->insert(cont, commonprefixstrings[i].key, commonprefixstrings[i].value);
+    if (err)
+      goto failure;
+  }
+
+  for (i = 0; i < max; i++)
+    (void) cont->lookup(cont, commonprefixstrings[i].key);
+
+  LOG("Counters");
+
+  err = cont->instrument(cont, &counts);
+  if (err == error_NOT_IMPLEMENTED)
+  {
+    LOG("Not built with instrumentation");
+    err = error_OK;
+  }
+  else if (err)
+  {
+    goto failure;
+  }
+  else
+  {
+    for (op = 0; op < datastruct_OP__LIMIT; op++)
+    {
+      const datastruct_op_counts_t *c = &counts.op[op];
+      unsigned long                 total;
+      int                           j;
+
+      LOG3("op %d: %lu calls, %lu compares", op, c->calls, c->compares);
+      LOG2("op %d: %lu visits", op, c->visits);
+
+      total = 0;
+      for (j = 0; j < datastruct_HISTOGRAM_BUCKETS; j++)
+        total += c->histogram[j];
+      if (total != c->calls)
+        LOG("*** Histogram does not account for every call!");
+    }
+
+    /* some structures insert the first key without a search */
+    if (counts.op[datastruct_OP_INSERT].calls + 1 < (unsigned long) max)
+      LOG("*** Incorrect number of inserts counted!");
+    if (counts.op[datastruct_OP_LOOKUP].calls != (unsigned long) max)
+      LOG("*** Incorrect number of lookups counted!");
+    if (counts.op[datastruct_OP_LOOKUP].visits == 0)
+      LOG("*** No nodes visited by lookups!");
+  }
+
+  LOG("Destroy");
+
+  cont->destroy(cont);
+
+  return error_OK;
+
+
+failure:
+
+  LOG1("error %lu\n", err);
+
+  return err;
+}
+
+#undef NAME
+
+/* ----------------------------------------------------------------------- */
+
+#define NAME "depthtest"
+
+static error depthtest(icontainer_maker *maker, const char *testname)
+{
+  const int                max = NELEMS(commonprefixstrings);
+  error                    err;
+  icontainer_t            *cont;
+  int                      i;
+  datastruct_depth_stats_t stats;
+  unsigned long            total;
+
+  NOT_USED(testname);
+
+  LOG("Create cont");
+
+  err = maker(&cont, &static_string_key, &static_string_value);
+  if (err)
+    goto failure;
+
+  LOG("Insert test values");
+
+  for (i = 0; i < max; i++)
+  {
+    err = cont->insert(cont, commonprefixstrings[i].key, commonprefixstrings[i].value);
+    if (err)
+      goto failure;
+  }
+
+  LOG("Depth stats");
+
+  err = cont->depth_stats(cont, &stats);
+  if (err == error_NOT_IMPLEMENTED)
+  {
+    LOG("Not implemented");
+    err = error_OK;
+  }
+  else if (err)
+  {
+    goto failure;
+  }
+  else
+  {
+    LOG3("depth min %d max %d elements %d", stats.min_depth, stats.max_depth, stats.elements);
+    LOG2("chains %d bins %d", stats.chains, stats.bins);
+
+    if (stats.elements != max)
+      LOG("*** Incorrect number of elements seen!");
+    if (stats.min_depth > stats.max_depth ||
+        stats.avg_depth < stats.min_depth ||
+        stats.avg_depth > stats.max_depth)
+      LOG("*** Inconsistent depths!");
+
+    /* the histogram counts elements, or bins for hashes */
+    total = 0;
+    for (i = 0; i < datastruct_DEPTH_BUCKETS; i++)
+      total += stats.histogram[i];
+    if (total != (unsigned long) (stats.bins ? stats.bins : max))
+      LOG("*** Histogram does not account for everything!");
+  }
+
+  LOG("Destroy");
+
+  cont->destroy(cont);
+
+  return error_OK;
+
+
 failure:
 
   LOG1("error %lu\n", err);
@@ -734,6 +1159,10 @@ static error test_icontainer_type(icontainer_maker *maker,
     { inttest,          "int test",                  "int"          },
     { stringtest,       "string test",               "string"       },
     { commonprefixtest, "common prefix string test", "commonprefix" },
+    { sizedstringtest,  "sized string test",         "sizedstring"  },
+    { statstest,        "memory stats test",         "stats"        },
+    { instrumenttest,   "instrumentation test",      "instrument"   },
+    { depthtest,        "depth stats test",          "depth"        },
   };
 
   error err;
@@ -768,6 +1197,51 @@ failure:
   return err;
 }
 
+/* A sharded container with bstree shards. */
+static error container_create_sharded_bstree(icontainer_t            **container,
+                                             const icontainer_key_t   *key,
+                                             const icontainer_value_t *value)
+{
+  return container_create_sharded(container, container_create_bstree, 4,
+                                  key, value);
+}
+
+/* An S3-FIFO cache big enough that the tests never cause an eviction. */
+static error container_create_cache_s3fifo(icontainer_t            **container,
+                                           const icontainer_key_t   *key,
+                                           const icontainer_value_t *value)
+{
+  return container_create_cache(container, cache_POLICY_S3FIFO, 1000,
+                                key, value);
+}
+
+/* A sharded container of caches, whose lookups take write locks. */
+static error container_create_sharded_cache(icontainer_t            **container,
+                                            const icontainer_key_t   *key,
+                                            const icontainer_value_t *value)
+{
+  return container_create_sharded(container, container_create_cache_s3fifo,
+                                  4, key, value);
+}
+
+/* A hash fronted by a Bloom filter. */
+static error container_create_bloom_hash(icontainer_t            **container,
+                                         const icontainer_key_t   *key,
+                                         const icontainer_value_t *value)
+{
+  return container_create_filtered(container, container_create_hash,
+                                   container_FILTER_BLOOM, 1000, key, value);
+}
+
+/* A critbit tree fronted by an XOR filter. */
+static error container_create_xor_critbit(icontainer_t            **container,
+                                          const icontainer_key_t   *key,
+                                          const icontainer_value_t *value)
+{
+  return container_create_filtered(container, container_create_critbit,
+                                   container_FILTER_XOR, 0, key, value);
+}
+
 int test_container(int viz) // viz ignored now
 {
   static const struct
@@ -786,6 +1260,14 @@ int test_container(int viz) // viz ignored now
     { container_create_trie,         "trie",          "trie"         },
     { container_create_critbit,      "critbit",       "critbit"      },
     { container_create_patricia,     "patricia",      "patricia"     },
+    { container_create_sharded_bstree, "sharded bstree", "shardedbstree" },
+    { container_create_cache_s3fifo, "cache (S3-FIFO)", "caches3fifo" },
+    { container_create_sharded_cache, "sharded cache", "shardedcache" },
+    { container_create_bloom_hash,   "hash (Bloom filter)",  "bloomhash"     },
+    { container_create_xor_critbit,  "critbit (XOR filter)", "xorcritbit"    },
+    { container_create_hash_inline_keys,     "hash (inline keys)",     "hashinline"     },
+    { container_create_critbit_inline_keys,  "critbit (inline keys)",  "critbitinline"  },
+    { container_create_patricia_inline_keys, "patricia (inline keys)", "patriciainline" },
   };
 
   error err;
@@ -0,0 +1,358 @@
+/* hash-bench.c */
+
+/* Measures the throughput of the concurrent hash as the number of threads
+ * grows, for a range of read/write mixes. For comparison it also measures
+ * an ordinary hash guarded by a single mutex.
+ *
+ * Then compares single-threaded lookups, and memory use, of an ordinary
+ * hash and of a perfect hash frozen from it. */
+
+/* clock_gettime is not part of C99 */
+#define _POSIX_C_SOURCE 199309L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "datastruct/hash.h"
+#include "datastruct/perfecthash.h"
+
+/* ----------------------------------------------------------------------- */
+
+#define NKEYS      65536      /* keys drawn from [0, NKEYS) */
+#define MAXTHREADS 64
+
+static int keys[NKEYS];
+
+static unsigned int bench_hash(const void *a)
+{
+  return *(const int *) a * 2654435761u;
+}
+
+static int bench_compare(const void *a, const void *b)
+{
+  int ia = *(const int *) a;
+  int ib = *(const int *) b;
+
+  return (ia > ib) - (ia < ib);
+}
+
+static void bench_destroy_nothing(void *doomed)
+{
+  NOT_USED(doomed);
+}
+
+/* ----------------------------------------------------------------------- */
+
+typedef struct bench
+{
+  hash_t          *h;
+  pthread_mutex_t *lock;   /* non-NULL to serialise all operations */
+  int              ops;    /* operations per thread */
+  int              reads;  /* percentage of operations which are lookups */
+}
+bench_t;
+
+typedef struct bench_thread
+{
+  const bench_t   *bench;
+  unsigned int     seed;
+  error            err;
+}
+bench_thread_t;
+
+static unsigned int bench_rand(unsigned int *state)
+{
+  unsigned int x = *state;
+
+  /* xorshift32 */
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+
+  return *state = x;
+}
+
+static void *bench_worker(void *opaque)
+{
+  bench_thread_t *thread = opaque;
+  const bench_t  *b      = thread->bench;
+  int             i;
+
+  thread->err = error_OK;
+
+  for (i = 0; i < b->ops; i++)
+  {
+    unsigned int r;
+    int         *key;
+
+    r   = bench_rand(&thread->seed);
+    key = &keys[(r >> 8) % NKEYS];
+
+    if (b->lock)
+      pthread_mutex_lock(b->lock);
+
+    if ((int) (r & 0xff) * 100 < b->reads * 256)
+    {
+      (void) hash_lookup(b->h, key);
+    }
+    else if (r & 0x80000000)
+    {
+      error err;
+
+      err = hash_insert(b->h, key, sizeof(*key), key);
+      if (err)
+        thread->err = err;
+    }
+    else
+    {
+      hash_remove(b->h, key);
+    }
+
+    if (b->lock)
+      pthread_mutex_unlock(b->lock);
+
+    if (thread->err)
+      break;
+  }
+
+  return NULL;
+}
+
+static double bench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Returns millions of operations per second, or a negative value on
+ * error. */
+static double bench_run(int concurrent, int nthreads, int ops, int reads)
+{
+  error           err;
+  bench_t         b;
+  pthread_mutex_t lock;
+  bench_thread_t  threads[MAXTHREADS];
+  pthread_t       ids[MAXTHREADS];
+  int             started;
+  double          start;
+  double          elapsed;
+  int             i;
+
+  if (concurrent)
+    err = hash_create_concurrent(NULL, NKEYS / 2, bench_hash, bench_compare,
+                                 bench_destroy_nothing, bench_destroy_nothing,
+                                 &b.h);
+  else
+    err = hash_create(NULL, NKEYS / 2, bench_hash, bench_compare,
+                      bench_destroy_nothing, bench_destroy_nothing,
+                      &b.h);
+  if (err)
+    return -1.0;
+
+  /* start half full */
+  for (i = 0; i < NKEYS && !err; i += 2)
+    err = hash_insert(b.h, &keys[i], sizeof(keys[i]), &keys[i]);
+
+  b.lock  = NULL;
+  b.ops   = ops;
+  b.reads = reads;
+
+  if (!concurrent)
+  {
+    pthread_mutex_init(&lock, NULL);
+    b.lock = &lock;
+  }
+
+  start = bench_now();
+
+  started = 0;
+  for (i = 0; i < nthreads && !err; i++)
+  {
+    threads[i].bench = &b;
+    threads[i].seed  = 0x9e3779b9u * (i + 1);
+    if (pthread_create(&ids[i], NULL, bench_worker, &threads[i]) != 0)
+      err = error_OOM;
+    else
+      started++;
+  }
+
+  for (i = 0; i < started; i++)
+  {
+    pthread_join(ids[i], NULL);
+    if (threads[i].err && !err)
+      err = threads[i].err;
+  }
+
+  elapsed = bench_now() - start;
+
+  if (!concurrent)
+    pthread_mutex_destroy(&lock);
+
+  hash_destroy(b.h);
+
+  if (err)
+    return -1.0;
+
+  return (double) nthreads * ops / elapsed / 1e6;
+}
+
+/* ----------------------------------------------------------------------- */
+
+/* Returns millions of lookups per second of a full hash, then of a perfect
+ * hash frozen from it, along with the bytes each occupies. */
+static error bench_frozen(int     ops,
+                          double *hash_mops,
+                          size_t *hash_bytes,
+                          double *frozen_mops,
+                          size_t *frozen_bytes)
+{
+  error              err;
+  hash_t            *h;
+  perfecthash_t     *ph = NULL;
+  datastruct_stats_t stats;
+  unsigned int       seed;
+  const void        *found;
+  double             start;
+  int                i;
+
+  err = hash_create(NULL, NKEYS, bench_hash, bench_compare,
+                    bench_destroy_nothing, bench_destroy_nothing,
+                    &h);
+  if (err)
+    return err;
+
+  *hash_mops   = *frozen_mops  = 0.0;
+  *hash_bytes  = *frozen_bytes = 0;
+
+  for (i = 0; i < NKEYS && !err; i++)
+    err = hash_insert(h, &keys[i], sizeof(keys[i]), &keys[i]);
+  if (!err)
+    err = perfecthash_create(NULL, &ph);
+  if (!err)
+    err = hash_walk(h, perfecthash_add_item, ph);
+  if (!err)
+    err = perfecthash_build(ph);
+  if (err)
+    goto exit;
+
+  found = NULL;
+
+  seed  = 0x9e3779b9u;
+  start = bench_now();
+  for (i = 0; i < ops; i++)
+    found = hash_lookup(h, &keys[(bench_rand(&seed) >> 8) % NKEYS]);
+  *hash_mops = ops / (bench_now() - start) / 1e6;
+
+  seed  = 0x9e3779b9u;
+  start = bench_now();
+  for (i = 0; i < ops; i++)
+    found = perfecthash_lookup(ph, &keys[(bench_rand(&seed) >> 8) % NKEYS],
+                               sizeof(int));
+  *frozen_mops = ops / (bench_now() - start) / 1e6;
+
+  if (found == NULL)
+    err = error_NOT_FOUND;
+
+  hash_stats(h, &stats);
+  *hash_bytes = stats.total_bytes;
+  perfecthash_stats(ph, &stats);
+  *frozen_bytes = stats.total_bytes;
+
+exit:
+
+  perfecthash_destroy(ph);
+  hash_destroy(h);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+int main(int argc, char *argv[])
+{
+  static const int mixes[] = { 50, 90, 99 };
+
+  int maxthreads = 8;
+  int ops        = 1000000;
+  int m;
+  int i;
+
+  while (++argv, --argc)
+  {
+    if (strcmp(argv[0], "-threads") == 0 && argc > 1)
+    {
+      maxthreads = atoi(*++argv), argc--;
+    }
+    else if (strcmp(argv[0], "-ops") == 0 && argc > 1)
+    {
+      ops = atoi(*++argv), argc--;
+    }
+    else
+    {
+      fprintf(stderr, "Usage: hash-bench [-threads <max>] [-ops <per thread>]\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  if (maxthreads < 1 || maxthreads > MAXTHREADS || ops < 1)
+  {
+    fprintf(stderr, "Bad arguments\n");
+    exit(EXIT_FAILURE);
+  }
+
+  for (i = 0; i < NKEYS; i++)
+    keys[i] = i;
+
+  printf("%d ops per thread, Mops/s (concurrent hash | mutex-guarded hash)\n",
+         ops);
+
+  for (m = 0; m < NELEMS(mixes); m++)
+  {
+    int nthreads;
+
+    printf("\nmix %d/%d read/write\n", mixes[m], 100 - mixes[m]);
+
+    for (nthreads = 1; nthreads <= maxthreads; nthreads *= 2)
+    {
+      double c, l;
+
+      c = bench_run(1, nthreads, ops, mixes[m]);
+      l = bench_run(0, nthreads, ops, mixes[m]);
+      if (c < 0 || l < 0)
+      {
+        fprintf(stderr, "Benchmark failed\n");
+        exit(EXIT_FAILURE);
+      }
+
+      printf("%3d threads: %8.2f | %8.2f\n", nthreads, c, l);
+    }
+  }
+
+  {
+    double hash_mops, frozen_mops;
+    size_t hash_bytes, frozen_bytes;
+
+    if (bench_frozen(ops, &hash_mops, &hash_bytes,
+                     &frozen_mops, &frozen_bytes))
+    {
+      fprintf(stderr, "Benchmark failed\n");
+      exit(EXIT_FAILURE);
+    }
+
+    printf("\nread only, %d keys, Mops/s and bytes (hash | perfect hash)\n",
+           NKEYS);
+    printf("lookups: %8.2f | %8.2f\n", hash_mops, frozen_mops);
+    printf("  bytes: %8zu | %8zu\n", hash_bytes, frozen_bytes);
+  }
+
+  exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,345 @@
+/* template-bench.c */
+
+/* Compares the function-pointer hash and critbit tree with specialisations
+ * generated by DEFINE_HASH and DEFINE_CRITBIT, timing inserts, lookups and
+ * removes of the same keys in the same order. */
+
+/* clock_gettime is not part of C99 */
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "datastruct/critbit.h"
+#include "datastruct/critbit-template.h"
+#include "datastruct/hash.h"
+#include "datastruct/hash-template.h"
+
+/* ----------------------------------------------------------------------- */
+
+#define NKEYS 65536
+
+static int  ints[NKEYS];
+static char strings[NKEYS][12];
+
+/* ----------------------------------------------------------------------- */
+
+static unsigned int bench_hash(const void *a)
+{
+  return *(const int *) a * 2654435761u;
+}
+
+static int bench_compare(const void *a, const void *b)
+{
+  int ia = *(const int *) a;
+  int ib = *(const int *) b;
+
+  return (ia > ib) - (ia < ib);
+}
+
+static void bench_destroy_nothing(void *doomed)
+{
+  NOT_USED(doomed);
+}
+
+#define bench_int_hash(k)  ((unsigned int) (k))
+#define bench_int_eq(a, b) ((a) == (b))
+
+DEFINE_HASH(bench_ints, int, const int *, bench_int_hash, bench_int_eq)
+
+DEFINE_CRITBIT(bench_strings, const char *, const char *, strlen)
+
+/* ----------------------------------------------------------------------- */
+
+typedef struct bench_result
+{
+  double insert;  /* Mops/s */
+  double lookup;
+  double remove;
+}
+bench_result_t;
+
+static unsigned int bench_rand(unsigned int *state)
+{
+  unsigned int x = *state;
+
+  /* xorshift32 */
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+
+  return *state = x;
+}
+
+static double bench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* The key to use for operation 'i' of a pass: a fixed scramble of [0,
+ * NKEYS). */
+#define KEY(i) ((int) ((unsigned int) (i) * 40503u % NKEYS))
+
+/* ----------------------------------------------------------------------- */
+
+static error bench_hash_fptr(int ops, bench_result_t *r)
+{
+  error        err;
+  hash_t      *h;
+  unsigned int seed;
+  const void  *found;
+  double       start;
+  int          i;
+
+  /* as many bins as the specialisation will have grown to */
+  err = hash_create(NULL, NKEYS, bench_hash, bench_compare,
+                    bench_destroy_nothing, bench_destroy_nothing,
+                    &h);
+  if (err)
+    return err;
+
+  start = bench_now();
+  for (i = 0; i < NKEYS && !err; i++)
+    err = hash_insert(h, &ints[KEY(i)], sizeof(int), &ints[KEY(i)]);
+  r->insert = NKEYS / (bench_now() - start) / 1e6;
+  if (err)
+    goto exit;
+
+  found = NULL;
+  seed  = 0x9e3779b9u;
+  start = bench_now();
+  for (i = 0; i < ops; i++)
+    found = hash_lookup(h, &ints[(bench_rand(&seed) >> 8) % NKEYS]);
+  r->lookup = ops / (bench_now() - start) / 1e6;
+  if (found == NULL)
+    err = error_NOT_FOUND;
+
+  start = bench_now();
+  for (i = 0; i < NKEYS; i++)
+    hash_remove(h, &ints[KEY(i)]);
+  r->remove = NKEYS / (bench_now() - start) / 1e6;
+
+exit:
+
+  hash_destroy(h);
+
+  return err;
+}
+
+static error bench_hash_specialised(int ops, bench_result_t *r)
+{
+  error         err;
+  bench_ints_t  h;
+  unsigned int  seed;
+  const int   **found;
+  double        start;
+  int           i;
+
+  bench_ints_init(&h);
+
+  err = error_OK;
+
+  start = bench_now();
+  for (i = 0; i < NKEYS && !err; i++)
+    err = bench_ints_insert(&h, ints[KEY(i)], &ints[KEY(i)]);
+  r->insert = NKEYS / (bench_now() - start) / 1e6;
+  if (err)
+    goto exit;
+
+  found = NULL;
+  seed  = 0x9e3779b9u;
+  start = bench_now();
+  for (i = 0; i < ops; i++)
+    found = bench_ints_lookup(&h, ints[(bench_rand(&seed) >> 8) % NKEYS]);
+  r->lookup = ops / (bench_now() - start) / 1e6;
+  if (found == NULL)
+    err = error_NOT_FOUND;
+
+  start = bench_now();
+  for (i = 0; i < NKEYS; i++)
+    bench_ints_remove(&h, ints[KEY(i)]);
+  r->remove = NKEYS / (bench_now() - start) / 1e6;
+
+exit:
+
+  bench_ints_fini(&h);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+static error bench_critbit_fptr(int ops, bench_result_t *r)
+{
+  error        err;
+  critbit_t   *t;
+  unsigned int seed;
+  const void  *found;
+  const char  *key;
+  double       start;
+  int          i;
+
+  err = critbit_create(NULL, bench_destroy_nothing, bench_destroy_nothing,
+                       &t);
+  if (err)
+    return err;
+
+  start = bench_now();
+  for (i = 0; i < NKEYS && !err; i++)
+  {
+    key = strings[KEY(i)];
+    err = critbit_insert(t, key, strlen(key), key);
+  }
+  r->insert = NKEYS / (bench_now() - start) / 1e6;
+  if (err)
+    goto exit;
+
+  found = NULL;
+  seed  = 0x9e3779b9u;
+  start = bench_now();
+  for (i = 0; i < ops; i++)
+  {
+    key   = strings[(bench_rand(&seed) >> 8) % NKEYS];
+    found = critbit_lookup(t, key, strlen(key));
+  }
+  r->lookup = ops / (bench_now() - start) / 1e6;
+  if (found == NULL)
+    err = error_NOT_FOUND;
+
+  start = bench_now();
+  for (i = 0; i < NKEYS; i++)
+  {
+    key = strings[KEY(i)];
+    critbit_remove(t, key, strlen(key));
+  }
+  r->remove = NKEYS / (bench_now() - start) / 1e6;
+
+exit:
+
+  critbit_destroy(t);
+
+  return err;
+}
+
+static error bench_critbit_specialised(int ops, bench_result_t *r)
+{
+  error            err;
+  bench_strings_t  t;
+  unsigned int     seed;
+  const char     **found;
+  const char      *key;
+  double           start;
+  int              i;
+
+  bench_strings_init(&t);
+
+  err = error_OK;
+
+  start = bench_now();
+  for (i = 0; i < NKEYS && !err; i++)
+  {
+    key = strings[KEY(i)];
+    err = bench_strings_insert(&t, key, key);
+  }
+  r->insert = NKEYS / (bench_now() - start) / 1e6;
+  if (err)
+    goto exit;
+
+  found = NULL;
+  seed  = 0x9e3779b9u;
+  start = bench_now();
+  for (i = 0; i < ops; i++)
+    found = bench_strings_lookup(&t,
+                                 strings[(bench_rand(&seed) >> 8) % NKEYS]);
+  r->lookup = ops / (bench_now() - start) / 1e6;
+  if (found == NULL)
+    err = error_NOT_FOUND;
+
+  start = bench_now();
+  for (i = 0; i < NKEYS; i++)
+    bench_strings_remove(&t, strings[KEY(i)]);
+  r->remove = NKEYS / (bench_now() - start) / 1e6;
+
+exit:
+
+  bench_strings_fini(&t);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+static void bench_print(const char           *name,
+                        const bench_result_t *fptr,
+                        const bench_result_t *specialised)
+{
+  printf("\n%s\n", name);
+  printf("insert: %8.2f | %8.2f\n", fptr->insert, specialised->insert);
+  printf("lookup: %8.2f | %8.2f\n", fptr->lookup, specialised->lookup);
+  printf("remove: %8.2f | %8.2f\n", fptr->remove, specialised->remove);
+}
+
+int main(int argc, char *argv[])
+{
+  bench_result_t fptr;
+  bench_result_t specialised;
+  int            ops = 1000000;
+  int            i;
+
+  while (++argv, --argc)
+  {
+    if (strcmp(argv[0], "-ops") == 0 && argc > 1)
+    {
+      ops = atoi(*++argv), argc--;
+    }
+    else
+    {
+      fprintf(stderr, "Usage: template-bench [-ops <lookups>]\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  if (ops < 1)
+  {
+    fprintf(stderr, "Bad arguments\n");
+    exit(EXIT_FAILURE);
+  }
+
+  for (i = 0; i < NKEYS; i++)
+  {
+    ints[i] = i;
+    sprintf(strings[i], "key%07d", i);
+  }
+
+  printf("%d keys, %d lookups, Mops/s (function pointers | specialised)\n",
+         NKEYS, ops);
+
+  if (bench_hash_fptr(ops, &fptr) ||
+      bench_hash_specialised(ops, &specialised))
+  {
+    fprintf(stderr, "Benchmark failed\n");
+    exit(EXIT_FAILURE);
+  }
+
+  bench_print("hash, int keys", &fptr, &specialised);
+
+  if (bench_critbit_fptr(ops, &fptr) ||
+      bench_critbit_specialised(ops, &specialised))
+  {
+    fprintf(stderr, "Benchmark failed\n");
+    exit(EXIT_FAILURE);
+  }
+
+  bench_print("critbit, string keys", &fptr, &specialised);
+
+  exit(EXIT_SUCCESS);
+}
@@ -1,9 +1,584 @@
+/* word-test.c */
+
+/* Word frequency benchmark.
+ *
+ * Counts the frequency of every word in a text corpus, or in a generated
+ * stream of words with a Zipfian distribution, using each container type in
+ * turn. Reports the throughput of counting, lookups, prefix queries and
+ * destruction, along with the numbers of keys and nodes the container's
+ * stats report and the peak resident set size of the process.
+ *
+ * Each container runs in its own child process so that its peak RSS is
+ * measured in isolation.
+ */
+
+/* clock_gettime, fork and getrusage are not part of C99 */
+#define _XOPEN_SOURCE 700
+
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "keyval/int.h"
+#include "keyval/string.h"
+
+#include "container/interface/container.h"
+#include "container/interface/key.h"
+#include "container/interface/value.h"
+#include "container/interface/maker.h"
+
+#include "container/orderedarray.h"
+#include "container/linkedlist.h"
+#include "container/hash.h"
+#include "container/bstree.h"
+#include "container/dstree.h"
+#include "container/trie.h"
+#include "container/critbit.h"
+#include "container/patricia.h"
+
+/* ----------------------------------------------------------------------- */
+
+static const struct
+{
+  icontainer_maker *maker;
+  const char       *name;
+}
+makers[] =
+{
+  { container_create_orderedarray, "orderedarray" },
+  { container_create_linkedlist,   "linkedlist"   },
+  { container_create_hash,         "hash"         },
+  { container_create_bstree,       "bstree"       },
+  { container_create_dstree,       "dstree"       },
+  { container_create_trie,         "trie"         },
+  { container_create_critbit,      "critbit"      },
+  { container_create_patricia,     "patricia"     },
+};
+
+/* Keys are malloc'd strings owned by the container. */
+static const icontainer_key_t word_key =
+{
+  stringkv_len, stringkv_compare, stringkv_hash,
+  { free, stringkv_fmt, stringkv_fmt_nodestroy }
+};
+
+/* Values are malloc'd int counts owned by the container. */
+static const icontainer_value_t count_value =
+{
+  NULL /* default value */,
+  { free, intkv_fmt, intkv_fmt_destroy }
+};
+
+/* ----------------------------------------------------------------------- */
 
-int main(void)
+/* The stream of words to count. */
+typedef struct corpus
 {
-  printf("This is just a stub file to allow compilation to work.\n");
-  exit(EXIT_SUCCESS);
+  char        *text;    /* storage for words, if loaded */
+  const char **words;   /* each word in stream order */
+  int          nwords;
+  char        *vocab;   /* storage for generated vocabulary */
+}
+corpus_t;
+
+/* Split a file into lower case alphabetic words. */
+static error corpus_load(corpus_t *corpus, const char *filename)
+{
+  FILE   *f;
+  long    length;
+  char   *p;
+  char   *end;
+  int     maxwords;
+
+  f = fopen(filename, "rb");
+  if (f == NULL)
+  {
+    fprintf(stderr, "Can't open '%s'\n", filename);
+    return error_NOT_FOUND;
+  }
+
+  fseek(f, 0, SEEK_END);
+  length = ftell(f);
+  fseek(f, 0, SEEK_SET);
+
+  corpus->text = malloc(length + 1);
+  if (corpus->text == NULL)
+  {
+    fclose(f);
+    return error_OOM;
+  }
+
+  length = (long) fread(corpus->text, 1, length, f);
+  fclose(f);
+
+  /* words are at least two chars apart, counting the separator */
+  maxwords = (int) (length / 2 + 1);
+  corpus->words = malloc(maxwords * sizeof(*corpus->words));
+  if (corpus->words == NULL)
+    return error_OOM;
+
+  corpus->nwords = 0;
+
+  /* terminate each word in place */
+  end = corpus->text + length;
+  for (p = corpus->text; p < end; )
+  {
+    char *word;
+
+    while (p < end && !isalpha((unsigned char) *p))
+      p++;
+    if (p == end)
+      break;
+
+    word = p;
+    while (p < end && isalpha((unsigned char) *p))
+    {
+      *p = (char) tolower((unsigned char) *p);
+      p++;
+    }
+    *p++ = '\0'; /* safe: the buffer has one spare byte */
+
+    corpus->words[corpus->nwords++] = word;
+  }
+
+  return error_OK;
+}
+
+static unsigned int corpus_rand(unsigned int *state)
+{
+  unsigned int x = *state;
+
+  /* xorshift32 */
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+
+  return *state = x;
+}
+
+/* Generate 'nwords' words drawn from a vocabulary of 'nvocab' distinct
+ * words, where the k'th most frequent word occurs with probability
+ * proportional to 1/k. */
+static error corpus_generate(corpus_t *corpus, int nwords, int nvocab)
+{
+  enum { MAXLEN = 12 };
+
+  char        **vocab;
+  double       *cdf;
+  double        total;
+  unsigned int  seed = 0x12345678;
+  int           i;
+
+  corpus->vocab = malloc((size_t) nvocab * (MAXLEN + 1));
+  vocab         = malloc(nvocab * sizeof(*vocab));
+  cdf           = malloc(nvocab * sizeof(*cdf));
+  corpus->words = malloc(nwords * sizeof(*corpus->words));
+  if (corpus->vocab == NULL || vocab == NULL || cdf == NULL ||
+      corpus->words == NULL)
+  {
+    free(cdf);
+    free(vocab);
+    return error_OOM;
+  }
+
+  /* make distinct words of varied length: the word's index written in base
+   * 26 followed by a pseudo-random tail */
+  for (i = 0; i < nvocab; i++)
+  {
+    char *w = corpus->vocab + (size_t) i * (MAXLEN + 1);
+    int   n = i;
+    int   len;
+    int   tail;
+
+    len = 0;
+    do
+    {
+      w[len++] = (char) ('a' + n % 26);
+      n /= 26;
+    }
+    while (n);
+
+    w[len++] = '-'; /* keeps the tails from making words collide */
+
+    tail = corpus_rand(&seed) % (MAXLEN - len + 1);
+    while (tail--)
+      w[len++] = (char) ('a' + corpus_rand(&seed) % 26);
+
+    w[len] = '\0';
+
+    vocab[i] = w;
+  }
+
+  total = 0.0;
+  for (i = 0; i < nvocab; i++)
+  {
+    total += 1.0 / (i + 1);
+    cdf[i] = total;
+  }
+
+  for (i = 0; i < nwords; i++)
+  {
+    double r;
+    int    lo, hi;
+
+    r = corpus_rand(&seed) / 4294967296.0 * total;
+
+    /* binary search for the first entry >= r */
+    lo = 0;
+    hi = nvocab - 1;
+    while (lo < hi)
+    {
+      int mid = (lo + hi) / 2;
+
+      if (cdf[mid] < r)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+    corpus->words[i] = vocab[lo];
+  }
+
+  corpus->nwords = nwords;
+
+  free(cdf);
+  free(vocab);
+
+  return error_OK;
+}
+
+static void corpus_destroy(corpus_t *corpus)
+{
+  free(corpus->words);
+  free(corpus->vocab);
+  free(corpus->text);
+}
+
+/* ----------------------------------------------------------------------- */
+
+static double now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static char *word_dup(const char *s)
+{
+  size_t len;
+  char  *d;
+
+  len = strlen(s) + 1;
+  d = malloc(len);
+  if (d)
+    memcpy(d, s, len);
+
+  return d;
 }
 
+/* Count every word in the corpus. */
+static error bench_count(icontainer_t *c, const corpus_t *corpus)
+{
+  int i;
+
+  for (i = 0; i < corpus->nwords; i++)
+  {
+    const char *word = corpus->words[i];
+    int        *count;
+
+    count = (int *) c->lookup(c, word); /* must cast away const */
+    if (count)
+    {
+      (*count)++;
+    }
+    else
+    {
+      char  *key;
+      error  err;
+
+      key   = word_dup(word);
+      count = malloc(sizeof(*count));
+      if (key == NULL || count == NULL)
+      {
+        free(count);
+        free(key);
+        return error_OOM;
+      }
+
+      *count = 1;
+
+      err = c->insert(c, key, count);
+      if (err)
+      {
+        free(count);
+        free(key);
+        return err;
+      }
+    }
+  }
+
+  return error_OK;
+}
+
+/* Look up every word in the corpus again. Returns the number of words
+ * found, which should be all of them. */
+static int bench_lookup(icontainer_t *c, const corpus_t *corpus)
+{
+  int hits;
+  int i;
+
+  hits = 0;
+  for (i = 0; i < corpus->nwords; i++)
+  {
+    const int *count;
+
+    count = c->lookup(c, corpus->words[i]);
+    hits += (count != NULL && *count > 0);
+  }
+
+  return hits;
+}
+
+static error bench_prefix_found(const item_t *item, void *opaque)
+{
+  long *found = opaque;
+
+  NOT_USED(item);
+
+  (*found)++;
+
+  return error_OK;
+}
+
+/* Query every two letter prefix. Returns the number of items found, or -1
+ * if the container doesn't support prefix queries. */
+static long bench_prefix(icontainer_t *c, int *nqueries)
+{
+  long found;
+  char prefix[3];
+  int  a, b;
+
+  found     = 0;
+  *nqueries = 0;
+
+  prefix[2] = '\0';
+  for (a = 0; a < 26; a++)
+    for (b = 0; b < 26; b++)
+    {
+      error err;
+
+      prefix[0] = (char) ('a' + a);
+      prefix[1] = (char) ('a' + b);
+
+      err = c->lookup_prefix(c, prefix, bench_prefix_found, &found);
+      if (err == error_NOT_IMPLEMENTED)
+        return -1;
+
+      ++*nqueries;
+    }
+
+  return found;
+}
+
+/* ----------------------------------------------------------------------- */
+
+static int bench_container(icontainer_maker *maker,
+                           const char       *name,
+                           const corpus_t   *corpus)
+{
+  error              err;
+  icontainer_t      *c;
+  double             t0, t1, t2, t3, t4;
+  int                hits;
+  long               found;
+  int                nqueries;
+  datastruct_stats_t stats;
+  struct rusage      usage;
+
+  err = maker(&c, &word_key, &count_value);
+  if (err)
+  {
+    fprintf(stderr, "%s: create failed (%lu)\n", name, err);
+    return EXIT_FAILURE;
+  }
+
+  t0 = now();
+  err = bench_count(c, corpus);
+  t1 = now();
+  if (err)
+  {
+    fprintf(stderr, "%s: count failed (%lu)\n", name, err);
+    return EXIT_FAILURE;
+  }
+
+  hits = bench_lookup(c, corpus);
+  t2 = now();
+  if (hits != corpus->nwords)
+  {
+    fprintf(stderr, "%s: only %d of %d words found\n",
+            name, hits, corpus->nwords);
+    return EXIT_FAILURE;
+  }
+
+  found = bench_prefix(c, &nqueries);
+  t3 = now();
+
+  /* count() is of nodes for some containers and of keys for others, so
+   * take both from the stats */
+  c->stats(c, NULL, NULL, &stats);
+
+  c->destroy(c);
+  t4 = now();
+
+  getrusage(RUSAGE_SELF, &usage);
+
+  printf("%-12s %10.3f %10.3f ", name,
+         corpus->nwords / (t1 - t0) / 1e6,
+         corpus->nwords / (t2 - t1) / 1e6);
+  if (found >= 0)
+    printf("%10.0f %10ld ", nqueries / (t3 - t2), found);
+  else
+    printf("%10s %10s ", "n/a", "n/a");
+  printf("%10.3f %10d %10d %10ld\n",
+         (t4 - t3) * 1e3,
+         stats.elements,
+         stats.branches + stats.leaves,
+         usage.ru_maxrss);
+
+  return EXIT_SUCCESS;
+}
+
+/* Run the benchmark in a child process. */
+static int bench_fork(icontainer_maker *maker,
+                      const char       *name,
+                      const corpus_t   *corpus)
+{
+  pid_t pid;
+  int   status;
+
+  fflush(stdout);
+
+  pid = fork();
+  if (pid < 0)
+    return bench_container(maker, name, corpus); /* run it here instead */
+
+  if (pid == 0)
+  {
+    status = bench_container(maker, name, corpus);
+    fflush(stdout);
+    _exit(status);
+  }
+
+  if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status))
+    return EXIT_FAILURE;
+
+  return WEXITSTATUS(status);
+}
+
+/* ----------------------------------------------------------------------- */
+
+static void usage(void)
+{
+  fprintf(stderr,
+          "Usage: word-test [options]\n"
+          "  -file <name>      count the words in a text file\n"
+          "  -words <n>        otherwise generate n words (default 200000)\n"
+          "  -vocab <n>        from a vocabulary of n words (default 10000)\n"
+          "  -only <name,...>  benchmark only the named containers\n");
+  exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[])
+{
+  error       err;
+  const char *filename = NULL;
+  const char *only     = NULL;
+  int         nwords   = 200000;
+  int         nvocab   = 10000;
+  corpus_t    corpus;
+  int         failures;
+  int         i;
+
+  while (++argv, --argc)
+  {
+    if (argc < 2)
+      usage();
+
+    if (strcmp(argv[0], "-file") == 0)
+      filename = argv[1];
+    else if (strcmp(argv[0], "-words") == 0)
+      nwords = atoi(argv[1]);
+    else if (strcmp(argv[0], "-vocab") == 0)
+      nvocab = atoi(argv[1]);
+    else if (strcmp(argv[0], "-only") == 0)
+      only = argv[1];
+    else
+      usage();
+
+    ++argv, --argc;
+  }
+
+  if (nwords < 1 || nvocab < 1)
+    usage();
+
+  memset(&corpus, 0, sizeof(corpus));
+
+  if (filename)
+    err = corpus_load(&corpus, filename);
+  else
+    err = corpus_generate(&corpus, nwords, nvocab);
+  if (err)
+  {
+    fprintf(stderr, "Couldn't prepare corpus (%lu)\n", err);
+    exit(EXIT_FAILURE);
+  }
+
+  if (filename)
+    printf("corpus: %d words from '%s'\n", corpus.nwords, filename);
+  else
+    printf("corpus: %d words, Zipfian over %d distinct\n",
+           corpus.nwords, nvocab);
+
+  printf("%-12s %10s %10s %10s %10s %10s %10s %10s %10s\n",
+         "container", "count", "lookup", "prefix", "prefix", "destroy",
+         "keys", "nodes", "peak rss");
+  printf("%-12s %10s %10s %10s %10s %10s %10s %10s %10s\n",
+         "", "Mwords/s", "Mwords/s", "queries/s", "found", "ms",
+         "", "", "KiB");
+
+  failures = 0;
+  for (i = 0; i < NELEMS(makers); i++)
+  {
+    if (only)
+    {
+      const char *p;
+      size_t      len = strlen(makers[i].name);
+
+      /* match a whole comma separated name */
+      for (p = strstr(only, makers[i].name); p; p = strstr(p + 1, makers[i].name))
+        if ((p == only || p[-1] == ',') && (p[len] == ',' || p[len] == '\0'))
+          break;
+      if (p == NULL)
+        continue;
+    }
+
+    if (bench_fork(makers[i].maker, makers[i].name, &corpus) != EXIT_SUCCESS)
+      failures++;
+  }
+
+  corpus_destroy(&corpus);
+
+  exit(failures ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -0,0 +1,32 @@
+/* --------------------------------------------------------------------------
+ *    Name: atomic.h
+ * Purpose: Atomic memory operations
+ * ----------------------------------------------------------------------- */
+
+/* These wrap the GCC/Clang __atomic builtins. They operate on ordinary
+ * (non-_Atomic) objects of pointer or integer size. */
+
+#ifndef ATOMIC_H
+#define ATOMIC_H
+
+#define ATOMIC_LOAD_RELAXED(p)     __atomic_load_n((p), __ATOMIC_RELAXED)
+#define ATOMIC_LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define ATOMIC_LOAD(p)             __atomic_load_n((p), __ATOMIC_SEQ_CST)
+
+#define ATOMIC_STORE_RELAXED(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#define ATOMIC_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define ATOMIC_STORE(p, v)         __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+
+/* Returns non-zero if *p was 'expected' and is now 'desired'. */
+#define ATOMIC_CAS(p, expected, desired)                              \
+  __extension__ ({                                                    \
+    __typeof__(*(p)) atomic__expected = (expected);                   \
+    __atomic_compare_exchange_n((p), &atomic__expected, (desired), 0, \
+                                __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);  \
+  })
+
+#define ATOMIC_FETCH_ADD(p, v)     __atomic_fetch_add((p), (v), __ATOMIC_SEQ_CST)
+
+#define ATOMIC_FENCE()             __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+#endif /* ATOMIC_H */
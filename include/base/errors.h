@@ -16,6 +16,8 @@ typedef unsigned long int error;
 #define error_NOT_FOUND             3ul /* Item not found */
 #define error_EXISTS                4ul /* Item already exists */
 #define error_STOP_WALK             5ul /* Callback was cancelled */
+#define error_READ_ONLY             6ul /* Object cannot be modified */
+#define error_IO                    7ul /* File could not be read or written */
 
 /* Data structure errors */
 
@@ -27,6 +29,14 @@ typedef unsigned long int error;
 #define error_HASH_END            120ul
 #define error_HASH_BAD_CONT       121ul
 
+#define error_FLAT_BAD_FORMAT     130ul
+
+#define error_CRITBIT_UNSORTED    140ul
+
+#define error_PERFECTHASH_FAILED  150ul /* No perfect hash was found */
+
+#define error_FILTER_FAILED       160ul /* No XOR filter was found */
+
 /* Container errors */
 
 #define error_KEYLEN_REQUIRED     200ul
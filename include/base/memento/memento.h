@@ -1 +1,83 @@
-extern int dummy;
+/* --------------------------------------------------------------------------
+ *    Name: memento.h
+ * Purpose: Allocation tracker
+ * ----------------------------------------------------------------------- */
+
+/* When built with MEMENTO defined ('make memento=yes') every file which
+ * includes this header has its calls to malloc, calloc, realloc and free
+ * routed through the tracker. It counts allocations, frees and bytes, both
+ * overall and for each call site (file and line), recording the peak number
+ * of live bytes and a histogram of allocation sizes per site.
+ *
+ * Blocks allocated by files which don't include this header (or by the C
+ * library) may still be freed by files which do: the tracker only accounts
+ * for blocks it has seen allocated.
+ *
+ * Otherwise the allocation functions are left alone and the memento_ calls
+ * expand to nothing.
+ *
+ * Include this after any system headers.
+ */
+
+#ifndef MEMENTO_H
+#define MEMENTO_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ----------------------------------------------------------------------- */
+
+/* Bucket N counts allocations of up to 2^(N+3) bytes. The final bucket
+ * counts all larger allocations. */
+#define memento_HISTOGRAM_BUCKETS 16
+
+typedef struct memento_stats
+{
+  unsigned long allocs;       /* malloc, calloc and realloc of NULL */
+  unsigned long reallocs;     /* realloc of an existing block */
+  unsigned long frees;        /* free and realloc to zero */
+  unsigned long live_blocks;
+  size_t        live_bytes;
+  size_t        peak_bytes;   /* highest live_bytes */
+  size_t        total_bytes;  /* bytes allocated, including by realloc */
+}
+memento_stats_t;
+
+#ifdef MEMENTO
+
+void *memento_malloc(size_t size, const char *file, int line);
+void *memento_calloc(size_t nmemb, size_t size, const char *file, int line);
+void *memento_realloc(void *ptr, size_t size, const char *file, int line);
+void memento_free(void *ptr);
+
+/* Retrieve the overall counts. */
+void memento_stats(memento_stats_t *stats);
+
+/* Write the overall counts then those for every call site active since
+ * the last reset, most bytes first, to 'f'. */
+void memento_dump(FILE *f);
+
+/* Zero the counts. Live blocks remain tracked, so the live counts are kept
+ * and peak_bytes restarts from live_bytes. */
+void memento_reset(void);
+
+#ifndef MEMENTO_IMPLEMENTATION
+#define malloc(size)        memento_malloc(size, __FILE__, __LINE__)
+#define calloc(nmemb, size) memento_calloc(nmemb, size, __FILE__, __LINE__)
+#define realloc(ptr, size)  memento_realloc(ptr, size, __FILE__, __LINE__)
+#define free(ptr)           memento_free(ptr)
+#endif
+
+#else
+
+#define memento_stats(stats) memset(stats, 0, sizeof(memento_stats_t))
+#define memento_dump(f)      ((void) 0)
+#define memento_reset()      ((void) 0)
+
+#endif
+
+/* ----------------------------------------------------------------------- */
+
+#endif /* MEMENTO_H */
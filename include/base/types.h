@@ -37,6 +37,14 @@ typedef int intptr_t;
 #define INLINE __inline__
 #endif
 
+/* Marks static functions defined in headers, which not every includer
+ * calls. */
+#ifdef __GNUC__
+#define MAYBE_UNUSED __attribute__((unused))
+#else
+#define MAYBE_UNUSED
+#endif
+
 #ifdef __GNUC__
 #define likely(x)   __builtin_expect(!!(x), 1)
 #define unlikely(x) __builtin_expect(!!(x), 0)
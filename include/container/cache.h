@@ -0,0 +1,29 @@
+/* --------------------------------------------------------------------------
+ *    Name: cache.h
+ * Purpose: Interface of a cache container
+ * ----------------------------------------------------------------------- */
+
+/* A cache container holds at most 'max_entries' entries, evicting others
+ * according to 'policy' to make room for new ones. See datastruct/cache.h.
+ * The key interface must supply 'len', 'compare' and 'hash'.
+ *
+ * Lookups update the eviction state, so unlike most containers a cache
+ * container isn't safe to look up in from more than one thread at once. It
+ * sets 'lookups_modify' so that a sharded container of caches takes each
+ * shard's write lock for lookups.
+ */
+
+#ifndef CONTAINER_CACHE_H
+#define CONTAINER_CACHE_H
+
+#include "datastruct/cache.h"
+
+#include "container/interface/maker.h"
+
+error container_create_cache(icontainer_t            **container,
+                             cache_policy_t            policy,
+                             int                       max_entries,
+                             const icontainer_key_t   *key,
+                             const icontainer_value_t *value);
+
+#endif /* CONTAINER_CACHE_H */
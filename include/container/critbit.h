@@ -10,5 +10,9 @@
 
 icontainer_maker container_create_critbit;
 
+/* As above but the keys' bytes are copied into the data structure's nodes.
+ * See critbit_set_inline_keys. */
+icontainer_maker container_create_critbit_inline_keys;
+
 #endif /* CONTAINER_CRITBIT_H */
 
@@ -0,0 +1,47 @@
+/* --------------------------------------------------------------------------
+ *    Name: filtered.h
+ * Purpose: Interface of a container fronted by a membership filter
+ * ----------------------------------------------------------------------- */
+
+/* A filtered container wraps an inner container, made by 'maker', and
+ * checks a filter (datastruct/filter.h) of the keys' hashes before each
+ * lookup. Most lookups of absent keys are then answered by the filter,
+ * with one or three memory accesses, instead of a full search of the inner
+ * container. The key interface must supply 'len' and 'hash'.
+ *
+ * - container_FILTER_BLOOM suits containers which change. The Bloom filter
+ *   is sized for 'capacity' keys. Removed keys stay in it until the
+ *   container empties, and beyond 'capacity' keys its false positive rate
+ *   rises, but it never hides a key which is present.
+ *
+ * - container_FILTER_XOR suits containers which are filled then only read.
+ *   The container keeps the hash of every key and builds an XOR filter
+ *   from them in the first lookup after a change. Until then lookups go
+ *   straight to the inner container. Removes cost O(n). 'capacity' is only
+ *   a hint. Since a lookup may build the filter, lookups must not run
+ *   concurrently. A sharded container of this kind takes each shard's
+ *   write lock for lookups.
+ *
+ * All other methods are passed to the inner container.
+ */
+
+#ifndef CONTAINER_FILTERED_H
+#define CONTAINER_FILTERED_H
+
+#include "container/interface/maker.h"
+
+typedef enum container_filter
+{
+  container_FILTER_BLOOM,
+  container_FILTER_XOR
+}
+container_filter_t;
+
+error container_create_filtered(icontainer_t            **container,
+                                icontainer_maker         *maker,
+                                container_filter_t        filter,
+                                int                       capacity,
+                                const icontainer_key_t   *key,
+                                const icontainer_value_t *value);
+
+#endif /* CONTAINER_FILTERED_H */
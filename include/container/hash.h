@@ -10,5 +10,9 @@
 
 icontainer_maker container_create_hash;
 
+/* As above but the keys' bytes are copied into the data structure's nodes.
+ * See hash_set_inline_keys. */
+icontainer_maker container_create_hash_inline_keys;
+
 #endif /* CONTAINER_HASH_H */
 
@@ -24,7 +24,12 @@
 
 #include "base/errors.h"
 
+#include "datastruct/depth.h"
+#include "datastruct/instrument.h"
 #include "datastruct/item.h"
+#include "datastruct/stats.h"
+
+#include "container/interface/kv.h"
 
 #define T icontainer_t
 
@@ -45,6 +50,23 @@ typedef error (*icontainer_insert)(T          *c,
 typedef void (*icontainer_remove)(T          *c,
                                   const void *key);
 
+/* As lookup, insert and remove, but passed the key's length as the key
+ * interface's 'len' would return it. Use these when the length is already
+ * known, to save the container measuring the key again. Containers which
+ * compare whole keys, rather than their bytes, may ignore 'keylen'. */
+typedef const void *(*icontainer_lookup_n)(const T    *c,
+                                           const void *key,
+                                           size_t      keylen);
+
+typedef error (*icontainer_insert_n)(T          *c,
+                                     const void *key,
+                                     size_t      keylen,
+                                     const void *value);
+
+typedef void (*icontainer_remove_n)(T          *c,
+                                    const void *key,
+                                    size_t      keylen);
+
 /* Select K'th largest element. */
 typedef const item_t *(*icontainer_select)(const T *c,
                                            int      k);
@@ -59,9 +81,38 @@ typedef error (*icontainer_lookup_prefix)(const T                   *c,
                                           icontainer_found_callback  cb,
                                           void                      *opaque);
 
+/* As lookup_prefix, but passed the prefix's length as the key interface's
+ * 'len' would return it. Containers which compare whole keys, rather than
+ * their bytes, may ignore 'prefixlen'. */
+typedef error (*icontainer_lookup_prefix_n)(const T                   *c,
+                                            const void                *prefix,
+                                            size_t                     prefixlen,
+                                            icontainer_found_callback  cb,
+                                            void                      *opaque);
+
 /* Return number of elements in container. */
 typedef int (*icontainer_count)(const T *c);
 
+/* Report memory use. The node and table figures come from counters which
+ * the container maintains, so are cheap to fetch. If 'key_len' or
+ * 'value_len' are non-NULL then the bytes used by keys or values are summed
+ * too, which visits every element. */
+typedef void (*icontainer_stats)(const T            *c,
+                                 icontainer_kv_len   key_len,
+                                 icontainer_kv_len   value_len,
+                                 datastruct_stats_t *stats);
+
+/* Copy out operation counters. Returns error_NOT_IMPLEMENTED unless built
+ * with DATASTRUCT_INSTRUMENT. */
+typedef error (*icontainer_instrument)(const T                 *c,
+                                       datastruct_instrument_t *counts);
+
+/* Summarise the shape of the container by walking it. Returns
+ * error_NOT_IMPLEMENTED for containers with no meaningful shape. See
+ * datastruct/depth.h. */
+typedef error (*icontainer_depth_stats)(const T                  *c,
+                                        datastruct_depth_stats_t *stats);
+
 /* Display container's contents. */
 typedef error (*icontainer_show)(const T *c,
                                  FILE    *f);
@@ -75,15 +126,28 @@ typedef void (*icontainer_destroy)(T *doomed);
 
 struct icontainer
 {
-  icontainer_lookup        lookup;
-  icontainer_insert        insert;
-  icontainer_remove        remove;
-  icontainer_select        select;
-  icontainer_lookup_prefix lookup_prefix;
-  icontainer_count         count;
-  icontainer_show          show;
-  icontainer_show_viz      show_viz;
-  icontainer_destroy       destroy;
+  icontainer_lookup          lookup;
+  icontainer_insert          insert;
+  icontainer_remove          remove;
+  icontainer_lookup_n        lookup_n;
+  icontainer_insert_n        insert_n;
+  icontainer_remove_n        remove_n;
+  icontainer_select          select;
+  icontainer_lookup_prefix   lookup_prefix;
+  icontainer_lookup_prefix_n lookup_prefix_n;
+  icontainer_count           count;
+  icontainer_stats           stats;
+  icontainer_instrument      instrument;
+  icontainer_depth_stats     depth_stats;
+  icontainer_show            show;
+  icontainer_show_viz        show_viz;
+  icontainer_destroy         destroy;
+
+  /* Non-zero if the lookup, select or lookup_prefix methods, or their _n
+   * forms, may modify the container, e.g. to record a use, so mustn't run
+   * concurrently with one another. Set in each container's method table, or
+   * on creation where it depends on the arguments. */
+  int                        lookups_modify;
 };
 
 /* ----------------------------------------------------------------------- */
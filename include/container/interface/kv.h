@@ -6,6 +6,8 @@
 #ifndef ICONTAINER_KV_H
 #define ICONTAINER_KV_H
 
+#include <stddef.h>
+
 /* Destroy the specified key. */
 typedef void (*icontainer_kv_destroy)(void *kv);
 
@@ -15,6 +17,9 @@ typedef const char *(*icontainer_kv_show)(const void *kv);
 /* Destroy the object 'show' returned. */
 typedef void (*icontainer_kv_show_destroy)(char *doomed);
 
+/* Return the number of bytes used by the specified key or value. */
+typedef size_t (*icontainer_kv_len)(const void *kv);
+
 typedef struct icontainer_kv
 {
   icontainer_kv_destroy      destroy;
@@ -0,0 +1,36 @@
+/* --------------------------------------------------------------------------
+ *    Name: stats.h
+ * Purpose: Helpers for container memory statistics
+ * ----------------------------------------------------------------------- */
+
+#ifndef ICONTAINER_STATS_H
+#define ICONTAINER_STATS_H
+
+#include "datastruct/stats.h"
+
+#include "container/interface/kv.h"
+
+/* Glue libraries walk their data structure passing each element to
+ * icontainer_kv_stats_add to total up key and value bytes. */
+
+typedef struct icontainer_kv_stats
+{
+  icontainer_kv_len   key_len;   /* may be NULL */
+  icontainer_kv_len   value_len; /* may be NULL */
+  datastruct_stats_t *stats;
+}
+icontainer_kv_stats_t;
+
+/* Account for the glue structure of 'size' bytes, then set up 'kvs'.
+ * Returns non-zero if a walk is needed to total up keys and values. */
+int icontainer_kv_stats_init(icontainer_kv_stats_t *kvs,
+                             size_t                 size,
+                             icontainer_kv_len      key_len,
+                             icontainer_kv_len      value_len,
+                             datastruct_stats_t    *stats);
+
+void icontainer_kv_stats_add(icontainer_kv_stats_t *kvs,
+                             const void            *key,
+                             const void            *value);
+
+#endif /* ICONTAINER_STATS_H */
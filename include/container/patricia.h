@@ -10,5 +10,9 @@
 
 icontainer_maker container_create_patricia;
 
+/* As above but the keys' bytes are copied into the data structure's nodes.
+ * See patricia_set_inline_keys. */
+icontainer_maker container_create_patricia_inline_keys;
+
 #endif /* CONTAINER_PATRICIA_H */
 
@@ -0,0 +1,34 @@
+/* --------------------------------------------------------------------------
+ *    Name: sharded.h
+ * Purpose: Interface of a thread-safe sharded container
+ * ----------------------------------------------------------------------- */
+
+/* A sharded container spreads its keys across 'nshards' inner containers,
+ * each made by 'maker' and each guarded by its own reader-writer lock. Keys
+ * are routed to a shard by their hash, so the key interface must supply a
+ * 'hash' function. It must also supply 'compare' which is used to merge the
+ * ordered output of the shards for 'select' and 'lookup_prefix'.
+ *
+ * Every method is safe to call concurrently from multiple threads. Lookups
+ * on different shards proceed in parallel. Lookups on the same shard share
+ * its lock, unless the inner containers set 'lookups_modify' - as caches
+ * and XOR-filtered containers do - in which case lookup, select and
+ * lookup_prefix take the write lock instead.
+ *
+ * Pointers returned by 'lookup' and 'select' point into the inner
+ * containers. They remain valid only until the key is next removed or
+ * overwritten by another thread.
+ */
+
+#ifndef CONTAINER_SHARDED_H
+#define CONTAINER_SHARDED_H
+
+#include "container/interface/maker.h"
+
+error container_create_sharded(icontainer_t            **container,
+                               icontainer_maker         *maker,
+                               int                       nshards,
+                               const icontainer_key_t   *key,
+                               const icontainer_value_t *value);
+
+#endif /* CONTAINER_SHARDED_H */
@@ -10,6 +10,9 @@
 
 #include "base/errors.h"
 #include "item.h"
+#include "depth.h"
+#include "instrument.h"
+#include "stats.h"
 
 /* ----------------------------------------------------------------------- */
 
@@ -56,6 +59,16 @@ const item_t *bstree_select(T *t, int k);
 
 int bstree_count(T *t);
 
+/* Report memory use, excluding keys and values. O(1). */
+void bstree_stats(const T *t, datastruct_stats_t *stats);
+
+/* Copy out operation counters. See instrument.h. */
+error bstree_instrument(const T *t, datastruct_instrument_t *counts);
+
+/* Summarise the depths of elements by walking the whole tree. O(n).
+ * See depth.h. */
+error bstree_depth_stats(const T *t, datastruct_depth_stats_t *stats);
+
 /* ----------------------------------------------------------------------- */
 
 typedef error (bstree_found_callback)(const item_t *item,
@@ -0,0 +1,160 @@
+/* --------------------------------------------------------------------------
+ *    Name: cache.h
+ * Purpose: Bounded associative array which evicts to stay within a budget
+ * ----------------------------------------------------------------------- */
+
+/* A cache is an associative array which holds no more than a fixed budget
+ * of entries, or of bytes, evicting entries to make room for new ones. Its
+ * entries live in a pool and are found by key through a chained hash table
+ * of the cache's own, which grows as the cache fills. Which entry goes is
+ * chosen by the cache's policy:
+ *
+ * - LRU evicts the least recently inserted, updated or looked up entry.
+ *
+ * - CLOCK approximates LRU with a reference bit per entry. A hand sweeps
+ *   round the entries clearing set bits and evicts the first entry found
+ *   without one.
+ *
+ * - S3-FIFO keeps new entries in a small FIFO queue holding a tenth of the
+ *   budget. Entries looked up more than once while there move to a main
+ *   queue; others are evicted, but remembered in a ghost queue so that they
+ *   go straight into the main queue if they return. Main queue entries are
+ *   reinserted while they have been looked up since they last reached its
+ *   end. A scan of keys which are only used once passes through the small
+ *   queue without disturbing the main one.
+ *
+ * See "FIFO queues are all you need for cache eviction", Yang et al., 2023,
+ * for S3-FIFO.
+ *
+ * Each entry is a single pool record holding its key, value, key length,
+ * cost and key hash, a 32-bit link to the next entry in its bin, and its
+ * eviction state: two 32-bit links and two bytes. Bins and links hold pool
+ * indices rather than pointers. Lookups never allocate. The bins start out
+ * sized for a budget which counts entries, and double whenever the cache
+ * holds as many entries as there are bins, so lookups stay O(1) however
+ * large the cache grows. The S3-FIFO ghost queue
+ * remembers as many evicted keys as the cache holds, as 32-bit key hashes
+ * in a ring and a set, using twelve bytes per key. A new key whose hash
+ * matches a remembered one goes straight to the main queue.
+ *
+ * Lookups update eviction state, so a cache is not safe for use by more
+ * than one thread at a time, even if all are only looking up.
+ */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/errors.h"
+#include "hash.h"
+#include "item.h"
+#include "stats.h"
+
+/* ----------------------------------------------------------------------- */
+
+#define T cache_t
+
+typedef struct cache T;
+
+/* ----------------------------------------------------------------------- */
+
+typedef enum cache_policy
+{
+  cache_POLICY_LRU,
+  cache_POLICY_CLOCK,
+  cache_POLICY_S3FIFO
+}
+cache_policy_t;
+
+/* Return the cost of holding the specified entry, typically its size in
+ * bytes. */
+typedef size_t (cache_cost)(const void *key, const void *value);
+
+/* Destroy the specified key. */
+typedef void (cache_destroy_key)(void *key);
+
+/* Destroy the specified value. */
+typedef void (cache_destroy_value)(void *value);
+
+/* Create a cache holding entries whose costs sum to no more than 'budget'.
+ * If 'cost' is NULL every entry costs one, so 'budget' is a count of
+ * entries. An entry which costs more than the budget is held alone.
+ *
+ * 'fn' and 'compare' are as for hash_create. Keys and values passed in are
+ * owned by the cache, which destroys them when their entry is evicted,
+ * removed or updated.
+ */
+error cache_create(cache_policy_t       policy,
+                   size_t               budget,
+                   cache_cost          *cost,
+                   const void          *default_value,
+                   hash_fn             *fn,
+                   hash_compare        *compare,
+                   cache_destroy_key   *destroy_key,
+                   cache_destroy_value *destroy_value,
+                   T                  **cache);
+void cache_destroy(T *cache);
+
+/* ----------------------------------------------------------------------- */
+
+/* Return the value held for 'key', or the default value. Counts as a hit
+ * or a miss, and as a use of the entry for eviction. */
+const void *cache_lookup(T *cache, const void *key);
+
+/* Insert or update an entry, first evicting others if it wouldn't fit. */
+error cache_insert(T          *cache,
+                   const void *key,
+                   size_t      keylen,
+                   const void *value);
+
+void cache_remove(T *cache, const void *key);
+
+int cache_count(const T *cache);
+
+/* Return the total cost of the entries held. */
+size_t cache_used(const T *cache);
+
+/* ----------------------------------------------------------------------- */
+
+typedef struct cache_counters
+{
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+}
+cache_counters_t;
+
+/* Copy out the counts of lookup hits and misses and of evictions. */
+void cache_counters(const T *cache, cache_counters_t *counters);
+
+/* Report memory use, excluding keys and values. O(1). */
+void cache_stats(const T *cache, datastruct_stats_t *stats);
+
+/* ----------------------------------------------------------------------- */
+
+typedef error (cache_found_callback)(const item_t *item, void *opaque);
+
+/* Call 'cb' for every entry whose key begins with 'prefix', in key order
+ * (as memcmp, shorter keys first). The cache keeps no index by key, so this
+ * examines every entry then sorts the matches: O(n + k log k) for k
+ * matches. Doesn't count as a use of the entries found.
+ *
+ * Returns error_OK if at least one key matched, error_NOT_FOUND if none
+ * did, or error_OOM. */
+error cache_lookup_prefix(const T              *cache,
+                          const void           *prefix,
+                          size_t                prefixlen,
+                          cache_found_callback *cb,
+                          void                 *opaque);
+
+/* Call 'cb' for every entry, in no particular order. Doesn't count as a
+ * use of the entries. */
+error cache_walk(const T *cache, cache_found_callback *cb, void *opaque);
+
+/* ----------------------------------------------------------------------- */
+
+#undef T
+
+#endif /* CACHE_H */
@@ -0,0 +1,43 @@
+/* --------------------------------------------------------------------------
+ *    Name: chunkqueue.h
+ * Purpose: Unbounded queue implemented as a list of fixed-size chunks
+ * ----------------------------------------------------------------------- */
+
+/* Unlike queue_t this queue has no fixed capacity. Elements are stored in
+ * chunks of 'chunkelems' elements which are linked together as the queue
+ * grows. Elements are never moved once enqueued. Chunks which are drained by
+ * dequeueing are kept on a free list and reused, so a queue which repeatedly
+ * grows and shrinks to the same size stops allocating once it has warmed
+ * up. */
+
+#ifndef CHUNKQUEUE_H
+#define CHUNKQUEUE_H
+
+#include <stdlib.h>
+
+#include "base/errors.h"
+
+typedef struct chunkqueue chunkqueue_t;
+
+#define T chunkqueue_t
+
+/* Creates an empty queue of 'length'-long objects, allocated 'chunkelems'
+ * elements at a time. */
+T *chunkqueue_create(int chunkelems, size_t length);
+void chunkqueue_destroy(T *doomed);
+
+/* Copies the specified value into the queue. Returns error_OOM if a new
+ * chunk was required and could not be allocated. */
+error chunkqueue_enqueue(T *queue, const void *value);
+
+/* Removes the next value from the queue. 'value' is assumed to point to a
+ * buffer large enough to hold the returned value (which is the 'length'
+ * specified to chunkqueue_create). */
+error chunkqueue_dequeue(T *queue, void *value);
+
+int chunkqueue_count(const T *queue);
+int chunkqueue_empty(const T *queue);
+
+#undef T
+
+#endif /* CHUNKQUEUE_H */
@@ -0,0 +1,328 @@
+/* --------------------------------------------------------------------------
+ *    Name: critbit-template.h
+ * Purpose: Type-specialised critbit trees generated by macro
+ * ----------------------------------------------------------------------- */
+
+/* critbit_t calls through function pointers and lives in its own
+ * translation units, so a compiler can inline none of its work into the
+ * caller. DEFINE_CRITBIT instead generates a critbit tree specialised for
+ * one key and value type as static functions, klib style, so that key
+ * length calculations and byte fetches can be inlined into each use.
+ *
+ * The functions aren't declared inline: every body is visible at every call
+ * so the compiler may inline them regardless, and -Winline would otherwise
+ * report each call it decides not to.
+ *
+ *   DEFINE_CRITBIT(name, keytype, valtype, len_fn)
+ *
+ * 'keytype' must be a pointer to the key's bytes, e.g. const char *.
+ * 'len_fn(key)' returns the key's length in bytes. It may be a function or
+ * a function-like macro. Keys which differ only by trailing zero bytes
+ * clash, as they do for critbit_t.
+ *
+ * This generates:
+ *
+ *   name_t                           the tree type
+ *   void     name_init(name_t *)     initialise an empty tree
+ *   void     name_fini(name_t *)     free the tree's nodes
+ *   valtype *name_lookup(const name_t *, keytype)
+ *                                    the key's value, or NULL if absent
+ *   error    name_insert(name_t *, keytype, valtype)
+ *                                    insert or update
+ *   int      name_remove(name_t *, keytype)
+ *                                    non-zero if the key was removed
+ *   int      name_count(const name_t *)
+ *
+ * The tree holds the key pointers passed in but never copies nor destroys
+ * keys or values. An update replaces both the key pointer and the value.
+ * Trees are not safe for use by more than one thread at a time.
+ *
+ * There are no snapshots, cursors, prefix lookups or statistics: use
+ * critbit_t for those.
+ */
+
+#ifndef CRITBIT_TEMPLATE_H
+#define CRITBIT_TEMPLATE_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/errors.h"
+#include "base/types.h"
+
+/* ----------------------------------------------------------------------- */
+
+/* Child links have their low bit set when they point to an external node. */
+#define CRITBIT_TEMPLATE_IS_EXTERNAL(p) (((intptr_t) (p) & 1) != 0)
+#define CRITBIT_TEMPLATE_FROM_STORE(p)  ((void *) ((intptr_t) (p) - 1))
+#define CRITBIT_TEMPLATE_TO_STORE(p)    ((void *) ((intptr_t) (p) + 1))
+
+/* Gets a byte or returns zero if it's out of range. */
+#define CRITBIT_TEMPLATE_GET_BYTE(KEY, KEYLEN, INDEX) \
+  (((INDEX) < (KEYLEN)) ? (KEY)[INDEX] : 0)
+
+/* Extract the specified indexed binary direction from the key. */
+#define CRITBIT_TEMPLATE_GET_DIR(KEY, KEYLEN, INDEX, OTHERBITS) \
+  ((1 + ((OTHERBITS) | CRITBIT_TEMPLATE_GET_BYTE(KEY, KEYLEN, INDEX))) >> 8)
+
+/* ----------------------------------------------------------------------- */
+
+#define DEFINE_CRITBIT(name, keytype, valtype, len_fn)                        \
+                                                                              \
+typedef struct name##__extnode                                                \
+{                                                                             \
+  keytype        key;                                                         \
+  size_t         keylen;                                                      \
+  valtype        value;                                                       \
+}                                                                             \
+name##__extnode_t;                                                            \
+                                                                              \
+typedef struct name##__node                                                   \
+{                                                                             \
+  void          *child[2];  /* tagged as CRITBIT_TEMPLATE_TO_STORE */         \
+  size_t         byte;      /* byte offset of critical bit */                 \
+  unsigned char  otherbits; /* inverted mask of critical bit */               \
+}                                                                             \
+name##__node_t;                                                               \
+                                                                              \
+typedef struct name                                                           \
+{                                                                             \
+  void          *root;                                                        \
+  int            count;                                                       \
+}                                                                             \
+name##_t;                                                                     \
+                                                                              \
+static MAYBE_UNUSED void name##_init(name##_t *t)                             \
+{                                                                             \
+  t->root  = NULL;                                                            \
+  t->count = 0;                                                               \
+}                                                                             \
+                                                                              \
+/* Rotates internal nodes up out of the way so that it needs no stack. */    \
+static MAYBE_UNUSED void name##_fini(name##_t *t)                             \
+{                                                                             \
+  void *p = t->root;                                                          \
+                                                                              \
+  while (p)                                                                   \
+  {                                                                           \
+    name##__node_t *n;                                                        \
+    name##__node_t *m;                                                        \
+                                                                              \
+    if (CRITBIT_TEMPLATE_IS_EXTERNAL(p))                                      \
+    {                                                                         \
+      free(CRITBIT_TEMPLATE_FROM_STORE(p));                                   \
+      break;                                                                  \
+    }                                                                         \
+                                                                              \
+    n = p;                                                                    \
+    if (CRITBIT_TEMPLATE_IS_EXTERNAL(n->child[0]))                            \
+    {                                                                         \
+      free(CRITBIT_TEMPLATE_FROM_STORE(n->child[0]));                         \
+      p = n->child[1];                                                        \
+      free(n);                                                                \
+    }                                                                         \
+    else                                                                      \
+    {                                                                         \
+      m           = n->child[0];                                              \
+      n->child[0] = m->child[1];                                              \
+      m->child[1] = n;                                                        \
+      p           = m;                                                        \
+    }                                                                         \
+  }                                                                           \
+                                                                              \
+  name##_init(t);                                                             \
+}                                                                             \
+                                                                              \
+static MAYBE_UNUSED valtype *name##_lookup(const name##_t *t, keytype key)    \
+{                                                                             \
+  const unsigned char *ukey   = (const unsigned char *) key;                  \
+  size_t               keylen = len_fn(key);                                  \
+  void                *p      = t->root;                                      \
+  name##__extnode_t   *e;                                                     \
+                                                                              \
+  if (p == NULL)                                                              \
+    return NULL;                                                              \
+                                                                              \
+  while (!CRITBIT_TEMPLATE_IS_EXTERNAL(p))                                    \
+  {                                                                           \
+    const name##__node_t *n = p;                                              \
+                                                                              \
+    p = n->child[CRITBIT_TEMPLATE_GET_DIR(ukey, keylen,                       \
+                                          n->byte, n->otherbits)];            \
+  }                                                                           \
+                                                                              \
+  e = CRITBIT_TEMPLATE_FROM_STORE(p);                                         \
+  if (e->keylen != keylen || memcmp(e->key, ukey, keylen) != 0)               \
+    return NULL;                                                              \
+                                                                              \
+  return &e->value;                                                           \
+}                                                                             \
+                                                                              \
+static MAYBE_UNUSED error name##_insert(name##_t *t,                          \
+                                        keytype   key,                        \
+                                        valtype   value)                      \
+{                                                                             \
+  const unsigned char *ukey   = (const unsigned char *) key;                  \
+  size_t               keylen = len_fn(key);                                  \
+  const unsigned char *qkey;                                                  \
+  size_t               qkeylen;                                               \
+  size_t               newbyte;                                               \
+  size_t               maxlen;                                                \
+  unsigned int         newotherbits;                                          \
+  int                  newdir;                                                \
+  name##__extnode_t   *q;                                                     \
+  name##__extnode_t   *newextnode;                                            \
+  name##__node_t      *newnode;                                               \
+  void               **pn;                                                    \
+  void                *p;                                                     \
+                                                                              \
+  newextnode = malloc(sizeof(*newextnode));                                   \
+  if (newextnode == NULL)                                                     \
+    return error_OOM;                                                         \
+                                                                              \
+  newextnode->key    = key;                                                   \
+  newextnode->keylen = keylen;                                                \
+  newextnode->value  = value;                                                 \
+                                                                              \
+  /* deal with inserting into an empty tree */                                \
+  if (t->root == NULL)                                                        \
+  {                                                                           \
+    t->root = CRITBIT_TEMPLATE_TO_STORE(newextnode);                          \
+    t->count++;                                                               \
+    return error_OK;                                                          \
+  }                                                                           \
+                                                                              \
+  /* find closest node */                                                     \
+  p = t->root;                                                                \
+  while (!CRITBIT_TEMPLATE_IS_EXTERNAL(p))                                    \
+  {                                                                           \
+    const name##__node_t *n = p;                                              \
+                                                                              \
+    p = n->child[CRITBIT_TEMPLATE_GET_DIR(ukey, keylen,                       \
+                                          n->byte, n->otherbits)];            \
+  }                                                                           \
+                                                                              \
+  q       = CRITBIT_TEMPLATE_FROM_STORE(p);                                   \
+  qkey    = (const unsigned char *) q->key;                                   \
+  qkeylen = q->keylen;                                                        \
+                                                                              \
+  /* locate the critical bit */                                               \
+  newotherbits = 0;                                                           \
+  maxlen       = MAX(keylen, qkeylen);                                        \
+  for (newbyte = 0; newbyte < maxlen; newbyte++)                              \
+  {                                                                           \
+    newotherbits = CRITBIT_TEMPLATE_GET_BYTE(qkey, qkeylen, newbyte) ^        \
+                   CRITBIT_TEMPLATE_GET_BYTE(ukey, keylen, newbyte);          \
+    if (newotherbits)                                                         \
+      break;                                                                  \
+  }                                                                           \
+                                                                              \
+  if (newbyte == maxlen)                                                      \
+  {                                                                           \
+    free(newextnode);                                                         \
+                                                                              \
+    if (keylen != qkeylen)                                                    \
+      return error_CLASHES;                                                   \
+                                                                              \
+    /* update the existing key's value */                                     \
+    q->key   = key;                                                           \
+    q->value = value;                                                         \
+    return error_OK;                                                          \
+  }                                                                           \
+                                                                              \
+  /* isolate the highest differing bit then invert it */                      \
+  newotherbits |= newotherbits >> 1;                                          \
+  newotherbits |= newotherbits >> 2;                                          \
+  newotherbits |= newotherbits >> 4;                                          \
+  newotherbits  = (newotherbits & ~(newotherbits >> 1)) ^ 255;                \
+                                                                              \
+  newdir = CRITBIT_TEMPLATE_GET_DIR(qkey, qkeylen, newbyte, newotherbits);    \
+                                                                              \
+  /* insert new item */                                                       \
+  newnode = malloc(sizeof(*newnode));                                         \
+  if (newnode == NULL)                                                        \
+  {                                                                           \
+    free(newextnode);                                                         \
+    return error_OOM;                                                         \
+  }                                                                           \
+                                                                              \
+  newnode->byte      = newbyte;                                               \
+  newnode->otherbits = (unsigned char) newotherbits;                          \
+                                                                              \
+  pn = &t->root;                                                              \
+  for (;;)                                                                    \
+  {                                                                           \
+    name##__node_t *n = *pn;                                                  \
+                                                                              \
+    if (CRITBIT_TEMPLATE_IS_EXTERNAL(n))                                      \
+      break;                                                                  \
+    if (n->byte > newbyte)                                                    \
+      break;                                                                  \
+    if (n->byte == newbyte && n->otherbits > newotherbits)                    \
+      break;                                                                  \
+                                                                              \
+    pn = &n->child[CRITBIT_TEMPLATE_GET_DIR(ukey, keylen,                     \
+                                            n->byte, n->otherbits)];          \
+  }                                                                           \
+                                                                              \
+  newnode->child[newdir]  = *pn;                                              \
+  newnode->child[!newdir] = CRITBIT_TEMPLATE_TO_STORE(newextnode);            \
+  *pn = newnode;                                                              \
+                                                                              \
+  t->count++;                                                                 \
+                                                                              \
+  return error_OK;                                                            \
+}                                                                             \
+                                                                              \
+static MAYBE_UNUSED int name##_remove(name##_t *t, keytype key)               \
+{                                                                             \
+  const unsigned char *ukey   = (const unsigned char *) key;                  \
+  size_t               keylen = len_fn(key);                                  \
+  void               **wherem = NULL;                                         \
+  void               **wherep = &t->root;                                     \
+  name##__node_t      *n      = NULL;                                         \
+  int                  dir    = 0;                                            \
+  name##__extnode_t   *e;                                                     \
+  void                *p      = t->root;                                      \
+                                                                              \
+  if (p == NULL)                                                              \
+    return 0; /* empty tree */                                                \
+                                                                              \
+  while (!CRITBIT_TEMPLATE_IS_EXTERNAL(p))                                    \
+  {                                                                           \
+    wherem = wherep;                                                          \
+    n      = p;                                                               \
+    dir    = CRITBIT_TEMPLATE_GET_DIR(ukey, keylen, n->byte, n->otherbits);   \
+    wherep = &n->child[dir];                                                  \
+    p      = *wherep;                                                         \
+  }                                                                           \
+                                                                              \
+  e = CRITBIT_TEMPLATE_FROM_STORE(p);                                         \
+  if (e->keylen != keylen || memcmp(e->key, ukey, keylen) != 0)               \
+    return 0; /* not found */                                                 \
+                                                                              \
+  if (wherem == NULL)                                                         \
+  {                                                                           \
+    t->root = NULL;                                                           \
+  }                                                                           \
+  else                                                                        \
+  {                                                                           \
+    *wherem = n->child[1 - dir];                                              \
+    free(n);                                                                  \
+  }                                                                           \
+                                                                              \
+  free(e);                                                                    \
+  t->count--;                                                                 \
+                                                                              \
+  return 1;                                                                   \
+}                                                                             \
+                                                                              \
+static MAYBE_UNUSED int name##_count(const name##_t *t)                       \
+{                                                                             \
+  return t->count;                                                            \
+}
+
+/* ----------------------------------------------------------------------- */
+
+#endif /* CRITBIT_TEMPLATE_H */
@@ -18,6 +18,10 @@
 
 #include "base/errors.h"
 #include "item.h"
+#include "depth.h"
+#include "flat.h"
+#include "instrument.h"
+#include "stats.h"
 
 /* ----------------------------------------------------------------------- */
 
@@ -48,6 +52,56 @@ error critbit_create(const void            *default_value,
                      T                     **t);
 void critbit_destroy(T *t);
 
+/* Create a critbit tree for use by multiple threads.
+ *
+ * critbit_lookup and critbit_lookup_prefix take no locks: they run in
+ * parallel with one another and with a writer. All other operations are
+ * serialised by an internal mutex. Nodes unlinked by writers are freed using
+ * epoch-based reclamation, once no reader can still be traversing them.
+ *
+ * Values and items handed out by lookups remain valid only until their key
+ * is removed or replaced. To use them safely while other threads may be
+ * writing, bracket the lookup and the use with critbit_read_begin and
+ * critbit_read_end. A lookup_prefix callback is already so bracketed. Such
+ * sections must not call critbit operations other than lookups.
+ */
+error critbit_create_concurrent(const void            *default_value,
+                                critbit_destroy_key   *destroy_key,
+                                critbit_destroy_value *destroy_value,
+                                T                     **t);
+
+/* Returns a token to pass to critbit_read_end. */
+int critbit_read_begin(const T *t);
+void critbit_read_end(const T *t, int token);
+
+/* Make the tree copy each key's bytes into the node which holds it rather
+ * than keep a pointer to the caller's key. Lookups then compare against
+ * bytes adjacent to the node, a short key sharing its cache line, and
+ * there's no separate key allocation to chase.
+ *
+ * The tree then never takes ownership of keys, nor destroys them: the
+ * caller may free or reuse a key as soon as critbit_insert returns. Keys
+ * handed out by lookups and walks point into the tree's nodes.
+ *
+ * Call this on a new, empty tree.
+ */
+void critbit_set_inline_keys(T *t);
+
+/* Take a snapshot of the tree: a read-only view of its contents as they are
+ * now, unaffected by later inserts and removes. All operations other than
+ * critbit_insert and critbit_remove work on the snapshot. Destroy it with
+ * critbit_destroy, before the tree it was taken of is destroyed.
+ *
+ * A snapshot shares all of its nodes with the tree. While any snapshot
+ * lives, modifying the tree copies only the nodes on the path to the change,
+ * so each snapshot costs memory proportional to the tree's depth for each
+ * subsequent change rather than a full copy. Shared nodes are freed when the
+ * last snapshot which can reach them is destroyed.
+ *
+ * Snapshots can be taken of concurrent trees and read without locking.
+ */
+error critbit_snapshot(T *t, T **snapshot);
+
 /* ----------------------------------------------------------------------- */
 
 const void *critbit_lookup(const T *t, const void *key, size_t keylen);
@@ -57,12 +111,38 @@ error critbit_insert(T          *t,
                      size_t      keylen,
                      const void *value);
 
+/* Fill in 'item' with the next key and value to load and return error_OK,
+ * or return error_NOT_FOUND once there are no more. Any other error stops
+ * the load and is returned. */
+typedef error (critbit_build_next)(item_t *item, void *opaque);
+
+/* Load keys supplied in ascending order (as memcmp, shorter keys first).
+ * Into an empty tree this is a single pass which neither searches the tree
+ * nor compares each key against more than its predecessor, so is O(n).
+ * Keys are owned as for critbit_insert. Returns error_CRITBIT_UNSORTED if
+ * a key is out of order or error_CLASHES for a duplicate, leaving the keys
+ * before it in the tree. A tree which isn't empty gets each key inserted
+ * in turn. */
+error critbit_build_sorted(T                  *t,
+                           critbit_build_next *next,
+                           void               *opaque);
+
 void critbit_remove(T *t, const void *key, size_t keylen);
 
 const item_t *critbit_select(T *t, int k);
 
 int critbit_count(T *t);
 
+/* Report memory use, excluding keys and values. O(1). */
+void critbit_stats(const T *t, datastruct_stats_t *stats);
+
+/* Copy out operation counters. See instrument.h. */
+error critbit_instrument(const T *t, datastruct_instrument_t *counts);
+
+/* Summarise the depths of elements by walking the whole tree. O(n).
+ * See depth.h. */
+error critbit_depth_stats(const T *t, datastruct_depth_stats_t *stats);
+
 /* ----------------------------------------------------------------------- */
 
 typedef error (critbit_found_callback)(const item_t *item,
@@ -87,6 +167,14 @@ error critbit_walk(const T               *t,
 
 /* ----------------------------------------------------------------------- */
 
+/* Write the tree's keys and values to a sorted flat file. 'value_len'
+ * gives the length of each value, or NULL if they're strings. See flat.h. */
+error critbit_save(const T        *t,
+                   flat_value_len *value_len,
+                   const char     *filename);
+
+/* ----------------------------------------------------------------------- */
+
 /* To dump the data meaningfully critbit_show must call back to the client to
  * get the opaque keys and values turned into printable strings. These
  * strings may or may not be dynamically allocated so critbit_show_destroy is
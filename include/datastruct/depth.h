@@ -0,0 +1,107 @@
+/* --------------------------------------------------------------------------
+ *    Name: depth.h
+ * Purpose: Shape and depth statistics of data structures
+ * ----------------------------------------------------------------------- */
+
+/* Each tree's _depth_stats function walks the whole tree, without
+ * recursing, and summarises how deep its elements lie. An element's depth
+ * is the number of links followed from the root to reach it, so the
+ * element at the root of a binary search tree has depth zero.
+ *
+ * Hashes report on their chains instead: the depths are chain lengths and
+ * the histogram counts bins by chain length.
+ *
+ * These are O(n) so are meant for spotting degenerate shapes rather than
+ * for use as a live metric.
+ */
+
+#ifndef DATASTRUCT_DEPTH_H
+#define DATASTRUCT_DEPTH_H
+
+#include "base/errors.h"
+
+/* ----------------------------------------------------------------------- */
+
+/* The final bucket counts every element at least this deep less one. */
+#define datastruct_DEPTH_BUCKETS 64
+
+typedef struct datastruct_depth_stats
+{
+  int           elements;
+  int           min_depth;    /* shallowest element, or shortest chain */
+  int           max_depth;    /* deepest element, or longest chain */
+  double        avg_depth;    /* mean depth, or mean non-empty chain */
+  unsigned long total_depth;  /* sum of depths, or of chain lengths */
+  unsigned long histogram[datastruct_DEPTH_BUCKETS]; /* elements by depth */
+
+  /* trees only */
+  double        imbalance;    /* max_depth / ceil(log2(elements)) */
+  int           chains;       /* runs of nodes having a single child */
+  int           chain_nodes;  /* nodes within those runs */
+
+  /* hashes only */
+  int           bins;
+  int           empty_bins;
+  double        load_factor;  /* elements per bin */
+}
+datastruct_depth_stats_t;
+
+/* Zero 'stats' ready for accumulating. */
+void datastruct_depth_init(datastruct_depth_stats_t *stats);
+
+/* Account for an element at 'depth'. */
+void datastruct_depth_add(datastruct_depth_stats_t *stats, int depth);
+
+/* Account for a node with 'children' children. 'chained' is as pushed with
+ * the node. Returns the value to push with its children. */
+int datastruct_depth_branch(datastruct_depth_stats_t *stats,
+                            int                       children,
+                            int                       chained);
+
+/* Account for a hash bin holding a chain of 'length' elements. */
+void datastruct_depth_add_chain(datastruct_depth_stats_t *stats, int length);
+
+/* Accumulate the stats in 'src' into 'dst'. */
+void datastruct_depth_merge(datastruct_depth_stats_t       *dst,
+                            const datastruct_depth_stats_t *src);
+
+/* Compute the averages once everything has been added. */
+void datastruct_depth_finish(datastruct_depth_stats_t *stats);
+
+/* ----------------------------------------------------------------------- */
+
+/* For use by implementations: an explicit stack for walking a tree without
+ * recursing, so that a degenerate tree cannot exhaust the C stack. */
+
+typedef struct datastruct_depth_entry
+{
+  const void *node;
+  int         depth;
+  int         chained; /* parent has a single child */
+}
+datastruct_depth_entry_t;
+
+typedef struct datastruct_depth_stack
+{
+  datastruct_depth_entry_t *entries;
+  int                       used;
+  int                       allocated;
+}
+datastruct_depth_stack_t;
+
+void datastruct_depth_stack_init(datastruct_depth_stack_t *stack);
+
+error datastruct_depth_stack_push(datastruct_depth_stack_t *stack,
+                                  const void               *node,
+                                  int                       depth,
+                                  int                       chained);
+
+/* Returns zero once the stack is empty. */
+int datastruct_depth_stack_pop(datastruct_depth_stack_t *stack,
+                               datastruct_depth_entry_t *entry);
+
+void datastruct_depth_stack_fini(datastruct_depth_stack_t *stack);
+
+/* ----------------------------------------------------------------------- */
+
+#endif /* DATASTRUCT_DEPTH_H */
@@ -17,6 +17,9 @@
 
 #include "base/errors.h"
 #include "item.h"
+#include "depth.h"
+#include "instrument.h"
+#include "stats.h"
 
 /* ----------------------------------------------------------------------- */
 
@@ -60,6 +63,16 @@ const item_t *dstree_select(T *t, int k);
 
 int dstree_count(T *t);
 
+/* Report memory use, excluding keys and values. O(1). */
+void dstree_stats(const T *t, datastruct_stats_t *stats);
+
+/* Copy out operation counters. See instrument.h. */
+error dstree_instrument(const T *t, datastruct_instrument_t *counts);
+
+/* Summarise the depths of elements by walking the whole tree. O(n).
+ * See depth.h. */
+error dstree_depth_stats(const T *t, datastruct_depth_stats_t *stats);
+
 /* ----------------------------------------------------------------------- */
 
 typedef error (dstree_found_callback)(const item_t *item,
@@ -0,0 +1,76 @@
+/* --------------------------------------------------------------------------
+ *    Name: filter.h
+ * Purpose: Approximate membership filters
+ * ----------------------------------------------------------------------- */
+
+/* A filter answers "might this key be present?" in much less space than
+ * the keys themselves. It never answers no for a key which was added, but
+ * answers yes for a small fraction of keys which weren't. Placed in front
+ * of a data structure it turns most lookups of absent keys into a single
+ * memory access.
+ *
+ * Filters work on 64-bit key hashes. These should be well mixed: the
+ * filters use different bits of them for different purposes.
+ *
+ * Two kinds are provided:
+ *
+ * - A blocked Bloom filter takes keys one at a time. Each key sets eight
+ *   bits within one 32-byte block, so a query reads one cache line. Sized
+ *   at 12 bits per key of its capacity, it answers yes for around 0.5% of
+ *   absent keys until it holds more keys than its capacity. Keys can't be
+ *   removed, only the whole filter cleared.
+ *
+ * - An XOR filter is built once from a complete set of keys and can't
+ *   change afterwards. It holds an 8-bit fingerprint in each of 1.23 slots
+ *   per key, and a query reads three slots. It answers yes for around 0.4%
+ *   of absent keys.
+ *
+ * Filters are not synchronised, but queries don't modify them.
+ */
+
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/errors.h"
+#include "stats.h"
+
+/* ----------------------------------------------------------------------- */
+
+typedef struct filter_bloom filter_bloom_t;
+
+/* Create a Bloom filter sized for 'capacity' keys. */
+error filter_bloom_create(int capacity, filter_bloom_t **bloom);
+void filter_bloom_destroy(filter_bloom_t *doomed);
+
+void filter_bloom_add(filter_bloom_t *bloom, uint64_t hash);
+
+/* Returns non-zero if the key might be present. */
+int filter_bloom_contains(const filter_bloom_t *bloom, uint64_t hash);
+
+/* Forget every key. */
+void filter_bloom_clear(filter_bloom_t *bloom);
+
+/* 'elements' is the number of keys added since the filter was cleared. */
+void filter_bloom_stats(const filter_bloom_t *bloom, datastruct_stats_t *stats);
+
+/* ----------------------------------------------------------------------- */
+
+typedef struct filter_xor filter_xor_t;
+
+/* Build an XOR filter over 'n' key hashes. Duplicate hashes are allowed.
+ * Returns error_FILTER_FAILED in the unlikely event that no filter is
+ * found. */
+error filter_xor_create(const uint64_t *hashes, int n, filter_xor_t **xf);
+void filter_xor_destroy(filter_xor_t *doomed);
+
+/* Returns non-zero if the key might be present. */
+int filter_xor_contains(const filter_xor_t *xf, uint64_t hash);
+
+void filter_xor_stats(const filter_xor_t *xf, datastruct_stats_t *stats);
+
+/* ----------------------------------------------------------------------- */
+
+#endif /* FILTER_H */
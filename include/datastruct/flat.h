@@ -0,0 +1,132 @@
+/* --------------------------------------------------------------------------
+ *    Name: flat.h
+ * Purpose: Read-only associative array held in a flat, mappable file
+ * ----------------------------------------------------------------------- */
+
+/* A flat file holds a snapshot of an associative array in a position
+ * independent form: entries refer to their keys and values by offset from
+ * the start of the file rather than by pointer. flat_open maps the file into
+ * memory and lookups are then served directly from the mapping, so opening
+ * a file costs the same however many entries it holds and pages are only
+ * read in as lookups touch them.
+ *
+ * A file is laid out as:
+ *
+ *   header   - magic, byte order, kind, counts and section offsets
+ *   entries  - for each entry the offset and length of its key and value
+ *   bins     - hashed files only: the first entry of each bin
+ *   blob     - the bytes of every key and value, each followed by a NUL
+ *
+ * Sorted files keep their entries in key order (as memcmp, then shorter
+ * keys first) and are searched by bisection. They support prefix lookups.
+ * Hashed files group their entries by bin and answer lookups in around one
+ * key comparison.
+ *
+ * Files are written in the host's byte order and are refused by a host of
+ * another. Only the header is checked on opening: the rest of the file is
+ * trusted.
+ *
+ * Values are copied into the file as bytes so they must not contain
+ * pointers. Since each is followed by a NUL string values may be used in
+ * place.
+ */
+
+#ifndef FLAT_H
+#define FLAT_H
+
+#include <stddef.h>
+
+#include "base/errors.h"
+#include "item.h"
+
+/* ----------------------------------------------------------------------- */
+
+typedef enum flat_kind
+{
+  flat_KIND_SORTED,
+  flat_KIND_HASHED
+}
+flat_kind_t;
+
+/* Return the length in bytes of the specified value. */
+typedef size_t (flat_value_len)(const void *value);
+
+/* ----------------------------------------------------------------------- */
+
+/* Writing. The writer gathers entries then lays them out on saving. */
+
+typedef struct flat_writer flat_writer_t;
+
+/* NULL can be passed in for value_len when values are NUL-terminated
+ * strings. */
+error flat_writer_create(flat_kind_t      kind,
+                         flat_value_len  *value_len,
+                         flat_writer_t  **w);
+void flat_writer_destroy(flat_writer_t *w);
+
+/* Add an entry. Only pointers are kept so the key and value must remain
+ * valid until the writer is saved. Keys must be unique. */
+error flat_writer_add(flat_writer_t *w,
+                      const void    *key,
+                      size_t         keylen,
+                      const void    *value);
+
+/* Write out the entries added so far. Returns error_EXISTS if a sorted
+ * writer holds a duplicate key or error_IO if the file can't be written.
+ *
+ * The file is written under a temporary name in the same directory, synced,
+ * then renamed over 'filename', so processes which have the old file open
+ * keep a consistent view of it and a failed save leaves it untouched. */
+error flat_writer_save(flat_writer_t *w, const char *filename);
+
+/* ----------------------------------------------------------------------- */
+
+/* Reading. */
+
+#define T flat_t
+
+typedef struct flat T;
+
+/* Map the specified file. Returns error_IO if it can't be read or
+ * error_FLAT_BAD_FORMAT if it isn't a flat file for this host. */
+error flat_open(const char *filename, T **f);
+void flat_close(T *f);
+
+int flat_count(const T *f);
+
+flat_kind_t flat_kind(const T *f);
+
+/* Returns a pointer to the value within the mapping, or NULL if the key is
+ * absent. If 'valuelen' is non-NULL it receives the length of the value. */
+const void *flat_lookup(const T    *f,
+                        const void *key,
+                        size_t      keylen,
+                        size_t     *valuelen);
+
+/* ----------------------------------------------------------------------- */
+
+/* Items passed to callbacks point into the mapping. */
+
+typedef error (flat_found_callback)(const item_t *item,
+                                    void         *opaque);
+
+/* Call 'cb' for every key beginning with 'prefix', in key order. Returns
+ * error_NOT_FOUND if there are none, or error_NOT_IMPLEMENTED for a hashed
+ * file. */
+error flat_lookup_prefix(const T             *f,
+                         const void          *prefix,
+                         size_t               prefixlen,
+                         flat_found_callback *cb,
+                         void                *opaque);
+
+typedef error (flat_walk_callback)(const item_t *item,
+                                   void         *opaque);
+
+/* Walk every entry: in key order for sorted files, otherwise by bin. */
+error flat_walk(const T *f, flat_walk_callback *cb, void *opaque);
+
+/* ----------------------------------------------------------------------- */
+
+#undef T
+
+#endif /* FLAT_H */
@@ -0,0 +1,246 @@
+/* --------------------------------------------------------------------------
+ *    Name: hash-template.h
+ * Purpose: Type-specialised hashes generated by macro
+ * ----------------------------------------------------------------------- */
+
+/* hash_t calls its hash and compare functions through pointers and lives
+ * in its own translation units, so a compiler can inline none of its work
+ * into the caller. DEFINE_HASH instead generates a hash specialised for one
+ * key and value type as static functions, klib style, so that hashing and
+ * key comparison can be inlined into each use.
+ *
+ *   DEFINE_HASH(name, keytype, valtype, hash_fn, eq_fn)
+ *
+ * Keys and values are held by value. 'hash_fn(key)' returns an unsigned
+ * int hash of the key. 'eq_fn(a, b)' returns non-zero if two keys are
+ * equal. Either may be a function or a function-like macro. The hash
+ * scrambles the hash it's given before use, so an identity hash of an
+ * integer key is adequate.
+ *
+ * This generates:
+ *
+ *   name_t                           the hash type
+ *   void     name_init(name_t *)     initialise an empty hash
+ *   void     name_fini(name_t *)     free the hash's nodes and bins
+ *   valtype *name_lookup(const name_t *, keytype)
+ *                                    the key's value, or NULL if absent
+ *   error    name_insert(name_t *, keytype, valtype)
+ *                                    insert or update
+ *   int      name_remove(name_t *, keytype)
+ *                                    non-zero if the key was removed
+ *   int      name_count(const name_t *)
+ *
+ * Unlike hash_t the number of bins isn't fixed at creation: it starts at
+ * eight and doubles whenever the hash holds as many keys as it has bins.
+ * An update replaces both the key and the value. Nothing is destroyed but
+ * the hash's own nodes. Hashes are not safe for use by more than one thread
+ * at a time.
+ */
+
+#ifndef HASH_TEMPLATE_H
+#define HASH_TEMPLATE_H
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "base/errors.h"
+#include "base/types.h"
+
+/* ----------------------------------------------------------------------- */
+
+/* Bins to start with, as a power of two. */
+#define HASH_TEMPLATE_LOG2BINS 3
+
+/* Fibonacci hashing: scramble 'h' then take its top 'log2bins' bits. */
+#define HASH_TEMPLATE_BIN(h, log2bins) \
+  ((uint32_t) ((uint32_t) (h) * 2654435769u) >> (32 - (log2bins)))
+
+/* ----------------------------------------------------------------------- */
+
+#define DEFINE_HASH(name, keytype, valtype, hash_fn, eq_fn)                   \
+                                                                              \
+typedef struct name##__node                                                   \
+{                                                                             \
+  struct name##__node  *next;                                                 \
+  unsigned int          hash;                                                 \
+  keytype               key;                                                  \
+  valtype               value;                                                \
+}                                                                             \
+name##__node_t;                                                               \
+                                                                              \
+typedef struct name                                                           \
+{                                                                             \
+  name##__node_t      **bins;     /* NULL until the first insert */           \
+  int                   log2bins;                                             \
+  int                   count;                                                \
+}                                                                             \
+name##_t;                                                                     \
+                                                                              \
+static MAYBE_UNUSED void name##_init(name##_t *h)                             \
+{                                                                             \
+  h->bins     = NULL;                                                         \
+  h->log2bins = 0;                                                            \
+  h->count    = 0;                                                            \
+}                                                                             \
+                                                                              \
+static MAYBE_UNUSED void name##_fini(name##_t *h)                             \
+{                                                                             \
+  int i;                                                                      \
+                                                                              \
+  if (h->bins)                                                                \
+    for (i = 0; i < (1 << h->log2bins); i++)                                  \
+    {                                                                         \
+      name##__node_t *n;                                                      \
+      name##__node_t *next;                                                   \
+                                                                              \
+      for (n = h->bins[i]; n; n = next)                                       \
+      {                                                                       \
+        next = n->next;                                                       \
+        free(n);                                                              \
+      }                                                                       \
+    }                                                                         \
+                                                                              \
+  free(h->bins);                                                              \
+                                                                              \
+  name##_init(h);                                                             \
+}                                                                             \
+                                                                              \
+/* Returns the link which points to 'key''s node, or to NULL. */              \
+static MAYBE_UNUSED name##__node_t **name##__lookup_node(const name##_t *h,   \
+                                                         keytype         key, \
+                                                         unsigned int    hash)\
+{                                                                             \
+  name##__node_t **n;                                                         \
+                                                                              \
+  n = &h->bins[HASH_TEMPLATE_BIN(hash, h->log2bins)];                         \
+  while (*n && !((*n)->hash == hash && eq_fn((*n)->key, key)))                \
+    n = &(*n)->next;                                                          \
+                                                                              \
+  return n;                                                                   \
+}                                                                             \
+                                                                              \
+static MAYBE_UNUSED valtype *name##_lookup(const name##_t *h, keytype key)    \
+{                                                                             \
+  name##__node_t *n;                                                          \
+                                                                              \
+  if (h->bins == NULL)                                                        \
+    return NULL;                                                              \
+                                                                              \
+  n = *name##__lookup_node(h, key, hash_fn(key));                             \
+                                                                              \
+  return n ? &n->value : NULL;                                                \
+}                                                                             \
+                                                                              \
+/* Doubles the bins, or allocates the first. */                               \
+static MAYBE_UNUSED error name##__grow(name##_t *h)                           \
+{                                                                             \
+  int               log2bins;                                                 \
+  name##__node_t  **bins;                                                     \
+  int               i;                                                        \
+                                                                              \
+  log2bins = h->bins ? h->log2bins + 1 : HASH_TEMPLATE_LOG2BINS;              \
+                                                                              \
+  bins = calloc((size_t) 1 << log2bins, sizeof(*bins));                       \
+  if (bins == NULL)                                                           \
+    return error_OOM;                                                         \
+                                                                              \
+  if (h->bins)                                                                \
+  {                                                                           \
+    for (i = 0; i < (1 << h->log2bins); i++)                                  \
+    {                                                                         \
+      name##__node_t *n;                                                      \
+      name##__node_t *next;                                                   \
+                                                                              \
+      for (n = h->bins[i]; n; n = next)                                       \
+      {                                                                       \
+        name##__node_t **bin;                                                 \
+                                                                              \
+        next    = n->next;                                                    \
+        bin     = &bins[HASH_TEMPLATE_BIN(n->hash, log2bins)];                \
+        n->next = *bin;                                                       \
+        *bin    = n;                                                          \
+      }                                                                       \
+    }                                                                         \
+                                                                              \
+    free(h->bins);                                                            \
+  }                                                                           \
+                                                                              \
+  h->bins     = bins;                                                         \
+  h->log2bins = log2bins;                                                     \
+                                                                              \
+  return error_OK;                                                            \
+}                                                                             \
+                                                                              \
+static MAYBE_UNUSED error name##_insert(name##_t *h,                          \
+                                        keytype   key,                        \
+                                        valtype   value)                      \
+{                                                                             \
+  unsigned int      hash = hash_fn(key);                                      \
+  name##__node_t  **pn;                                                       \
+  name##__node_t   *n;                                                        \
+                                                                              \
+  if (h->bins)                                                                \
+  {                                                                           \
+    n = *name##__lookup_node(h, key, hash);                                   \
+    if (n)                                                                    \
+    {                                                                         \
+      /* update the existing key's value */                                   \
+      n->key   = key;                                                         \
+      n->value = value;                                                       \
+      return error_OK;                                                        \
+    }                                                                         \
+  }                                                                           \
+                                                                              \
+  if (h->bins == NULL || h->count >= (1 << h->log2bins))                      \
+  {                                                                           \
+    error err;                                                                \
+                                                                              \
+    err = name##__grow(h);                                                    \
+    if (err)                                                                  \
+      return err;                                                             \
+  }                                                                           \
+                                                                              \
+  n = malloc(sizeof(*n));                                                     \
+  if (n == NULL)                                                              \
+    return error_OOM;                                                         \
+                                                                              \
+  pn       = &h->bins[HASH_TEMPLATE_BIN(hash, h->log2bins)];                  \
+  n->next  = *pn;                                                             \
+  n->hash  = hash;                                                            \
+  n->key   = key;                                                             \
+  n->value = value;                                                           \
+  *pn      = n;                                                               \
+                                                                              \
+  h->count++;                                                                 \
+                                                                              \
+  return error_OK;                                                            \
+}                                                                             \
+                                                                              \
+static MAYBE_UNUSED int name##_remove(name##_t *h, keytype key)               \
+{                                                                             \
+  name##__node_t **pn;                                                        \
+  name##__node_t  *n;                                                         \
+                                                                              \
+  if (h->bins == NULL)                                                        \
+    return 0;                                                                 \
+                                                                              \
+  pn = name##__lookup_node(h, key, hash_fn(key));                             \
+  n  = *pn;                                                                   \
+  if (n == NULL)                                                              \
+    return 0; /* not found */                                                 \
+                                                                              \
+  *pn = n->next;                                                              \
+  free(n);                                                                    \
+  h->count--;                                                                 \
+                                                                              \
+  return 1;                                                                   \
+}                                                                             \
+                                                                              \
+static MAYBE_UNUSED int name##_count(const name##_t *h)                       \
+{                                                                             \
+  return h->count;                                                            \
+}
+
+/* ----------------------------------------------------------------------- */
+
+#endif /* HASH_TEMPLATE_H */
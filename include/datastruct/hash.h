@@ -15,10 +15,15 @@
 #ifndef HASH_H
 #define HASH_H
 
+#include <stdint.h>
 #include <stdio.h>
 
 #include "base/errors.h"
 #include "item.h"
+#include "depth.h"
+#include "flat.h"
+#include "instrument.h"
+#include "stats.h"
 
 #define T hash_t
 
@@ -67,6 +72,90 @@ error hash_create(const void         *default_value,
                   hash_destroy_value *destroy_value,
                   T                 **hash);
 
+/**
+ * Create a hash which is safe for use by multiple threads.
+ *
+ * hash_lookup takes no locks: it runs in parallel with other lookups and
+ * with writers. hash_insert and hash_remove lock one of a fixed set of
+ * stripes, each guarding a subset of the bins, so writers to different
+ * bins proceed in parallel. hash_walk, hash_walk_continuation and hash_show
+ * lock every stripe, so their callbacks must not modify the hash. Cursors
+ * take no locks; see hash_cursor_init.
+ *
+ * Unlike a hash made by hash_create the table grows as items are added.
+ * Growing builds a new table alongside the old one, so readers are never
+ * blocked. Memory unlinked by writers is freed once no reader can still be
+ * using it.
+ *
+ * Values returned by hash_lookup remain valid only until their key is
+ * removed or updated. To use them safely while other threads may be
+ * writing, bracket the lookup and the use with hash_read_begin and
+ * hash_read_end.
+ *
+ * The parameters are as for hash_create.
+ */
+error hash_create_concurrent(const void         *default_value,
+                             int                 nbins,
+                             hash_fn            *fn,
+                             hash_compare       *compare,
+                             hash_destroy_key   *destroy_key,
+                             hash_destroy_value *destroy_value,
+                             T                 **hash);
+
+/**
+ * Make the hash copy each key's bytes into the node which holds it rather
+ * than keep a pointer to the caller's key.
+ *
+ * The hash then never takes ownership of keys, nor destroys them: the
+ * caller may free or reuse a key as soon as hash_insert returns.
+ *
+ * \param hash Hash. Must be empty.
+ */
+void hash_set_inline_keys(T *hash);
+
+/**
+ * The order in which an ordered hash keeps its elements.
+ */
+typedef enum hash_order
+{
+  hash_ORDER_NONE,      /* bin order: the default */
+  hash_ORDER_INSERTION, /* oldest insertion first. Updates keep their place. */
+  hash_ORDER_ACCESS     /* least recently inserted, updated or looked up first */
+}
+hash_order_t;
+
+/**
+ * Make the hash keep its elements on a doubly linked list in the specified
+ * order, as well as in its bins.
+ *
+ * hash_walk and cursors then visit elements oldest first, and
+ * hash_pop_oldest removes the oldest in O(1). Each element costs three more
+ * pointers. In access order a successful hash_lookup moves its element to
+ * the newest end, so is no longer a pure read, and an element looked up
+ * during an iteration may be seen again.
+ *
+ * \param hash  Hash. Must be empty and not concurrent.
+ * \param order Order to keep.
+ */
+void hash_set_order(T *hash, hash_order_t order);
+
+/**
+ * Begin a read-side critical section on a concurrent hash.
+ *
+ * \param hash Hash.
+ *
+ * \return Token to pass to hash_read_end.
+ */
+int hash_read_begin(const T *hash);
+
+/**
+ * End a read-side critical section on a concurrent hash.
+ *
+ * \param hash  Hash.
+ * \param token Token returned by hash_read_begin.
+ */
+void hash_read_end(const T *hash, int token);
+
 /**
  * Destroy a hash.
  *
@@ -113,6 +202,23 @@ error hash_insert(T          *hash,
  */
 void hash_remove(T *hash, const void *key);
 
+/**
+ * Remove the oldest element from an ordered hash, handing its key and value
+ * to the caller rather than destroying them.
+ *
+ * \param      hash  Hash. Must be ordered.
+ * \param[out] key   Pointer to receive the key, or NULL to have it destroyed.
+ *                   Must be NULL if keys are inline: the key's bytes are
+ *                   freed along with the element.
+ * \param[out] value Pointer to receive the value, or NULL to have it
+ *                   destroyed.
+ *
+ * \return Error indication.
+ * \retval error_OK        If an element was removed.
+ * \retval error_NOT_FOUND If the hash is empty.
+ */
+error hash_pop_oldest(T *hash, const void **key, const void **value);
+
 /**
  * Return the count of items stored in the hash.
  *
@@ -122,6 +228,84 @@ void hash_remove(T *hash, const void *key);
  */
 int hash_count(T *hash);
 
+/**
+ * Report the memory used by the hash, excluding keys and values.
+ *
+ * Uses maintained counters so is cheap to call.
+ *
+ * \param hash  Hash.
+ * \param stats Filled in with the hash's memory use.
+ */
+void hash_stats(const T *hash, datastruct_stats_t *stats);
+
+/**
+ * Copy out the hash's operation counters.
+ *
+ * \param hash   Hash.
+ * \param counts Filled in with the counters.
+ *
+ * \return error_NOT_IMPLEMENTED if built without DATASTRUCT_INSTRUMENT.
+ */
+error hash_instrument(const T *hash, datastruct_instrument_t *counts);
+
+/**
+ * Summarise the hash's chain lengths by visiting every bin. O(n).
+ *
+ * \param hash  Hash.
+ * \param stats Filled in with a histogram of bins by chain length and the
+ *              load factor. See depth.h.
+ *
+ * \return error_OK.
+ */
+error hash_depth_stats(const T *hash, datastruct_depth_stats_t *stats);
+
+/* ----------------------------------------------------------------------- */
+
+/**
+ * A function called for every key:value pair matching a prefix.
+ *
+ * Return an error to halt the lookup.
+ */
+typedef error (hash_found_callback)(const item_t *item,
+                                    void         *opaque);
+
+/**
+ * Call the specified routine for every key which begins with the specified
+ * prefix, in key order (as memcmp, shorter keys first).
+ *
+ * Keys are compared as bytes, using the lengths given to hash_insert.
+ *
+ * Buckets hold no order so this uses a side index of nodes sorted by key,
+ * built by the first call. Hashes which are never asked for a prefix pay
+ * nothing for it. Keys inserted later are merged into the index by the next
+ * call, in O(n + k log k) for k new keys. Removing a key finds and clears
+ * its entry in O(log n) and the next call closes up the gaps in O(n). Only
+ * growing a concurrent hash has the next call rebuild it in O(n log n).
+ * Matching keys are then found in O(log n) plus one step per match.
+ *
+ * Like hash_lookup this may be called from several threads at once, if no
+ * thread is modifying the hash: the index is guarded by a lock of its own,
+ * held throughout the call, so the callback must not look up prefixes in
+ * the same hash. In concurrent mode this also locks every stripe, so the
+ * callback must not modify the hash.
+ *
+ * \param hash      Hash.
+ * \param prefix    Prefix to match.
+ * \param prefixlen Length of prefix.
+ * \param cb        Callback routine.
+ * \param opaque    Opaque pointer to pass to callback routine.
+ *
+ * \return Error indication.
+ * \retval error_OK        If at least one key matched.
+ * \retval error_NOT_FOUND If no key matched.
+ * \retval error_OOM       If the index could not be built.
+ */
+error hash_lookup_prefix(T                   *hash,
+                         const void          *prefix,
+                         size_t               prefixlen,
+                         hash_found_callback *cb,
+                         void                *opaque);
+
 /* ----------------------------------------------------------------------- */
 
 /**
@@ -133,7 +317,8 @@ typedef error (hash_walk_callback)(const item_t *item,
                                    void         *opaque);
 
 /**
- * Walk the hash, calling the specified routine for every element.
+ * Walk the hash, calling the specified routine for every element. An
+ * ordered hash is walked oldest first.
  *
  * \param hash   Hash.
  * \param cb     Callback routine.
@@ -146,9 +331,77 @@ error hash_walk(const T *hash, hash_walk_callback *cb, void *opaque);
 
 /* ----------------------------------------------------------------------- */
 
+/**
+ * A position within an iteration over a hash. Allocate one wherever is
+ * convenient. The members are private.
+ */
+typedef struct hash_cursor
+{
+  const void *table; /* NULL if following an ordered hash's list */
+  const void *node;  /* next node to return, or NULL */
+  uint64_t    bin;   /* next bin to examine */
+  int         token;
+}
+hash_cursor_t;
+
+/**
+ * Begin iterating over the hash. An ordered hash is visited oldest first.
+ *
+ * Each step costs O(1) plus any empty bins skipped, so a complete
+ * iteration is O(n + nbins).
+ *
+ * The item just returned may be removed before the next step. Keys
+ * inserted or removed while the iteration is under way may or may not be
+ * seen. Other keys are seen exactly once.
+ *
+ * In concurrent mode the cursor holds a read-side critical section until
+ * hash_cursor_end. It takes no locks, so other threads may modify the hash
+ * meanwhile. If the table grows the cursor carries on through the table it
+ * started with, which holds every key present when it was replaced. The
+ * thread holding a cursor must not itself modify a concurrent hash.
+ *
+ * A concurrent cursor therefore blocks reclamation for its whole lifetime:
+ * every node removed or replaced, and every table outgrown, by any thread
+ * while it is open stays allocated until hash_cursor_end. Under heavy
+ * writes keep iterations short, ending the cursor and starting another,
+ * rather than holding one open.
+ *
+ * \param      hash   Hash.
+ * \param[out] cursor Cursor to initialise.
+ */
+void hash_cursor_init(const T *hash, hash_cursor_t *cursor);
+
+/**
+ * Return the next element.
+ *
+ * \param      cursor Cursor.
+ * \param[out] item   Pointer to receive the element. Valid until the key is
+ *                    removed or, in concurrent mode, until hash_cursor_end.
+ *
+ * \return Error indication.
+ * \retval error_OK       If an element was found.
+ * \retval error_HASH_END If no elements remain.
+ */
+error hash_cursor_next(hash_cursor_t *cursor, const item_t **item);
+
+/**
+ * Finish iterating. Call once for every hash_cursor_init, whether or not the
+ * iteration reached the end.
+ *
+ * \param hash   Hash.
+ * \param cursor Cursor.
+ */
+void hash_cursor_end(const T *hash, hash_cursor_t *cursor);
+
+/* ----------------------------------------------------------------------- */
+
 /**
  * Walk the hash, returning each element in turn.
  *
+ * The continuation packs the bin and the position within its chain into
+ * 16 bits each, and each call walks the chain afresh, so this is limited to
+ * 65536 bins and is quadratic in chain length. Prefer hash_cursor_init.
+ *
  * \param      hash             Hash.
  * \param      continuation     Continuation value. Zero for initial call.
  * \param[out] nextcontinuation Next continuation value.
@@ -167,6 +420,21 @@ error hash_walk_continuation(T           *hash,
 
 /* ----------------------------------------------------------------------- */
 
+/**
+ * Write the hash's keys and values to a hashed flat file. See flat.h.
+ *
+ * \param hash      Hash.
+ * \param value_len Returns the length of a value. NULL if they're strings.
+ * \param filename  File to write.
+ *
+ * \return Error indication.
+ */
+error hash_save(const T        *hash,
+                flat_value_len *value_len,
+                const char     *filename);
+
+/* ----------------------------------------------------------------------- */
+
 /* To dump the data meaningfully hash_show must call back to the client to
  * get the opaque keys and values turned into printable strings. These
  * strings may or may not be dynamically allocated so hash_show_destroy is
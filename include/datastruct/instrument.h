@@ -0,0 +1,107 @@
+/* --------------------------------------------------------------------------
+ *    Name: instrument.h
+ * Purpose: Operation counters for data structures
+ * ----------------------------------------------------------------------- */
+
+/* When built with DATASTRUCT_INSTRUMENT defined ('make instrument=yes')
+ * every data structure counts the work done by its lookups, inserts and
+ * removes: key comparisons, nodes visited (or hash chain entries probed),
+ * key bits extracted and nodes allocated and freed. Each operation also
+ * records how many nodes it visited in a histogram, giving the distribution
+ * of search depths or probe lengths.
+ *
+ * Otherwise the counting macros expand to nothing and the _instrument
+ * functions return error_NOT_IMPLEMENTED.
+ *
+ * The counters are not synchronised so are only accurate when a single
+ * thread uses the data structure.
+ */
+
+#ifndef DATASTRUCT_INSTRUMENT_H
+#define DATASTRUCT_INSTRUMENT_H
+
+/* ----------------------------------------------------------------------- */
+
+typedef enum datastruct_op
+{
+  datastruct_OP_LOOKUP,
+  datastruct_OP_INSERT,
+  datastruct_OP_REMOVE,
+  datastruct_OP__LIMIT
+}
+datastruct_op_t;
+
+/* The final bucket counts every operation visiting at least this many
+ * nodes less one. */
+#define datastruct_HISTOGRAM_BUCKETS 64
+
+typedef struct datastruct_op_counts
+{
+  unsigned long calls;
+  unsigned long compares;  /* key comparisons */
+  unsigned long visits;    /* nodes visited */
+  unsigned long bits;      /* key bits extracted */
+  unsigned long histogram[datastruct_HISTOGRAM_BUCKETS]; /* calls by visits */
+}
+datastruct_op_counts_t;
+
+typedef struct datastruct_instrument
+{
+  datastruct_op_counts_t op[datastruct_OP__LIMIT];
+
+  unsigned long          allocs;  /* nodes allocated */
+  unsigned long          frees;   /* nodes freed */
+
+  /* counts for the operation in progress */
+  unsigned long          compares;
+  unsigned long          visits;
+  unsigned long          bits;
+}
+datastruct_instrument_t;
+
+/* Add the counts in 'src' to 'dst'. */
+void datastruct_instrument_add(datastruct_instrument_t       *dst,
+                               const datastruct_instrument_t *src);
+
+/* Fold the counts for the operation in progress into those for 'op'. */
+void datastruct_instrument_end(datastruct_instrument_t *i, datastruct_op_t op);
+
+/* ----------------------------------------------------------------------- */
+
+/* For use by data structure implementations, which hold a
+ * datastruct_instrument_t named 'instrument' when instrumented. Lookups
+ * take a const pointer so the counters are updated through a cast. */
+
+#ifdef DATASTRUCT_INSTRUMENT
+
+#include <string.h>
+
+#define INSTRUMENT_BLOCK(t) \
+  ((datastruct_instrument_t *) &(t)->instrument)
+
+#define INSTRUMENT_INIT(t) \
+  memset(INSTRUMENT_BLOCK(t), 0, sizeof(datastruct_instrument_t))
+
+#define INSTRUMENT_COMPARE(t)  (INSTRUMENT_BLOCK(t)->compares++)
+#define INSTRUMENT_VISIT(t)    (INSTRUMENT_BLOCK(t)->visits++)
+#define INSTRUMENT_BITS(t, n)  (INSTRUMENT_BLOCK(t)->bits += (n))
+#define INSTRUMENT_ALLOC(t)    (INSTRUMENT_BLOCK(t)->allocs++)
+#define INSTRUMENT_FREE(t)     (INSTRUMENT_BLOCK(t)->frees++)
+#define INSTRUMENT_END(t, op) \
+  datastruct_instrument_end(INSTRUMENT_BLOCK(t), datastruct_OP_##op)
+
+#else
+
+#define INSTRUMENT_INIT(t)     ((void) 0)
+#define INSTRUMENT_COMPARE(t)  ((void) 0)
+#define INSTRUMENT_VISIT(t)    ((void) 0)
+#define INSTRUMENT_BITS(t, n)  ((void) 0)
+#define INSTRUMENT_ALLOC(t)    ((void) 0)
+#define INSTRUMENT_FREE(t)     ((void) 0)
+#define INSTRUMENT_END(t, op)  ((void) 0)
+
+#endif
+
+/* ----------------------------------------------------------------------- */
+
+#endif /* DATASTRUCT_INSTRUMENT_H */
@@ -10,6 +10,8 @@
 
 #include "base/errors.h"
 #include "item.h"
+#include "instrument.h"
+#include "stats.h"
 
 /* ----------------------------------------------------------------------- */
 
@@ -56,6 +58,12 @@ const item_t *linkedlist_select(T *t, int k);
 
 int linkedlist_count(T *t);
 
+/* Report memory use, excluding keys and values. O(1). */
+void linkedlist_stats(const T *t, datastruct_stats_t *stats);
+
+/* Copy out operation counters. See instrument.h. */
+error linkedlist_instrument(const T *t, datastruct_instrument_t *counts);
+
 /* ----------------------------------------------------------------------- */
 
 typedef error (linkedlist_found_callback)(const item_t *item,
@@ -11,6 +11,9 @@
 #include "base/errors.h"
 #include "utils/utils.h"
 #include "item.h"
+#include "flat.h"
+#include "instrument.h"
+#include "stats.h"
 
 /* ----------------------------------------------------------------------- */
 
@@ -60,6 +63,12 @@ const item_t *orderedarray_select(T *t, int k);
 
 int orderedarray_count(T *t);
 
+/* Report memory use, excluding keys and values. O(1). */
+void orderedarray_stats(const T *t, datastruct_stats_t *stats);
+
+/* Copy out operation counters. See instrument.h. */
+error orderedarray_instrument(const T *t, datastruct_instrument_t *counts);
+
 /* ----------------------------------------------------------------------- */
 
 typedef error (orderedarray_found_callback)(const item_t *item,
@@ -82,6 +91,14 @@ error orderedarray_walk(const T                    *t,
 
 /* ----------------------------------------------------------------------- */
 
+/* Write the array's keys and values to a sorted flat file. 'value_len'
+ * gives the length of each value, or NULL if they're strings. See flat.h. */
+error orderedarray_save(const T        *t,
+                        flat_value_len *value_len,
+                        const char     *filename);
+
+/* ----------------------------------------------------------------------- */
+
 /* To dump the data meaningfully orderedarray_show must call back to the
  * client to get the opaque keys and values turned into printable strings.
  * These strings may or may not be dynamically allocated so
@@ -13,6 +13,10 @@
 
 #include "base/errors.h"
 #include "item.h"
+#include "depth.h"
+#include "flat.h"
+#include "instrument.h"
+#include "stats.h"
 
 /* ----------------------------------------------------------------------- */
 
@@ -43,6 +47,15 @@ error patricia_create(const void             *default_value,
                       T                     **t);
 void patricia_destroy(T *t);
 
+/* Make the tree copy each key's bytes into the node which holds it rather
+ * than keep a pointer to the caller's key. The tree then never takes
+ * ownership of keys, nor destroys them: the caller may free or reuse a key
+ * as soon as patricia_insert returns.
+ *
+ * Call this on a new, empty tree.
+ */
+void patricia_set_inline_keys(T *t);
+
 /* ----------------------------------------------------------------------- */
 
 const void *patricia_lookup(const T *t, const void *key, size_t keylen);
@@ -58,6 +71,16 @@ const item_t *patricia_select(T *t, int k);
 
 int patricia_count(T *t);
 
+/* Report memory use, excluding keys and values. O(1). */
+void patricia_stats(const T *t, datastruct_stats_t *stats);
+
+/* Copy out operation counters. See instrument.h. */
+error patricia_instrument(const T *t, datastruct_instrument_t *counts);
+
+/* Summarise the depths of elements by walking the whole tree. O(n).
+ * See depth.h. */
+error patricia_depth_stats(const T *t, datastruct_depth_stats_t *stats);
+
 /* ----------------------------------------------------------------------- */
 
 typedef error (patricia_found_callback)(const item_t *item,
@@ -82,6 +105,14 @@ error patricia_walk(const T                *t,
 
 /* ----------------------------------------------------------------------- */
 
+/* Write the tree's keys and values to a sorted flat file. 'value_len'
+ * gives the length of each value, or NULL if they're strings. See flat.h. */
+error patricia_save(const T        *t,
+                    flat_value_len *value_len,
+                    const char     *filename);
+
+/* ----------------------------------------------------------------------- */
+
 /* To dump the data meaningfully patricia_show must call back to the client
  * to get the opaque keys and values turned into printable strings. These
  * strings may or may not be dynamically allocated so patricia_show_destroy
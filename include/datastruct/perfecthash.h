@@ -0,0 +1,93 @@
+/* --------------------------------------------------------------------------
+ *    Name: perfecthash.h
+ * Purpose: Read-only associative array indexed by a minimal perfect hash
+ * ----------------------------------------------------------------------- */
+
+/* A perfect hash is built once from a fixed set of keys and then only read.
+ * Building finds a hash function which sends each key to its own slot, with
+ * exactly as many slots as keys, so a lookup is one slot probe and one key
+ * comparison. There are no chains or empty bins.
+ *
+ * Construction is by "hash and displace" (as in CHD and PTHash): keys are
+ * hashed into buckets averaging a few keys each, then, largest bucket
+ * first, each bucket tries a sequence of 'pilot' values until one places
+ * all of its keys in free slots. A lookup hashes its key, reads its
+ * bucket's pilot and goes straight to the slot. Pilots cost a little
+ * over a byte per key.
+ *
+ * Keys are compared as bytes. Their bytes are copied into a block kept in
+ * slot order, so the keys passed in need only last until the build.
+ * Values are held by pointer and are not owned. A slot is sixteen bytes:
+ * the value pointer and the key's 32-bit offset and length.
+ *
+ * To freeze any other data structure, pass perfecthash_add_item to its
+ * walk, e.g. hash_walk(h, perfecthash_add_item, ph), then build.
+ */
+
+#ifndef PERFECTHASH_H
+#define PERFECTHASH_H
+
+#include <stddef.h>
+
+#include "base/errors.h"
+#include "item.h"
+#include "stats.h"
+
+/* ----------------------------------------------------------------------- */
+
+#define T perfecthash_t
+
+typedef struct perfecthash T;
+
+/* ----------------------------------------------------------------------- */
+
+error perfecthash_create(const void *default_value, T **ph);
+void perfecthash_destroy(T *doomed);
+
+/* ----------------------------------------------------------------------- */
+
+/* Add a key ahead of building. The key must remain valid until the build.
+ * Returns error_READ_ONLY once built. Keys may total no more than 4GiB. */
+error perfecthash_add(T          *ph,
+                      const void *key,
+                      size_t      keylen,
+                      const void *value);
+
+/* As perfecthash_add, with the signature of a walk callback. 'opaque' is
+ * the perfect hash. */
+error perfecthash_add_item(const item_t *item, void *opaque);
+
+/* Build the perfect hash over the keys added. Returns error_EXISTS if a
+ * key was added twice or, vanishingly rarely, error_PERFECTHASH_FAILED if
+ * no perfect hash was found. Takes expected O(n log n) time. */
+error perfecthash_build(T *ph);
+
+/* ----------------------------------------------------------------------- */
+
+/* Returns the value for 'key', or the default value if absent or not yet
+ * built. */
+const void *perfecthash_lookup(const T    *ph,
+                               const void *key,
+                               size_t      keylen);
+
+int perfecthash_count(const T *ph);
+
+/* ----------------------------------------------------------------------- */
+
+typedef error (perfecthash_walk_callback)(const item_t *item,
+                                          void         *opaque);
+
+/* Walk every entry in slot order, which is no particular key order. */
+error perfecthash_walk(const T                   *ph,
+                       perfecthash_walk_callback *cb,
+                       void                      *opaque);
+
+/* ----------------------------------------------------------------------- */
+
+void perfecthash_stats(const T *ph, datastruct_stats_t *stats);
+
+/* ----------------------------------------------------------------------- */
+
+#undef T
+
+#endif /* PERFECTHASH_H */
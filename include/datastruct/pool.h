@@ -0,0 +1,98 @@
+/* --------------------------------------------------------------------------
+ *    Name: pool.h
+ * Purpose: Pool of fixed-size elements addressed by 32-bit index
+ * ----------------------------------------------------------------------- */
+
+/* A pool hands out fixed-size elements from large arrays ("segments")
+ * rather than allocating each one from the heap, and identifies them by a
+ * 32-bit index rather than by pointer. Index zero is never handed out so it
+ * can be used as a null link.
+ *
+ * Segments are never moved once allocated, so pointers to elements remain
+ * valid until the element is freed. Only the array of segment pointers
+ * grows. Freed elements are kept on a free list for reuse and all memory is
+ * returned by datastruct_pool_fini.
+ *
+ * Pools are not synchronised.
+ */
+
+#ifndef DATASTRUCT_POOL_H
+#define DATASTRUCT_POOL_H
+
+#include <stddef.h>
+
+#include "base/types.h"
+
+/* ----------------------------------------------------------------------- */
+
+typedef uint32_t datastruct_pool_index_t;
+
+#define datastruct_POOL_NIL 0
+
+/* Each segment holds 1 << datastruct_POOL_LOG2_SEGMENT elements. */
+#define datastruct_POOL_LOG2_SEGMENT 8
+
+typedef struct datastruct_pool
+{
+  size_t                   size;      /* bytes per element */
+  unsigned char          **segments;
+  unsigned int             nsegments;
+  unsigned int             allocated; /* entries in 'segments' */
+  datastruct_pool_index_t  next;      /* first never-used index */
+  datastruct_pool_index_t  free;      /* head of the free list */
+  unsigned long            used;      /* elements handed out */
+}
+datastruct_pool_t;
+
+/* Prepare an empty pool of 'size'-byte elements. Nothing is allocated
+ * until the first call to datastruct_pool_alloc. */
+void datastruct_pool_init(datastruct_pool_t *pool, size_t size);
+
+/* Release all memory held by the pool, including any elements still in
+ * use. */
+void datastruct_pool_fini(datastruct_pool_t *pool);
+
+/* Returns the index of a new, uninitialised element, or datastruct_POOL_NIL
+ * if out of memory. */
+datastruct_pool_index_t datastruct_pool_alloc(datastruct_pool_t *pool);
+
+void datastruct_pool_free(datastruct_pool_t       *pool,
+                          datastruct_pool_index_t  index);
+
+/* Returns the number of bytes allocated to segments. */
+size_t datastruct_pool_bytes(const datastruct_pool_t *pool);
+
+/* ----------------------------------------------------------------------- */
+
+/* Returns a pointer to the element at 'index', which must be in use.
+ * 'index' is evaluated twice. */
+#define datastruct_pool_get(pool, index)                                   \
+  ((void *) ((pool)->segments[(index) >> datastruct_POOL_LOG2_SEGMENT] +  \
+             ((index) & ((1u << datastruct_POOL_LOG2_SEGMENT) - 1)) *     \
+             (pool)->size))
+
+/* ----------------------------------------------------------------------- */
+
+/* For use by tree implementations which offer the compact node layout,
+ * selected by building with DATASTRUCT_COMPACT defined ('make
+ * compact=yes'). The tree holds a datastruct_pool_t named 'pool' and links
+ * its nodes together using POOL_LINK. Otherwise links are plain pointers
+ * and nodes come from malloc. */
+
+#ifdef DATASTRUCT_COMPACT
+
+#define POOL_LINK(type)        datastruct_pool_index_t
+#define POOL_NIL               datastruct_POOL_NIL
+#define POOL_NODE(t, type, l)  ((type *) datastruct_pool_get(&(t)->pool, (l)))
+
+#else
+
+#define POOL_LINK(type)        type *
+#define POOL_NIL               NULL
+#define POOL_NODE(t, type, l)  (l)
+
+#endif
+
+/* ----------------------------------------------------------------------- */
+
+#endif /* DATASTRUCT_POOL_H */
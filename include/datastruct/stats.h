@@ -0,0 +1,33 @@
+/* --------------------------------------------------------------------------
+ *    Name: stats.h
+ * Purpose: Memory use of data structures
+ * ----------------------------------------------------------------------- */
+
+#ifndef DATASTRUCT_STATS_H
+#define DATASTRUCT_STATS_H
+
+#include <stddef.h>
+
+/* Each data structure's _stats function fills one of these in from counters
+ * it maintains as it changes, so it's cheap enough to call as a live
+ * metric.
+ *
+ * Byte counts are of the sizes requested from malloc. Allocator overhead is
+ * not included.
+ */
+typedef struct datastruct_stats
+{
+  int    elements;     /* number of keys stored */
+  int    branches;     /* nodes which hold no element */
+  int    leaves;       /* nodes which hold an element */
+  size_t node_bytes;   /* bytes in branches and leaves */
+  size_t table_bytes;  /* bytes in bins or arrays, including slack */
+  size_t slack_bytes;  /* allocated but unused part of table_bytes */
+  size_t other_bytes;  /* the structure itself, locks and the like */
+  size_t key_bytes;    /* keys - only when requested */
+  size_t value_bytes;  /* values - only when requested */
+  size_t total_bytes;  /* all of the above - slack is within table_bytes */
+}
+datastruct_stats_t;
+
+#endif /* DATASTRUCT_STATS_H */
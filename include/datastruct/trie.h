@@ -16,6 +16,9 @@
 
 #include "base/errors.h"
 #include "item.h"
+#include "depth.h"
+#include "instrument.h"
+#include "stats.h"
 
 /* ----------------------------------------------------------------------- */
 
@@ -58,6 +61,16 @@ const item_t *trie_select(T *t, int k);
 
 int trie_count(T *t);
 
+/* Report memory use, excluding keys and values. O(1). */
+void trie_stats(const T *t, datastruct_stats_t *stats);
+
+/* Copy out operation counters. See instrument.h. */
+error trie_instrument(const T *t, datastruct_instrument_t *counts);
+
+/* Summarise the depths of elements by walking the whole tree. O(n).
+ * See depth.h. */
+error trie_depth_stats(const T *t, datastruct_depth_stats_t *stats);
+
 /* ----------------------------------------------------------------------- */
 
 typedef error (trie_found_callback)(const item_t *item,
@@ -0,0 +1,47 @@
+/* --------------------------------------------------------------------------
+ *    Name: sizedstring.h
+ * Purpose: Functions for keys or values which are strings of known length
+ * ----------------------------------------------------------------------- */
+
+/* A sized string is a string preceded in memory by its length, so its
+ * length is to hand without scanning it as strlen must. It is otherwise an
+ * ordinary NUL-terminated string, so it compares, hashes and prints as a
+ * string does.
+ *
+ * Containers may call their key's 'len' on any key or prefix passed to
+ * their lookup, insert, remove and lookup_prefix methods. Given
+ * sizedstringkv_len that's a single load however long the key is, but the
+ * load is from just before the string, so every key or prefix passed to
+ * those methods must itself be a sized string. Pass plain strings to the
+ * _n forms of the methods instead, along with their lengths.
+ *
+ * Containers with inline keys copy only the string, not its length, so the
+ * keys they hand back are plain strings.
+ */
+
+#ifndef SIZEDSTRING_KV_H
+#define SIZEDSTRING_KV_H
+
+#include <stddef.h>
+
+#include "keyval/kv.h"
+#include "keyval/common.h"
+#include "keyval/string.h"
+
+/* Return a new sized string holding the first 'len' bytes of 's', or NULL
+ * if out of memory. */
+char *sizedstring_create(const char *s, size_t len);
+
+/* Destroy a sized string. */
+kv_destroy sizedstring_destroy;
+
+kv_len sizedstringkv_len;
+#define sizedstringkv_compare stringkv_compare
+#define sizedstringkv_destroy sizedstring_destroy
+#define sizedstringkv_nodestroy kv_nodestroy
+#define sizedstringkv_hash stringkv_hash
+#define sizedstringkv_fmt stringkv_fmt
+#define sizedstringkv_fmt_destroy kv_fmtdestroy
+#define sizedstringkv_fmt_nodestroy kv_nofmtdestroy
+
+#endif /* SIZEDSTRING_KV_H */
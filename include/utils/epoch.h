@@ -0,0 +1,52 @@
+/* --------------------------------------------------------------------------
+ *    Name: epoch.h
+ * Purpose: Epoch-based memory reclamation
+ * ----------------------------------------------------------------------- */
+
+/* Epoch-based reclamation lets readers traverse a shared data structure
+ * without taking locks while writers unlink and free parts of it.
+ *
+ * Readers bracket each traversal with epoch_enter and epoch_leave. A writer
+ * which unlinks a block passes it to epoch_retire rather than freeing it
+ * directly. The block is freed only once every reader which could have seen
+ * it has left.
+ *
+ * All calls are thread safe except epoch_destroy, which must be called
+ * once nothing else is using the epoch. A reader must not call
+ * epoch_synchronize, nor wait on a thread which may be doing so.
+ */
+
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include "base/errors.h"
+
+#define T epoch_t
+
+typedef struct epoch T;
+
+/* Frees a retired block. */
+typedef void (epoch_free)(void *block, void *opaque);
+
+error epoch_create(T **e);
+
+/* Frees any blocks still awaiting reclamation. */
+void epoch_destroy(T *e);
+
+/* Enter a read-side critical section. Returns a token to pass to
+ * epoch_leave. Sections may nest. */
+int epoch_enter(T *e);
+void epoch_leave(T *e, int token);
+
+/* Arrange for 'block' to be freed by 'fn' once all current readers have
+ * left. Never fails: if memory is short it waits for readers to leave and
+ * frees the block immediately. */
+void epoch_retire(T *e, void *block, epoch_free *fn, void *opaque);
+
+/* Wait until all current readers have left, then free everything
+ * retired so far. */
+void epoch_synchronize(T *e);
+
+#undef T
+
+#endif /* EPOCH_H */
@@ -0,0 +1,419 @@
+/* --------------------------------------------------------------------------
+ *    Name: memento.c
+ * Purpose: Allocation tracker
+ * ----------------------------------------------------------------------- */
+
+#ifdef MEMENTO
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* call the real allocator in here */
+#define MEMENTO_IMPLEMENTATION
+#include "base/memento/memento.h"
+
+/* ----------------------------------------------------------------------- */
+
+/* Live blocks are found by address in a chained hash. */
+#define NBINS (1 << 16)
+
+/* Call sites are held in an open-addressed hash. Once it fills further
+ * sites are counted against the final entry. */
+#define NSITES 1024
+
+typedef struct memento__site
+{
+  const char     *file; /* NULL if unused */
+  int             line;
+  memento_stats_t stats;
+  unsigned long   histogram[memento_HISTOGRAM_BUCKETS];
+}
+memento__site_t;
+
+typedef struct memento__block
+{
+  struct memento__block *next;
+  void                  *ptr;
+  size_t                 size;
+  memento__site_t       *site;
+}
+memento__block_t;
+
+static pthread_mutex_t   memento__lock = PTHREAD_MUTEX_INITIALIZER;
+static memento_stats_t   memento__stats;
+static memento__block_t *memento__bins[NBINS];
+static memento__site_t   memento__sites[NSITES + 1];
+static int               memento__nsites;
+
+/* ----------------------------------------------------------------------- */
+
+static unsigned int memento__hash_ptr(const void *ptr)
+{
+  size_t h;
+
+  h = (size_t) ptr;
+  h ^= h >> 16;
+  h *= 0x45d9f3b;
+  h ^= h >> 16;
+
+  return (unsigned int) h & (NBINS - 1);
+}
+
+static memento__site_t *memento__site(const char *file, int line)
+{
+  unsigned int     h;
+  const char      *p;
+  int              i;
+  memento__site_t *s;
+
+  h = (unsigned int) line;
+  for (p = file; *p; p++)
+    h = h * 31 + (unsigned char) *p;
+
+  for (i = 0; i < NSITES; i++)
+  {
+    s = &memento__sites[(h + i) % NSITES];
+    if (s->file == NULL)
+    {
+      if (memento__nsites == NSITES - 1)
+        break; /* keep a free entry to terminate searches */
+
+      memento__nsites++;
+      s->file = file;
+      s->line = line;
+      return s;
+    }
+    if (s->line == line && (s->file == file || strcmp(s->file, file) == 0))
+      return s;
+  }
+
+  s = &memento__sites[NSITES];
+  s->file = "(other)";
+  return s;
+}
+
+static int memento__bucket(size_t size)
+{
+  int b;
+
+  for (b = 0; b < memento_HISTOGRAM_BUCKETS - 1; b++)
+    if (size <= ((size_t) 8 << b))
+      break;
+
+  return b;
+}
+
+static void memento__count_alloc(memento_stats_t *st, size_t size)
+{
+  st->live_blocks++;
+  st->live_bytes  += size;
+  st->total_bytes += size;
+  if (st->live_bytes > st->peak_bytes)
+    st->peak_bytes = st->live_bytes;
+}
+
+static void memento__count_free(memento_stats_t *st, size_t size)
+{
+  st->frees++;
+  st->live_blocks--;
+  st->live_bytes -= size;
+}
+
+/* Link a block record into its bin. Called with the lock held. */
+static void memento__relink(memento__block_t *b)
+{
+  memento__block_t **bin;
+
+  bin = &memento__bins[memento__hash_ptr(b->ptr)];
+  b->next = *bin;
+  *bin = b;
+}
+
+/* Record a new block. Called with the lock held. If the record can't be
+ * allocated the block goes untracked. */
+static void memento__track(void *ptr, size_t size, memento__site_t *site)
+{
+  memento__block_t *b;
+
+  b = malloc(sizeof(*b));
+  if (b == NULL)
+    return;
+
+  b->ptr  = ptr;
+  b->size = size;
+  b->site = site;
+  memento__relink(b);
+
+  memento__count_alloc(&memento__stats, size);
+  memento__count_alloc(&site->stats, size);
+  site->histogram[memento__bucket(size)]++;
+}
+
+/* Unlink and return the record for a block, or NULL if it's untracked.
+ * Called with the lock held. */
+static memento__block_t *memento__untrack(void *ptr)
+{
+  memento__block_t **pb;
+  memento__block_t  *b;
+
+  for (pb = &memento__bins[memento__hash_ptr(ptr)]; *pb; pb = &(*pb)->next)
+  {
+    b = *pb;
+    if (b->ptr == ptr)
+    {
+      *pb = b->next;
+      return b;
+    }
+  }
+
+  return NULL;
+}
+
+/* ----------------------------------------------------------------------- */
+
+void *memento_malloc(size_t size, const char *file, int line)
+{
+  void            *ptr;
+  memento__site_t *site;
+
+  ptr = malloc(size);
+  if (ptr == NULL)
+    return NULL;
+
+  pthread_mutex_lock(&memento__lock);
+
+  site = memento__site(file, line);
+  memento__stats.allocs++;
+  site->stats.allocs++;
+  memento__track(ptr, size, site);
+
+  pthread_mutex_unlock(&memento__lock);
+
+  return ptr;
+}
+
+void *memento_calloc(size_t nmemb, size_t size, const char *file, int line)
+{
+  void            *ptr;
+  memento__site_t *site;
+
+  ptr = calloc(nmemb, size);
+  if (ptr == NULL)
+    return NULL;
+
+  pthread_mutex_lock(&memento__lock);
+
+  site = memento__site(file, line);
+  memento__stats.allocs++;
+  site->stats.allocs++;
+  memento__track(ptr, nmemb * size, site);
+
+  pthread_mutex_unlock(&memento__lock);
+
+  return ptr;
+}
+
+void *memento_realloc(void *ptr, size_t size, const char *file, int line)
+{
+  memento__block_t *b;
+  void             *newptr;
+  memento__site_t  *site;
+
+  if (ptr == NULL)
+    return memento_malloc(size, file, line);
+
+  if (size == 0)
+  {
+    memento_free(ptr);
+    return NULL;
+  }
+
+  /* detach the record first: 'ptr' may not be used once realloc succeeds */
+  pthread_mutex_lock(&memento__lock);
+  b = memento__untrack(ptr);
+  pthread_mutex_unlock(&memento__lock);
+
+  newptr = realloc(ptr, size);
+
+  pthread_mutex_lock(&memento__lock);
+
+  if (newptr == NULL)
+  {
+    /* the original block is untouched */
+    if (b)
+      memento__relink(b);
+    goto exit;
+  }
+
+  /* a resized block is accounted as freed and allocated afresh at this
+   * call site, but counted as a realloc rather than a free and an alloc */
+  if (b)
+  {
+    memento__count_free(&memento__stats, b->size);
+    memento__count_free(&b->site->stats, b->size);
+    memento__stats.frees--;
+    b->site->stats.frees--;
+    free(b);
+  }
+
+  site = memento__site(file, line);
+  memento__stats.reallocs++;
+  site->stats.reallocs++;
+  memento__track(newptr, size, site);
+
+exit:
+
+  pthread_mutex_unlock(&memento__lock);
+
+  return newptr;
+}
+
+void memento_free(void *ptr)
+{
+  memento__block_t *b;
+
+  if (ptr == NULL)
+    return;
+
+  pthread_mutex_lock(&memento__lock);
+
+  b = memento__untrack(ptr);
+  if (b)
+  {
+    memento__count_free(&memento__stats, b->size);
+    memento__count_free(&b->site->stats, b->size);
+    free(b);
+  }
+
+  pthread_mutex_unlock(&memento__lock);
+
+  free(ptr);
+}
+
+/* ----------------------------------------------------------------------- */
+
+void memento_stats(memento_stats_t *stats)
+{
+  pthread_mutex_lock(&memento__lock);
+  *stats = memento__stats;
+  pthread_mutex_unlock(&memento__lock);
+}
+
+static void memento__reset_stats(memento_stats_t *st)
+{
+  st->allocs      = 0;
+  st->reallocs    = 0;
+  st->frees       = 0;
+  st->total_bytes = 0;
+  st->peak_bytes  = st->live_bytes;
+}
+
+void memento_reset(void)
+{
+  int i;
+
+  pthread_mutex_lock(&memento__lock);
+
+  memento__reset_stats(&memento__stats);
+  for (i = 0; i <= NSITES; i++)
+  {
+    memento__reset_stats(&memento__sites[i].stats);
+    memset(memento__sites[i].histogram, 0,
+           sizeof(memento__sites[i].histogram));
+  }
+
+  pthread_mutex_unlock(&memento__lock);
+}
+
+static int memento__compare_sites(const void *va, const void *vb)
+{
+  const memento__site_t *a = *(const memento__site_t **) va;
+  const memento__site_t *b = *(const memento__site_t **) vb;
+
+  if (a->stats.total_bytes != b->stats.total_bytes)
+    return (a->stats.total_bytes < b->stats.total_bytes) ? 1 : -1;
+
+  if (a->stats.allocs != b->stats.allocs)
+    return (a->stats.allocs < b->stats.allocs) ? 1 : -1;
+
+  return 0;
+}
+
+static void memento__print_stats(FILE *f, const memento_stats_t *st)
+{
+  fprintf(f, "%lu allocs, %lu reallocs, %lu frees, "
+             "%lu live blocks, %lu live bytes, %lu peak bytes, "
+             "%lu total bytes\n",
+          st->allocs,
+          st->reallocs,
+          st->frees,
+          st->live_blocks,
+          (unsigned long) st->live_bytes,
+          (unsigned long) st->peak_bytes,
+          (unsigned long) st->total_bytes);
+}
+
+void memento_dump(FILE *f)
+{
+  const memento__site_t **sites;
+  int                     nsites;
+  int                     i;
+  int                     b;
+
+  pthread_mutex_lock(&memento__lock);
+
+  fprintf(f, "memento: ");
+  memento__print_stats(f, &memento__stats);
+
+  sites = malloc((NSITES + 1) * sizeof(*sites));
+  if (sites == NULL)
+    goto exit;
+
+  nsites = 0;
+  for (i = 0; i <= NSITES; i++)
+    if (memento__sites[i].file &&
+        (memento__sites[i].stats.allocs ||
+         memento__sites[i].stats.reallocs ||
+         memento__sites[i].stats.frees))
+      sites[nsites++] = &memento__sites[i];
+
+  qsort(sites, nsites, sizeof(*sites), memento__compare_sites);
+
+  for (i = 0; i < nsites; i++)
+  {
+    const memento__site_t *s = sites[i];
+
+    fprintf(f, "memento: %s:%d: ", s->file, s->line);
+    memento__print_stats(f, &s->stats);
+
+    fprintf(f, "memento: %s:%d: sizes", s->file, s->line);
+    for (b = 0; b < memento_HISTOGRAM_BUCKETS; b++)
+    {
+      if (s->histogram[b] == 0)
+        continue;
+
+      if (b < memento_HISTOGRAM_BUCKETS - 1)
+        fprintf(f, " <=%lu:%lu",
+                (unsigned long) ((size_t) 8 << b), s->histogram[b]);
+      else
+        fprintf(f, " >%lu:%lu",
+                (unsigned long) ((size_t) 8 << (b - 1)), s->histogram[b]);
+    }
+    fprintf(f, "\n");
+  }
+
+  free((void *) sites);
+
+exit:
+
+  pthread_mutex_unlock(&memento__lock);
+}
+
+#else
+
+/* ISO C forbids an empty translation unit */
+extern int memento__dummy;
+
+#endif /* MEMENTO */
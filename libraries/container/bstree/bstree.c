@@ -9,8 +9,10 @@
 
 #include "base/memento/memento.h"
 #include "base/errors.h"
+#include "base/types.h"
 #include "datastruct/bstree.h"
 #include "container/interface/container.h"
+#include "container/interface/stats.h"
 
 #include "container/bstree.h"
 
@@ -36,13 +38,32 @@ static const void *container_bstree__lookup(const icontainer_t *c_,
   return bstree_lookup(c->t, key);
 }
 
+static const void *container_bstree__lookup_n(const icontainer_t *c_,
+                                              const void         *key,
+                                              size_t              keylen)
+{
+  NOT_USED(keylen);
+
+  return container_bstree__lookup(c_, key);
+}
+
+static error container_bstree__insert_n(icontainer_t *c_,
+                                        const void   *key,
+                                        size_t        keylen,
+                                        const void   *value)
+{
+  container_bstree_t *c = (container_bstree_t *) c_;
+
+  return bstree_insert(c->t, key, keylen, value);
+}
+
 static error container_bstree__insert(icontainer_t *c_,
                                       const void   *key,
                                       const void   *value)
 {
   container_bstree_t *c = (container_bstree_t *) c_;
 
-  return bstree_insert(c->t, key, c->len(key), value);
+  return container_bstree__insert_n(c_, key, c->len(key), value);
 }
 
 static void container_bstree__remove(icontainer_t *c_, const void *key)
@@ -52,6 +73,15 @@ static void container_bstree__remove(icontainer_t *c_, const void *key)
   bstree_remove(c->t, key);
 }
 
+static void container_bstree__remove_n(icontainer_t *c_,
+                                       const void   *key,
+                                       size_t        keylen)
+{
+  NOT_USED(keylen);
+
+  container_bstree__remove(c_, key);
+}
+
 static const item_t *container_bstree__select(const icontainer_t *c_, int k)
 {
   container_bstree_t *c = (container_bstree_t *) c_;
@@ -59,10 +89,11 @@ static const item_t *container_bstree__select(const icontainer_t *c_, int k)
   return bstree_select(c->t, k);
 }
 
-static error container_bstree__lookup_prefix(const icontainer_t        *c_,
-                                             const void                *prefix,
-                                             icontainer_found_callback  cb,
-                                             void                      *opaque)
+static error container_bstree__lookup_prefix_n(const icontainer_t        *c_,
+                                               const void                *prefix,
+                                               size_t                     prefixlen,
+                                               icontainer_found_callback  cb,
+                                               void                      *opaque)
 {
   const container_bstree_t *c = (container_bstree_t *) c_;
 
@@ -72,10 +103,21 @@ static error container_bstree__lookup_prefix(const icontainer_t        *c_,
    * another. */
 
   return bstree_lookup_prefix(c->t,
-                              prefix, c->len(prefix),
+                              prefix, prefixlen,
                               (icontainer_found_callback) cb, opaque);
 }
 
+static error container_bstree__lookup_prefix(const icontainer_t        *c_,
+                                             const void                *prefix,
+                                             icontainer_found_callback  cb,
+                                             void                      *opaque)
+{
+  const container_bstree_t *c = (container_bstree_t *) c_;
+
+  return container_bstree__lookup_prefix_n(c_, prefix, c->len(prefix),
+                                           cb, opaque);
+}
+
 static int container_bstree__count(const icontainer_t *c_)
 {
   const container_bstree_t *c = (container_bstree_t *) c_;
@@ -83,6 +125,47 @@ static int container_bstree__count(const icontainer_t *c_)
   return bstree_count(c->t);
 }
 
+static error container_bstree__stats_kv(const item_t *item,
+                                        int           level,
+                                        void         *opaque)
+{
+  NOT_USED(level);
+
+  icontainer_kv_stats_add(opaque, item->key, item->value);
+
+  return error_OK;
+}
+
+static void container_bstree__stats(const icontainer_t *c_,
+                                    icontainer_kv_len   key_len,
+                                    icontainer_kv_len   value_len,
+                                    datastruct_stats_t *stats)
+{
+  const container_bstree_t *c = (container_bstree_t *) c_;
+  icontainer_kv_stats_t    kvs;
+
+  bstree_stats(c->t, stats);
+
+  if (icontainer_kv_stats_init(&kvs, sizeof(*c), key_len, value_len, stats))
+    (void) bstree_walk(c->t, bstree_WALK_IN_ORDER, container_bstree__stats_kv, &kvs);
+}
+
+static error container_bstree__instrument(const icontainer_t      *c_,
+                                          datastruct_instrument_t *counts)
+{
+  const container_bstree_t *c = (container_bstree_t *) c_;
+
+  return bstree_instrument(c->t, counts);
+}
+
+static error container_bstree__depth_stats(const icontainer_t       *c_,
+                                           datastruct_depth_stats_t *stats)
+{
+  const container_bstree_t *c = (container_bstree_t *) c_;
+
+  return bstree_depth_stats(c->t, stats);
+}
+
 static error container_bstree__show(const icontainer_t *c_, FILE *f)
 {
   container_bstree_t *c = (container_bstree_t *) c_;
@@ -120,12 +203,20 @@ error container_create_bstree(icontainer_t            **container,
     container_bstree__lookup,
     container_bstree__insert,
     container_bstree__remove,
+    container_bstree__lookup_n,
+    container_bstree__insert_n,
+    container_bstree__remove_n,
     container_bstree__select,
     container_bstree__lookup_prefix,
+    container_bstree__lookup_prefix_n,
     container_bstree__count,
+    container_bstree__stats,
+    container_bstree__instrument,
+    container_bstree__depth_stats,
     container_bstree__show,
     container_bstree__show_viz,
     container_bstree__destroy,
+    0, /* lookups_modify */
   };
 
   error               err;
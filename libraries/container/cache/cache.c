@@ -0,0 +1,297 @@
+/* --------------------------------------------------------------------------
+ *    Name: cache.c
+ * Purpose: Glue to make a cache be a container
+ * ----------------------------------------------------------------------- */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "base/memento/memento.h"
+#include "base/errors.h"
+#include "base/types.h"
+#include "datastruct/cache.h"
+#include "container/interface/container.h"
+#include "container/interface/stats.h"
+
+#include "container/cache.h"
+
+typedef struct container_cache
+{
+  icontainer_t               c;
+  cache_t                   *t;
+
+  icontainer_key_len         len;
+
+  icontainer_kv_show         show_key;
+  icontainer_kv_show_destroy show_key_destroy;
+  icontainer_kv_show         show_value;
+  icontainer_kv_show_destroy show_value_destroy;
+}
+container_cache_t;
+
+static const void *container_cache__lookup(const icontainer_t *c_,
+                                           const void         *key)
+{
+  const container_cache_t *c = (container_cache_t *) c_;
+
+  /* a lookup counts as a use of the entry, so it modifies the cache */
+  return cache_lookup(c->t, key);
+}
+
+static const void *container_cache__lookup_n(const icontainer_t *c_,
+                                             const void         *key,
+                                             size_t              keylen)
+{
+  NOT_USED(keylen);
+
+  return container_cache__lookup(c_, key);
+}
+
+static error container_cache__insert_n(icontainer_t *c_,
+                                       const void   *key,
+                                       size_t        keylen,
+                                       const void   *value)
+{
+  container_cache_t *c = (container_cache_t *) c_;
+
+  return cache_insert(c->t, key, keylen, value);
+}
+
+static error container_cache__insert(icontainer_t *c_,
+                                     const void   *key,
+                                     const void   *value)
+{
+  container_cache_t *c = (container_cache_t *) c_;
+
+  return container_cache__insert_n(c_, key, c->len(key), value);
+}
+
+static void container_cache__remove(icontainer_t *c_, const void *key)
+{
+  container_cache_t *c = (container_cache_t *) c_;
+
+  cache_remove(c->t, key);
+}
+
+static void container_cache__remove_n(icontainer_t *c_,
+                                      const void   *key,
+                                      size_t        keylen)
+{
+  NOT_USED(keylen);
+
+  container_cache__remove(c_, key);
+}
+
+static const item_t *container_cache__select(const icontainer_t *c_, int k)
+{
+  NOT_USED(c_);
+  NOT_USED(k);
+
+  return NULL; /* not implemented */
+}
+
+static error container_cache__lookup_prefix_n(const icontainer_t        *c_,
+                                              const void                *prefix,
+                                              size_t                     prefixlen,
+                                              icontainer_found_callback  cb,
+                                              void                      *opaque)
+{
+  container_cache_t *c = (container_cache_t *) c_;
+
+  /* cache_found_callback and icontainer_found_callback have the same
+   * signature so we can just cast one to the other here. */
+
+  return cache_lookup_prefix(c->t,
+                             prefix, prefixlen,
+                             (cache_found_callback *) cb, opaque);
+}
+
+static error container_cache__lookup_prefix(const icontainer_t        *c_,
+                                            const void                *prefix,
+                                            icontainer_found_callback  cb,
+                                            void                      *opaque)
+{
+  container_cache_t *c = (container_cache_t *) c_;
+
+  return container_cache__lookup_prefix_n(c_, prefix, c->len(prefix),
+                                          cb, opaque);
+}
+
+static int container_cache__count(const icontainer_t *c_)
+{
+  const container_cache_t *c = (container_cache_t *) c_;
+
+  return cache_count(c->t);
+}
+
+static error container_cache__stats_kv(const item_t *item, void *opaque)
+{
+  icontainer_kv_stats_add(opaque, item->key, item->value);
+
+  return error_OK;
+}
+
+static void container_cache__stats(const icontainer_t *c_,
+                                   icontainer_kv_len   key_len,
+                                   icontainer_kv_len   value_len,
+                                   datastruct_stats_t *stats)
+{
+  const container_cache_t *c = (container_cache_t *) c_;
+  icontainer_kv_stats_t    kvs;
+
+  cache_stats(c->t, stats);
+
+  if (icontainer_kv_stats_init(&kvs, sizeof(*c), key_len, value_len, stats))
+    (void) cache_walk(c->t, container_cache__stats_kv, &kvs);
+}
+
+static error container_cache__instrument(const icontainer_t      *c_,
+                                         datastruct_instrument_t *counts)
+{
+  NOT_USED(c_);
+  NOT_USED(counts);
+
+  return error_NOT_IMPLEMENTED;
+}
+
+static error container_cache__depth_stats(const icontainer_t       *c_,
+                                          datastruct_depth_stats_t *stats)
+{
+  NOT_USED(c_);
+  NOT_USED(stats);
+
+  return error_NOT_IMPLEMENTED;
+}
+
+typedef struct container_cache__show_args
+{
+  const container_cache_t *c;
+  FILE                    *f;
+}
+container_cache__show_args_t;
+
+static error container_cache__show_item(const item_t *item, void *opaque)
+{
+  const container_cache__show_args_t *args = opaque;
+  const container_cache_t            *c    = args->c;
+  const char                         *key;
+  const char                         *value;
+
+  key   = c->show_key   && item->key   ? c->show_key(item->key)     : NULL;
+  value = c->show_value && item->value ? c->show_value(item->value) : NULL;
+
+  (void) fprintf(args->f, "cache: %s -> %s\n",
+                 key   ? key   : "(null)",
+                 value ? value : "(null)");
+
+  if (c->show_key_destroy   && key)   c->show_key_destroy((char *) key);
+  if (c->show_value_destroy && value) c->show_value_destroy((char *) value);
+
+  return error_OK;
+}
+
+static error container_cache__show(const icontainer_t *c_, FILE *f)
+{
+  container_cache__show_args_t args;
+
+  args.c = (container_cache_t *) c_;
+  args.f = f;
+
+  return cache_walk(args.c->t, container_cache__show_item, &args);
+}
+
+static error container_cache__show_viz(const icontainer_t *c_, FILE *f)
+{
+  NOT_USED(c_);
+  NOT_USED(f);
+
+  return error_NOT_IMPLEMENTED;
+}
+
+static void container_cache__destroy(icontainer_t *doomed_)
+{
+  container_cache_t *doomed = (container_cache_t *) doomed_;
+
+  cache_destroy(doomed->t);
+  free(doomed);
+}
+
+error container_create_cache(icontainer_t            **container,
+                             cache_policy_t            policy,
+                             int                       max_entries,
+                             const icontainer_key_t   *key,
+                             const icontainer_value_t *value)
+{
+  static const icontainer_t methods =
+  {
+    container_cache__lookup,
+    container_cache__insert,
+    container_cache__remove,
+    container_cache__lookup_n,
+    container_cache__insert_n,
+    container_cache__remove_n,
+    container_cache__select,
+    container_cache__lookup_prefix,
+    container_cache__lookup_prefix_n,
+    container_cache__count,
+    container_cache__stats,
+    container_cache__instrument,
+    container_cache__depth_stats,
+    container_cache__show,
+    container_cache__show_viz,
+    container_cache__destroy,
+    1, /* lookups_modify: lookups record uses */
+  };
+
+  error              err;
+  container_cache_t *c;
+
+  assert(container);
+  assert(max_entries > 0);
+  assert(key);
+  assert(value);
+
+  *container = NULL;
+
+  /* ensure required callbacks are specified */
+
+  if (key->len == NULL)
+    return error_KEYLEN_REQUIRED;
+  if (key->compare == NULL)
+    return error_KEYCOMPARE_REQUIRED;
+  if (key->hash == NULL)
+    return error_KEYHASH_REQIURED;
+
+  c = malloc(sizeof(*c));
+  if (c == NULL)
+    return error_OOM;
+
+  c->c                  = methods;
+
+  c->len                = key->len;
+
+  c->show_key           = key->kv.show;
+  c->show_key_destroy   = key->kv.show_destroy;
+  c->show_value         = value->kv.show;
+  c->show_value_destroy = value->kv.show_destroy;
+
+  err = cache_create(policy,
+                     max_entries,
+                     NULL, /* every entry costs one */
+                     value->default_value,
+                     key->hash,
+                     key->compare,
+                     key->kv.destroy,
+                     value->kv.destroy,
+                     &c->t);
+  if (err)
+  {
+    free(c);
+    return err;
+  }
+
+  *container = &c->c;
+
+  return error_OK;
+}
@@ -9,8 +9,10 @@
 
 #include "base/memento/memento.h"
 #include "base/errors.h"
+#include "base/types.h"
 #include "datastruct/dstree.h"
 #include "container/interface/container.h"
+#include "container/interface/stats.h"
 
 #include "container/dstree.h"
 
@@ -28,12 +30,31 @@ typedef struct container_dstree
 }
 container_dstree_t;
 
+static const void *container_dstree__lookup_n(const icontainer_t *c_,
+                                              const void         *key,
+                                              size_t              keylen)
+{
+  const container_dstree_t *c = (container_dstree_t *) c_;
+
+  return dstree_lookup(c->t, key, keylen);
+}
+
 static const void *container_dstree__lookup(const icontainer_t *c_,
                                             const void         *key)
 {
   const container_dstree_t *c = (container_dstree_t *) c_;
 
-  return dstree_lookup(c->t, key, c->len(key));
+  return container_dstree__lookup_n(c_, key, c->len(key));
+}
+
+static error container_dstree__insert_n(icontainer_t *c_,
+                                        const void   *key,
+                                        size_t        keylen,
+                                        const void   *value)
+{
+  container_dstree_t *c = (container_dstree_t *) c_;
+
+  return dstree_insert(c->t, key, keylen, value);
 }
 
 static error container_dstree__insert(icontainer_t *c_,
@@ -42,14 +63,23 @@ static error container_dstree__insert(icontainer_t *c_,
 {
   container_dstree_t *c = (container_dstree_t *) c_;
 
-  return dstree_insert(c->t, key, c->len(key), value);
+  return container_dstree__insert_n(c_, key, c->len(key), value);
+}
+
+static void container_dstree__remove_n(icontainer_t *c_,
+                                       const void   *key,
+                                       size_t        keylen)
+{
+  container_dstree_t *c = (container_dstree_t *) c_;
+
+  dstree_remove(c->t, key, keylen);
 }
 
 static void container_dstree__remove(icontainer_t *c_, const void *key)
 {
   container_dstree_t *c = (container_dstree_t *) c_;
 
-  dstree_remove(c->t, key, c->len(key));
+  container_dstree__remove_n(c_, key, c->len(key));
 }
 
 static const item_t *container_dstree__select(const icontainer_t *c_, int k)
@@ -59,10 +89,11 @@ static const item_t *container_dstree__select(const icontainer_t *c_, int k)
   return dstree_select(c->t, k);
 }
 
-static error container_dstree__lookup_prefix(const icontainer_t        *c_,
-                                             const void                *prefix,
-                                             icontainer_found_callback  cb,
-                                             void                      *opaque)
+static error container_dstree__lookup_prefix_n(const icontainer_t        *c_,
+                                               const void                *prefix,
+                                               size_t                     prefixlen,
+                                               icontainer_found_callback  cb,
+                                               void                      *opaque)
 {
   const container_dstree_t *c = (container_dstree_t *) c_;
 
@@ -72,10 +103,21 @@ static error container_dstree__lookup_prefix(const icontainer_t        *c_,
    * another. */
 
   return dstree_lookup_prefix(c->t,
-                              prefix, c->len(prefix),
+                              prefix, prefixlen,
                               (icontainer_found_callback) cb, opaque);
 }
 
+static error container_dstree__lookup_prefix(const icontainer_t        *c_,
+                                             const void                *prefix,
+                                             icontainer_found_callback  cb,
+                                             void                      *opaque)
+{
+  const container_dstree_t *c = (container_dstree_t *) c_;
+
+  return container_dstree__lookup_prefix_n(c_, prefix, c->len(prefix),
+                                           cb, opaque);
+}
+
 static int container_dstree__count(const icontainer_t *c_)
 {
   const container_dstree_t *c = (container_dstree_t *) c_;
@@ -83,6 +125,47 @@ static int container_dstree__count(const icontainer_t *c_)
   return dstree_count(c->t);
 }
 
+static error container_dstree__stats_kv(const item_t *item,
+                                        int           level,
+                                        void         *opaque)
+{
+  NOT_USED(level);
+
+  icontainer_kv_stats_add(opaque, item->key, item->value);
+
+  return error_OK;
+}
+
+static void container_dstree__stats(const icontainer_t *c_,
+                                    icontainer_kv_len   key_len,
+                                    icontainer_kv_len   value_len,
+                                    datastruct_stats_t *stats)
+{
+  const container_dstree_t *c = (container_dstree_t *) c_;
+  icontainer_kv_stats_t    kvs;
+
+  dstree_stats(c->t, stats);
+
+  if (icontainer_kv_stats_init(&kvs, sizeof(*c), key_len, value_len, stats))
+    (void) dstree_walk(c->t, container_dstree__stats_kv, &kvs);
+}
+
+static error container_dstree__instrument(const icontainer_t      *c_,
+                                          datastruct_instrument_t *counts)
+{
+  const container_dstree_t *c = (container_dstree_t *) c_;
+
+  return dstree_instrument(c->t, counts);
+}
+
+static error container_dstree__depth_stats(const icontainer_t       *c_,
+                                           datastruct_depth_stats_t *stats)
+{
+  const container_dstree_t *c = (container_dstree_t *) c_;
+
+  return dstree_depth_stats(c->t, stats);
+}
+
 static error container_dstree__show(const icontainer_t *c_, FILE *f)
 {
   container_dstree_t *c = (container_dstree_t *) c_;
@@ -120,12 +203,20 @@ error container_create_dstree(icontainer_t            **container,
     container_dstree__lookup,
     container_dstree__insert,
     container_dstree__remove,
+    container_dstree__lookup_n,
+    container_dstree__insert_n,
+    container_dstree__remove_n,
     container_dstree__select,
     container_dstree__lookup_prefix,
+    container_dstree__lookup_prefix_n,
     container_dstree__count,
+    container_dstree__stats,
+    container_dstree__instrument,
+    container_dstree__depth_stats,
     container_dstree__show,
     container_dstree__show_viz,
     container_dstree__destroy,
+    0, /* lookups_modify */
   };
 
   error               err;
@@ -0,0 +1,410 @@
+/* --------------------------------------------------------------------------
+ *    Name: filtered.c
+ * Purpose: Glue to front a container with a membership filter
+ * ----------------------------------------------------------------------- */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "base/memento/memento.h"
+#include "base/errors.h"
+#include "base/types.h"
+#include "datastruct/filter.h"
+#include "container/interface/container.h"
+
+#include "container/filtered.h"
+
+typedef struct container_filtered
+{
+  icontainer_t        c;
+  icontainer_t       *inner;
+
+  container_filter_t  filter;
+  icontainer_key_len  len;
+  icontainer_hash     hash;
+  const void         *default_value;
+
+  filter_bloom_t     *bloom;      /* BLOOM only */
+
+  /* XOR only */
+  filter_xor_t       *xor;        /* NULL until built, or if it couldn't be */
+  int                 stale;      /* keys have changed since 'xor' was built */
+  unsigned int       *hashes;     /* of every key, in no order */
+  int                 nhashes;
+  int                 maxhashes;
+}
+container_filtered_t;
+
+/* ----------------------------------------------------------------------- */
+
+/* Widen a key's hash to the 64 well-mixed bits the filters want. The
+ * SplitMix64 finaliser. */
+static uint64_t container_filtered__widen(unsigned int h32)
+{
+  uint64_t h = h32 + 0x9e3779b97f4a7c15ull;
+
+  h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+  h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+
+  return h ^ (h >> 31);
+}
+
+/* Build the XOR filter from the hashes of the current keys. On failure
+ * lookups just go unfiltered. */
+static void container_filtered__freeze(container_filtered_t *c)
+{
+  uint64_t *wide;
+  int       i;
+
+  filter_xor_destroy(c->xor);
+  c->xor   = NULL;
+  c->stale = 0;
+
+  wide = malloc((c->nhashes ? c->nhashes : 1) * sizeof(*wide));
+  if (wide == NULL)
+    return;
+
+  for (i = 0; i < c->nhashes; i++)
+    wide[i] = container_filtered__widen(c->hashes[i]);
+
+  if (filter_xor_create(wide, c->nhashes, &c->xor))
+    c->xor = NULL;
+
+  free(wide);
+}
+
+/* ----------------------------------------------------------------------- */
+
+/* Returns non-zero if the filter rules out 'key'. */
+static int container_filtered__absent(const icontainer_t *c_,
+                                      const void         *key)
+{
+  container_filtered_t *c = (container_filtered_t *) c_; /* casts away const */
+  uint64_t              h;
+
+  h = container_filtered__widen(c->hash(key));
+
+  if (c->filter == container_FILTER_BLOOM)
+    return !filter_bloom_contains(c->bloom, h);
+
+  if (c->stale)
+    container_filtered__freeze(c);
+
+  return c->xor && !filter_xor_contains(c->xor, h);
+}
+
+static const void *container_filtered__lookup(const icontainer_t *c_,
+                                              const void         *key)
+{
+  const container_filtered_t *c = (container_filtered_t *) c_;
+
+  if (container_filtered__absent(c_, key))
+    return c->default_value;
+
+  return c->inner->lookup(c->inner, key);
+}
+
+static const void *container_filtered__lookup_n(const icontainer_t *c_,
+                                                const void         *key,
+                                                size_t              keylen)
+{
+  const container_filtered_t *c = (container_filtered_t *) c_;
+
+  if (container_filtered__absent(c_, key))
+    return c->default_value;
+
+  return c->inner->lookup_n(c->inner, key, keylen);
+}
+
+static error container_filtered__insert_n(icontainer_t *c_,
+                                          const void   *key,
+                                          size_t        keylen,
+                                          const void   *value)
+{
+  container_filtered_t *c = (container_filtered_t *) c_;
+  unsigned int          h;
+  int                   count;
+  error                 err;
+
+  /* hash first: the inner container may destroy the key */
+  h     = c->hash(key);
+  count = c->inner->count(c->inner);
+
+  if (c->filter == container_FILTER_XOR && c->nhashes == c->maxhashes)
+  {
+    int           maxhashes;
+    unsigned int *hashes;
+
+    maxhashes = c->maxhashes ? c->maxhashes * 2 : 16;
+    hashes = realloc(c->hashes, maxhashes * sizeof(*hashes));
+    if (hashes == NULL)
+      return error_OOM;
+
+    c->hashes    = hashes;
+    c->maxhashes = maxhashes;
+  }
+
+  err = c->inner->insert_n(c->inner, key, keylen, value);
+  if (err)
+    return err;
+
+  if (c->filter == container_FILTER_BLOOM)
+  {
+    filter_bloom_add(c->bloom, container_filtered__widen(h));
+  }
+  else if (c->inner->count(c->inner) > count) /* not an update */
+  {
+    c->hashes[c->nhashes++] = h;
+    c->stale = 1;
+  }
+
+  return error_OK;
+}
+
+static error container_filtered__insert(icontainer_t *c_,
+                                        const void   *key,
+                                        const void   *value)
+{
+  container_filtered_t *c = (container_filtered_t *) c_;
+
+  return container_filtered__insert_n(c_, key, c->len(key), value);
+}
+
+static void container_filtered__remove_n(icontainer_t *c_,
+                                         const void   *key,
+                                         size_t        keylen)
+{
+  container_filtered_t *c = (container_filtered_t *) c_;
+  unsigned int          h;
+  int                   count;
+  int                   i;
+
+  h     = c->hash(key);
+  count = c->inner->count(c->inner);
+
+  c->inner->remove_n(c->inner, key, keylen);
+
+  if (c->inner->count(c->inner) == count)
+    return; /* it wasn't there */
+
+  if (c->filter == container_FILTER_BLOOM)
+  {
+    /* a Bloom filter can't forget one key, but it can forget all of them */
+    if (count == 1)
+      filter_bloom_clear(c->bloom);
+  }
+  else
+  {
+    /* forget one copy of its hash: others may belong to other keys */
+    for (i = 0; i < c->nhashes; i++)
+      if (c->hashes[i] == h)
+      {
+        c->hashes[i] = c->hashes[--c->nhashes];
+        break;
+      }
+
+    c->stale = 1;
+  }
+}
+
+static void container_filtered__remove(icontainer_t *c_, const void *key)
+{
+  container_filtered_t *c = (container_filtered_t *) c_;
+
+  container_filtered__remove_n(c_, key, c->len(key));
+}
+
+static const item_t *container_filtered__select(const icontainer_t *c_,
+                                                int                 k)
+{
+  const container_filtered_t *c = (container_filtered_t *) c_;
+
+  return c->inner->select(c->inner, k);
+}
+
+static error container_filtered__lookup_prefix(const icontainer_t        *c_,
+                                               const void                *prefix,
+                                               icontainer_found_callback  cb,
+                                               void                      *opaque)
+{
+  const container_filtered_t *c = (container_filtered_t *) c_;
+
+  return c->inner->lookup_prefix(c->inner, prefix, cb, opaque);
+}
+
+static error container_filtered__lookup_prefix_n(const icontainer_t        *c_,
+                                                 const void                *prefix,
+                                                 size_t                     prefixlen,
+                                                 icontainer_found_callback  cb,
+                                                 void                      *opaque)
+{
+  const container_filtered_t *c = (container_filtered_t *) c_;
+
+  return c->inner->lookup_prefix_n(c->inner, prefix, prefixlen, cb, opaque);
+}
+
+static int container_filtered__count(const icontainer_t *c_)
+{
+  const container_filtered_t *c = (container_filtered_t *) c_;
+
+  return c->inner->count(c->inner);
+}
+
+static void container_filtered__stats(const icontainer_t *c_,
+                                      icontainer_kv_len   key_len,
+                                      icontainer_kv_len   value_len,
+                                      datastruct_stats_t *stats)
+{
+  const container_filtered_t *c = (container_filtered_t *) c_;
+  datastruct_stats_t          filter;
+  size_t                      bytes;
+
+  c->inner->stats(c->inner, key_len, value_len, stats);
+
+  if (c->bloom)
+    filter_bloom_stats(c->bloom, &filter);
+  else if (c->xor)
+    filter_xor_stats(c->xor, &filter);
+  else
+    filter.total_bytes = 0;
+
+  bytes = sizeof(*c) + c->maxhashes * sizeof(*c->hashes) + filter.total_bytes;
+
+  stats->other_bytes += bytes;
+  stats->total_bytes += bytes;
+}
+
+static error container_filtered__instrument(const icontainer_t      *c_,
+                                            datastruct_instrument_t *counts)
+{
+  const container_filtered_t *c = (container_filtered_t *) c_;
+
+  return c->inner->instrument(c->inner, counts);
+}
+
+static error container_filtered__depth_stats(const icontainer_t       *c_,
+                                             datastruct_depth_stats_t *stats)
+{
+  const container_filtered_t *c = (container_filtered_t *) c_;
+
+  return c->inner->depth_stats(c->inner, stats);
+}
+
+static error container_filtered__show(const icontainer_t *c_, FILE *f)
+{
+  const container_filtered_t *c = (container_filtered_t *) c_;
+
+  return c->inner->show(c->inner, f);
+}
+
+static error container_filtered__show_viz(const icontainer_t *c_, FILE *f)
+{
+  const container_filtered_t *c = (container_filtered_t *) c_;
+
+  return c->inner->show_viz(c->inner, f);
+}
+
+static void container_filtered__destroy(icontainer_t *doomed_)
+{
+  container_filtered_t *doomed = (container_filtered_t *) doomed_;
+
+  if (doomed->inner)
+    doomed->inner->destroy(doomed->inner);
+  filter_bloom_destroy(doomed->bloom);
+  filter_xor_destroy(doomed->xor);
+  free(doomed->hashes);
+  free(doomed);
+}
+
+error container_create_filtered(icontainer_t            **container,
+                                icontainer_maker         *maker,
+                                container_filter_t        filter,
+                                int                       capacity,
+                                const icontainer_key_t   *key,
+                                const icontainer_value_t *value)
+{
+  static const icontainer_t methods =
+  {
+    container_filtered__lookup,
+    container_filtered__insert,
+    container_filtered__remove,
+    container_filtered__lookup_n,
+    container_filtered__insert_n,
+    container_filtered__remove_n,
+    container_filtered__select,
+    container_filtered__lookup_prefix,
+    container_filtered__lookup_prefix_n,
+    container_filtered__count,
+    container_filtered__stats,
+    container_filtered__instrument,
+    container_filtered__depth_stats,
+    container_filtered__show,
+    container_filtered__show_viz,
+    container_filtered__destroy,
+    0, /* lookups_modify */
+  };
+
+  error                 err;
+  container_filtered_t *c;
+
+  assert(container);
+  assert(maker);
+  assert(key);
+  assert(value);
+
+  *container = NULL;
+
+  /* ensure required callbacks are specified */
+
+  if (key->len == NULL)
+    return error_KEYLEN_REQUIRED;
+  if (key->hash == NULL)
+    return error_KEYHASH_REQIURED;
+
+  c = calloc(1, sizeof(*c));
+  if (c == NULL)
+    return error_OOM;
+
+  c->c             = methods;
+
+  c->filter        = filter;
+  c->len           = key->len;
+  c->hash          = key->hash;
+  c->default_value = value->default_value;
+
+  if (filter == container_FILTER_BLOOM)
+  {
+    err = filter_bloom_create(capacity, &c->bloom);
+  }
+  else
+  {
+    /* the filter is built on the first lookup, but the hashes can be
+     * sized ahead */
+    err = error_OK;
+    if (capacity > 0)
+    {
+      c->hashes = malloc(capacity * sizeof(*c->hashes));
+      if (c->hashes == NULL)
+        err = error_OOM;
+      else
+        c->maxhashes = capacity;
+    }
+  }
+  if (!err)
+    err = maker(&c->inner, key, value);
+  if (err)
+  {
+    container_filtered__destroy(&c->c);
+    return err;
+  }
+
+  /* an XOR filter is built by the first lookup after a change */
+  c->c.lookups_modify = (filter == container_FILTER_XOR) ||
+                        c->inner->lookups_modify;
+
+  *container = &c->c;
+
+  return error_OK;
+}
@@ -12,6 +12,7 @@
 #include "base/types.h"
 #include "datastruct/hash.h"
 #include "container/interface/container.h"
+#include "container/interface/stats.h"
 
 #include "container/hash.h"
 
@@ -21,6 +22,7 @@ typedef struct container_hash
   hash_t                    *t;
 
   icontainer_key_len         len;
+  icontainer_kv_destroy      destroy_key; /* set if keys are inline */
 
   icontainer_kv_show         show_key;
   icontainer_kv_show_destroy show_key_destroy;
@@ -37,13 +39,40 @@ static const void *container_hash__lookup(const icontainer_t *c_,
   return hash_lookup(c->t, key);
 }
 
+static const void *container_hash__lookup_n(const icontainer_t *c_,
+                                            const void         *key,
+                                            size_t              keylen)
+{
+  NOT_USED(keylen);
+
+  return container_hash__lookup(c_, key);
+}
+
+static error container_hash__insert_n(icontainer_t *c_,
+                                      const void   *key,
+                                      size_t        keylen,
+                                      const void   *value)
+{
+  container_hash_t *c = (container_hash_t *) c_;
+  error            err;
+
+  err = hash_insert(c->t, key, keylen, value);
+
+  /* containers own the keys they're given but an inline key has been
+   * copied, so the original is no longer needed */
+  if (err == error_OK && c->destroy_key)
+    c->destroy_key((void *) key); /* must cast away const */
+
+  return err;
+}
+
 static error container_hash__insert(icontainer_t *c_,
                                     const void   *key,
                                     const void   *value)
 {
   container_hash_t *c = (container_hash_t *) c_;
 
-  return hash_insert(c->t, key, c->len(key), value);
+  return container_hash__insert_n(c_, key, c->len(key), value);
 }
 
 static void container_hash__remove(icontainer_t *c_, const void *key)
@@ -53,6 +82,15 @@ static void container_hash__remove(icontainer_t *c_, const void *key)
   hash_remove(c->t, key);
 }
 
+static void container_hash__remove_n(icontainer_t *c_,
+                                     const void   *key,
+                                     size_t        keylen)
+{
+  NOT_USED(keylen);
+
+  container_hash__remove(c_, key);
+}
+
 static const item_t *container_hash__select(const icontainer_t *c_, int k)
 {
   NOT_USED(c_);
@@ -61,17 +99,31 @@ static const item_t *container_hash__select(const icontainer_t *c_, int k)
   return NULL; /* not implemented */
 }
 
+static error container_hash__lookup_prefix_n(const icontainer_t        *c_,
+                                             const void                *prefix,
+                                             size_t                     prefixlen,
+                                             icontainer_found_callback  cb,
+                                             void                      *opaque)
+{
+  container_hash_t *c = (container_hash_t *) c_;
+
+  /* hash_found_callback and icontainer_found_callback have the same
+   * signature so we can just cast one to the other here. */
+
+  return hash_lookup_prefix(c->t,
+                            prefix, prefixlen,
+                            (hash_found_callback *) cb, opaque);
+}
+
 static error container_hash__lookup_prefix(const icontainer_t        *c_,
                                            const void                *prefix,
                                            icontainer_found_callback  cb,
                                            void                      *opaque)
 {
-  NOT_USED(c_);
-  NOT_USED(prefix);
-  NOT_USED(cb);
-  NOT_USED(opaque);
-  
-  return error_NOT_IMPLEMENTED;
+  container_hash_t *c = (container_hash_t *) c_;
+
+  return container_hash__lookup_prefix_n(c_, prefix, c->len(prefix),
+                                         cb, opaque);
 }
 
 static int container_hash__count(const icontainer_t *c_)
@@ -81,6 +133,43 @@ static int container_hash__count(const icontainer_t *c_)
   return hash_count(c->t);
 }
 
+static error container_hash__stats_kv(const item_t *item, void *opaque)
+{
+  icontainer_kv_stats_add(opaque, item->key, item->value);
+
+  return error_OK;
+}
+
+static void container_hash__stats(const icontainer_t *c_,
+                                  icontainer_kv_len   key_len,
+                                  icontainer_kv_len   value_len,
+                                  datastruct_stats_t *stats)
+{
+  const container_hash_t *c = (container_hash_t *) c_;
+  icontainer_kv_stats_t  kvs;
+
+  hash_stats(c->t, stats);
+
+  if (icontainer_kv_stats_init(&kvs, sizeof(*c), key_len, value_len, stats))
+    (void) hash_walk(c->t, container_hash__stats_kv, &kvs);
+}
+
+static error container_hash__instrument(const icontainer_t      *c_,
+                                        datastruct_instrument_t *counts)
+{
+  const container_hash_t *c = (container_hash_t *) c_;
+
+  return hash_instrument(c->t, counts);
+}
+
+static error container_hash__depth_stats(const icontainer_t       *c_,
+                                         datastruct_depth_stats_t *stats)
+{
+  const container_hash_t *c = (container_hash_t *) c_;
+
+  return hash_depth_stats(c->t, stats);
+}
+
 static error container_hash__show(const icontainer_t *c_, FILE *f)
 {
   container_hash_t *c = (container_hash_t *) c_;
@@ -107,21 +196,30 @@ static void container_hash__destroy(icontainer_t *doomed_)
   free(doomed);
 }
 
-error container_create_hash(icontainer_t            **container,
-                            const icontainer_key_t   *key,
-                            const icontainer_value_t *value)
+static error container_hash__create(icontainer_t            **container,
+                                    const icontainer_key_t   *key,
+                                    const icontainer_value_t *value,
+                                    int                       inline_keys)
 {
   static const icontainer_t methods =
   {
     container_hash__lookup,
     container_hash__insert,
     container_hash__remove,
+    container_hash__lookup_n,
+    container_hash__insert_n,
+    container_hash__remove_n,
     container_hash__select,
     container_hash__lookup_prefix,
+    container_hash__lookup_prefix_n,
     container_hash__count,
+    container_hash__stats,
+    container_hash__instrument,
+    container_hash__depth_stats,
     container_hash__show,
     container_hash__show_viz,
     container_hash__destroy,
+    0, /* lookups_modify */
   };
 
   error             err;
@@ -149,6 +247,7 @@ error container_create_hash(icontainer_t            **container,
   c->c                  = methods;
 
   c->len                = key->len;
+  c->destroy_key        = NULL;
 
   c->show_key           = key->kv.show;
   c->show_key_destroy   = key->kv.show_destroy;
@@ -168,7 +267,27 @@ error container_create_hash(icontainer_t            **container,
     return err;
   }
 
+  if (inline_keys)
+  {
+    hash_set_inline_keys(c->t);
+    c->destroy_key = key->kv.destroy;
+  }
+
   *container = &c->c;
 
   return error_OK;
 }
+
+error container_create_hash(icontainer_t            **container,
+                            const icontainer_key_t   *key,
+                            const icontainer_value_t *value)
+{
+  return container_hash__create(container, key, value, 0);
+}
+
+error container_create_hash_inline_keys(icontainer_t            **container,
+                                        const icontainer_key_t   *key,
+                                        const icontainer_value_t *value)
+{
+  return container_hash__create(container, key, value, 1);
+}
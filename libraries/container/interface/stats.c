@@ -0,0 +1,46 @@
+/* --------------------------------------------------------------------------
+ *    Name: stats.c
+ * Purpose: Helpers for container memory statistics
+ * ----------------------------------------------------------------------- */
+
+#include <stddef.h>
+
+#include "container/interface/stats.h"
+
+int icontainer_kv_stats_init(icontainer_kv_stats_t *kvs,
+                             size_t                 size,
+                             icontainer_kv_len      key_len,
+                             icontainer_kv_len      value_len,
+                             datastruct_stats_t    *stats)
+{
+  stats->other_bytes += size;
+  stats->total_bytes += size;
+
+  kvs->key_len   = key_len;
+  kvs->value_len = value_len;
+  kvs->stats     = stats;
+
+  return key_len != NULL || value_len != NULL;
+}
+
+void icontainer_kv_stats_add(icontainer_kv_stats_t *kvs,
+                             const void            *key,
+                             const void            *value)
+{
+  datastruct_stats_t *stats = kvs->stats;
+  size_t              bytes;
+
+  if (kvs->key_len)
+  {
+    bytes = kvs->key_len(key);
+    stats->key_bytes   += bytes;
+    stats->total_bytes += bytes;
+  }
+
+  if (kvs->value_len && value)
+  {
+    bytes = kvs->value_len(value);
+    stats->value_bytes += bytes;
+    stats->total_bytes += bytes;
+  }
+}
@@ -11,6 +11,7 @@
 #include "base/errors.h"
 #include "base/types.h"
 #include "container/interface/container.h"
+#include "container/interface/stats.h"
 #include "datastruct/linkedlist.h"
 
 #include "container/linkedlist.h"
@@ -29,12 +30,31 @@ typedef struct container_linkedlist
 }
 container_linkedlist_t;
 
+static const void *container_linkedlist__lookup_n(const icontainer_t *c_,
+                                                  const void         *key,
+                                                  size_t              keylen)
+{
+  const container_linkedlist_t *c = (container_linkedlist_t *) c_;
+
+  return linkedlist_lookup(c->t, key, keylen);
+}
+
 static const void *container_linkedlist__lookup(const icontainer_t *c_,
                                                 const void         *key)
 {
   const container_linkedlist_t *c = (container_linkedlist_t *) c_;
 
-  return linkedlist_lookup(c->t, key, c->len(key));
+  return container_linkedlist__lookup_n(c_, key, c->len(key));
+}
+
+static error container_linkedlist__insert_n(icontainer_t *c_,
+                                            const void   *key,
+                                            size_t        keylen,
+                                            const void   *value)
+{
+  container_linkedlist_t *c = (container_linkedlist_t *) c_;
+
+  return linkedlist_insert(c->t, key, keylen, value);
 }
 
 static error container_linkedlist__insert(icontainer_t *c_,
@@ -43,14 +63,23 @@ static error container_linkedlist__insert(icontainer_t *c_,
 {
   container_linkedlist_t *c = (container_linkedlist_t *) c_;
 
-  return linkedlist_insert(c->t, key, c->len(key), value);
+  return container_linkedlist__insert_n(c_, key, c->len(key), value);
+}
+
+static void container_linkedlist__remove_n(icontainer_t *c_,
+                                           const void   *key,
+                                           size_t        keylen)
+{
+  container_linkedlist_t *c = (container_linkedlist_t *) c_;
+
+  linkedlist_remove(c->t, key, keylen);
 }
 
 static void container_linkedlist__remove(icontainer_t *c_, const void *key)
 {
   container_linkedlist_t *c = (container_linkedlist_t *) c_;
 
-  linkedlist_remove(c->t, key, c->len(key));
+  container_linkedlist__remove_n(c_, key, c->len(key));
 }
 
 static const item_t *container_linkedlist__select(const icontainer_t *c_,
@@ -61,10 +90,11 @@ static const item_t *container_linkedlist__select(const icontainer_t *c_,
   return linkedlist_select(c->t, k);
 }
 
-static error container_linkedlist__lookup_prefix(const icontainer_t        *c_,
-                                                 const void                *prefix,
-                                                 icontainer_found_callback  cb,
-                                                 void                      *opaque)
+static error container_linkedlist__lookup_prefix_n(const icontainer_t        *c_,
+                                                   const void                *prefix,
+                                                   size_t                     prefixlen,
+                                                   icontainer_found_callback  cb,
+                                                   void                      *opaque)
 {
   const container_linkedlist_t *c = (container_linkedlist_t *) c_;
 
@@ -74,10 +104,21 @@ static error container_linkedlist__lookup_prefix(const icontainer_t        *c_,
    * another. */
 
   return linkedlist_lookup_prefix(c->t,
-                                  prefix, c->len(prefix),
+                                  prefix, prefixlen,
                                   (icontainer_found_callback) cb, opaque);
 }
 
+static error container_linkedlist__lookup_prefix(const icontainer_t        *c_,
+                                                 const void                *prefix,
+                                                 icontainer_found_callback  cb,
+                                                 void                      *opaque)
+{
+  const container_linkedlist_t *c = (container_linkedlist_t *) c_;
+
+  return container_linkedlist__lookup_prefix_n(c_, prefix, c->len(prefix),
+                                               cb, opaque);
+}
+
 static int container_linkedlist__count(const icontainer_t *c_)
 {
   container_linkedlist_t *c = (container_linkedlist_t *) c_;
@@ -85,6 +126,44 @@ static int container_linkedlist__count(const icontainer_t *c_)
   return linkedlist_count(c->t);
 }
 
+static error container_linkedlist__stats_kv(const item_t *item, void *opaque)
+{
+  icontainer_kv_stats_add(opaque, item->key, item->value);
+
+  return error_OK;
+}
+
+static void container_linkedlist__stats(const icontainer_t *c_,
+                                        icontainer_kv_len   key_len,
+                                        icontainer_kv_len   value_len,
+                                        datastruct_stats_t *stats)
+{
+  const container_linkedlist_t *c = (container_linkedlist_t *) c_;
+  icontainer_kv_stats_t        kvs;
+
+  linkedlist_stats(c->t, stats);
+
+  if (icontainer_kv_stats_init(&kvs, sizeof(*c), key_len, value_len, stats))
+    (void) linkedlist_walk(c->t, container_linkedlist__stats_kv, &kvs);
+}
+
+static error container_linkedlist__instrument(const icontainer_t      *c_,
+                                              datastruct_instrument_t *counts)
+{
+  const container_linkedlist_t *c = (container_linkedlist_t *) c_;
+
+  return linkedlist_instrument(c->t, counts);
+}
+
+static error container_linkedlist__depth_stats(const icontainer_t       *c_,
+                                               datastruct_depth_stats_t *stats)
+{
+  NOT_USED(c_);
+  NOT_USED(stats);
+
+  return error_NOT_IMPLEMENTED;
+}
+
 static error container_linkedlist__show(const icontainer_t *c_, FILE *f)
 {
   container_linkedlist_t *c = (container_linkedlist_t *) c_;
@@ -120,12 +199,20 @@ error container_create_linkedlist(icontainer_t            **container,
     container_linkedlist__lookup,
     container_linkedlist__insert,
     container_linkedlist__remove,
+    container_linkedlist__lookup_n,
+    container_linkedlist__insert_n,
+    container_linkedlist__remove_n,
     container_linkedlist__select,
     container_linkedlist__lookup_prefix,
+    container_linkedlist__lookup_prefix_n,
     container_linkedlist__count,
+    container_linkedlist__stats,
+    container_linkedlist__instrument,
+    container_linkedlist__depth_stats,
     container_linkedlist__show,
     container_linkedlist__show_viz,
     container_linkedlist__destroy,
+    0, /* lookups_modify */
   };
 
   error                   err;
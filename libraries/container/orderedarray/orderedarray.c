@@ -12,6 +12,7 @@
 #include "base/types.h"
 #include "datastruct/orderedarray.h"
 #include "container/interface/container.h"
+#include "container/interface/stats.h"
 
 #include "container/orderedarray.h"
 
@@ -37,13 +38,32 @@ static const void *container_orderedarray__lookup(const icontainer_t *c_,
   return orderedarray_lookup(c->t, key);
 }
 
+static const void *container_orderedarray__lookup_n(const icontainer_t *c_,
+                                                    const void         *key,
+                                                    size_t              keylen)
+{
+  NOT_USED(keylen);
+
+  return container_orderedarray__lookup(c_, key);
+}
+
+static error container_orderedarray__insert_n(icontainer_t *c_,
+                                              const void   *key,
+                                              size_t        keylen,
+                                              const void   *value)
+{
+  container_orderedarray_t *c = (container_orderedarray_t *) c_;
+
+  return orderedarray_insert(c->t, key, keylen, value);
+}
+
 static error container_orderedarray__insert(icontainer_t *c_,
                                             const void   *key,
                                             const void   *value)
 {
   container_orderedarray_t *c = (container_orderedarray_t *) c_;
 
-  return orderedarray_insert(c->t, key, c->len(key), value);
+  return container_orderedarray__insert_n(c_, key, c->len(key), value);
 }
 
 static void container_orderedarray__remove(icontainer_t *c_, const void *key)
@@ -53,6 +73,15 @@ static void container_orderedarray__remove(icontainer_t *c_, const void *key)
   orderedarray_remove(c->t, key);
 }
 
+static void container_orderedarray__remove_n(icontainer_t *c_,
+                                             const void   *key,
+                                             size_t        keylen)
+{
+  NOT_USED(keylen);
+
+  container_orderedarray__remove(c_, key);
+}
+
 static const item_t *container_orderedarray__select(const icontainer_t *c_,
                                                     int                 k)
 {
@@ -61,10 +90,11 @@ static const item_t *container_orderedarray__select(const icontainer_t *c_,
   return orderedarray_select(c->t, k);
 }
 
-static error container_orderedarray__lookup_prefix(const icontainer_t        *c_,
-                                                   const void                *prefix,
-                                                   icontainer_found_callback  cb,
-                                                   void                      *opaque)
+static error container_orderedarray__lookup_prefix_n(const icontainer_t        *c_,
+                                                     const void                *prefix,
+                                                     size_t                     prefixlen,
+                                                     icontainer_found_callback  cb,
+                                                     void                      *opaque)
 {
   const container_orderedarray_t *c = (container_orderedarray_t *) c_;
 
@@ -74,10 +104,21 @@ static error container_orderedarray__lookup_prefix(const icontainer_t        *c_
    * into another. */
 
   return orderedarray_lookup_prefix(c->t,
-                                    prefix, c->len(prefix),
+                                    prefix, prefixlen,
                                     (icontainer_found_callback) cb, opaque);
 }
 
+static error container_orderedarray__lookup_prefix(const icontainer_t        *c_,
+                                                   const void                *prefix,
+                                                   icontainer_found_callback  cb,
+                                                   void                      *opaque)
+{
+  const container_orderedarray_t *c = (container_orderedarray_t *) c_;
+
+  return container_orderedarray__lookup_prefix_n(c_, prefix, c->len(prefix),
+                                                 cb, opaque);
+}
+
 static int container_orderedarray__count(const icontainer_t *c_)
 {
   container_orderedarray_t *c = (container_orderedarray_t *) c_;
@@ -85,6 +126,44 @@ static int container_orderedarray__count(const icontainer_t *c_)
   return orderedarray_count(c->t);
 }
 
+static error container_orderedarray__stats_kv(const item_t *item, void *opaque)
+{
+  icontainer_kv_stats_add(opaque, item->key, item->value);
+
+  return error_OK;
+}
+
+static void container_orderedarray__stats(const icontainer_t *c_,
+                                          icontainer_kv_len   key_len,
+                                          icontainer_kv_len   value_len,
+                                          datastruct_stats_t *stats)
+{
+  const container_orderedarray_t *c = (container_orderedarray_t *) c_;
+  icontainer_kv_stats_t          kvs;
+
+  orderedarray_stats(c->t, stats);
+
+  if (icontainer_kv_stats_init(&kvs, sizeof(*c), key_len, value_len, stats))
+    (void) orderedarray_walk(c->t, container_orderedarray__stats_kv, &kvs);
+}
+
+static error container_orderedarray__instrument(const icontainer_t      *c_,
+                                                datastruct_instrument_t *counts)
+{
+  const container_orderedarray_t *c = (container_orderedarray_t *) c_;
+
+  return orderedarray_instrument(c->t, counts);
+}
+
+static error container_orderedarray__depth_stats(const icontainer_t       *c_,
+                                                 datastruct_depth_stats_t *stats)
+{
+  NOT_USED(c_);
+  NOT_USED(stats);
+
+  return error_NOT_IMPLEMENTED;
+}
+
 static error container_orderedarray__show(const icontainer_t *c_, FILE *f)
 {
   container_orderedarray_t *c = (container_orderedarray_t *) c_;
@@ -120,12 +199,20 @@ error container_create_orderedarray(icontainer_t            **container,
     container_orderedarray__lookup,
     container_orderedarray__insert,
     container_orderedarray__remove,
+    container_orderedarray__lookup_n,
+    container_orderedarray__insert_n,
+    container_orderedarray__remove_n,
     container_orderedarray__select,
     container_orderedarray__lookup_prefix,
+    container_orderedarray__lookup_prefix_n,
     container_orderedarray__count,
+    container_orderedarray__stats,
+    container_orderedarray__instrument,
+    container_orderedarray__depth_stats,
     container_orderedarray__show,
     container_orderedarray__show_viz,
     container_orderedarray__destroy,
+    0, /* lookups_modify */
   };
 
   error                     err;
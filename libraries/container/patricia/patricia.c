@@ -9,8 +9,10 @@
 
 #include "base/memento/memento.h"
 #include "base/errors.h"
+#include "base/types.h"
 #include "datastruct/patricia.h"
 #include "container/interface/container.h"
+#include "container/interface/stats.h"
 
 #include "container/patricia.h"
 
@@ -20,6 +22,7 @@ typedef struct container_patricia
   patricia_t                *t;
 
   icontainer_key_len         len;
+  icontainer_kv_destroy      destroy_key; /* set if keys are inline */
 
   icontainer_kv_show         show_key;
   icontainer_kv_show_destroy show_key_destroy;
@@ -28,12 +31,39 @@ typedef struct container_patricia
 }
 container_patricia_t;
 
+static const void *container_patricia__lookup_n(const icontainer_t *c_,
+                                                const void         *key,
+                                                size_t              keylen)
+{
+  const container_patricia_t *c = (container_patricia_t *) c_;
+
+  return patricia_lookup(c->t, key, keylen);
+}
+
 static const void *container_patricia__lookup(const icontainer_t *c_,
                                               const void         *key)
 {
   const container_patricia_t *c = (container_patricia_t *) c_;
 
-  return patricia_lookup(c->t, key, c->len(key));
+  return container_patricia__lookup_n(c_, key, c->len(key));
+}
+
+static error container_patricia__insert_n(icontainer_t *c_,
+                                          const void   *key,
+                                          size_t        keylen,
+                                          const void   *value)
+{
+  container_patricia_t *c = (container_patricia_t *) c_;
+  error                err;
+
+  err = patricia_insert(c->t, key, keylen, value);
+
+  /* containers own the keys they're given but an inline key has been
+   * copied, so the original is no longer needed */
+  if (err == error_OK && c->destroy_key)
+    c->destroy_key((void *) key); /* must cast away const */
+
+  return err;
 }
 
 static error container_patricia__insert(icontainer_t *c_,
@@ -42,14 +72,23 @@ static error container_patricia__insert(icontainer_t *c_,
 {
   container_patricia_t *c = (container_patricia_t *) c_;
 
-  return patricia_insert(c->t, key, c->len(key), value);
+  return container_patricia__insert_n(c_, key, c->len(key), value);
+}
+
+static void container_patricia__remove_n(icontainer_t *c_,
+                                         const void   *key,
+                                         size_t        keylen)
+{
+  container_patricia_t *c = (container_patricia_t *) c_;
+
+  patricia_remove(c->t, key, keylen);
 }
 
 static void container_patricia__remove(icontainer_t *c_, const void *key)
 {
   container_patricia_t *c = (container_patricia_t *) c_;
 
-  patricia_remove(c->t, key, c->len(key));
+  container_patricia__remove_n(c_, key, c->len(key));
 }
 
 static const item_t *container_patricia__select(const icontainer_t *c_,
@@ -60,10 +99,11 @@ static const item_t *container_patricia__select(const icontainer_t *c_,
   return patricia_select(c->t, k);
 }
 
-static error container_patricia__lookup_prefix(const icontainer_t        *c_,
-                                               const void                *prefix,
-                                               icontainer_found_callback  cb,
-                                               void                      *opaque)
+static error container_patricia__lookup_prefix_n(const icontainer_t        *c_,
+                                                 const void                *prefix,
+                                                 size_t                     prefixlen,
+                                                 icontainer_found_callback  cb,
+                                                 void                      *opaque)
 {
   const container_patricia_t *c = (container_patricia_t *) c_;
 
@@ -73,10 +113,21 @@ static error container_patricia__lookup_prefix(const icontainer_t        *c_,
    * another. */
 
   return patricia_lookup_prefix(c->t,
-                                prefix, c->len(prefix),
+                                prefix, prefixlen,
                                 (icontainer_found_callback) cb, opaque);
 }
 
+static error container_patricia__lookup_prefix(const icontainer_t        *c_,
+                                               const void                *prefix,
+                                               icontainer_found_callback  cb,
+                                               void                      *opaque)
+{
+  const container_patricia_t *c = (container_patricia_t *) c_;
+
+  return container_patricia__lookup_prefix_n(c_, prefix, c->len(prefix),
+                                             cb, opaque);
+}
+
 static int container_patricia__count(const icontainer_t *c_)
 {
   const container_patricia_t *c = (container_patricia_t *) c_;
@@ -84,6 +135,48 @@ static int container_patricia__count(const icontainer_t *c_)
   return patricia_count(c->t);
 }
 
+static error container_patricia__stats_kv(const void *key,
+                                          const void *value,
+                                          int         level,
+                                          void       *opaque)
+{
+  NOT_USED(level);
+
+  icontainer_kv_stats_add(opaque, key, value);
+
+  return error_OK;
+}
+
+static void container_patricia__stats(const icontainer_t *c_,
+                                      icontainer_kv_len   key_len,
+                                      icontainer_kv_len   value_len,
+                                      datastruct_stats_t *stats)
+{
+  const container_patricia_t *c = (container_patricia_t *) c_;
+  icontainer_kv_stats_t      kvs;
+
+  patricia_stats(c->t, stats);
+
+  if (icontainer_kv_stats_init(&kvs, sizeof(*c), key_len, value_len, stats))
+    (void) patricia_walk(c->t, container_patricia__stats_kv, &kvs);
+}
+
+static error container_patricia__instrument(const icontainer_t      *c_,
+                                            datastruct_instrument_t *counts)
+{
+  const container_patricia_t *c = (container_patricia_t *) c_;
+
+  return patricia_instrument(c->t, counts);
+}
+
+static error container_patricia__depth_stats(const icontainer_t       *c_,
+                                             datastruct_depth_stats_t *stats)
+{
+  const container_patricia_t *c = (container_patricia_t *) c_;
+
+  return patricia_depth_stats(c->t, stats);
+}
+
 static error container_patricia__show(const icontainer_t *c_, FILE *f)
 {
   container_patricia_t *c = (container_patricia_t *) c_;
@@ -112,21 +205,30 @@ static void container_patricia__destroy(icontainer_t *doomed_)
   free(doomed);
 }
 
-error container_create_patricia(icontainer_t            **container,
-                                const icontainer_key_t   *key,
-                                const icontainer_value_t *value)
+static error container_patricia__create(icontainer_t            **container,
+                                        const icontainer_key_t   *key,
+                                        const icontainer_value_t *value,
+                                        int                       inline_keys)
 {
   static const icontainer_t methods =
   {
     container_patricia__lookup,
     container_patricia__insert,
     container_patricia__remove,
+    container_patricia__lookup_n,
+    container_patricia__insert_n,
+    container_patricia__remove_n,
     container_patricia__select,
     container_patricia__lookup_prefix,
+    container_patricia__lookup_prefix_n,
     container_patricia__count,
+    container_patricia__stats,
+    container_patricia__instrument,
+    container_patricia__depth_stats,
     container_patricia__show,
     container_patricia__show_viz,
     container_patricia__destroy,
+    0, /* lookups_modify */
   };
 
   error                 err;
@@ -150,6 +252,7 @@ error container_create_patricia(icontainer_t            **container,
   c->c                  = methods;
 
   c->len                = key->len;
+  c->destroy_key        = NULL;
 
   c->show_key           = key->kv.show;
   c->show_key_destroy   = key->kv.show_destroy;
@@ -166,7 +269,27 @@ error container_create_patricia(icontainer_t            **container,
     return err;
   }
 
+  if (inline_keys)
+  {
+    patricia_set_inline_keys(c->t);
+    c->destroy_key = key->kv.destroy;
+  }
+
   *container = &c->c;
 
   return error_OK;
 }
+
+error container_create_patricia(icontainer_t            **container,
+                                const icontainer_key_t   *key,
+                                const icontainer_value_t *value)
+{
+  return container_patricia__create(container, key, value, 0);
+}
+
+error container_create_patricia_inline_keys(icontainer_t            **container,
+                                            const icontainer_key_t   *key,
+                                            const icontainer_value_t *value)
+{
+  return container_patricia__create(container, key, value, 1);
+}
@@ -0,0 +1,637 @@
+/* --------------------------------------------------------------------------
+ *    Name: sharded.c
+ * Purpose: Glue to make a set of containers be a thread-safe container
+ * ----------------------------------------------------------------------- */
+
+/* pthread_rwlock_t is not part of C99 */
+#define _POSIX_C_SOURCE 200112L
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/memento/memento.h"
+#include "base/errors.h"
+#include "base/types.h"
+#include "container/interface/container.h"
+
+#include "container/sharded.h"
+
+typedef struct container_sharded__shard
+{
+  pthread_rwlock_t           lock;
+  icontainer_t              *c;
+}
+container_sharded__shard_t;
+
+typedef struct container_sharded
+{
+  icontainer_t                c;
+
+  container_sharded__shard_t *shards;
+  int                         nshards;
+
+  icontainer_hash             hash;
+  icontainer_key_compare      compare;
+
+  int                         exclusive; /* lookups take the write lock */
+}
+container_sharded_t;
+
+/* ----------------------------------------------------------------------- */
+
+static container_sharded__shard_t *container_sharded__shard(const container_sharded_t *c,
+                                                            const void                *key)
+{
+  unsigned int h;
+
+  /* Mix the hash so that poorly distributed low bits (e.g. from integer
+   * keys) still spread evenly across the shards. */
+  h = c->hash(key) * 0x9e3779b1u;
+  h ^= h >> 16;
+
+  return &c->shards[h % (unsigned int) c->nshards];
+}
+
+/* Lock a shard for a lookup, which modifies it if 'exclusive' is set. */
+static void container_sharded__lock_lookup(const container_sharded_t  *c,
+                                           container_sharded__shard_t *s)
+{
+  if (c->exclusive)
+    pthread_rwlock_wrlock(&s->lock);
+  else
+    pthread_rwlock_rdlock(&s->lock);
+}
+
+static void container_sharded__lock_lookup_all(const container_sharded_t *c)
+{
+  int i;
+
+  /* always lock in ascending order to avoid deadlock with other threads
+   * doing the same */
+  for (i = 0; i < c->nshards; i++)
+    container_sharded__lock_lookup(c, &c->shards[i]);
+}
+
+static void container_sharded__unlock_all(const container_sharded_t *c)
+{
+  int i;
+
+  for (i = c->nshards - 1; i >= 0; i--)
+    pthread_rwlock_unlock(&c->shards[i].lock);
+}
+
+/* ----------------------------------------------------------------------- */
+
+static const void *container_sharded__lookup(const icontainer_t *c_,
+                                             const void         *key)
+{
+  const container_sharded_t  *c = (container_sharded_t *) c_;
+  container_sharded__shard_t *s;
+  const void                 *value;
+
+  s = container_sharded__shard(c, key);
+
+  container_sharded__lock_lookup(c, s);
+  value = s->c->lookup(s->c, key);
+  pthread_rwlock_unlock(&s->lock);
+
+  return value;
+}
+
+static error container_sharded__insert(icontainer_t *c_,
+                                       const void   *key,
+                                       const void   *value)
+{
+  container_sharded_t        *c = (container_sharded_t *) c_;
+  container_sharded__shard_t *s;
+  error                       err;
+
+  s = container_sharded__shard(c, key);
+
+  pthread_rwlock_wrlock(&s->lock);
+  err = s->c->insert(s->c, key, value);
+  pthread_rwlock_unlock(&s->lock);
+
+  return err;
+}
+
+static void container_sharded__remove(icontainer_t *c_, const void *key)
+{
+  container_sharded_t        *c = (container_sharded_t *) c_;
+  container_sharded__shard_t *s;
+
+  s = container_sharded__shard(c, key);
+
+  pthread_rwlock_wrlock(&s->lock);
+  s->c->remove(s->c, key);
+  pthread_rwlock_unlock(&s->lock);
+}
+
+static const void *container_sharded__lookup_n(const icontainer_t *c_,
+                                               const void         *key,
+                                               size_t              keylen)
+{
+  const container_sharded_t  *c = (container_sharded_t *) c_;
+  container_sharded__shard_t *s;
+  const void                 *value;
+
+  s = container_sharded__shard(c, key);
+
+  container_sharded__lock_lookup(c, s);
+  value = s->c->lookup_n(s->c, key, keylen);
+  pthread_rwlock_unlock(&s->lock);
+
+  return value;
+}
+
+static error container_sharded__insert_n(icontainer_t *c_,
+                                         const void   *key,
+                                         size_t        keylen,
+                                         const void   *value)
+{
+  container_sharded_t        *c = (container_sharded_t *) c_;
+  container_sharded__shard_t *s;
+  error                       err;
+
+  s = container_sharded__shard(c, key);
+
+  pthread_rwlock_wrlock(&s->lock);
+  err = s->c->insert_n(s->c, key, keylen, value);
+  pthread_rwlock_unlock(&s->lock);
+
+  return err;
+}
+
+static void container_sharded__remove_n(icontainer_t *c_,
+                                        const void   *key,
+                                        size_t        keylen)
+{
+  container_sharded_t        *c = (container_sharded_t *) c_;
+  container_sharded__shard_t *s;
+
+  s = container_sharded__shard(c, key);
+
+  pthread_rwlock_wrlock(&s->lock);
+  s->c->remove_n(s->c, key, keylen);
+  pthread_rwlock_unlock(&s->lock);
+}
+
+/* Select the k'th item by merging the shards' ordered sequences. Each
+ * shard's position in its sequence is tracked in 'index'. */
+static const item_t *container_sharded__select(const icontainer_t *c_,
+                                               int                 k)
+{
+  const container_sharded_t *c = (container_sharded_t *) c_;
+  int                       *index;
+  const item_t             **heads;
+  const item_t              *item;
+  int                        i;
+
+  if (k < 0)
+    return NULL;
+
+  index = calloc(c->nshards, sizeof(*index));
+  heads = malloc(c->nshards * sizeof(*heads));
+  if (index == NULL || heads == NULL)
+  {
+    free(heads);
+    free(index);
+    return NULL;
+  }
+
+  container_sharded__lock_lookup_all(c);
+
+  for (i = 0; i < c->nshards; i++)
+    heads[i] = c->shards[i].c->select(c->shards[i].c, 0);
+
+  item = NULL;
+  for (;;)
+  {
+    int min;
+
+    min = -1;
+    for (i = 0; i < c->nshards; i++)
+      if (heads[i] && (min < 0 || c->compare(heads[i]->key,
+                                             heads[min]->key) < 0))
+        min = i;
+
+    if (min < 0)
+      break; /* all shards exhausted */
+
+    if (k-- == 0)
+    {
+      item = heads[min];
+      break;
+    }
+
+    heads[min] = c->shards[min].c->select(c->shards[min].c, ++index[min]);
+  }
+
+  container_sharded__unlock_all(c);
+
+  free(heads);
+  free(index);
+
+  return item;
+}
+
+/* ----------------------------------------------------------------------- */
+
+/* Matching items gathered from one shard by lookup_prefix. The items are
+ * copied since a container may pass a temporary item to its callback. */
+typedef struct container_sharded__found
+{
+  item_t *items;
+  int     nitems;
+  int     maxitems;
+  int     next; /* merge position */
+}
+container_sharded__found_t;
+
+static error container_sharded__gather(const item_t *item, void *opaque)
+{
+  container_sharded__found_t *found = opaque;
+
+  if (found->nitems == found->maxitems)
+  {
+    int     newmax;
+    item_t *newitems;
+
+    newmax = found->maxitems ? found->maxitems * 2 : 8;
+    newitems = realloc(found->items, newmax * sizeof(*newitems));
+    if (newitems == NULL)
+      return error_OOM;
+
+    found->items    = newitems;
+    found->maxitems = newmax;
+  }
+
+  found->items[found->nitems++] = *item;
+
+  return error_OK;
+}
+
+/* Look up 'prefix' in every shard then merge what they find. 'prefixlen'
+ * is NULL if the shards are to measure the prefix themselves. */
+static error container_sharded__lookup_prefix_common(const container_sharded_t *c,
+                                                     const void                *prefix,
+                                                     const size_t              *prefixlen,
+                                                     icontainer_found_callback  cb,
+                                                     void                      *opaque)
+{
+  container_sharded__found_t *found;
+  error                       err;
+  int                         anyfound;
+  int                         i;
+
+  found = calloc(c->nshards, sizeof(*found));
+  if (found == NULL)
+    return error_OOM;
+
+  container_sharded__lock_lookup_all(c);
+
+  /* gather each shard's matches, which arrive in that shard's order */
+
+  anyfound = 0;
+  for (i = 0; i < c->nshards; i++)
+  {
+    icontainer_t *inner = c->shards[i].c;
+
+    if (prefixlen)
+      err = inner->lookup_prefix_n(inner, prefix, *prefixlen,
+                                   container_sharded__gather, &found[i]);
+    else
+      err = inner->lookup_prefix(inner, prefix,
+                                 container_sharded__gather, &found[i]);
+    if (err == error_NOT_FOUND)
+      continue;
+    if (err)
+      goto exit;
+
+    anyfound = 1;
+  }
+
+  /* merge */
+
+  err = error_OK;
+  for (;;)
+  {
+    int min;
+
+    min = -1;
+    for (i = 0; i < c->nshards; i++)
+      if (found[i].next < found[i].nitems &&
+          (min < 0 || c->compare(found[i].items[found[i].next].key,
+                                 found[min].items[found[min].next].key) < 0))
+        min = i;
+
+    if (min < 0)
+      break;
+
+    err = cb(&found[min].items[found[min].next++], opaque);
+    if (err)
+      goto exit;
+  }
+
+  if (!anyfound)
+    err = error_NOT_FOUND;
+
+exit:
+
+  container_sharded__unlock_all(c);
+
+  for (i = 0; i < c->nshards; i++)
+    free(found[i].items);
+  free(found);
+
+  return err;
+}
+
+static error container_sharded__lookup_prefix(const icontainer_t        *c_,
+                                              const void                *prefix,
+                                              icontainer_found_callback  cb,
+                                              void                      *opaque)
+{
+  return container_sharded__lookup_prefix_common((container_sharded_t *) c_,
+                                                 prefix, NULL, cb, opaque);
+}
+
+static error container_sharded__lookup_prefix_n(const icontainer_t        *c_,
+                                                const void                *prefix,
+                                                size_t                     prefixlen,
+                                                icontainer_found_callback  cb,
+                                                void                      *opaque)
+{
+  return container_sharded__lookup_prefix_common((container_sharded_t *) c_,
+                                                 prefix, &prefixlen,
+                                                 cb, opaque);
+}
+
+static int container_sharded__count(const icontainer_t *c_)
+{
+  const container_sharded_t *c = (container_sharded_t *) c_;
+  int                        count;
+  int                        i;
+
+  count = 0;
+  for (i = 0; i < c->nshards; i++)
+  {
+    container_sharded__shard_t *s = &c->shards[i];
+
+    pthread_rwlock_rdlock(&s->lock);
+    count += s->c->count(s->c);
+    pthread_rwlock_unlock(&s->lock);
+  }
+
+  return count;
+}
+
+static void container_sharded__stats(const icontainer_t *c_,
+                                     icontainer_kv_len   key_len,
+                                     icontainer_kv_len   value_len,
+                                     datastruct_stats_t *stats)
+{
+  const container_sharded_t *c = (container_sharded_t *) c_;
+  int                        i;
+
+  memset(stats, 0, sizeof(*stats));
+
+  for (i = 0; i < c->nshards; i++)
+  {
+    container_sharded__shard_t *s = &c->shards[i];
+    datastruct_stats_t          shard;
+
+    pthread_rwlock_rdlock(&s->lock);
+    s->c->stats(s->c, key_len, value_len, &shard);
+    pthread_rwlock_unlock(&s->lock);
+
+    stats->elements    += shard.elements;
+    stats->branches    += shard.branches;
+    stats->leaves      += shard.leaves;
+    stats->node_bytes  += shard.node_bytes;
+    stats->table_bytes += shard.table_bytes;
+    stats->slack_bytes += shard.slack_bytes;
+    stats->other_bytes += shard.other_bytes;
+    stats->key_bytes   += shard.key_bytes;
+    stats->value_bytes += shard.value_bytes;
+    stats->total_bytes += shard.total_bytes;
+  }
+
+  stats->other_bytes += sizeof(*c) + c->nshards * sizeof(*c->shards);
+  stats->total_bytes += sizeof(*c) + c->nshards * sizeof(*c->shards);
+}
+
+static error container_sharded__instrument(const icontainer_t      *c_,
+                                           datastruct_instrument_t *counts)
+{
+  const container_sharded_t *c = (container_sharded_t *) c_;
+  error                      err;
+  int                        i;
+
+  memset(counts, 0, sizeof(*counts));
+
+  err = error_OK;
+  for (i = 0; i < c->nshards && !err; i++)
+  {
+    container_sharded__shard_t *s = &c->shards[i];
+    datastruct_instrument_t     shard;
+
+    pthread_rwlock_rdlock(&s->lock);
+    err = s->c->instrument(s->c, &shard);
+    pthread_rwlock_unlock(&s->lock);
+
+    if (!err)
+      datastruct_instrument_add(counts, &shard);
+  }
+
+  return err;
+}
+
+/* Merge the shapes of the shards. */
+static error container_sharded__depth_stats(const icontainer_t       *c_,
+                                            datastruct_depth_stats_t *stats)
+{
+  const container_sharded_t *c = (container_sharded_t *) c_;
+  error                      err;
+  int                        i;
+
+  datastruct_depth_init(stats);
+
+  for (i = 0; i < c->nshards; i++)
+  {
+    container_sharded__shard_t *s = &c->shards[i];
+    datastruct_depth_stats_t    shard;
+
+    pthread_rwlock_rdlock(&s->lock);
+    err = s->c->depth_stats(s->c, &shard);
+    pthread_rwlock_unlock(&s->lock);
+
+    if (err)
+      return err;
+
+    datastruct_depth_merge(stats, &shard);
+  }
+
+  datastruct_depth_finish(stats);
+
+  return error_OK;
+}
+
+static error container_sharded__show(const icontainer_t *c_, FILE *f)
+{
+  const container_sharded_t *c = (container_sharded_t *) c_;
+  error                      err;
+  int                        i;
+
+  err = error_OK;
+  for (i = 0; i < c->nshards && !err; i++)
+  {
+    container_sharded__shard_t *s = &c->shards[i];
+
+    (void) fprintf(f, "sharded: shard %d of %d\n", i, c->nshards);
+
+    pthread_rwlock_rdlock(&s->lock);
+    err = s->c->show(s->c, f);
+    pthread_rwlock_unlock(&s->lock);
+  }
+
+  return err;
+}
+
+/* Each shard emits a separate graph. */
+static error container_sharded__show_viz(const icontainer_t *c_, FILE *f)
+{
+  const container_sharded_t *c = (container_sharded_t *) c_;
+  error                      err;
+  int                        i;
+
+  err = error_OK;
+  for (i = 0; i < c->nshards && !err; i++)
+  {
+    container_sharded__shard_t *s = &c->shards[i];
+
+    pthread_rwlock_rdlock(&s->lock);
+    err = s->c->show_viz(s->c, f);
+    pthread_rwlock_unlock(&s->lock);
+  }
+
+  return err;
+}
+
+static void container_sharded__destroy(icontainer_t *doomed_)
+{
+  container_sharded_t *doomed = (container_sharded_t *) doomed_;
+  int                  i;
+
+  for (i = 0; i < doomed->nshards; i++)
+  {
+    container_sharded__shard_t *s = &doomed->shards[i];
+
+    if (s->c)
+      s->c->destroy(s->c);
+    pthread_rwlock_destroy(&s->lock);
+  }
+
+  free(doomed->shards);
+  free(doomed);
+}
+
+error container_create_sharded(icontainer_t            **container,
+                               icontainer_maker         *maker,
+                               int                       nshards,
+                               const icontainer_key_t   *key,
+                               const icontainer_value_t *value)
+{
+  static const icontainer_t methods =
+  {
+    container_sharded__lookup,
+    container_sharded__insert,
+    container_sharded__remove,
+    container_sharded__lookup_n,
+    container_sharded__insert_n,
+    container_sharded__remove_n,
+    container_sharded__select,
+    container_sharded__lookup_prefix,
+    container_sharded__lookup_prefix_n,
+    container_sharded__count,
+    container_sharded__stats,
+    container_sharded__instrument,
+    container_sharded__depth_stats,
+    container_sharded__show,
+    container_sharded__show_viz,
+    container_sharded__destroy,
+    0, /* lookups_modify */
+  };
+
+  error                err;
+  container_sharded_t *c;
+  int                  i;
+
+  assert(container);
+  assert(maker);
+  assert(nshards > 0);
+  assert(key);
+  assert(value);
+
+  *container = NULL;
+
+  /* ensure required callbacks are specified */
+
+  if (key->compare == NULL)
+    return error_KEYCOMPARE_REQUIRED;
+  if (key->hash == NULL)
+    return error_KEYHASH_REQIURED;
+
+  c = malloc(sizeof(*c));
+  if (c == NULL)
+    return error_OOM;
+
+  c->c         = methods;
+
+  c->hash      = key->hash;
+  c->compare   = key->compare;
+  c->exclusive = 0;
+
+  c->shards = calloc(nshards, sizeof(*c->shards));
+  if (c->shards == NULL)
+  {
+    free(c);
+    return error_OOM;
+  }
+
+  c->nshards = 0;
+
+  for (i = 0; i < nshards; i++)
+  {
+    container_sharded__shard_t *s = &c->shards[i];
+
+    if (pthread_rwlock_init(&s->lock, NULL) != 0)
+    {
+      err = error_OOM;
+      goto failure;
+    }
+
+    c->nshards++; /* from here on destroy will clean up this shard */
+
+    err = maker(&s->c, key, value);
+    if (err)
+      goto failure;
+
+    if (s->c->lookups_modify)
+      c->exclusive = 1;
+  }
+
+  *container = &c->c;
+
+  return error_OK;
+
+
+failure:
+
+  container_sharded__destroy(&c->c);
+
+  return err;
+}
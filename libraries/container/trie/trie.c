@@ -9,8 +9,10 @@
 
 #include "base/memento/memento.h"
 #include "base/errors.h"
+#include "base/types.h"
 #include "datastruct/trie.h"
 #include "container/interface/container.h"
+#include "container/interface/stats.h"
 
 #include "container/trie.h"
 
@@ -28,12 +30,31 @@ typedef struct container_trie
 }
 container_trie_t;
 
+static const void *container_trie__lookup_n(const icontainer_t *c_,
+                                            const void         *key,
+                                            size_t              keylen)
+{
+  const container_trie_t *c = (container_trie_t *) c_;
+
+  return trie_lookup(c->t, key, keylen);
+}
+
 static const void *container_trie__lookup(const icontainer_t *c_,
                                           const void         *key)
 {
   const container_trie_t *c = (container_trie_t *) c_;
 
-  return trie_lookup(c->t, key, c->len(key));
+  return container_trie__lookup_n(c_, key, c->len(key));
+}
+
+static error container_trie__insert_n(icontainer_t *c_,
+                                      const void   *key,
+                                      size_t        keylen,
+                                      const void   *value)
+{
+  container_trie_t *c = (container_trie_t *) c_;
+
+  return trie_insert(c->t, key, keylen, value);
 }
 
 static error container_trie__insert(icontainer_t *c_,
@@ -42,14 +63,23 @@ static error container_trie__insert(icontainer_t *c_,
 {
   container_trie_t *c = (container_trie_t *) c_;
 
-  return trie_insert(c->t, key, c->len(key), value);
+  return container_trie__insert_n(c_, key, c->len(key), value);
+}
+
+static void container_trie__remove_n(icontainer_t *c_,
+                                     const void   *key,
+                                     size_t        keylen)
+{
+  container_trie_t *c = (container_trie_t *) c_;
+
+  trie_remove(c->t, key, keylen);
 }
 
 static void container_trie__remove(icontainer_t *c_, const void *key)
 {
   container_trie_t *c = (container_trie_t *) c_;
 
-  trie_remove(c->t, key, c->len(key));
+  container_trie__remove_n(c_, key, c->len(key));
 }
 
 static const item_t *container_trie__select(const icontainer_t *c_, int k)
@@ -59,10 +89,11 @@ static const item_t *container_trie__select(const icontainer_t *c_, int k)
   return trie_select(c->t, k);
 }
 
-static error container_trie__lookup_prefix(const icontainer_t        *c_,
-                                           const void                *prefix,
-                                           icontainer_found_callback  cb,
-                                           void                      *opaque)
+static error container_trie__lookup_prefix_n(const icontainer_t        *c_,
+                                             const void                *prefix,
+                                             size_t                     prefixlen,
+                                             icontainer_found_callback  cb,
+                                             void                      *opaque)
 {
   const container_trie_t *c = (container_trie_t *) c_;
 
@@ -72,10 +103,21 @@ static error container_trie__lookup_prefix(const icontainer_t        *c_,
    * another. */
 
   return trie_lookup_prefix(c->t,
-                            prefix, c->len(prefix),
+                            prefix, prefixlen,
                             (icontainer_found_callback) cb, opaque);
 }
 
+static error container_trie__lookup_prefix(const icontainer_t        *c_,
+                                           const void                *prefix,
+                                           icontainer_found_callback  cb,
+                                           void                      *opaque)
+{
+  const container_trie_t *c = (container_trie_t *) c_;
+
+  return container_trie__lookup_prefix_n(c_, prefix, c->len(prefix),
+                                         cb, opaque);
+}
+
 static int container_trie__count(const icontainer_t *c_)
 {
   const container_trie_t *c = (container_trie_t *) c_;
@@ -83,6 +125,47 @@ static int container_trie__count(const icontainer_t *c_)
   return trie_count(c->t);
 }
 
+static error container_trie__stats_kv(const item_t *item,
+                                      int           level,
+                                      void         *opaque)
+{
+  NOT_USED(level);
+
+  icontainer_kv_stats_add(opaque, item->key, item->value);
+
+  return error_OK;
+}
+
+static void container_trie__stats(const icontainer_t *c_,
+                                  icontainer_kv_len   key_len,
+                                  icontainer_kv_len   value_len,
+                                  datastruct_stats_t *stats)
+{
+  const container_trie_t *c = (container_trie_t *) c_;
+  icontainer_kv_stats_t  kvs;
+
+  trie_stats(c->t, stats);
+
+  if (icontainer_kv_stats_init(&kvs, sizeof(*c), key_len, value_len, stats))
+    (void) trie_walk(c->t, container_trie__stats_kv, &kvs);
+}
+
+static error container_trie__instrument(const icontainer_t      *c_,
+                                        datastruct_instrument_t *counts)
+{
+  const container_trie_t *c = (container_trie_t *) c_;
+
+  return trie_instrument(c->t, counts);
+}
+
+static error container_trie__depth_stats(const icontainer_t       *c_,
+                                         datastruct_depth_stats_t *stats)
+{
+  const container_trie_t *c = (container_trie_t *) c_;
+
+  return trie_depth_stats(c->t, stats);
+}
+
 static error container_trie__show(const icontainer_t *c_, FILE *f)
 {
   container_trie_t *c = (container_trie_t *) c_;
@@ -120,12 +203,20 @@ error container_create_trie(icontainer_t            **container,
     container_trie__lookup,
     container_trie__insert,
     container_trie__remove,
+    container_trie__lookup_n,
+    container_trie__insert_n,
+    container_trie__remove_n,
     container_trie__select,
     container_trie__lookup_prefix,
+    container_trie__lookup_prefix_n,
     container_trie__count,
+    container_trie__stats,
+    container_trie__instrument,
+    container_trie__depth_stats,
     container_trie__show,
     container_trie__show_viz,
     container_trie__destroy,
+    0, /* lookups_modify */
   };
 
   error             err;
@@ -27,7 +27,7 @@ error bstree_create(const void            *default_value,
   if (t == NULL)
     return error_OOM;
 
-  t->root          = NULL;
+  t->root          = NIL;
   t->default_value = default_value;
   t->compare       = compare;
   t->destroy_key   = destroy_key;
@@ -35,6 +35,12 @@ error bstree_create(const void            *default_value,
 
   t->count         = 0;
 
+#ifdef DATASTRUCT_COMPACT
+  datastruct_pool_init(&t->pool, sizeof(bstree__node_t));
+#endif
+
+  INSTRUMENT_INIT(t);
+
   *pt = t;
 
   return error_OK;
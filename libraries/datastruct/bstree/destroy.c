@@ -17,7 +17,12 @@ static error bstree__destroy_node(bstree__node_t *n, int level, void *opaque)
 {
   NOT_USED(level);
 
+#ifdef DATASTRUCT_COMPACT
+  /* the pool is released in one go below */
+  bstree__node_clear(opaque, n);
+#else
   bstree__node_destroy(opaque, n);
+#endif
 
   return error_OK;
 }
@@ -26,6 +31,10 @@ void bstree_destroy(bstree_t *t)
 {
   (void) bstree__walk_internal_post(t, bstree__destroy_node, t);
 
+#ifdef DATASTRUCT_COMPACT
+  datastruct_pool_fini(&t->pool);
+#endif
+
   free(t);
 }
 
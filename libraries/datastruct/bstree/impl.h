@@ -6,24 +6,30 @@
 #ifndef BSTREE_IMPL_H
 #define BSTREE_IMPL_H
 
+#include "datastruct/instrument.h"
 #include "datastruct/item.h"
+#include "datastruct/pool.h"
 
 #include "datastruct/bstree.h"
 
 /* ----------------------------------------------------------------------- */
 
+/* Nodes link to one another by pointer, or by pool index when built with
+ * DATASTRUCT_COMPACT. See pool.h. */
+typedef POOL_LINK(struct bstree__node) bstree__link_t;
+
 typedef struct bstree__node
 {
   /* using an array here rather than separate left,right elements makes some
    * operations more convenient */
-  struct bstree__node  *child[2]; /* left, right children */
+  bstree__link_t        child[2]; /* left, right children */
   item_t                item;
 }
 bstree__node_t;
 
 struct bstree
 {
-  bstree__node_t       *root;
+  bstree__link_t        root;
 
   int                   count;
 
@@ -32,16 +38,38 @@ struct bstree
   bstree_compare       *compare;
   bstree_destroy_key   *destroy_key;
   bstree_destroy_value *destroy_value;
+
+#ifdef DATASTRUCT_COMPACT
+  datastruct_pool_t     pool;
+#endif
+
+#ifdef DATASTRUCT_INSTRUMENT
+  datastruct_instrument_t instrument;
+#endif
 };
 
 /* ----------------------------------------------------------------------- */
 
-bstree__node_t *bstree__node_create(bstree_t   *t,
-                                    const void *key,
-                                    size_t      keylen,
-                                    const void *value);
+#define NIL POOL_NIL
+
+/* Returns the node 'l' links to. 'l' must not be NIL. */
+#define NODE(t, l) POOL_NODE(t, bstree__node_t, l)
+
+/* As NODE, but maps NIL to NULL. */
+#define NODE_OR_NULL(t, l) ((l) == NIL ? NULL : NODE(t, l))
+
+/* ----------------------------------------------------------------------- */
+
+/* Returns NIL if out of memory. */
+bstree__link_t bstree__node_create(bstree_t   *t,
+                                   const void *key,
+                                   size_t      keylen,
+                                   const void *value);
+
+void bstree__node_destroy(bstree_t *t, bstree__link_t l);
 
-void bstree__node_destroy(bstree_t *t, bstree__node_t *n);
+/* Return a node's memory without destroying its key or value. */
+void bstree__node_free(bstree_t *t, bstree__link_t l);
 
 void bstree__node_clear(bstree_t *t, bstree__node_t *n);
 
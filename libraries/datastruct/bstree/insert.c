@@ -12,16 +12,20 @@
 
 #include "impl.h"
 
-static INLINE bstree__node_t **bstree__insert_node(bstree__node_t **pn,
-                                                   const void      *key,
-                                                   bstree_compare  *compare)
+static INLINE bstree__link_t *bstree__insert_node(const bstree_t  *t,
+                                                  bstree__link_t  *pn,
+                                                  const void      *key,
+                                                  bstree_compare  *compare)
 {
   bstree__node_t *n;
 
-  while ((n = *pn) != NULL)
+  while ((n = NODE_OR_NULL(t, *pn)) != NULL)
   {
     int d;
 
+    INSTRUMENT_VISIT(t);
+    INSTRUMENT_COMPARE(t);
+
     d = compare(key, n->item.key);
     if (d == 0)
       return NULL; /* found match */
@@ -37,14 +41,17 @@ error bstree_insert(bstree_t   *t,
                     size_t      keylen,
                     const void *value)
 {
-  bstree__node_t **pn;
+  bstree__link_t *pn;
+
+  pn = bstree__insert_node(t, &t->root, key, t->compare);
+
+  INSTRUMENT_END(t, INSERT);
 
-  pn = bstree__insert_node(&t->root, key, t->compare);
   if (pn == NULL)
     return error_EXISTS;
 
   *pn = bstree__node_create(t, key, keylen, value);
-  if (*pn == NULL)
+  if (*pn == NIL)
     return error_OOM;
 
   return error_OK;
@@ -12,20 +12,28 @@
 
 #include "impl.h"
 
-static INLINE const void *bstree__lookup_node(const bstree__node_t *n,
+static INLINE const void *bstree__lookup_node(const bstree_t       *t,
+                                              bstree__link_t        l,
                                               const void           *key,
                                               const void           *default_value,
                                               bstree_compare       *compare)
 {
-  while (n)
+  const bstree__node_t *n;
+
+  while (l != NIL)
   {
     int d;
 
+    n = NODE(t, l);
+
+    INSTRUMENT_VISIT(t);
+    INSTRUMENT_COMPARE(t);
+
     d = compare(key, n->item.key);
     if (d == 0)
       return n->item.value; /* found */
 
-    n = n->child[d < 0 ? 0 : 1];
+    l = n->child[d < 0 ? 0 : 1];
   }
 
   return default_value; /* not found */
@@ -33,6 +41,12 @@ static INLINE const void *bstree__lookup_node(const bstree__node_t *n,
 
 const void *bstree_lookup(bstree_t *t, const void *key)
 {
-  return bstree__lookup_node(t->root, key, t->default_value, t->compare);
+  const void *value;
+
+  value = bstree__lookup_node(t, t->root, key, t->default_value, t->compare);
+
+  INSTRUMENT_END(t, LOOKUP);
+
+  return value;
 }
 
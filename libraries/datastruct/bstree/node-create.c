@@ -12,26 +12,35 @@
 
 #include "impl.h"
 
-bstree__node_t *bstree__node_create(bstree_t   *t,
-                                    const void *key,
-                                    size_t      keylen,
-                                    const void *value)
+bstree__link_t bstree__node_create(bstree_t   *t,
+                                   const void *key,
+                                   size_t      keylen,
+                                   const void *value)
 {
+  bstree__link_t  l;
   bstree__node_t *n;
 
-  n = malloc(sizeof(*n));
-  if (n == NULL)
-    return NULL;
+#ifdef DATASTRUCT_COMPACT
+  l = datastruct_pool_alloc(&t->pool);
+#else
+  l = malloc(sizeof(*l));
+#endif
+  if (l == NIL)
+    return NIL;
 
-  n->child[0]    = NULL;
-  n->child[1]    = NULL;
+  n = NODE(t, l);
+
+  n->child[0]    = NIL;
+  n->child[1]    = NIL;
   n->item.key    = key;
   n->item.keylen = keylen;
   n->item.value  = value;
 
+  INSTRUMENT_ALLOC(t);
+
   t->count++;
 
-  return n;
+  return l;
 }
 
 
@@ -19,12 +19,22 @@ void bstree__node_clear(bstree_t *t, bstree__node_t *n)
     t->destroy_value((void *) n->item.value);
 }
 
-void bstree__node_destroy(bstree_t *t, bstree__node_t *n)
+void bstree__node_free(bstree_t *t, bstree__link_t l)
 {
-  bstree__node_clear(t, n);
+#ifdef DATASTRUCT_COMPACT
+  datastruct_pool_free(&t->pool, l);
+#else
+  free(l);
+#endif
 
-  free(n);
+  INSTRUMENT_FREE(t);
 
   t->count--;
 }
 
+void bstree__node_destroy(bstree_t *t, bstree__link_t l)
+{
+  bstree__node_clear(t, NODE(t, l));
+  bstree__node_free(t, l);
+}
+
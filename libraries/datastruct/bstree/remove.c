@@ -13,66 +13,71 @@
 
 void bstree_remove(bstree_t *t, const void *key)
 {
-  bstree__node_t **pn;
+  bstree__link_t  *pn;
   bstree__node_t  *n;
+  bstree__link_t   doomed;
 
   pn = &t->root;
-  n  = *pn;
+  n  = NODE_OR_NULL(t, *pn);
   while (n)
   {
     int d;
 
+    INSTRUMENT_VISIT(t);
+    INSTRUMENT_COMPARE(t);
+
     d = t->compare(key, n->item.key);
     if (d == 0)
       break;
 
     pn = &n->child[d < 0 ? 0 : 1];
-    n  = *pn;
+    n  = NODE_OR_NULL(t, *pn);
   }
 
+  INSTRUMENT_END(t, REMOVE);
+
   if (n == NULL)
     return; /* not found */
 
   bstree__node_clear(t, n);
 
+  doomed = *pn;
+
   /* case 1: node has no children */
-  if (n->child[0] == NULL && n->child[1] == NULL)
+  if (n->child[0] == NIL && n->child[1] == NIL)
   {
     /* set parent to NULL */
-    *pn = NULL;
+    *pn = NIL;
   }
   /* case 2: node has just one child */
-  else if (n->child[0] == NULL || n->child[1] == NULL)
+  else if (n->child[0] == NIL || n->child[1] == NIL)
   {
     /* point parent to grandchild */
-    *pn = n->child[0] ? n->child[0] : n->child[1];
+    *pn = n->child[0] != NIL ? n->child[0] : n->child[1];
   }
   /* case 3: node has both children */
   else
   {
-    bstree__node_t **pmin;
+    bstree__link_t  *pmin;
     bstree__node_t  *min;
 
     /* find minimum node in right subtree */
     pmin = &n->child[1];
-    min  = *pmin;
-    while (min->child[0])
+    min  = NODE(t, *pmin);
+    while (min->child[0] != NIL)
     {
       pmin = &min->child[0];
-      min  = *pmin;
+      min  = NODE(t, *pmin);
     }
 
     /* take minimum node's item to replace existing item */
     n->item = min->item;
 
     /* minimum is now a duplicate: remove it */
+    doomed = *pmin;
     *pmin = min->child[1]; /* right child, or NULL */
-
-    n = min;
   }
 
-  free(n);
-
-  t->count--;
+  bstree__node_free(t, doomed);
 }
 
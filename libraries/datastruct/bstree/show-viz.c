@@ -15,6 +15,7 @@
 
 typedef struct bstree__show_viz_args
 {
+  const bstree_t      *t;
   bstree_show_key     *key;
   bstree_show_destroy *key_destroy;
   bstree_show_value   *value;
@@ -40,10 +41,12 @@ static error bstree__node_show_viz(bstree__node_t *n,
                  n,
                  key   ? key   : "(null)",
                  value ? value : "(null)");
-  if (n->child[0])
-    (void) fprintf(args->f, "\t\"%p\":sw -> \"%p\":n;\n", n, n->child[0]);
-  if (n->child[1])
-    (void) fprintf(args->f, "\t\"%p\":se -> \"%p\":n;\n", n, n->child[1]);
+  if (n->child[0] != NIL)
+    (void) fprintf(args->f, "\t\"%p\":sw -> \"%p\":n;\n",
+                   (void *) n, (void *) NODE(args->t, n->child[0]));
+  if (n->child[1] != NIL)
+    (void) fprintf(args->f, "\t\"%p\":se -> \"%p\":n;\n",
+                   (void *) n, (void *) NODE(args->t, n->child[1]));
 
   if (args->key_destroy   && key)   args->key_destroy((char *) key);
   if (args->value_destroy && value) args->value_destroy((char *) value);
@@ -61,6 +64,7 @@ error bstree_show_viz(const bstree_t      *t,
   error                   err;
   bstree__show_viz_args_t args;
 
+  args.t             = t;
   args.key           = key;
   args.key_destroy   = key_destroy;
   args.value         = value;
@@ -13,19 +13,24 @@
 #include "impl.h"
 
 /* post-order (which allows for deletions) */
-static error bstree__node_walk_internal_post(bstree__node_t                 *n,
+static error bstree__node_walk_internal_post(const bstree_t                 *t,
+                                             bstree__link_t                  l,
                                              int                             level,
                                              bstree__walk_internal_callback *cb,
                                              void                           *opaque)
 {
-  error err;
+  error           err;
+  bstree__node_t *n;
 
-  if (n == NULL)
+  if (l == NIL)
     return error_OK;
 
-  err = bstree__node_walk_internal_post(n->child[0], level + 1, cb, opaque);
+  n = NODE(t, l);
+
+  err = bstree__node_walk_internal_post(t, n->child[0], level + 1, cb, opaque);
   if (!err)
-    err = bstree__node_walk_internal_post(n->child[1], level + 1, cb, opaque);
+    err = bstree__node_walk_internal_post(t, n->child[1], level + 1,
+                                          cb, opaque);
   if (!err)
     err = cb(n, level, opaque);
 
@@ -39,24 +44,28 @@ error bstree__walk_internal_post(bstree_t                       *t,
   if (t == NULL)
     return error_OK;
 
-  return bstree__node_walk_internal_post(t->root, 0, cb, opaque);
+  return bstree__node_walk_internal_post(t, t->root, 0, cb, opaque);
 }
 
-static error bstree__node_walk_internal(bstree__node_t                 *n,
+static error bstree__node_walk_internal(const bstree_t                 *t,
+                                        bstree__link_t                  l,
                                         int                             level,
                                         bstree__walk_internal_callback *cb,
                                         void                           *opaque)
 {
-  error err;
+  error           err;
+  bstree__node_t *n;
 
-  if (n == NULL)
+  if (l == NIL)
     return error_OK;
 
-  err = bstree__node_walk_internal(n->child[0], level + 1, cb, opaque);
+  n = NODE(t, l);
+
+  err = bstree__node_walk_internal(t, n->child[0], level + 1, cb, opaque);
   if (!err)
     err = cb(n, level, opaque);
   if (!err)
-    err = bstree__node_walk_internal(n->child[1], level + 1, cb, opaque);
+    err = bstree__node_walk_internal(t, n->child[1], level + 1, cb, opaque);
 
   return err;
 }
@@ -69,6 +78,6 @@ error bstree__walk_internal(bstree_t                       *t,
   if (t == NULL)
     return error_OK;
 
-  return bstree__node_walk_internal(t->root, 0, cb, opaque);
+  return bstree__node_walk_internal(t, t->root, 0, cb, opaque);
 }
 
@@ -11,60 +11,72 @@
 
 #include "impl.h"
 
-static error walk_in_order(const bstree__node_t *n,
+static error walk_in_order(const bstree_t       *t,
+                           bstree__link_t        l,
                            bstree_walk_flags     flags,
                            int                   level,
                            bstree_walk_callback *cb,
                            void                 *opaque)
 {
-  error err;
+  error                 err;
+  const bstree__node_t *n;
 
-  if (n == NULL)
+  if (l == NIL)
     return error_OK;
 
-  err = walk_in_order(n->child[0], flags, level + 1, cb, opaque);
+  n = NODE(t, l);
+
+  err = walk_in_order(t, n->child[0], flags, level + 1, cb, opaque);
   if (!err)
     err = cb(&n->item, level, opaque);
   if (!err)
-    err = walk_in_order(n->child[1], flags, level + 1, cb, opaque);
+    err = walk_in_order(t, n->child[1], flags, level + 1, cb, opaque);
 
   return err;
 }
 
-static error walk_pre_order(const bstree__node_t *n,
+static error walk_pre_order(const bstree_t       *t,
+                            bstree__link_t        l,
                             bstree_walk_flags     flags,
                             int                   level,
                             bstree_walk_callback *cb,
                             void                 *opaque)
 {
-  error err;
+  error                 err;
+  const bstree__node_t *n;
 
-  if (n == NULL)
+  if (l == NIL)
     return error_OK;
 
+  n = NODE(t, l);
+
   err = cb(&n->item, level, opaque);
   if (!err)
-    err = walk_in_order(n->child[0], flags, level + 1, cb, opaque);
+    err = walk_in_order(t, n->child[0], flags, level + 1, cb, opaque);
   if (!err)
-    err = walk_in_order(n->child[1], flags, level + 1, cb, opaque);
+    err = walk_in_order(t, n->child[1], flags, level + 1, cb, opaque);
 
   return err;
 }
 
-static error walk_post_order(const bstree__node_t *n,
+static error walk_post_order(const bstree_t       *t,
+                             bstree__link_t        l,
                              bstree_walk_flags     flags,
                              int                   level,
                              bstree_walk_callback *cb,
                              void                 *opaque)
 {
-  error err;
+  error                 err;
+  const bstree__node_t *n;
 
-  if (n == NULL)
+  if (l == NIL)
     return error_OK;
 
-  err = walk_in_order(n->child[0], flags, level + 1, cb, opaque);
+  n = NODE(t, l);
+
+  err = walk_in_order(t, n->child[0], flags, level + 1, cb, opaque);
   if (!err)
-    err = walk_in_order(n->child[1], flags, level + 1, cb, opaque);
+    err = walk_in_order(t, n->child[1], flags, level + 1, cb, opaque);
   if (!err)
     err = cb(&n->item, level, opaque);
 
@@ -76,7 +88,8 @@ error bstree_walk(const bstree_t       *t,
                   bstree_walk_callback *cb,
                   void                 *opaque)
 {
-  error (*walker)(const bstree__node_t *n,
+  error (*walker)(const bstree_t       *t,
+                  bstree__link_t        l,
                   bstree_walk_flags     flags,
                   int                   level,
                   bstree_walk_callback *cb,
@@ -103,6 +116,6 @@ error bstree_walk(const bstree_t       *t,
     break;
   }
 
-  return walker(t->root, flags, 0, cb, opaque);
+  return walker(t, t->root, flags, 0, cb, opaque);
 }
 
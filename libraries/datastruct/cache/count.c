@@ -0,0 +1,25 @@
+/* --------------------------------------------------------------------------
+ *    Name: count.c
+ * Purpose: Bounded associative array which evicts to stay within a budget
+ * ----------------------------------------------------------------------- */
+
+#include <stddef.h>
+
+#include "datastruct/cache.h"
+
+#include "impl.h"
+
+int cache_count(const cache_t *c)
+{
+  return c->count;
+}
+
+size_t cache_used(const cache_t *c)
+{
+  return c->used;
+}
+
+void cache_counters(const cache_t *c, cache_counters_t *counters)
+{
+  *counters = c->counters;
+}
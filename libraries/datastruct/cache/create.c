@@ -0,0 +1,98 @@
+/* --------------------------------------------------------------------------
+ *    Name: create.c
+ * Purpose: Bounded associative array which evicts to stay within a budget
+ * ----------------------------------------------------------------------- */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/memento/memento.h"
+
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "datastruct/cache.h"
+#include "datastruct/hash.h"
+#include "datastruct/pool.h"
+
+#include "impl.h"
+
+error cache_create(cache_policy_t       policy,
+                   size_t               budget,
+                   cache_cost          *cost,
+                   const void          *default_value,
+                   hash_fn             *fn,
+                   hash_compare        *compare,
+                   cache_destroy_key   *destroy_key,
+                   cache_destroy_value *destroy_value,
+                   cache_t            **pc)
+{
+  cache_t *c;
+
+  c = malloc(sizeof(*c));
+  if (c == NULL)
+    return error_OOM;
+
+  /* a budget which counts entries says how many bins will be needed, so
+   * allocate them up front, within reason. Beyond that the table grows as
+   * entries arrive. */
+  c->log2bins = cache__LOG2BINS;
+  if (cost == NULL)
+    while (c->log2bins < cache__MAXLOG2BINS &&
+           ((size_t) 1 << c->log2bins) < budget)
+      c->log2bins++;
+
+  c->bins = calloc((size_t) 1 << c->log2bins, sizeof(*c->bins));
+  if (c->bins == NULL)
+  {
+    free(c);
+    return error_OOM;
+  }
+
+  c->policy        = policy;
+  c->budget        = budget;
+  c->used          = 0;
+  c->count         = 0;
+
+  c->cost          = cost;
+  c->default_value = default_value;
+  c->hash_fn       = fn;
+  c->compare       = compare;
+  c->destroy_key   = destroy_key;
+  c->destroy_value = destroy_value;
+
+  datastruct_pool_init(&c->pool, sizeof(cache__entry_t));
+
+  memset(&c->main,     0, sizeof(c->main));
+  memset(&c->small,    0, sizeof(c->small));
+  c->hand = NIL;
+  memset(&c->ghost,    0, sizeof(c->ghost));
+  memset(&c->counters, 0, sizeof(c->counters));
+
+  *pc = c;
+
+  return error_OK;
+}
+
+void cache_destroy(cache_t *c)
+{
+  cache__index_t i;
+
+  /* every index below 'next' has been handed out at some point */
+  for (i = 1; i < c->pool.next; i++)
+  {
+    cache__entry_t *e = ENTRY(c, i);
+
+    if (e->queue == cache__QUEUE_FREE)
+      continue;
+
+    c->destroy_key((void *) e->key);     /* must cast away const */
+    c->destroy_value((void *) e->value); /* must cast away const */
+  }
+
+  free(c->bins);
+  datastruct_pool_fini(&c->pool);
+  cache__ghost_fini(c);
+
+  free(c);
+}
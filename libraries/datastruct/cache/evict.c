@@ -0,0 +1,378 @@
+/* --------------------------------------------------------------------------
+ *    Name: evict.c
+ * Purpose: Bounded associative array which evicts to stay within a budget
+ * ----------------------------------------------------------------------- */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "base/memento/memento.h"
+
+#include "datastruct/cache.h"
+#include "datastruct/pool.h"
+
+#include "impl.h"
+
+/* ----------------------------------------------------------------------- */
+
+static void cache__list_push(cache_t *c, cache__list_t *l, cache__index_t i)
+{
+  cache__entry_t *e = ENTRY(c, i);
+
+  e->prev = NIL;
+  e->next = l->newest;
+
+  if (l->newest != NIL)
+    ENTRY(c, l->newest)->prev = i;
+  else
+    l->oldest = i;
+
+  l->newest = i;
+  l->used  += e->cost;
+}
+
+static void cache__list_unlink(cache_t *c, cache__list_t *l, cache__index_t i)
+{
+  cache__entry_t *e = ENTRY(c, i);
+
+  if (e->prev != NIL)
+    ENTRY(c, e->prev)->next = e->next;
+  else
+    l->newest = e->next;
+
+  if (e->next != NIL)
+    ENTRY(c, e->next)->prev = e->prev;
+  else
+    l->oldest = e->prev;
+
+  l->used -= e->cost;
+}
+
+/* ----------------------------------------------------------------------- */
+
+/* Ghost hashes are stored non-zero and placed by their top bits after
+ * mixing. */
+#define GHOST_HASH(h)       ((h) ? (h) : 1u)
+#define GHOST_HOME(g, h)    ((int) (((h) * 2654435769u) >> (g)->shift))
+
+static void cache__ghost_set_add(cache__ghost_t *g, unsigned int h)
+{
+  int i;
+
+  for (i = GHOST_HOME(g, h); g->set[i]; i = (i + 1) & (g->nset - 1))
+    ;
+
+  g->set[i] = h;
+}
+
+/* Remove one copy of 'h', shifting later members of its run back so that
+ * none is left beyond a gap from its home slot. */
+static void cache__ghost_set_remove(cache__ghost_t *g, unsigned int h)
+{
+  int mask = g->nset - 1;
+  int i;
+  int j;
+
+  for (i = GHOST_HOME(g, h); g->set[i] != h; i = (i + 1) & mask)
+    assert(g->set[i] != 0);
+
+  for (j = (i + 1) & mask; g->set[j]; j = (j + 1) & mask)
+  {
+    int home = GHOST_HOME(g, g->set[j]);
+
+    /* can the member at j move back to i? only if its home isn't in
+     * (i, j], cyclically. */
+    if (((i <= j) ? (i < home && home <= j) : (i < home || home <= j)))
+      continue;
+
+    g->set[i] = g->set[j];
+    i = j;
+  }
+
+  g->set[i] = 0;
+}
+
+static int cache__ghost_contains(const cache_t *c, unsigned int h)
+{
+  const cache__ghost_t *g = &c->ghost;
+  int                   i;
+
+  if (g->nset == 0)
+    return 0;
+
+  h = GHOST_HASH(h);
+
+  for (i = GHOST_HOME(g, h); g->set[i]; i = (i + 1) & (g->nset - 1))
+    if (g->set[i] == h)
+      return 1;
+
+  return 0;
+}
+
+/* Grow the ghost ring, keeping its contents in order, and rebuild the set
+ * to suit. */
+static void cache__ghost_grow(cache_t *c)
+{
+  cache__ghost_t *g = &c->ghost;
+  cache__ghost_t  new;
+  int             log2nset;
+  int             i;
+
+  new.nring = g->nring ? g->nring * 2 : 64;
+  new.nset  = new.nring * 2;
+  for (log2nset = 0; (1 << log2nset) < new.nset; log2nset++)
+    ;
+  new.shift = 32 - log2nset;
+
+  new.ring = malloc(new.nring * sizeof(*new.ring));
+  new.set  = calloc(new.nset, sizeof(*new.set));
+  if (new.ring == NULL || new.set == NULL)
+  {
+    /* not fatal: carry on with the ring we have */
+    free(new.ring);
+    free(new.set);
+    return;
+  }
+
+  new.head = 0;
+  new.n    = g->n;
+  for (i = 0; i < g->n; i++)
+  {
+    new.ring[i] = g->ring[(g->head + i) % g->nring];
+    cache__ghost_set_add(&new, new.ring[i]);
+  }
+
+  free(g->ring);
+  free(g->set);
+
+  *g = new;
+}
+
+/* Remember an evicted key's hash, forgetting the oldest once the ring holds
+ * as many as the cache holds entries. */
+static void cache__ghost_add(cache_t *c, unsigned int h)
+{
+  cache__ghost_t *g = &c->ghost;
+
+  if (g->n == g->nring && c->count > g->nring)
+    cache__ghost_grow(c);
+
+  if (g->nring == 0)
+    return;
+
+  h = GHOST_HASH(h);
+
+  if (g->n == g->nring)
+  {
+    cache__ghost_set_remove(g, g->ring[g->head]);
+    g->head = (g->head + 1) % g->nring;
+    g->n--;
+  }
+
+  g->ring[(g->head + g->n) % g->nring] = h;
+  cache__ghost_set_add(g, h);
+  g->n++;
+}
+
+void cache__ghost_fini(cache_t *c)
+{
+  free(c->ghost.ring);
+  free(c->ghost.set);
+}
+
+/* ----------------------------------------------------------------------- */
+
+void cache__admit(cache_t *c, cache__index_t i, unsigned int hash)
+{
+  cache__entry_t *e = ENTRY(c, i);
+
+  switch (c->policy)
+  {
+  case cache_POLICY_LRU:
+    cache__list_push(c, &c->main, i);
+    break;
+
+  case cache_POLICY_CLOCK:
+    break; /* the hand will find it */
+
+  case cache_POLICY_S3FIFO:
+    if (cache__ghost_contains(c, hash))
+    {
+      cache__list_push(c, &c->main, i);
+    }
+    else
+    {
+      e->queue = cache__QUEUE_SMALL;
+      cache__list_push(c, &c->small, i);
+    }
+    break;
+  }
+}
+
+void cache__touch(cache_t *c, cache__index_t i)
+{
+  cache__entry_t *e = ENTRY(c, i);
+
+  switch (c->policy)
+  {
+  case cache_POLICY_LRU:
+    if (c->main.newest != i)
+    {
+      cache__list_unlink(c, &c->main, i);
+      cache__list_push(c, &c->main, i);
+    }
+    break;
+
+  case cache_POLICY_CLOCK:
+    e->freq = 1;
+    break;
+
+  case cache_POLICY_S3FIFO:
+    if (e->freq < 3)
+      e->freq++;
+    break;
+  }
+}
+
+void cache__forget(cache_t *c, cache__index_t i)
+{
+  cache__entry_t *e = ENTRY(c, i);
+
+  if (c->policy == cache_POLICY_CLOCK)
+    return; /* the hand skips free entries */
+
+  cache__list_unlink(c,
+                     e->queue == cache__QUEUE_SMALL ? &c->small : &c->main,
+                     i);
+}
+
+void cache__discard(cache_t *c, cache__index_t i)
+{
+  cache__entry_t *e = ENTRY(c, i);
+
+  cache__unlink(c, i);
+
+  c->destroy_key((void *) e->key);     /* must cast away const */
+  c->destroy_value((void *) e->value); /* must cast away const */
+
+  c->used -= e->cost;
+  c->count--;
+
+  e->queue = cache__QUEUE_FREE;
+  datastruct_pool_free(&c->pool, i);
+}
+
+/* ----------------------------------------------------------------------- */
+
+static cache__index_t cache__choose_lru(cache_t *c)
+{
+  cache__index_t i;
+
+  i = c->main.oldest;
+  cache__list_unlink(c, &c->main, i);
+
+  return i;
+}
+
+/* Sweep the hand round the pool, giving referenced entries a second
+ * chance. Terminates within two sweeps. */
+static cache__index_t cache__choose_clock(cache_t *c)
+{
+  for (;;)
+  {
+    cache__index_t  i;
+    cache__entry_t *e;
+
+    if (c->hand == NIL || c->hand >= c->pool.next)
+      c->hand = 1;
+
+    i = c->hand++;
+    e = ENTRY(c, i);
+
+    if (e->queue == cache__QUEUE_FREE)
+      continue;
+
+    if (e->freq == 0)
+      return i;
+
+    e->freq = 0;
+  }
+}
+
+/* Evict from the small queue while it holds at least its share of the
+ * budget, otherwise from the main queue. Small queue entries used more than
+ * once move to the main queue instead; main queue entries used since they
+ * were last reinserted are reinserted. */
+static cache__index_t cache__choose_s3fifo(cache_t *c)
+{
+  size_t small_budget = c->budget / 10;
+
+  for (;;)
+  {
+    cache__index_t  i;
+    cache__entry_t *e;
+
+    if (c->small.oldest != NIL &&
+        (c->small.used >= small_budget || c->main.oldest == NIL))
+    {
+      i = c->small.oldest;
+      e = ENTRY(c, i);
+
+      cache__list_unlink(c, &c->small, i);
+
+      if (e->freq > 1)
+      {
+        e->queue = cache__QUEUE_MAIN;
+        cache__list_push(c, &c->main, i);
+        continue;
+      }
+
+      cache__ghost_add(c, e->hash);
+
+      return i;
+    }
+    else
+    {
+      i = c->main.oldest;
+      e = ENTRY(c, i);
+
+      cache__list_unlink(c, &c->main, i);
+
+      if (e->freq > 0)
+      {
+        e->freq--;
+        cache__list_push(c, &c->main, i);
+        continue;
+      }
+
+      return i;
+    }
+  }
+}
+
+void cache__evict(cache_t *c)
+{
+  cache__index_t i = NIL;
+
+  assert(c->count > 0);
+
+  switch (c->policy)
+  {
+  case cache_POLICY_LRU:
+    i = cache__choose_lru(c);
+    break;
+
+  case cache_POLICY_CLOCK:
+    i = cache__choose_clock(c);
+    break;
+
+  case cache_POLICY_S3FIFO:
+    i = cache__choose_s3fifo(c);
+    break;
+  }
+
+  cache__discard(c, i);
+
+  c->counters.evictions++;
+}
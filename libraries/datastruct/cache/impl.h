@@ -0,0 +1,148 @@
+/* --------------------------------------------------------------------------
+ *    Name: impl.h
+ * Purpose: Bounded associative array which evicts to stay within a budget
+ * ----------------------------------------------------------------------- */
+
+#ifndef CACHE_IMPL_H
+#define CACHE_IMPL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "datastruct/cache.h"
+#include "datastruct/hash.h"
+#include "datastruct/pool.h"
+
+/* ----------------------------------------------------------------------- */
+
+/* Entries are identified by their pool index. Each entry is a node in
+ * both the cache's own chained hash table, which finds it by key, and the
+ * policy's lists, so all of its state is held in one place. Index zero is
+ * never handed out so serves as the end of a chain or list. */
+
+typedef datastruct_pool_index_t cache__index_t;
+
+#define NIL datastruct_POOL_NIL
+
+#define ENTRY(c, i)   ((cache__entry_t *) datastruct_pool_get(&(c)->pool, (i)))
+
+/* The table starts with at least this many bins, as a power of two, and
+ * doubles whenever the cache holds as many entries as it has bins. A cache
+ * whose budget counts entries starts with enough for them, but no more
+ * than cache__MAXLOG2BINS. */
+#define cache__LOG2BINS    4
+#define cache__MAXLOG2BINS 16
+
+/* Fibonacci hashing: scramble the key's hash then take its top bits. */
+#define BIN(c, h) (((uint32_t) ((h) * 2654435769u)) >> (32 - (c)->log2bins))
+
+/* Where an entry is. LRU and CLOCK use only MAIN. */
+enum
+{
+  cache__QUEUE_FREE,
+  cache__QUEUE_MAIN,
+  cache__QUEUE_SMALL
+};
+
+typedef struct cache__entry
+{
+  const void     *key;   /* first: the pool links free entries through it */
+  const void     *value;
+  size_t          keylen;
+  size_t          cost;
+  unsigned int    hash;  /* of the key, as returned by 'hash_fn' */
+  cache__index_t  chain; /* next entry in the same bin */
+  cache__index_t  prev;  /* towards the newest */
+  cache__index_t  next;  /* towards the oldest */
+  unsigned char   freq;  /* CLOCK reference bit, or S3-FIFO use count */
+  unsigned char   queue;
+}
+cache__entry_t;
+
+/* A doubly linked list of entries: the LRU list or an S3-FIFO queue. */
+typedef struct cache__list
+{
+  cache__index_t  newest;
+  cache__index_t  oldest;
+  size_t          used;   /* total cost of the entries on it */
+}
+cache__list_t;
+
+/* S3-FIFO's ghost queue: a ring of the hashes of evicted keys, oldest
+ * first, and an open addressed set of the same hashes for membership
+ * tests. Zero marks an empty slot in the set. */
+typedef struct cache__ghost
+{
+  unsigned int   *ring;
+  int             nring;
+  int             head;   /* oldest */
+  int             n;
+  unsigned int   *set;
+  int             nset;   /* a power of two, twice 'nring' */
+  int             shift;  /* 32 - log2(nset) */
+}
+cache__ghost_t;
+
+struct cache
+{
+  cache_policy_t       policy;
+  size_t               budget;
+  size_t               used;
+  int                  count;
+
+  cache_cost          *cost;
+  const void          *default_value;
+  hash_fn             *hash_fn;
+  hash_compare        *compare;
+  cache_destroy_key   *destroy_key;
+  cache_destroy_value *destroy_value;
+
+  cache__index_t      *bins;   /* heads of chains */
+  int                  log2bins;
+  datastruct_pool_t    pool;
+
+  cache__list_t        main;   /* LRU list, or S3-FIFO main queue */
+  cache__list_t        small;  /* S3-FIFO only */
+  cache__index_t       hand;   /* CLOCK only */
+  cache__ghost_t       ghost;  /* S3-FIFO only */
+
+  cache_counters_t     counters;
+};
+
+/* ----------------------------------------------------------------------- */
+
+/* Return the entry holding 'key', whose hash is 'hash', or NIL. */
+cache__index_t cache__find(const cache_t *c,
+                           const void    *key,
+                           unsigned int   hash);
+
+/* Add entry 'i', whose key and hash are set, to the table, growing it if
+ * it's full and memory allows. */
+void cache__link(cache_t *c, cache__index_t i);
+
+/* Take entry 'i' out of the table. */
+void cache__unlink(cache_t *c, cache__index_t i);
+
+/* ----------------------------------------------------------------------- */
+
+/* Place new entry 'i' according to the policy. */
+void cache__admit(cache_t *c, cache__index_t i, unsigned int hash);
+
+/* Note a use of entry 'i'. */
+void cache__touch(cache_t *c, cache__index_t i);
+
+/* Take entry 'i' out of the policy's lists ahead of removing it. */
+void cache__forget(cache_t *c, cache__index_t i);
+
+/* Evict one entry. The cache must not be empty. */
+void cache__evict(cache_t *c);
+
+/* Remove entry 'i', already forgotten, from the table then destroy it. */
+void cache__discard(cache_t *c, cache__index_t i);
+
+/* Free the ghost queue. */
+void cache__ghost_fini(cache_t *c);
+
+/* ----------------------------------------------------------------------- */
+
+#endif /* CACHE_IMPL_H */
@@ -0,0 +1,100 @@
+/* --------------------------------------------------------------------------
+ *    Name: index.c
+ * Purpose: Bounded associative array which evicts to stay within a budget
+ * ----------------------------------------------------------------------- */
+
+#include <stdlib.h>
+
+#include "base/memento/memento.h"
+
+#include "datastruct/cache.h"
+#include "datastruct/pool.h"
+
+#include "impl.h"
+
+/* Return the link which holds entry 'i'. */
+static cache__index_t *cache__find_link(cache_t *c, cache__index_t i)
+{
+  cache__index_t *link;
+
+  for (link = &c->bins[BIN(c, ENTRY(c, i)->hash)];
+       *link != i;
+       link = &ENTRY(c, *link)->chain)
+    ;
+
+  return link;
+}
+
+cache__index_t cache__find(const cache_t *c,
+                           const void    *key,
+                           unsigned int   hash)
+{
+  cache__index_t i;
+
+  for (i = c->bins[BIN(c, hash)]; i != NIL; i = ENTRY(c, i)->chain)
+  {
+    const cache__entry_t *e = ENTRY(c, i);
+
+    if (e->hash == hash && c->compare(e->key, key) == 0)
+      break;
+  }
+
+  return i;
+}
+
+/* Double the bins. Not fatal if there's no memory: the chains just grow
+ * longer. */
+static void cache__grow(cache_t *c)
+{
+  cache__index_t *old    = c->bins;
+  int             oldlog = c->log2bins;
+  cache__index_t *bins;
+  int             b;
+
+  bins = calloc((size_t) 2 << oldlog, sizeof(*bins));
+  if (bins == NULL)
+    return;
+
+  c->bins     = bins;
+  c->log2bins = oldlog + 1;
+
+  for (b = 0; b < (1 << oldlog); b++)
+  {
+    cache__index_t i;
+    cache__index_t next;
+
+    for (i = old[b]; i != NIL; i = next)
+    {
+      cache__entry_t *e = ENTRY(c, i);
+      cache__index_t *bin;
+
+      next     = e->chain;
+      bin      = &bins[BIN(c, e->hash)];
+      e->chain = *bin;
+      *bin     = i;
+    }
+  }
+
+  free(old);
+}
+
+void cache__link(cache_t *c, cache__index_t i)
+{
+  cache__entry_t *e = ENTRY(c, i);
+  cache__index_t *bin;
+
+  if (c->count >= (1 << c->log2bins))
+    cache__grow(c);
+
+  bin      = &c->bins[BIN(c, e->hash)];
+  e->chain = *bin;
+  *bin     = i;
+}
+
+void cache__unlink(cache_t *c, cache__index_t i)
+{
+  cache__index_t *link;
+
+  link  = cache__find_link(c, i);
+  *link = ENTRY(c, i)->chain;
+}
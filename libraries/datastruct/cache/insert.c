@@ -0,0 +1,96 @@
+/* --------------------------------------------------------------------------
+ *    Name: insert.c
+ * Purpose: Bounded associative array which evicts to stay within a budget
+ * ----------------------------------------------------------------------- */
+
+#include "base/errors.h"
+
+#include "datastruct/cache.h"
+#include "datastruct/pool.h"
+
+#include "impl.h"
+
+/* Update the value of existing entry 'i'. */
+static void cache__update(cache_t        *c,
+                          cache__index_t  i,
+                          const void     *key,
+                          const void     *value,
+                          size_t          cost)
+{
+  cache__entry_t *e = ENTRY(c, i);
+
+  c->destroy_value((void *) e->value); /* must cast away const */
+  c->destroy_key((void *) key); /* the entry keeps its own copy */
+
+  e->value = value;
+
+  c->used -= e->cost;
+  c->used += cost;
+
+  if (c->policy != cache_POLICY_CLOCK) /* CLOCK keeps no lists */
+  {
+    cache__list_t *l;
+
+    l = (e->queue == cache__QUEUE_SMALL) ? &c->small : &c->main;
+    l->used -= e->cost;
+    l->used += cost;
+  }
+
+  e->cost = cost;
+
+  cache__touch(c, i);
+
+  /* a grown entry may have pushed the cache over budget */
+  while (c->used > c->budget && c->count > 1)
+    cache__evict(c);
+}
+
+error cache_insert(cache_t    *c,
+                   const void *key,
+                   size_t      keylen,
+                   const void *value)
+{
+  size_t          cost;
+  unsigned int    hash;
+  cache__index_t  i;
+  cache__entry_t *e;
+
+  cost = c->cost ? c->cost(key, value) : 1;
+  hash = c->hash_fn(key);
+
+  i = cache__find(c, key, hash);
+  if (i != NIL)
+  {
+    cache__update(c, i, key, value, cost);
+    return error_OK;
+  }
+
+  /* make room first so that the new entry can't be chosen */
+  while (c->count > 0 && c->used + cost > c->budget)
+    cache__evict(c);
+
+  i = datastruct_pool_alloc(&c->pool);
+  if (i == NIL)
+    return error_OOM;
+
+  e = ENTRY(c, i);
+  e->key    = key;
+  e->value  = value;
+  e->keylen = keylen;
+  e->cost   = cost;
+  e->hash   = hash;
+  e->chain  = NIL;
+  e->prev   = NIL;
+  e->next   = NIL;
+  e->freq   = 0;
+  e->queue  = cache__QUEUE_MAIN;
+
+  cache__link(c, i);
+
+  c->used += cost;
+  c->count++;
+
+  cache__admit(c, i, hash);
+
+  return error_OK;
+}
@@ -0,0 +1,26 @@
+/* --------------------------------------------------------------------------
+ *    Name: lookup.c
+ * Purpose: Bounded associative array which evicts to stay within a budget
+ * ----------------------------------------------------------------------- */
+
+#include "datastruct/cache.h"
+
+#include "impl.h"
+
+const void *cache_lookup(cache_t *c, const void *key)
+{
+  cache__index_t i;
+
+  i = cache__find(c, key, c->hash_fn(key));
+  if (i == NIL)
+  {
+    c->counters.misses++;
+    return c->default_value;
+  }
+
+  c->counters.hits++;
+
+  cache__touch(c, i);
+
+  return ENTRY(c, i)->value;
+}
@@ -0,0 +1,20 @@
+/* --------------------------------------------------------------------------
+ *    Name: remove.c
+ * Purpose: Bounded associative array which evicts to stay within a budget
+ * ----------------------------------------------------------------------- */
+
+#include "datastruct/cache.h"
+
+#include "impl.h"
+
+void cache_remove(cache_t *c, const void *key)
+{
+  cache__index_t i;
+
+  i = cache__find(c, key, c->hash_fn(key));
+  if (i == NIL)
+    return;
+
+  cache__forget(c, i);
+  cache__discard(c, i);
+}
@@ -0,0 +1,40 @@
+/* --------------------------------------------------------------------------
+ *    Name: stats.c
+ * Purpose: Bounded associative array which evicts to stay within a budget
+ * ----------------------------------------------------------------------- */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "datastruct/cache.h"
+#include "datastruct/pool.h"
+
+#include "impl.h"
+
+void cache_stats(const cache_t *c, datastruct_stats_t *stats)
+{
+  const cache__ghost_t *g = &c->ghost;
+  size_t                entries;
+  size_t                bins;
+  size_t                unused;
+
+  /* each entry is a leaf of the table; pooled entries not in use count as
+   * slack */
+  entries = c->count * sizeof(cache__entry_t);
+  bins    = ((size_t) 1 << c->log2bins) * sizeof(*c->bins);
+  unused  = datastruct_pool_bytes(&c->pool) - entries;
+
+  memset(stats, 0, sizeof(*stats));
+
+  stats->elements    = c->count;
+  stats->leaves      = c->count;
+  stats->node_bytes  = entries;
+  stats->table_bytes = bins + unused;
+  stats->slack_bytes = unused;
+  stats->other_bytes = sizeof(*c) +
+                       g->nring * sizeof(*g->ring) +
+                       g->nset * sizeof(*g->set);
+
+  stats->total_bytes = stats->node_bytes + stats->table_bytes +
+                       stats->other_bytes;
+}
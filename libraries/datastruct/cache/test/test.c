@@ -0,0 +1,358 @@
+/* test.c */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/memento/memento.h"
+
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "datastruct/cache.h"
+
+error cachetest(void);
+
+/* ----------------------------------------------------------------------- */
+
+#define NKEYS 2000
+
+static int keys[NKEYS];
+
+static int destroyed; /* count of values destroyed */
+
+static unsigned int cachetest_hash(const void *a)
+{
+  return *(const int *) a * 2654435761u;
+}
+
+static int cachetest_compare(const void *a, const void *b)
+{
+  int ia = *(const int *) a;
+  int ib = *(const int *) b;
+
+  return (ia > ib) - (ia < ib);
+}
+
+static void cachetest_destroy_key(void *doomed)
+{
+  NOT_USED(doomed);
+}
+
+static void cachetest_destroy_value(void *doomed)
+{
+  NOT_USED(doomed);
+
+  destroyed++;
+}
+
+/* Every key's value is a pointer to the key itself. */
+static error cachetest_insert(cache_t *c, int k)
+{
+  return cache_insert(c, &keys[k], sizeof(int), &keys[k]);
+}
+
+static int cachetest_holds(cache_t *c, int k)
+{
+  return cache_lookup(c, &keys[k]) == &keys[k];
+}
+
+static error cachetest_create(cache_policy_t policy,
+                              size_t         budget,
+                              cache_cost    *cost,
+                              cache_t      **c)
+{
+  return cache_create(policy, budget, cost, NULL,
+                      cachetest_hash, cachetest_compare,
+                      cachetest_destroy_key, cachetest_destroy_value,
+                      c);
+}
+
+/* ----------------------------------------------------------------------- */
+
+/* Insert 0, 1, 2 into a cache of three, use 0, then insert 3. LRU and
+ * CLOCK should both evict 1. */
+static error cachetest1(void)
+{
+  static const cache_policy_t policies[] = { cache_POLICY_LRU,
+                                             cache_POLICY_CLOCK };
+
+  error            err;
+  int              p;
+  int              i;
+  cache_t         *c;
+  cache_counters_t counters;
+
+  printf("> cache test 1 - LRU and CLOCK eviction\n");
+
+  for (p = 0; p < NELEMS(policies); p++)
+  {
+    err = cachetest_create(policies[p], 3, NULL, &c);
+    if (err)
+      return err;
+
+    destroyed = 0;
+
+    for (i = 0; i < 3 && !err; i++)
+      err = cachetest_insert(c, i);
+    if (!err && !cachetest_holds(c, 0))
+      err = error_TEST_FAILED;
+    if (!err)
+      err = cachetest_insert(c, 3);
+    if (err)
+      goto failure;
+
+    cache_counters(c, &counters);
+
+    if (cache_count(c) != 3 || destroyed != 1 ||
+        counters.hits != 1 || counters.evictions != 1 ||
+        cachetest_holds(c, 1) ||
+        !cachetest_holds(c, 0) || !cachetest_holds(c, 2) ||
+        !cachetest_holds(c, 3))
+    {
+      printf("policy %d evicted the wrong entry\n", p);
+      err = error_TEST_FAILED;
+      goto failure;
+    }
+
+    cache_counters(c, &counters);
+    if (counters.misses != 1) /* the lookup of 1 */
+    {
+      printf("policy %d miscounted misses\n", p);
+      err = error_TEST_FAILED;
+      goto failure;
+    }
+
+    cache_remove(c, &keys[2]);
+    if (cache_count(c) != 2 || destroyed != 2)
+    {
+      printf("remove failed\n");
+      err = error_TEST_FAILED;
+      goto failure;
+    }
+
+    cache_destroy(c);
+
+    if (destroyed != 4)
+    {
+      printf("destroy missed values\n");
+      return error_TEST_FAILED;
+    }
+  }
+
+  return error_OK;
+
+
+failure:
+
+  cache_destroy(c);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+#define NHOT    20
+#define BUDGET  100
+
+/* Use a hot set of keys, then scan many keys once each. S3-FIFO should keep
+ * every hot key while LRU loses them all. */
+static error cachetest_scan(cache_policy_t policy, int *hot_kept)
+{
+  error    err;
+  cache_t *c;
+  int      round;
+  int      i;
+
+  err = cachetest_create(policy, BUDGET, NULL, &c);
+  if (err)
+    return err;
+
+  for (round = 0; round < 3 && !err; round++)
+    for (i = 0; i < NHOT && !err; i++)
+      if (!cachetest_holds(c, i))
+        err = cachetest_insert(c, i);
+
+  for (i = NHOT; i < NKEYS && !err; i++)
+    err = cachetest_insert(c, i);
+
+  if (!err && cache_count(c) != BUDGET)
+  {
+    printf("cache holds %d entries\n", cache_count(c));
+    err = error_TEST_FAILED;
+  }
+
+  *hot_kept = 0;
+  for (i = 0; i < NHOT; i++)
+    if (cachetest_holds(c, i))
+      (*hot_kept)++;
+
+  cache_destroy(c);
+
+  return err;
+}
+
+static error cachetest2(void)
+{
+  error err;
+  int   lru_kept;
+  int   s3fifo_kept;
+
+  printf("> cache test 2 - S3-FIFO scan resistance\n");
+
+  err = cachetest_scan(cache_POLICY_LRU, &lru_kept);
+  if (!err)
+    err = cachetest_scan(cache_POLICY_S3FIFO, &s3fifo_kept);
+  if (err)
+    return err;
+
+  printf("hot keys kept: LRU %d, S3-FIFO %d of %d\n",
+         lru_kept, s3fifo_kept, NHOT);
+
+  if (lru_kept != 0 || s3fifo_kept != NHOT)
+    return error_TEST_FAILED;
+
+  return error_OK;
+}
+
+/* ----------------------------------------------------------------------- */
+
+static size_t cachetest_cost(const void *key, const void *value)
+{
+  NOT_USED(value);
+
+  return 1 + *(const int *) key % 4; /* 1..4 'bytes' */
+}
+
+static error cachetest3(void)
+{
+  static const cache_policy_t policies[] = { cache_POLICY_LRU,
+                                             cache_POLICY_CLOCK,
+                                             cache_POLICY_S3FIFO };
+
+  error    err;
+  int      p;
+  int      i;
+  cache_t *c;
+
+  printf("> cache test 3 - byte budgets\n");
+
+  for (p = 0; p < NELEMS(policies); p++)
+  {
+    err = cachetest_create(policies[p], 50, cachetest_cost, &c);
+    if (err)
+      return err;
+
+    destroyed = 0;
+
+    for (i = 0; i < NKEYS && !err; i++)
+    {
+      err = cachetest_insert(c, i);
+      if (!err && cache_used(c) > 50)
+      {
+        printf("policy %d used %zu of 50\n", p, cache_used(c));
+        err = error_TEST_FAILED;
+      }
+      if (!err && i % 3 == 0)
+        (void) cachetest_holds(c, i / 2);
+    }
+
+    if (!err && destroyed != NKEYS - cache_count(c))
+    {
+      printf("policy %d destroyed %d values\n", p, destroyed);
+      err = error_TEST_FAILED;
+    }
+
+    cache_destroy(c);
+
+    if (err)
+      return err;
+  }
+
+  return error_OK;
+}
+
+/* A byte budget gives no hint of how many entries there will be, so the
+ * table must grow from its initial size as the cache fills. Every key must
+ * stay reachable through each growth and after removals. */
+static error cachetest4(void)
+{
+  error              err;
+  int                i;
+  cache_t           *c;
+  datastruct_stats_t stats;
+
+  printf("> cache test 4 - table growth\n");
+
+  err = cachetest_create(cache_POLICY_LRU, NKEYS * 4, cachetest_cost, &c);
+  if (err)
+    return err;
+
+  for (i = 0; i < NKEYS && !err; i++)
+    err = cachetest_insert(c, i);
+
+  for (i = 0; i < NKEYS && !err; i++)
+    if (!cachetest_holds(c, i))
+    {
+      printf("key %d lost\n", i);
+      err = error_TEST_FAILED;
+    }
+
+  if (!err)
+  {
+    /* as many bins as entries, so at least a pointer's worth per entry */
+    cache_stats(c, &stats);
+    if (stats.elements != NKEYS ||
+        stats.table_bytes - stats.slack_bytes < NKEYS * sizeof(int))
+    {
+      printf("stats: %d elements, %zu table bytes\n",
+             stats.elements, stats.table_bytes - stats.slack_bytes);
+      err = error_TEST_FAILED;
+    }
+  }
+
+  for (i = 0; i < NKEYS && !err; i += 2)
+    cache_remove(c, &keys[i]);
+
+  for (i = 0; i < NKEYS && !err; i++)
+    if (cachetest_holds(c, i) != (i & 1))
+    {
+      printf("key %d %s after removals\n", i, (i & 1) ? "lost" : "kept");
+      err = error_TEST_FAILED;
+    }
+
+  cache_destroy(c);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+error cachetest(void)
+{
+  error err;
+  int   i;
+
+  printf(">> cache test\n");
+
+  for (i = 0; i < NKEYS; i++)
+    keys[i] = i;
+
+  err = cachetest1();
+  if (!err)
+    err = cachetest2();
+  if (!err)
+    err = cachetest3();
+  if (!err)
+    err = cachetest4();
+  if (err)
+  {
+    printf("unexpected error: %lx\n", err);
+    return err;
+  }
+
+  printf("<< cache tests ok\n");
+
+  return error_OK;
+}
@@ -0,0 +1,112 @@
+/* --------------------------------------------------------------------------
+ *    Name: walk.c
+ * Purpose: Bounded associative array which evicts to stay within a budget
+ * ----------------------------------------------------------------------- */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/memento/memento.h"
+
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "datastruct/cache.h"
+#include "datastruct/pool.h"
+
+#include "impl.h"
+
+/* Order entries by key as memcmp, shorter keys first. */
+static int cache__compare_entries(const void *a_, const void *b_)
+{
+  const cache__entry_t *a = *(const cache__entry_t **) a_;
+  const cache__entry_t *b = *(const cache__entry_t **) b_;
+  int                   d;
+
+  d = memcmp(a->key, b->key, MIN(a->keylen, b->keylen));
+  if (d)
+    return d;
+
+  return (a->keylen > b->keylen) - (a->keylen < b->keylen);
+}
+
+static error cache__call(const cache__entry_t *e,
+                         cache_found_callback *cb,
+                         void                 *opaque)
+{
+  item_t item;
+
+  item.key    = e->key;
+  item.keylen = e->keylen;
+  item.value  = e->value;
+
+  return cb(&item, opaque);
+}
+
+error cache_lookup_prefix(const cache_t        *c,
+                          const void           *prefix,
+                          size_t                prefixlen,
+                          cache_found_callback *cb,
+                          void                 *opaque)
+{
+  error                  err;
+  const cache__entry_t **found;
+  int                    nfound;
+  cache__index_t         i;
+  int                    j;
+
+  if (c->count == 0)
+    return error_NOT_FOUND;
+
+  found = malloc(c->count * sizeof(*found));
+  if (found == NULL)
+    return error_OOM;
+
+  /* every index below 'next' has been handed out at some point */
+  nfound = 0;
+  for (i = 1; i < c->pool.next; i++)
+  {
+    const cache__entry_t *e = ENTRY(c, i);
+
+    if (e->queue == cache__QUEUE_FREE ||
+        e->keylen < prefixlen ||
+        memcmp(e->key, prefix, prefixlen) != 0)
+      continue;
+
+    found[nfound++] = e;
+  }
+
+  qsort(found, nfound, sizeof(*found), cache__compare_entries);
+
+  err = error_OK;
+  for (j = 0; j < nfound && !err; j++)
+    err = cache__call(found[j], cb, opaque);
+
+  free(found);
+
+  if (err)
+    return err;
+
+  return nfound ? error_OK : error_NOT_FOUND;
+}
+
+error cache_walk(const cache_t *c, cache_found_callback *cb, void *opaque)
+{
+  cache__index_t i;
+
+  for (i = 1; i < c->pool.next; i++)
+  {
+    const cache__entry_t *e = ENTRY(c, i);
+    error                 err;
+
+    if (e->queue == cache__QUEUE_FREE)
+      continue;
+
+    err = cache__call(e, cb, opaque);
+    if (err)
+      return err;
+  }
+
+  return error_OK;
+}
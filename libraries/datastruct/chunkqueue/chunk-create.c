@@ -0,0 +1,36 @@
+/* --------------------------------------------------------------------------
+ *    Name: chunk-create.c
+ * Purpose: Unbounded queue implemented as a list of fixed-size chunks
+ * ----------------------------------------------------------------------- */
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "base/memento/memento.h"
+
+#include "datastruct/chunkqueue.h"
+
+#include "impl.h"
+
+/* Return a chunk from the free list, or allocate a new one if it's empty. */
+chunkqueue__chunk_t *chunkqueue__chunk_create(chunkqueue_t *q)
+{
+  chunkqueue__chunk_t *c;
+
+  c = q->free;
+  if (c)
+  {
+    q->free = c->next;
+  }
+  else
+  {
+    c = malloc(offsetof(chunkqueue__chunk_t, buffer) +
+               q->chunkelems * q->width);
+    if (c == NULL)
+      return NULL;
+  }
+
+  c->next = NULL;
+
+  return c;
+}
@@ -0,0 +1,13 @@
+/* --------------------------------------------------------------------------
+ *    Name: count.c
+ * Purpose: Unbounded queue implemented as a list of fixed-size chunks
+ * ----------------------------------------------------------------------- */
+
+#include "datastruct/chunkqueue.h"
+
+#include "impl.h"
+
+int chunkqueue_count(const chunkqueue_t *q)
+{
+  return q->count;
+}
@@ -0,0 +1,43 @@
+/* --------------------------------------------------------------------------
+ *    Name: create.c
+ * Purpose: Unbounded queue implemented as a list of fixed-size chunks
+ * ----------------------------------------------------------------------- */
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "base/memento/memento.h"
+
+#include "datastruct/chunkqueue.h"
+
+#include "impl.h"
+
+/* Note: The parameter 'length' in the header is called 'width' here. */
+chunkqueue_t *chunkqueue_create(int chunkelems, size_t width)
+{
+  chunkqueue_t *q;
+
+  if (chunkelems < 1)
+    chunkelems = 1;
+
+  q = malloc(sizeof(*q));
+  if (q == NULL)
+    return NULL;
+
+  q->free       = NULL;
+  q->count      = 0;
+  q->chunkelems = chunkelems;
+  q->width      = width;
+
+  q->head = chunkqueue__chunk_create(q);
+  if (q->head == NULL)
+  {
+    free(q);
+    return NULL;
+  }
+
+  q->headp = q->tailp = &q->head->buffer[0];
+  q->tail  = q->head;
+
+  return q;
+}
@@ -0,0 +1,44 @@
+/* --------------------------------------------------------------------------
+ *    Name: dequeue.c
+ * Purpose: Unbounded queue implemented as a list of fixed-size chunks
+ * ----------------------------------------------------------------------- */
+
+#include <string.h>
+
+#include "base/errors.h"
+
+#include "datastruct/chunkqueue.h"
+
+#include "impl.h"
+
+error chunkqueue_dequeue(chunkqueue_t *q, void *value)
+{
+  if (chunkqueue_empty(q))
+    return error_QUEUE_EMPTY;
+
+  if (q->headp == CHUNK_END(q, q->head))
+  {
+    chunkqueue__chunk_t *c;
+
+    /* head chunk is drained: move it to the free list */
+
+    c = q->head;
+
+    q->head  = c->next;
+    q->headp = &q->head->buffer[0];
+
+    c->next = q->free;
+    q->free = c;
+  }
+
+  memcpy(value, q->headp, q->width);
+  q->headp += q->width;
+
+  if (--q->count == 0)
+  {
+    /* the queue is now empty, so rewind to the start of the current chunk */
+    q->headp = q->tailp = &q->head->buffer[0];
+  }
+
+  return error_OK;
+}
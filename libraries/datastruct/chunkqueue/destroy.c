@@ -0,0 +1,34 @@
+/* --------------------------------------------------------------------------
+ *    Name: destroy.c
+ * Purpose: Unbounded queue implemented as a list of fixed-size chunks
+ * ----------------------------------------------------------------------- */
+
+#include <stdlib.h>
+
+#include "base/memento/memento.h"
+
+#include "datastruct/chunkqueue.h"
+
+#include "impl.h"
+
+static void chunkqueue__destroy_chunks(chunkqueue__chunk_t *c)
+{
+  chunkqueue__chunk_t *next;
+
+  for (; c; c = next)
+  {
+    next = c->next;
+    free(c);
+  }
+}
+
+void chunkqueue_destroy(chunkqueue_t *doomed)
+{
+  if (doomed == NULL)
+    return;
+
+  chunkqueue__destroy_chunks(doomed->head);
+  chunkqueue__destroy_chunks(doomed->free);
+
+  free(doomed);
+}
@@ -0,0 +1,37 @@
+/* --------------------------------------------------------------------------
+ *    Name: enqueue.c
+ * Purpose: Unbounded queue implemented as a list of fixed-size chunks
+ * ----------------------------------------------------------------------- */
+
+#include <string.h>
+
+#include "base/errors.h"
+
+#include "datastruct/chunkqueue.h"
+
+#include "impl.h"
+
+error chunkqueue_enqueue(chunkqueue_t *q, const void *value)
+{
+  if (q->tailp == CHUNK_END(q, q->tail))
+  {
+    chunkqueue__chunk_t *c;
+
+    /* tail chunk is full: link on another */
+
+    c = chunkqueue__chunk_create(q);
+    if (c == NULL)
+      return error_OOM;
+
+    q->tail->next = c;
+    q->tail       = c;
+    q->tailp      = &c->buffer[0];
+  }
+
+  memcpy(q->tailp, value, q->width);
+  q->tailp += q->width;
+
+  q->count++;
+
+  return error_OK;
+}
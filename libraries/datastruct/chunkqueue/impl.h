@@ -0,0 +1,45 @@
+/* --------------------------------------------------------------------------
+ *    Name: impl.h
+ * Purpose: Unbounded queue implemented as a list of fixed-size chunks
+ * ----------------------------------------------------------------------- */
+
+/* Elements are enqueued at 'tailp' in the 'tail' chunk and dequeued from
+ * 'headp' in the 'head' chunk. Chunks are linked from head to tail. When the
+ * head chunk is drained it moves onto the free list. */
+
+#ifndef CHUNKQUEUE_IMPL_H
+#define CHUNKQUEUE_IMPL_H
+
+#include <stddef.h>
+
+typedef struct chunkqueue__chunk
+{
+  struct chunkqueue__chunk *next;
+  char                      buffer[1];
+}
+chunkqueue__chunk_t;
+
+struct chunkqueue
+{
+  chunkqueue__chunk_t *head;
+  char                *headp;
+  chunkqueue__chunk_t *tail;
+  char                *tailp;
+
+  chunkqueue__chunk_t *free;  /* drained chunks awaiting reuse */
+
+  int                  count;
+  int                  chunkelems;
+  size_t               width;
+};
+
+/* Returns the end of the specified chunk's buffer. */
+#define CHUNK_END(q, c) ((c)->buffer + (q)->chunkelems * (q)->width)
+
+/* ----------------------------------------------------------------------- */
+
+chunkqueue__chunk_t *chunkqueue__chunk_create(chunkqueue_t *q);
+
+/* ----------------------------------------------------------------------- */
+
+#endif /* CHUNKQUEUE_IMPL_H */
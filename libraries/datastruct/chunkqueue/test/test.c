@@ -0,0 +1,194 @@
+/* test.c */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "base/memento/memento.h"
+
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "datastruct/chunkqueue.h"
+
+error chunkqueuetest(void);
+
+/* enqueue and dequeue many more values than fit in a single chunk */
+static error chunkqueuetest1(void)
+{
+  const int     chunkelems = 4;
+  const int     max        = 1000;
+
+  error         err;
+  chunkqueue_t *q;
+  int           i;
+  int           next;
+  int           v;
+
+  printf("> chunkqueue test 1 - ints\n");
+
+  q = chunkqueue_create(chunkelems, sizeof(int));
+  if (q == NULL)
+    return error_OOM;
+
+  err = chunkqueue_dequeue(q, &v);
+  if (err != error_QUEUE_EMPTY)
+  {
+    printf("dequeue from empty queue didn't fail!\n");
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+  /* enqueue two, dequeue one, so that the queue spans many chunks and the
+   * head chunk is drained and recycled as we go */
+
+  next = 0;
+  for (i = 0; i < max; i++)
+  {
+    int j;
+
+    for (j = 0; j < 2; j++)
+    {
+      v = i * 2 + j;
+      err = chunkqueue_enqueue(q, &v);
+      if (err)
+        goto exit;
+    }
+
+    err = chunkqueue_dequeue(q, &v);
+    if (err)
+      goto exit;
+
+    if (v != next++)
+    {
+      printf("values didn't match! (got %d, expected %d)\n", v, next - 1);
+      err = error_TEST_FAILED;
+      goto exit;
+    }
+  }
+
+  printf("count after interleaving: %d\n", chunkqueue_count(q));
+  if (chunkqueue_count(q) != max)
+  {
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+  /* drain */
+
+  while (!chunkqueue_empty(q))
+  {
+    err = chunkqueue_dequeue(q, &v);
+    if (err)
+      goto exit;
+
+    if (v != next++)
+    {
+      printf("values didn't match! (got %d, expected %d)\n", v, next - 1);
+      err = error_TEST_FAILED;
+      goto exit;
+    }
+  }
+
+  if (next != max * 2)
+  {
+    printf("wrong number of values dequeued\n");
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+  err = error_OK;
+
+exit:
+
+  chunkqueue_destroy(q);
+
+  return err;
+}
+
+/* test wider-than-int values and refilling after emptying */
+static error chunkqueuetest2(void)
+{
+  typedef struct testdata
+  {
+    int         num;
+    const char *name;
+  }
+  testdata;
+
+  static const testdata values[] =
+  {
+    { 1, "John"   },
+    { 2, "Paul"   },
+    { 3, "George" },
+    { 4, "Ringo"  },
+    { 5, "Dave"   },
+  };
+
+  error         err;
+  chunkqueue_t *q;
+  int           round;
+  int           i;
+  testdata      v;
+
+  printf("> chunkqueue test 2 - structs\n");
+
+  q = chunkqueue_create(2, sizeof(testdata));
+  if (q == NULL)
+    return error_OOM;
+
+  for (round = 0; round < 3; round++)
+  {
+    for (i = 0; i < NELEMS(values); i++)
+    {
+      err = chunkqueue_enqueue(q, &values[i]);
+      if (err)
+        goto exit;
+    }
+
+    for (i = 0; i < NELEMS(values); i++)
+    {
+      err = chunkqueue_dequeue(q, &v);
+      if (err)
+        goto exit;
+
+      printf("dequeue: %d/%s (new count=%d)\n", v.num, v.name, chunkqueue_count(q));
+      if (v.num != values[i].num)
+      {
+        printf("values didn't match!\n");
+        err = error_TEST_FAILED;
+        goto exit;
+      }
+    }
+  }
+
+  err = error_OK;
+
+exit:
+
+  chunkqueue_destroy(q);
+
+  return err;
+}
+
+error chunkqueuetest(void)
+{
+  error e1, e2;
+
+  printf(">> chunkqueue test\n");
+
+  e1 = chunkqueuetest1();
+  if (e1)
+    printf("unexpected error: %lx\n", e1);
+
+  e2 = chunkqueuetest2();
+  if (e2)
+    printf("unexpected error: %lx\n", e2);
+
+  if (e1 || e2)
+    return e1 != error_OK ? e1 : e2;
+
+  printf("<< chunkqueue tests ok\n");
+
+  return error_OK;
+}
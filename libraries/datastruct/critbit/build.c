@@ -0,0 +1,185 @@
+/* --------------------------------------------------------------------------
+ *    Name: build.c
+ * Purpose: Associative array implemented as a critbit tree
+ * ----------------------------------------------------------------------- */
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "base/memento/memento.h"
+
+#include "base/errors.h"
+
+#include "utils/utils.h"
+
+#include "datastruct/critbit.h"
+
+#include "impl.h"
+
+/* Keys arriving in order are always added at the far right of the tree, so
+ * only the right spine - the internal nodes reached from the root by
+ * following child[1] - is ever modified. Crit bits increase down the spine.
+ * The new key's crit bit against its predecessor says where on the spine
+ * it forks off: above the first node testing a later bit. */
+
+typedef struct critbit__spine
+{
+  critbit__node_t *n;
+  int              nbit;
+}
+critbit__spine_t;
+
+static error critbit__build_sorted(critbit_t          *t,
+                                   critbit_build_next *next,
+                                   void               *opaque)
+{
+  error               err;
+  critbit__spine_t   *spine     = NULL;
+  int                 depth     = 0;
+  int                 maxdepth  = 0;
+  item_t              prev;
+  item_t              item;
+  critbit__extnode_t *newextnode;
+
+  err = next(&item, opaque);
+  if (err == error_NOT_FOUND)
+    return error_OK; /* no keys */
+  if (err)
+    return err;
+
+  newextnode = critbit__extnode_create(t, item.key, item.keylen, item.value);
+  if (newextnode == NULL)
+    return error_OOM;
+
+  PUBLISH(&t->root, TO_STORE(newextnode));
+
+  INSTRUMENT_END(t, INSERT);
+
+  prev = newextnode->item;
+
+  for (;;)
+  {
+    const unsigned char *ukey;
+    int                  nbit;
+    int                  newbyte;
+    unsigned int         newotherbits;
+    critbit__node_t     *newnode;
+    critbit__node_t    **pn;
+
+    err = next(&item, opaque);
+    if (err == error_NOT_FOUND)
+    {
+      err = error_OK;
+      break;
+    }
+    if (err)
+      break;
+
+    INSTRUMENT_COMPARE(t);
+
+    ukey = item.key;
+
+    nbit = keydiffbit(prev.key, prev.keylen, ukey, item.keylen);
+    if (nbit == -1)
+    {
+      err = error_CLASHES;
+      break;
+    }
+
+    newotherbits = 1 << (7 - (nbit & 0x07));
+    newotherbits ^= 255;
+
+    newbyte = nbit >> 3;
+
+    /* a later key has the crit bit set */
+    if (GET_DIR(ukey, ukey + item.keylen, newbyte, newotherbits) != 1)
+    {
+      err = error_CRITBIT_UNSORTED;
+      break;
+    }
+
+    /* unwind the spine to the point where the new key forks off */
+    while (depth > 0 && spine[depth - 1].nbit > nbit)
+      depth--;
+
+    pn = (depth > 0) ? &spine[depth - 1].n->child[1] : &t->root;
+
+    if (depth == maxdepth)
+    {
+      critbit__spine_t *newspine;
+
+      maxdepth = maxdepth ? maxdepth * 2 : 64;
+      newspine = realloc(spine, maxdepth * sizeof(*spine));
+      if (newspine == NULL)
+      {
+        err = error_OOM;
+        break;
+      }
+
+      spine = newspine;
+    }
+
+    newextnode = critbit__extnode_create(t, item.key, item.keylen, item.value);
+    if (newextnode == NULL)
+    {
+      err = error_OOM;
+      break;
+    }
+
+    newnode = critbit__node_create(t, newbyte, (uint8_t) newotherbits);
+    if (newnode == NULL)
+    {
+      critbit__extnode_destroy(t, newextnode);
+      err = error_OOM;
+      break;
+    }
+
+    newnode->child[0] = *pn;
+    newnode->child[1] = TO_STORE(newextnode);
+
+    PUBLISH(pn, newnode);
+
+    INSTRUMENT_END(t, INSERT);
+
+    spine[depth].n    = newnode;
+    spine[depth].nbit = nbit;
+    depth++;
+
+    /* with inline keys this points at the copy held in the node */
+    prev = newextnode->item;
+  }
+
+  free(spine);
+
+  return err;
+}
+
+error critbit_build_sorted(critbit_t          *t,
+                           critbit_build_next *next,
+                           void               *opaque)
+{
+  error  err;
+  item_t item;
+
+  if (t->origin)
+    return error_READ_ONLY; /* snapshot */
+
+  critbit__lock(t);
+  if (t->root == NULL)
+  {
+    err = critbit__build_sorted(t, next, opaque);
+    critbit__unlock(t);
+    return err;
+  }
+  critbit__unlock(t);
+
+  /* the tree already holds keys: insert the new ones one by one */
+  while ((err = next(&item, opaque)) == error_OK)
+  {
+    err = critbit_insert(t, item.key, item.keylen, item.value);
+    if (err)
+      return err;
+  }
+
+  return err == error_NOT_FOUND ? error_OK : err;
+}
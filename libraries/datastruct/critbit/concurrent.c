@@ -0,0 +1,35 @@
+/* --------------------------------------------------------------------------
+ *    Name: concurrent.c
+ * Purpose: Associative array implemented as a critbit tree
+ * ----------------------------------------------------------------------- */
+
+#include <pthread.h>
+
+#include "utils/epoch.h"
+
+#include "datastruct/critbit.h"
+
+#include "impl.h"
+
+void critbit__lock(const critbit_t *t)
+{
+  if (t->epoch)
+    pthread_mutex_lock((pthread_mutex_t *) &t->lock); /* cast away const */
+}
+
+void critbit__unlock(const critbit_t *t)
+{
+  if (t->epoch)
+    pthread_mutex_unlock((pthread_mutex_t *) &t->lock);
+}
+
+int critbit_read_begin(const critbit_t *t)
+{
+  return t->epoch ? epoch_enter(t->epoch) : 0;
+}
+
+void critbit_read_end(const critbit_t *t, int token)
+{
+  if (t->epoch)
+    epoch_leave(t->epoch, token);
+}
@@ -9,6 +9,12 @@
 
 int critbit_count(critbit_t *t)
 {
-  return t->intcount + t->extcount;
+  int count;
+
+  critbit__lock(t);
+  count = t->intcount + t->extcount;
+  critbit__unlock(t);
+
+  return count;
 }
 
@@ -3,6 +3,7 @@
  * Purpose: Associative array implemented as a critbit tree
  * ----------------------------------------------------------------------- */
 
+#include <assert.h>
 #include <stddef.h>
 #include <stdlib.h>
 
@@ -28,14 +29,70 @@ error critbit_create(const void             *default_value,
 
   t->root          = NULL;
   t->default_value = default_value;
+  t->inline_keys   = 0;
+  t->inline_bytes  = 0;
   t->destroy_key   = destroy_key;
   t->destroy_value = destroy_value;
 
   t->intcount      = 0;
   t->extcount      = 0;
 
+  INSTRUMENT_INIT(t);
+
+  t->epoch         = NULL;
+
+  t->gen           = 0;
+  t->origin        = NULL;
+  t->snapshots     = NULL;
+  t->next          = NULL;
+  t->retired       = NULL;
+
+  *pt = t;
+
+  return error_OK;
+}
+
+error critbit_create_concurrent(const void             *default_value,
+                                critbit_destroy_key    *destroy_key,
+                                critbit_destroy_value  *destroy_value,
+                                critbit_t             **pt)
+{
+  error      err;
+  critbit_t *t;
+
+  err = critbit_create(default_value, destroy_key, destroy_value, &t);
+  if (err)
+    return err;
+
+  err = epoch_create(&t->epoch);
+  if (err)
+    goto failure;
+
+  if (pthread_mutex_init(&t->lock, NULL) != 0)
+  {
+    epoch_destroy(t->epoch);
+    t->epoch = NULL;
+    err = error_OOM;
+    goto failure;
+  }
+
   *pt = t;
 
   return error_OK;
+
+
+failure:
+
+  critbit_destroy(t);
+
+  return err;
 }
 
+
+void critbit_set_inline_keys(critbit_t *t)
+{
+  assert(t->root == NULL);
+  assert(t->origin == NULL);
+
+  t->inline_keys = 1;
+}
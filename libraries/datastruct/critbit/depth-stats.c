@@ -0,0 +1,56 @@
+/* --------------------------------------------------------------------------
+ *    Name: depth-stats.c
+ * Purpose: Associative array implemented as a critbit tree
+ * ----------------------------------------------------------------------- */
+
+#include <stddef.h>
+
+#include "base/errors.h"
+
+#include "datastruct/critbit.h"
+
+#include "impl.h"
+
+error critbit_depth_stats(const critbit_t *t, datastruct_depth_stats_t *stats)
+{
+  error                    err;
+  datastruct_depth_stack_t stack;
+  datastruct_depth_entry_t e;
+
+  datastruct_depth_init(stats);
+  datastruct_depth_stack_init(&stack);
+
+  critbit__lock(t);
+
+  err = error_OK;
+  if (t->root)
+    err = datastruct_depth_stack_push(&stack, t->root, 0, 0);
+
+  while (!err && datastruct_depth_stack_pop(&stack, &e))
+  {
+    const critbit__node_t *n = e.node;
+    int                    chained;
+    int                    i;
+
+    if (IS_EXTERNAL(n))
+    {
+      datastruct_depth_add(stats, e.depth);
+      continue;
+    }
+
+    /* internal nodes always have two children */
+    chained = datastruct_depth_branch(stats, 2, e.chained);
+
+    for (i = 0; i < 2 && !err; i++)
+      err = datastruct_depth_stack_push(&stack, n->child[i], e.depth + 1,
+                                        chained);
+  }
+
+  critbit__unlock(t);
+
+  datastruct_depth_stack_fini(&stack);
+
+  datastruct_depth_finish(stats);
+
+  return err;
+}
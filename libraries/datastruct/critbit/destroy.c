@@ -3,6 +3,7 @@
  * Purpose: Associative array implemented as a critbit tree
  * ----------------------------------------------------------------------- */
 
+#include <assert.h>
 #include <stdlib.h>
 
 #include "base/memento/memento.h"
@@ -29,6 +30,27 @@ static error critbit__destroy_node(critbit__node_t *n,
 
 void critbit_destroy(critbit_t *t)
 {
+  if (t->origin)
+  {
+    critbit__snapshot_destroy(t);
+    return;
+  }
+
+  /* snapshots share this tree's nodes so must be destroyed first */
+  assert(t->snapshots == NULL);
+
+  critbit__reclaim(t); /* frees all retired nodes */
+
+  if (t->epoch)
+  {
+    /* nothing can be reading now: free any retired nodes then revert to
+     * freeing nodes immediately */
+    epoch_destroy(t->epoch);
+    t->epoch = NULL;
+
+    pthread_mutex_destroy(&t->lock);
+  }
+
   (void) critbit__walk_internal(t,
                                 critbit_WALK_POST_ORDER |
                                 critbit_WALK_LEAVES     |
@@ -5,6 +5,7 @@
 
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "base/memento/memento.h"
 
@@ -23,15 +24,34 @@ critbit__extnode_t *critbit__extnode_create(critbit_t  *t,
    * boundary, leaving us the bottom bit spare to use as as a node type flag.
    */
 
-  n = malloc(sizeof(*n));
-  if (n == NULL)
-    return NULL;
+  if (t->inline_keys)
+  {
+    /* the key's bytes follow the node so short keys share its cache line.
+     * a terminator is added so that string keys remain strings. */
+    n = malloc(offsetof(critbit__extnode_t, key) + keylen + 1);
+    if (n == NULL)
+      return NULL;
+
+    memcpy(n->key, key, keylen);
+    n->key[keylen] = '\0';
+    key = n->key;
+  }
+  else
+  {
+    n = malloc(sizeof(*n));
+    if (n == NULL)
+      return NULL;
+  }
 
   n->item.key    = key;
   n->item.keylen = keylen;
   n->item.value  = value;
+  n->gen         = t->gen;
+
+  INSTRUMENT_ALLOC(t);
 
   t->extcount++;
+  t->inline_bytes += critbit__inline_bytes(t, n);
 
   return n;
 }
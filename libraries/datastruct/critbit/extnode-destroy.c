@@ -6,6 +6,7 @@
 #include <stdlib.h>
 
 #include "base/memento/memento.h"
+#include "base/types.h"
 
 #include "datastruct/critbit.h"
 
@@ -13,18 +14,51 @@
 
 void critbit__extnode_clear(critbit_t *t, critbit__extnode_t *n)
 {
-  if (t->destroy_key && n->item.key)
+  if (t->destroy_key && n->item.key && !t->inline_keys)
     t->destroy_key((void *) n->item.key); /* must cast away const */
   if (t->destroy_value && n->item.value)
     t->destroy_value((void *) n->item.value);
 }
 
+static void critbit__extnode_free_clear(void *block, void *opaque)
+{
+  critbit__extnode_clear(opaque, block);
+
+  free(block);
+}
+
+static void critbit__extnode_free_only(void *block, void *opaque)
+{
+  NOT_USED(opaque);
+
+  free(block);
+}
+
+void critbit__extnode_free(critbit_t *t, critbit__extnode_t *n, int clear)
+{
+  epoch_free *fn;
+
+  fn = clear ? critbit__extnode_free_clear : critbit__extnode_free_only;
+  if (t->epoch)
+    epoch_retire(t->epoch, n, fn, t);
+  else
+    fn(n, t);
+}
+
 void critbit__extnode_destroy(critbit_t *t, critbit__extnode_t *n)
 {
-  critbit__extnode_clear(t, n);
+  size_t bytes;
+
+  bytes = critbit__inline_bytes(t, n); /* 'n' may be freed next */
+
+  if (critbit__is_shared(t, n->gen))
+    critbit__retire(t, TO_STORE(n), 1);
+  else
+    critbit__extnode_free(t, n, 1);
 
-  free(n);
+  INSTRUMENT_FREE(t);
 
   t->extcount--;
+  t->inline_bytes -= bytes;
 }
 
@@ -6,8 +6,14 @@
 #ifndef CRITBIT_IMPL_H
 #define CRITBIT_IMPL_H
 
+#include <pthread.h>
+
+#include "base/atomic.h"
 #include "base/types.h"
 
+#include "utils/epoch.h"
+
+#include "datastruct/instrument.h"
 #include "datastruct/item.h"
 
 #include "datastruct/critbit.h"
@@ -18,6 +24,8 @@
 typedef struct critbit__extnode
 {
   item_t                   item;
+  unsigned int             gen;       /* generation created in */
+  unsigned char            key[];     /* the key, if inline_keys */
 }
 critbit__extnode_t;
 
@@ -29,9 +37,20 @@ typedef struct critbit__node
   struct critbit__node    *child[2];  /* left, right children */
   int                      byte;      /* byte offset of critical bit */
   unsigned char            otherbits; /* inverted mask of critical bit */
+  unsigned int             gen;       /* generation created in */
 }
 critbit__node_t;
 
+/* a node unlinked from the tree but still reachable from a snapshot */
+typedef struct critbit__retired
+{
+  struct critbit__retired *next;
+  critbit__node_t         *n;         /* internal or external */
+  unsigned int             died;      /* generation unlinked in */
+  int                      clear;     /* destroy the key and value too */
+}
+critbit__retired_t;
+
 struct critbit
 {
   critbit__node_t         *root;
@@ -41,8 +60,29 @@ struct critbit
 
   const void              *default_value;
 
+  int                      inline_keys; /* keys are copied into extnodes */
+  size_t                   inline_bytes; /* bytes they occupy, with terminators */
+
   critbit_destroy_key     *destroy_key;
   critbit_destroy_value   *destroy_value;
+
+  /* concurrent mode - 'epoch' is NULL otherwise */
+  epoch_t                 *epoch;
+  pthread_mutex_t          lock;     /* serialises writers */
+
+  /* Snapshots. Every snapshot takes the current generation as its id then
+   * the generation advances. A node belongs to every snapshot taken
+   * between the generation it was created in and the one it was unlinked
+   * in, so it must not be modified or freed while such a snapshot lives. */
+  unsigned int             gen;       /* current generation or snapshot id */
+  struct critbit          *origin;    /* tree a snapshot was taken of */
+  struct critbit          *snapshots; /* live snapshots of this tree... */
+  struct critbit          *next;      /* ...chained through here */
+  critbit__retired_t      *retired;   /* unlinked nodes awaiting release */
+
+#ifdef DATASTRUCT_INSTRUMENT
+  datastruct_instrument_t  instrument;
+#endif
 };
 
 /* ----------------------------------------------------------------------- */
@@ -60,14 +100,58 @@ critbit__extnode_t *critbit__extnode_create(critbit_t  *t,
 
 void critbit__extnode_clear(critbit_t *t, critbit__extnode_t *n);
 
+/* Bytes of inline key held by extnode 'n', or zero. */
+#define critbit__inline_bytes(t, n) \
+  ((t)->inline_keys ? (n)->item.keylen + 1 : 0)
+
 void critbit__extnode_destroy(critbit_t *t, critbit__extnode_t *n);
 
-const critbit__extnode_t *critbit__lookup(const critbit__node_t *n,
+/* Free nodes immediately, or once concurrent readers are done with them. */
+void critbit__node_free(critbit_t *t, critbit__node_t *n);
+void critbit__extnode_free(critbit_t *t, critbit__extnode_t *n, int clear);
+
+/* Returns non-zero if a snapshot may reach a node created in 'gen'. */
+int critbit__is_shared(const critbit_t *t, unsigned int gen);
+
+/* Keep an unlinked node until no snapshot can reach it. */
+void critbit__retire(critbit_t *t, critbit__node_t *n, int clear);
+
+/* Free retired nodes which no snapshot can reach any longer. */
+void critbit__reclaim(critbit_t *t);
+
+/* Walk towards 'key' replacing any nodes shared with snapshots by private
+ * copies. Stops before the first node whose critical bit comes after that
+ * specified by 'byte' and 'otherbits', or at a leaf. Returns the link which
+ * points to the node stopped at, or NULL if out of memory. */
+critbit__node_t **critbit__copy_path(critbit_t  *t,
+                                     const void *key,
+                                     size_t      keylen,
+                                     int         byte,
+                                     unsigned    otherbits);
+
+void critbit__snapshot_destroy(critbit_t *snapshot);
+
+/* In concurrent mode these take the writer lock. Otherwise they do
+ * nothing. */
+void critbit__lock(const critbit_t *t);
+void critbit__unlock(const critbit_t *t);
+
+const critbit__extnode_t *critbit__lookup(const critbit_t       *t,
+                                          const critbit__node_t *n,
                                           const void            *key,
                                           size_t                 keylen);
 
 /* ----------------------------------------------------------------------- */
 
+/* In concurrent mode readers traverse the tree while a writer modifies it.
+ * Writers initialise a node fully before publishing a pointer to it with a
+ * release store. Readers load every pointer which a writer may change with
+ * acquire semantics so that they see the node's contents. */
+#define LOAD_NODE(p)     ATOMIC_LOAD_ACQUIRE(p)
+#define PUBLISH(p, n)    ATOMIC_STORE_RELEASE(p, n)
+
+/* ----------------------------------------------------------------------- */
+
 /* These have a reversed sense compared to the original paper. */
 #define IS_INTERNAL(p) (((intptr_t) (p) & 1) == 0)
 #define IS_EXTERNAL(p) (!IS_INTERNAL(p))
@@ -4,6 +4,7 @@
  * ----------------------------------------------------------------------- */
 
 #include <assert.h>
+#include <limits.h>
 #include <stddef.h>
 #include <string.h>
 
@@ -24,10 +25,10 @@
 // crit-bit, but you can't discover the crit-bit of an all-zero-bits key
 // unless you arbitrarily fix the length of the keys.
 
-error critbit_insert(critbit_t  *t,
-                     const void *key,
-                     size_t      keylen,
-                     const void *value)
+static error critbit__insert(critbit_t  *t,
+                            const void *key,
+                            size_t      keylen,
+                            const void *value)
 {
   const unsigned char *ukey;
   const unsigned char *ukeyend;
@@ -48,30 +49,80 @@ error critbit_insert(critbit_t  *t,
       if (newextnode == NULL)
         return error_OOM;
 
-      t->root = TO_STORE(newextnode);
+      PUBLISH(&t->root, TO_STORE(newextnode));
 
       return error_OK;
     }
 
     /* find closest node */
-    q = (critbit__extnode_t *) critbit__lookup(t->root, key, keylen); /* we cast away const */
+    q = (critbit__extnode_t *) critbit__lookup(t, t->root, key, keylen); /* we cast away const */
     assert(q != NULL);
 
+    INSTRUMENT_COMPARE(t);
+
     if (q->item.keylen == keylen && memcmp(q->item.key, key, keylen) == 0)
     {
+      int shared;
+
       /* update the existing key's value */
 
-      if (q->item.key == key)
+      shared = critbit__is_shared(t, q->gen);
+
+      if (q->item.key == key && !shared)
       {
         /* existing key - just update the value */
-        q->item.value  = value;
+        ATOMIC_STORE_RELEASE(&q->item.value, value);
+      }
+      else if (t->epoch || shared)
+      {
+        critbit__extnode_t  *newextnode;
+        critbit__node_t    **pn;
+
+        /* readers or snapshots may be looking at q, so replace it rather
+         * than modify it in place */
+
+        newextnode = critbit__extnode_create(t, key, keylen, value);
+        if (newextnode == NULL)
+          return error_OOM;
+
+        pn = critbit__copy_path(t, key, keylen, INT_MAX, 0);
+        if (pn == NULL)
+        {
+          critbit__extnode_destroy(t, newextnode);
+          return error_OOM;
+        }
+
+        assert(FROM_STORE(*pn) == q);
+
+        PUBLISH(pn, TO_STORE(newextnode));
+
+        if (q->item.key == key)
+        {
+          /* the key now belongs to newextnode. as before, the old value is
+           * not destroyed */
+          t->inline_bytes -= critbit__inline_bytes(t, q);
+          if (shared)
+            critbit__retire(t, TO_STORE(q), 0);
+          else
+            critbit__extnode_free(t, q, 0);
+          INSTRUMENT_FREE(t);
+          t->extcount--;
+        }
+        else
+        {
+          critbit__extnode_destroy(t, q);
+        }
       }
       else
       {
         critbit__extnode_clear(t, q);
 
-        q->item.key    = key;
-        q->item.keylen = keylen;
+        /* an inline key stays put: it's the same bytes */
+        if (!t->inline_keys)
+        {
+          q->item.key    = key;
+          q->item.keylen = keylen;
+        }
         q->item.value  = value;
       }
 
@@ -127,20 +178,12 @@ error critbit_insert(critbit_t  *t,
 
     /* insert new node */
 
-    pn = &t->root;
-
-    for (;;)
+    pn = critbit__copy_path(t, key, keylen, newbyte, newotherbits);
+    if (pn == NULL)
     {
-      critbit__node_t *n;
-
-      n = *pn;
-
-      if (IS_EXTERNAL(n)    ||
-          n->byte > newbyte ||
-          (n->byte == newbyte && n->otherbits > newotherbits))
-        break;
-
-      pn = &n->child[GET_DIR(ukey, ukeyend, n->byte, n->otherbits)];
+      critbit__node_destroy(t, newnode);
+      critbit__extnode_destroy(t, newextnode);
+      return error_OOM;
     }
 
     newdir = GET_DIR(qkey, qkeyend, newbyte, newotherbits);
@@ -149,9 +192,27 @@ error critbit_insert(critbit_t  *t,
     newnode->child[newdir] = *pn;
     newnode->child[!newdir] = TO_STORE(newextnode);
 
-    *pn = newnode;
+    PUBLISH(pn, newnode);
   }
 
   return error_OK;
 }
 
+error critbit_insert(critbit_t  *t,
+                     const void *key,
+                     size_t      keylen,
+                     const void *value)
+{
+  error err;
+
+  if (t->origin)
+    return error_READ_ONLY; /* snapshot */
+
+  critbit__lock(t);
+  err = critbit__insert(t, key, keylen, value);
+  INSTRUMENT_END(t, INSERT);
+  critbit__unlock(t);
+
+  return err;
+}
+
@@ -33,11 +33,11 @@ static error critbit__lookup_prefix_walk(const critbit__node_t  *n,
   }
   else
   {
-    err = critbit__lookup_prefix_walk(n->child[0], cb, opaque);
+    err = critbit__lookup_prefix_walk(LOAD_NODE(&n->child[0]), cb, opaque);
     if (err)
       return err;
 
-    err = critbit__lookup_prefix_walk(n->child[1], cb, opaque);
+    err = critbit__lookup_prefix_walk(LOAD_NODE(&n->child[1]), cb, opaque);
     if (err)
       return err;
   }
@@ -45,11 +45,11 @@ static error critbit__lookup_prefix_walk(const critbit__node_t  *n,
   return error_OK;
 }
 
-error critbit_lookup_prefix(const critbit_t        *t,
-                            const void             *prefix,
-                            size_t                  prefixlen,
-                            critbit_found_callback *cb,
-                            void                   *opaque)
+static error critbit__lookup_prefix(const critbit_t        *t,
+                                   const void             *prefix,
+                                   size_t                  prefixlen,
+                                   critbit_found_callback *cb,
+                                   void                   *opaque)
 {
   const unsigned char   *uprefix    = prefix;
   const unsigned char   *uprefixend = uprefix + prefixlen;
@@ -58,7 +58,7 @@ error critbit_lookup_prefix(const critbit_t        *t,
   const critbit__node_t *top;
   critbit__extnode_t    *e;
 
-  n   = t->root;
+  n   = LOAD_NODE(&t->root);
   top = n;
 
   if (n == NULL)
@@ -70,7 +70,7 @@ error critbit_lookup_prefix(const critbit_t        *t,
 
     dir = GET_DIR(uprefix, uprefixend, n->byte, n->otherbits);
 
-    m = n->child[dir];
+    m = LOAD_NODE(&n->child[dir]);
 
     if ((size_t) n->byte < prefixlen)
       top = m;
@@ -90,3 +90,19 @@ error critbit_lookup_prefix(const critbit_t        *t,
   return critbit__lookup_prefix_walk(top, cb, opaque);
 }
 
+error critbit_lookup_prefix(const critbit_t        *t,
+                            const void             *prefix,
+                            size_t                  prefixlen,
+                            critbit_found_callback *cb,
+                            void                   *opaque)
+{
+  error err;
+  int   token;
+
+  token = critbit_read_begin(t);
+  err = critbit__lookup_prefix(t, prefix, prefixlen, cb, opaque);
+  critbit_read_end(t, token);
+
+  return err;
+}
+
@@ -12,7 +12,8 @@
 
 #include "impl.h"
 
-const critbit__extnode_t *critbit__lookup(const critbit__node_t *n,
+const critbit__extnode_t *critbit__lookup(const critbit_t       *t,
+                                          const critbit__node_t *n,
                                           const void            *key,
                                           size_t                 keylen)
 {
@@ -20,8 +21,15 @@ const critbit__extnode_t *critbit__lookup(const critbit__node_t *n,
   const unsigned char *ukeyend = ukey + keylen;
   int                  dir;
 
-  for (; IS_INTERNAL(n); n = n->child[dir])
+  for (; IS_INTERNAL(n); n = LOAD_NODE(&n->child[dir]))
+  {
+    INSTRUMENT_VISIT(t);
+    INSTRUMENT_BITS(t, 1);
+
     dir = GET_DIR(ukey, ukeyend, n->byte, n->otherbits);
+  }
+
+  INSTRUMENT_VISIT(t); /* the external node */
 
   return FROM_STORE(n);
 }
@@ -30,21 +38,40 @@ const void *critbit_lookup(const critbit_t *t,
                            const void      *key,
                            size_t           keylen)
 {
+  const critbit__node_t    *root;
   const critbit__extnode_t *n;
+  const void               *value;
+  int                       token;
 
   assert(key != NULL);
   assert(keylen > 0);
 
-  /* test for empty tree */
-  if (t->root == NULL)
-    return NULL;
+  token = critbit_read_begin(t);
 
-  n = critbit__lookup(t->root, key, keylen);
+  root = LOAD_NODE(&t->root);
 
-  assert(n != NULL);
-  if (n->item.keylen == keylen && memcmp(n->item.key, key, keylen) == 0)
-    return n->item.value; /* found */
+  /* test for empty tree */
+  if (root == NULL)
+  {
+    value = NULL;
+  }
   else
-    return t->default_value; /* not found */
+  {
+    n = critbit__lookup(t, root, key, keylen);
+
+    INSTRUMENT_COMPARE(t);
+
+    assert(n != NULL);
+    if (n->item.keylen == keylen && memcmp(n->item.key, key, keylen) == 0)
+      value = LOAD_NODE(&n->item.value); /* found */
+    else
+      value = t->default_value; /* not found */
+  }
+
+  INSTRUMENT_END(t, LOOKUP);
+
+  critbit_read_end(t, token);
+
+  return value;
 }
 
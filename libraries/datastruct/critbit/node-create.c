@@ -26,6 +26,9 @@ critbit__node_t *critbit__node_create(critbit_t *t,
   n->child[1]  = NULL;
   n->byte      = byte;
   n->otherbits = otherbits;
+  n->gen       = t->gen;
+
+  INSTRUMENT_ALLOC(t);
 
   t->intcount++;
 
@@ -6,14 +6,35 @@
 #include <stdlib.h>
 
 #include "base/memento/memento.h"
+#include "base/types.h"
 
 #include "datastruct/critbit.h"
 
 #include "impl.h"
 
+static void critbit__node_free_block(void *block, void *opaque)
+{
+  NOT_USED(opaque);
+
+  free(block);
+}
+
+void critbit__node_free(critbit_t *t, critbit__node_t *n)
+{
+  if (t->epoch)
+    epoch_retire(t->epoch, n, critbit__node_free_block, NULL);
+  else
+    free(n);
+}
+
 void critbit__node_destroy(critbit_t *t, critbit__node_t *n)
 {
-  free(n);
+  if (critbit__is_shared(t, n->gen))
+    critbit__retire(t, n, 1);
+  else
+    critbit__node_free(t, n);
+
+  INSTRUMENT_FREE(t);
 
   t->intcount--;
 }
@@ -3,6 +3,8 @@
  * Purpose: Associative array implemented as a critbit tree
  * ----------------------------------------------------------------------- */
 
+#include <assert.h>
+#include <limits.h>
 #include <stddef.h>
 #include <string.h>
 
@@ -12,7 +14,7 @@
 
 #include "impl.h"
 
-void critbit_remove(critbit_t *t, const void *key, size_t keylen)
+static void critbit__remove(critbit_t *t, const void *key, size_t keylen)
 {
   const unsigned char *ukey    = key;
   const unsigned char *ukeyend = ukey + keylen;
@@ -23,14 +25,26 @@ void critbit_remove(critbit_t *t, const void *key, size_t keylen)
   critbit__extnode_t  *e;
   critbit__node_t     *lastn;
 
+  if (t->root == NULL)
+    return; /* empty tree */
+
+  e = (critbit__extnode_t *) critbit__lookup(t, t->root, key, keylen); /* we cast away const */
+
+  INSTRUMENT_COMPARE(t);
+
+  if (!(e->item.keylen == keylen && memcmp(e->item.key, key, keylen) == 0))
+    return; /* not found */
+
+  /* snapshots may share the path: replace it with private copies. if we run
+   * out of memory doing so the key is left in place */
+  if (t->snapshots && critbit__copy_path(t, key, keylen, INT_MAX, 0) == NULL)
+    return;
+
   n = t->root;
 
   wherem = NULL;
   wheren = &t->root;
 
-  if (t->root == NULL)
-    return; /* empty tree */
-
   while (IS_INTERNAL(n))
   {
     wherem = wheren;
@@ -42,22 +56,33 @@ void critbit_remove(critbit_t *t, const void *key, size_t keylen)
     n = *wheren;
   }
 
-  e = FROM_STORE(n);
-
-  if (!(e->item.keylen == keylen && memcmp(e->item.key, key, keylen) == 0))
-    return; /* not found */
+  assert(FROM_STORE(n) == e);
 
-  critbit__extnode_destroy(t, e);
+  /* unlink before destroying, as readers may still be traversing */
 
   if (wherem == NULL)
   {
-    t->root = NULL;
+    PUBLISH(&t->root, NULL);
   }
   else
   {
-    *wherem = lastn->child[1 - dir];
+    PUBLISH(wherem, lastn->child[1 - dir]);
 
     critbit__node_destroy(t, lastn);
   }
+
+  critbit__extnode_destroy(t, e);
+}
+
+void critbit_remove(critbit_t *t, const void *key, size_t keylen)
+{
+  assert(t->origin == NULL); /* snapshots are read-only */
+  if (t->origin)
+    return;
+
+  critbit__lock(t);
+  critbit__remove(t, key, keylen);
+  INSTRUMENT_END(t, REMOVE);
+  critbit__unlock(t);
 }
 
@@ -0,0 +1,51 @@
+/* --------------------------------------------------------------------------
+ *    Name: save.c
+ * Purpose: Associative array implemented as a critbit tree
+ * ----------------------------------------------------------------------- */
+
+#include <stdlib.h>
+
+#include "base/errors.h"
+
+#include "datastruct/flat.h"
+
+#include "datastruct/critbit.h"
+
+#include "impl.h"
+
+static error critbit__save_node(critbit__node_t *n, int level, void *opaque)
+{
+  flat_writer_t      *w = opaque;
+  critbit__extnode_t *e;
+
+  NOT_USED(level);
+
+  e = FROM_STORE(n);
+
+  return flat_writer_add(w, e->item.key, e->item.keylen, e->item.value);
+}
+
+error critbit_save(const critbit_t *t,
+                   flat_value_len  *value_len,
+                   const char      *filename)
+{
+  error          err;
+  flat_writer_t *w;
+
+  err = flat_writer_create(flat_KIND_SORTED, value_len, &w);
+  if (err)
+    return err;
+
+  critbit__lock(t);
+  err = critbit__walk_internal((critbit_t *) t, /* cast away const */
+                               critbit_WALK_LEAVES,
+                               critbit__save_node,
+                               w);
+  critbit__unlock(t);
+  if (!err)
+    err = flat_writer_save(w, filename);
+
+  flat_writer_destroy(w);
+
+  return err;
+}
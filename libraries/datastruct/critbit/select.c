@@ -52,10 +52,12 @@ const item_t *critbit_select(critbit_t *t, int k)
   args.k    = k;
   args.item = NULL;
 
+  critbit__lock(t);
   err = critbit__walk_internal(t,
                                critbit_WALK_LEAVES,
                                critbit__select_node,
                                &args);
+  critbit__unlock(t);
 
   /* no errors save for the expected ones should happen here */
   assert(err == error_OK || err == error_STOP_WALK);
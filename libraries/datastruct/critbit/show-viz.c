@@ -170,12 +170,12 @@ static int critbit__count_for_rank(const critbit_t *t, int rank)
 
 /* ----------------------------------------------------------------------- */
 
-error critbit_show_viz(const critbit_t      *t,
-                       critbit_show_key     *key,
-                       critbit_show_destroy *key_destroy,
-                       critbit_show_value   *value,
-                       critbit_show_destroy *value_destroy,
-                       FILE                 *f)
+static error critbit__show_viz(const critbit_t      *t,
+                              critbit_show_key     *key,
+                              critbit_show_destroy *key_destroy,
+                              critbit_show_value   *value,
+                              critbit_show_destroy *value_destroy,
+                              FILE                 *f)
 {
   error                    err;
   critbit__show_viz_args_t args;
@@ -262,3 +262,18 @@ error critbit_show_viz(const critbit_t      *t,
   return error_OK;
 }
 
+error critbit_show_viz(const critbit_t      *t,
+                       critbit_show_key     *key,
+                       critbit_show_destroy *key_destroy,
+                       critbit_show_value   *value,
+                       critbit_show_destroy *value_destroy,
+                       FILE                 *f)
+{
+  error err;
+
+  critbit__lock(t);
+  err = critbit__show_viz(t, key, key_destroy, value, value_destroy, f);
+  critbit__unlock(t);
+
+  return err;
+}
@@ -65,6 +65,7 @@ error critbit_show(const critbit_t      *t,
                    critbit_show_destroy *value_destroy,
                    FILE                 *f)
 {
+  error                err;
   critbit__show_args_t args;
 
   args.key           = key;
@@ -73,8 +74,12 @@ error critbit_show(const critbit_t      *t,
   args.value_destroy = value_destroy;
   args.f             = f;
 
-  return critbit__walk_internal((critbit_t *) t,
-                                critbit_WALK_IN_ORDER | critbit_WALK_ALL,
-                                critbit__node_show, &args);
+  critbit__lock(t);
+  err = critbit__walk_internal((critbit_t *) t,
+                               critbit_WALK_IN_ORDER | critbit_WALK_ALL,
+                               critbit__node_show, &args);
+  critbit__unlock(t);
+
+  return err;
 }
 
@@ -0,0 +1,194 @@
+/* --------------------------------------------------------------------------
+ *    Name: snapshot.c
+ * Purpose: Associative array implemented as a critbit tree
+ * ----------------------------------------------------------------------- */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "base/memento/memento.h"
+#include "base/errors.h"
+
+#include "datastruct/critbit.h"
+
+#include "impl.h"
+
+/* Returns non-zero if a live snapshot of 't' has an id in [from, to). */
+static int critbit__covered(const critbit_t *t,
+                            unsigned int     from,
+                            unsigned int     to)
+{
+  const critbit_t *s;
+
+  for (s = t->snapshots; s; s = s->next)
+    if (s->gen >= from && s->gen < to)
+      return 1;
+
+  return 0;
+}
+
+int critbit__is_shared(const critbit_t *t, unsigned int gen)
+{
+  return t->snapshots && critbit__covered(t, gen, t->gen);
+}
+
+void critbit__retire(critbit_t *t, critbit__node_t *n, int clear)
+{
+  critbit__retired_t *r;
+
+  r = malloc(sizeof(*r));
+  if (r == NULL)
+    return; /* out of memory: the node leaks */
+
+  r->n     = n;
+  r->died  = t->gen;
+  r->clear = clear;
+
+  r->next    = t->retired;
+  t->retired = r;
+}
+
+void critbit__reclaim(critbit_t *t)
+{
+  critbit__retired_t **pr;
+  critbit__retired_t  *r;
+
+  for (pr = &t->retired; (r = *pr) != NULL; )
+  {
+    unsigned int born;
+
+    if (IS_EXTERNAL(r->n))
+    {
+      critbit__extnode_t *e = FROM_STORE(r->n);
+
+      born = e->gen;
+    }
+    else
+    {
+      born = r->n->gen;
+    }
+
+    if (critbit__covered(t, born, r->died))
+    {
+      pr = &r->next;
+      continue;
+    }
+
+    if (IS_EXTERNAL(r->n))
+      critbit__extnode_free(t, FROM_STORE(r->n), r->clear);
+    else
+      critbit__node_free(t, r->n);
+
+    *pr = r->next;
+    free(r);
+  }
+}
+
+critbit__node_t **critbit__copy_path(critbit_t  *t,
+                                     const void *key,
+                                     size_t      keylen,
+                                     int         byte,
+                                     unsigned    otherbits)
+{
+  const unsigned char *ukey    = key;
+  const unsigned char *ukeyend = ukey + keylen;
+  critbit__node_t    **pn;
+
+  for (pn = &t->root; ; )
+  {
+    critbit__node_t *n;
+
+    n = *pn;
+
+    if (n == NULL         ||
+        IS_EXTERNAL(n)    ||
+        n->byte > byte    ||
+        (n->byte == byte && n->otherbits > otherbits))
+      break;
+
+    if (critbit__is_shared(t, n->gen))
+    {
+      critbit__node_t *copy;
+
+      copy = critbit__node_create(t, n->byte, n->otherbits);
+      if (copy == NULL)
+        return NULL; /* the tree is intact: any copies so far are equivalent */
+
+      copy->child[0] = n->child[0];
+      copy->child[1] = n->child[1];
+
+      PUBLISH(pn, copy);
+
+      critbit__node_destroy(t, n);
+
+      n = copy;
+    }
+
+    pn = &n->child[GET_DIR(ukey, ukeyend, n->byte, n->otherbits)];
+  }
+
+  return pn;
+}
+
+/* ----------------------------------------------------------------------- */
+
+error critbit_snapshot(critbit_t *t, critbit_t **psnapshot)
+{
+  critbit_t *s;
+
+  assert(t->origin == NULL); /* can't snapshot a snapshot */
+
+  *psnapshot = NULL;
+
+  s = malloc(sizeof(*s));
+  if (s == NULL)
+    return error_OOM;
+
+  critbit__lock(t);
+
+  s->root          = t->root;
+  s->intcount      = t->intcount;
+  s->extcount      = t->extcount;
+  s->default_value = t->default_value;
+  s->inline_keys   = t->inline_keys;
+  s->inline_bytes  = t->inline_bytes;
+  s->destroy_key   = t->destroy_key;
+  s->destroy_value = t->destroy_value;
+
+  s->epoch         = NULL; /* snapshots never change so need no locking */
+
+  s->gen           = t->gen++;
+  s->origin        = t;
+  s->snapshots     = NULL;
+  s->retired       = NULL;
+
+  INSTRUMENT_INIT(s);
+
+  s->next          = t->snapshots;
+  t->snapshots     = s;
+
+  critbit__unlock(t);
+
+  *psnapshot = s;
+
+  return error_OK;
+}
+
+void critbit__snapshot_destroy(critbit_t *doomed)
+{
+  critbit_t  *t = doomed->origin;
+  critbit_t **ps;
+
+  critbit__lock(t);
+
+  for (ps = &t->snapshots; *ps != doomed; ps = &(*ps)->next)
+    assert(*ps != NULL);
+  *ps = doomed->next;
+
+  critbit__reclaim(t);
+
+  critbit__unlock(t);
+
+  free(doomed);
+}
@@ -0,0 +1,36 @@
+/* --------------------------------------------------------------------------
+ *    Name: stats.c
+ * Purpose: Associative array implemented as a critbit tree
+ * ----------------------------------------------------------------------- */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "datastruct/critbit.h"
+
+#include "impl.h"
+
+void critbit_stats(const critbit_t *t, datastruct_stats_t *stats)
+{
+  memset(stats, 0, sizeof(*stats));
+
+  critbit__lock(t);
+
+  /* a snapshot reports the nodes it can reach, which it shares with its
+   * tree */
+  stats->elements    = t->extcount;
+  stats->branches    = t->intcount;
+  stats->leaves      = t->extcount;
+  stats->node_bytes  = t->intcount * sizeof(critbit__node_t);
+  /* inline keys extend the extnode past its key member */
+  if (t->inline_keys)
+    stats->node_bytes += t->extcount * offsetof(critbit__extnode_t, key) +
+                         t->inline_bytes;
+  else
+    stats->node_bytes += t->extcount * sizeof(critbit__extnode_t);
+  stats->other_bytes = sizeof(*t);
+
+  critbit__unlock(t);
+
+  stats->total_bytes = stats->node_bytes + stats->other_bytes;
+}
@@ -0,0 +1,655 @@
+/* test.c */
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/memento/memento.h"
+
+#include "base/atomic.h"
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "datastruct/critbit.h"
+#include "datastruct/critbit-template.h"
+
+error critbittest(void);
+
+/* ----------------------------------------------------------------------- */
+
+#define NKEYS    256
+#define NREADERS 4
+#define NROUNDS  200
+
+/* Two copies of every key so that the writer can replace a key with an
+ * equal one held at a different address. */
+static char keys[2][NKEYS][8];
+
+/* A specialised tree of strings to ints. */
+DEFINE_CRITBIT(critbittest_tree, const char *, int, strlen)
+
+typedef struct critbittest_state
+{
+  critbit_t *t;
+  int        done;     /* set once the writer has finished */
+  int        failures; /* count of bad lookups seen by readers */
+}
+critbittest_state_t;
+
+static error critbittest_check_prefix(const item_t *item, void *opaque)
+{
+  critbittest_state_t *state = opaque;
+
+  if (item->keylen != 7 || memcmp(item->key, "key", 3) != 0 ||
+      strcmp(item->key, item->value) != 0)
+    ATOMIC_FETCH_ADD(&state->failures, 1);
+
+  return error_OK;
+}
+
+/* Readers repeatedly look up the even keys, which are always present, while
+ * the writer churns the odd keys and replaces the even ones. */
+static void *critbittest_reader(void *opaque)
+{
+  critbittest_state_t *state = opaque;
+  int                  i;
+
+  while (!ATOMIC_LOAD(&state->done))
+  {
+    for (i = 0; i < NKEYS; i += 2)
+    {
+      const char *value;
+
+      value = critbit_lookup(state->t, keys[0][i], 7);
+      if (value == NULL || strcmp(value, keys[0][i]) != 0)
+        ATOMIC_FETCH_ADD(&state->failures, 1);
+    }
+
+    (void) critbit_lookup_prefix(state->t, "key", 3,
+                                 critbittest_check_prefix, state);
+  }
+
+  return NULL;
+}
+
+static error critbittest1(void)
+{
+  error               err;
+  critbittest_state_t state;
+  pthread_t           readers[NREADERS];
+  int                 nreaders;
+  int                 round;
+  int                 i;
+
+  printf("> critbit test 1 - concurrent readers\n");
+
+  err = critbit_create_concurrent(NULL, NULL, NULL, &state.t);
+  if (err)
+    return err;
+
+  state.done     = 0;
+  state.failures = 0;
+
+  for (i = 0; i < NKEYS; i += 2)
+  {
+    err = critbit_insert(state.t, keys[0][i], 7, keys[0][i]);
+    if (err)
+      goto exit;
+  }
+
+  nreaders = 0;
+  for (i = 0; i < NREADERS; i++)
+  {
+    if (pthread_create(&readers[i], NULL, critbittest_reader, &state) != 0)
+      break;
+    nreaders++;
+  }
+
+  for (round = 0; round < NROUNDS && !err; round++)
+  {
+    for (i = 1; i < NKEYS && !err; i += 2)
+      err = critbit_insert(state.t, keys[0][i], 7, keys[0][i]);
+
+    /* swap each even key for its twin */
+    for (i = 0; i < NKEYS && !err; i += 2)
+      err = critbit_insert(state.t, keys[~round & 1][i], 7, keys[0][i]);
+
+    for (i = 1; i < NKEYS; i += 2)
+      critbit_remove(state.t, keys[0][i], 7);
+  }
+
+  ATOMIC_STORE(&state.done, 1);
+
+  for (i = 0; i < nreaders; i++)
+    pthread_join(readers[i], NULL);
+
+  if (err)
+    goto exit;
+
+  printf("%d readers, %d failures, %d nodes remain\n",
+         nreaders, state.failures, critbit_count(state.t));
+
+  if (state.failures != 0 || critbit_count(state.t) != NKEYS - 1)
+    err = error_TEST_FAILED;
+
+exit:
+
+  critbit_destroy(state.t);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+static char *critbittest_strdup(const char *s)
+{
+  char *d;
+
+  d = malloc(strlen(s) + 1);
+  if (d)
+    strcpy(d, s);
+
+  return d;
+}
+
+static void critbittest_free(void *value)
+{
+  free(value);
+}
+
+/* Check that every key in [first, last) with a step of 'step' is present
+ * in 't' with a value starting with 'prefix', and that 't' holds only
+ * those. */
+static error critbittest_check(const critbit_t *t,
+                               int              first,
+                               int              last,
+                               int              step,
+                               const char      *prefix)
+{
+  int i;
+  int n;
+
+  n = 0;
+  for (i = 0; i < NKEYS; i++)
+  {
+    const char *value;
+    int         expected;
+
+    expected = i >= first && i < last && (i - first) % step == 0;
+
+    value = critbit_lookup(t, keys[0][i], 7);
+    if ((value != NULL) != expected ||
+        (value && strncmp(value, prefix, strlen(prefix)) != 0))
+    {
+      printf("key %s: unexpected value %s\n", keys[0][i],
+             value ? value : "(none)");
+      return error_TEST_FAILED;
+    }
+
+    n += expected;
+  }
+
+  /* a full tree of n leaves has n - 1 internal nodes */
+  if (critbit_count((critbit_t *) t) != (n ? 2 * n - 1 : 0))
+  {
+    printf("unexpected count %d\n", critbit_count((critbit_t *) t));
+    return error_TEST_FAILED;
+  }
+
+  return error_OK;
+}
+
+static error critbittest2(void)
+{
+  error      err;
+  critbit_t *t;
+  critbit_t *snap1;
+  critbit_t *snap2;
+  int        i;
+
+  printf("> critbit test 2 - snapshots\n");
+
+  err = critbit_create(NULL, NULL, critbittest_free, &t);
+  if (err)
+    return err;
+
+  snap1 = NULL;
+  snap2 = NULL;
+
+  for (i = 0; i < NKEYS / 2; i++)
+  {
+    err = critbit_insert(t, keys[0][i], 7, critbittest_strdup("one"));
+    if (err)
+      goto exit;
+  }
+
+  err = critbit_snapshot(t, &snap1);
+  if (err)
+    goto exit;
+
+  /* remove the odd keys, replace the values of the rest */
+
+  for (i = 1; i < NKEYS / 2; i += 2)
+    critbit_remove(t, keys[0][i], 7);
+
+  for (i = 0; i < NKEYS / 2; i += 2)
+  {
+    err = critbit_insert(t, keys[1][i], 7, critbittest_strdup("two"));
+    if (err)
+      goto exit;
+  }
+
+  err = critbit_snapshot(t, &snap2);
+  if (err)
+    goto exit;
+
+  /* add the second half */
+
+  for (i = NKEYS / 2; i < NKEYS; i++)
+  {
+    err = critbit_insert(t, keys[0][i], 7, critbittest_strdup("three"));
+    if (err)
+      goto exit;
+  }
+
+  if (critbit_insert(snap1, keys[0][0], 7, NULL) != error_READ_ONLY)
+  {
+    printf("insert into snapshot didn't fail!\n");
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+  err = critbittest_check(snap1, 0, NKEYS / 2, 1, "one");
+  if (!err)
+    err = critbittest_check(snap2, 0, NKEYS / 2, 2, "two");
+  if (err)
+    goto exit;
+
+  critbit_destroy(snap1);
+  snap1 = NULL;
+
+  err = critbittest_check(snap2, 0, NKEYS / 2, 2, "two");
+  if (err)
+    goto exit;
+
+  critbit_destroy(snap2);
+  snap2 = NULL;
+
+  for (i = 0; i < NKEYS / 2; i += 2)
+    critbit_remove(t, keys[0][i], 7);
+
+  err = critbittest_check(t, NKEYS / 2, NKEYS, 1, "three");
+
+exit:
+
+  if (snap2)
+    critbit_destroy(snap2);
+  if (snap1)
+    critbit_destroy(snap1);
+
+  critbit_destroy(t);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+static error critbittest3(void)
+{
+  error      err;
+  critbit_t *t;
+  char       scratch[8];
+  int        round;
+  int        i;
+
+  printf("> critbit test 3 - inline keys\n");
+
+  err = critbit_create_concurrent(NULL, NULL, NULL, &t);
+  if (err)
+    return err;
+
+  critbit_set_inline_keys(t);
+
+  /* insert every key from the same buffer, twice so that the second round
+   * replaces the nodes, scribbling over the buffer after each insert */
+
+  for (round = 0; round < 2; round++)
+  {
+    for (i = 0; i < NKEYS && !err; i++)
+    {
+      strcpy(scratch, keys[0][i]);
+      err = critbit_insert(t, scratch, 7, keys[round][i]);
+      memset(scratch, 'x', sizeof(scratch));
+    }
+    if (err)
+      goto exit;
+  }
+
+  for (i = 0; i < NKEYS; i++)
+  {
+    if (critbit_lookup(t, keys[0][i], 7) != keys[1][i])
+    {
+      printf("key %s: not found\n", keys[0][i]);
+      err = error_TEST_FAILED;
+      goto exit;
+    }
+  }
+
+  if (critbit_count(t) != 2 * NKEYS - 1)
+  {
+    printf("unexpected count %d\n", critbit_count(t));
+    err = error_TEST_FAILED;
+  }
+
+exit:
+
+  critbit_destroy(t);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+typedef struct critbittest_build_state
+{
+  int   i;     /* next key to supply */
+  int   step;
+  int   n;     /* keys remaining */
+  char *value; /* last value supplied */
+}
+critbittest_build_state_t;
+
+static error critbittest_build_next(item_t *item, void *opaque)
+{
+  critbittest_build_state_t *state = opaque;
+
+  if (state->n == 0)
+    return error_NOT_FOUND;
+
+  state->value = critbittest_strdup("four");
+  if (state->value == NULL)
+    return error_OOM;
+
+  item->key    = keys[0][state->i];
+  item->keylen = 7;
+  item->value  = state->value;
+
+  state->i += state->step;
+  state->n--;
+
+  return error_OK;
+}
+
+static error critbittest4(void)
+{
+  error                     err;
+  critbit_t                *t;
+  critbittest_build_state_t state;
+  const item_t             *item;
+
+  printf("> critbit test 4 - build from sorted keys\n");
+
+  err = critbit_create(NULL, NULL, critbittest_free, &t);
+  if (err)
+    return err;
+
+  /* the even keys in one pass into the empty tree... */
+
+  state.i    = 0;
+  state.step = 2;
+  state.n    = NKEYS / 2;
+  err = critbit_build_sorted(t, critbittest_build_next, &state);
+  if (!err)
+    err = critbittest_check(t, 0, NKEYS, 2, "four");
+  if (err)
+    goto exit;
+
+  /* ...then the odd keys into the now populated tree */
+
+  state.i    = 1;
+  state.step = 2;
+  state.n    = NKEYS / 2;
+  err = critbit_build_sorted(t, critbittest_build_next, &state);
+  if (!err)
+    err = critbittest_check(t, 0, NKEYS, 1, "four");
+  if (err)
+    goto exit;
+
+  /* select counts leaves from the left so finds keys in order */
+  item = critbit_select(t, NKEYS - 1);
+  if (item == NULL || strcmp(item->key, keys[0][NKEYS - 1]) != 0)
+  {
+    printf("tree is out of order\n");
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+  critbit_destroy(t);
+
+  /* keys out of order are refused, keeping those before */
+
+  err = critbit_create(NULL, NULL, critbittest_free, &t);
+  if (err)
+    return err;
+
+  state.i    = NKEYS - 1;
+  state.step = -1;
+  state.n    = NKEYS;
+  err = critbit_build_sorted(t, critbittest_build_next, &state);
+  if (err != error_CRITBIT_UNSORTED)
+  {
+    printf("unsorted keys were accepted\n");
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+  free(state.value); /* the refused key's value remains ours */
+
+  err = critbittest_check(t, NKEYS - 1, NKEYS, 1, "four");
+
+exit:
+
+  critbit_destroy(t);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+static error critbittest5(void)
+{
+  error              err;
+  critbittest_tree_t t;
+  int               *value;
+  int                i;
+  int                j;
+
+  printf("> critbit test 5 - specialised tree\n");
+
+  critbittest_tree_init(&t);
+
+  /* insert in a scrambled order, then update every key from its copy */
+
+  err = critbittest_tree_insert(&t, "", -1);
+  for (i = 0; i < NKEYS && !err; i++)
+  {
+    j = (i * 97) % NKEYS;
+    err = critbittest_tree_insert(&t, keys[0][j], j);
+  }
+  for (i = 0; i < NKEYS && !err; i++)
+    err = critbittest_tree_insert(&t, keys[1][i], i + 1);
+  if (err)
+    goto exit;
+
+  if (critbittest_tree_count(&t) != NKEYS + 1)
+  {
+    printf("unexpected count %d\n", critbittest_tree_count(&t));
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+  /* remove the even keys and the empty key */
+
+  for (i = 0; i < NKEYS; i += 2)
+    if (!critbittest_tree_remove(&t, keys[0][i]))
+    {
+      printf("key %s: not removed\n", keys[0][i]);
+      err = error_TEST_FAILED;
+      goto exit;
+    }
+
+  if (!critbittest_tree_remove(&t, "") ||
+      critbittest_tree_remove(&t, "") ||
+      critbittest_tree_remove(&t, "key") ||
+      critbittest_tree_lookup(&t, "key00010") != NULL)
+  {
+    printf("absent keys mishandled\n");
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+  for (i = 0; i < NKEYS; i++)
+  {
+    value = critbittest_tree_lookup(&t, keys[0][i]);
+    if ((i & 1) ? (value == NULL || *value != i + 1) : (value != NULL))
+    {
+      printf("key %s: wrong lookup result\n", keys[0][i]);
+      err = error_TEST_FAILED;
+      goto exit;
+    }
+  }
+
+  if (critbittest_tree_count(&t) != NKEYS / 2)
+  {
+    printf("unexpected count %d\n", critbittest_tree_count(&t));
+    err = error_TEST_FAILED;
+  }
+
+exit:
+
+  critbittest_tree_fini(&t);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+#define STATSPAD 32 /* bytes by which long keys exceed short ones */
+
+static char longkeys[NKEYS][8 + STATSPAD];
+
+/* Inline keys are held within their extnodes, so node_bytes must grow by
+ * each byte of key and shrink back as keys are removed. */
+static error critbittest6(void)
+{
+  error              err;
+  critbit_t         *t[2];
+  datastruct_stats_t empty;
+  datastruct_stats_t stats[2];
+  int                i;
+  int                j;
+
+  printf("> critbit test 6 - stats with inline keys\n");
+
+  for (i = 0; i < NKEYS; i++)
+    sprintf(longkeys[i], "%s%0*d", keys[0][i], STATSPAD, 0);
+
+  t[0] = t[1] = NULL;
+
+  for (j = 0; j < 2; j++)
+  {
+    err = critbit_create(NULL, NULL, NULL, &t[j]);
+    if (err)
+      goto exit;
+
+    critbit_set_inline_keys(t[j]);
+  }
+
+  critbit_stats(t[0], &empty);
+
+  for (i = 0; i < NKEYS && !err; i++)
+  {
+    err = critbit_insert(t[0], keys[0][i], 7, NULL);
+    if (!err)
+      err = critbit_insert(t[1], longkeys[i], 7 + STATSPAD, NULL);
+  }
+  if (err)
+    goto exit;
+
+  for (j = 0; j < 2; j++)
+    critbit_stats(t[j], &stats[j]);
+
+  if (stats[0].node_bytes <= empty.node_bytes ||
+      stats[1].node_bytes - stats[0].node_bytes != NKEYS * STATSPAD)
+  {
+    printf("node bytes %lu for short keys, %lu for long\n",
+           (unsigned long) stats[0].node_bytes,
+           (unsigned long) stats[1].node_bytes);
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+  for (i = 0; i < NKEYS; i++)
+  {
+    critbit_remove(t[0], keys[0][i], 7);
+    critbit_remove(t[1], longkeys[i], 7 + STATSPAD);
+  }
+
+  for (j = 0; j < 2; j++)
+  {
+    critbit_stats(t[j], &stats[j]);
+    if (stats[j].node_bytes != empty.node_bytes)
+    {
+      printf("node bytes %lu once emptied\n",
+             (unsigned long) stats[j].node_bytes);
+      err = error_TEST_FAILED;
+    }
+  }
+
+exit:
+
+  for (j = 0; j < 2; j++)
+    if (t[j])
+      critbit_destroy(t[j]);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+error critbittest(void)
+{
+  error err;
+  int   i;
+
+  printf(">> critbit test\n");
+
+  for (i = 0; i < NKEYS; i++)
+  {
+    sprintf(keys[0][i], "key%04d", i);
+    strcpy(keys[1][i], keys[0][i]);
+  }
+
+  err = critbittest1();
+  if (!err)
+    err = critbittest2();
+  if (!err)
+    err = critbittest3();
+  if (!err)
+    err = critbittest4();
+  if (!err)
+    err = critbittest5();
+  if (!err)
+    err = critbittest6();
+  if (err)
+  {
+    printf("unexpected error: %lx\n", err);
+    return err;
+  }
+
+  printf("<< critbit tests ok\n");
+
+  return error_OK;
+}
@@ -48,9 +48,15 @@ error critbit_walk(const critbit_t       *t,
                    critbit_walk_callback *cb,
                    void                  *opaque)
 {
+  error err;
+
   if (t == NULL)
     return error_OK;
 
-  return critbit__walk_in_order(t->root, 0, cb, opaque);
+  critbit__lock(t);
+  err = critbit__walk_in_order(t->root, 0, cb, opaque);
+  critbit__unlock(t);
+
+  return err;
 }
 
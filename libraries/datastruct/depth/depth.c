@@ -0,0 +1,178 @@
+/* --------------------------------------------------------------------------
+ *    Name: depth.c
+ * Purpose: Shape and depth statistics of data structures
+ * ----------------------------------------------------------------------- */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/memento/memento.h"
+#include "base/errors.h"
+
+#include "datastruct/depth.h"
+
+/* ----------------------------------------------------------------------- */
+
+void datastruct_depth_init(datastruct_depth_stats_t *stats)
+{
+  memset(stats, 0, sizeof(*stats));
+}
+
+static void datastruct_depth__count(datastruct_depth_stats_t *stats,
+                                    int                       depth)
+{
+  if (depth >= datastruct_DEPTH_BUCKETS)
+    depth = datastruct_DEPTH_BUCKETS - 1;
+  stats->histogram[depth]++;
+}
+
+static void datastruct_depth__extent(datastruct_depth_stats_t *stats,
+                                     int                       min,
+                                     int                       max,
+                                     int                       first)
+{
+  if (first || min < stats->min_depth)
+    stats->min_depth = min;
+  if (first || max > stats->max_depth)
+    stats->max_depth = max;
+}
+
+void datastruct_depth_add(datastruct_depth_stats_t *stats, int depth)
+{
+  datastruct_depth__extent(stats, depth, depth, stats->elements == 0);
+  stats->elements++;
+  stats->total_depth += depth;
+  datastruct_depth__count(stats, depth);
+}
+
+int datastruct_depth_branch(datastruct_depth_stats_t *stats,
+                            int                       children,
+                            int                       chained)
+{
+  if (children != 1)
+    return 0;
+
+  if (!chained)
+    stats->chains++;
+  stats->chain_nodes++;
+
+  return 1;
+}
+
+void datastruct_depth_add_chain(datastruct_depth_stats_t *stats, int length)
+{
+  stats->bins++;
+  if (length == 0)
+  {
+    stats->empty_bins++;
+  }
+  else
+  {
+    datastruct_depth__extent(stats, length, length, stats->elements == 0);
+    stats->elements    += length;
+    stats->total_depth += length;
+  }
+  datastruct_depth__count(stats, length);
+}
+
+void datastruct_depth_merge(datastruct_depth_stats_t       *dst,
+                            const datastruct_depth_stats_t *src)
+{
+  int i;
+
+  if (src->elements)
+    datastruct_depth__extent(dst, src->min_depth, src->max_depth,
+                             dst->elements == 0);
+
+  dst->elements    += src->elements;
+  dst->total_depth += src->total_depth;
+  for (i = 0; i < datastruct_DEPTH_BUCKETS; i++)
+    dst->histogram[i] += src->histogram[i];
+
+  dst->chains      += src->chains;
+  dst->chain_nodes += src->chain_nodes;
+  dst->bins        += src->bins;
+  dst->empty_bins  += src->empty_bins;
+}
+
+void datastruct_depth_finish(datastruct_depth_stats_t *stats)
+{
+  int ideal;
+
+  stats->avg_depth   = 0.0;
+  stats->imbalance   = 0.0;
+  stats->load_factor = 0.0;
+
+  if (stats->bins)
+  {
+    if (stats->bins > stats->empty_bins)
+      stats->avg_depth = (double) stats->elements /
+                         (stats->bins - stats->empty_bins);
+    stats->load_factor = (double) stats->elements / stats->bins;
+  }
+  else if (stats->elements)
+  {
+    stats->avg_depth = (double) stats->total_depth / stats->elements;
+
+    /* the depth of a perfectly balanced binary tree */
+    for (ideal = 0; (1L << ideal) < stats->elements; ideal++)
+      ;
+    if (ideal)
+      stats->imbalance = (double) stats->max_depth / ideal;
+  }
+}
+
+/* ----------------------------------------------------------------------- */
+
+void datastruct_depth_stack_init(datastruct_depth_stack_t *stack)
+{
+  stack->entries   = NULL;
+  stack->used      = 0;
+  stack->allocated = 0;
+}
+
+error datastruct_depth_stack_push(datastruct_depth_stack_t *stack,
+                                  const void               *node,
+                                  int                       depth,
+                                  int                       chained)
+{
+  datastruct_depth_entry_t *e;
+
+  if (stack->used == stack->allocated)
+  {
+    int                       allocated;
+    datastruct_depth_entry_t *entries;
+
+    allocated = stack->allocated ? stack->allocated * 2 : 64;
+    entries = realloc(stack->entries, allocated * sizeof(*entries));
+    if (entries == NULL)
+      return error_OOM;
+
+    stack->entries   = entries;
+    stack->allocated = allocated;
+  }
+
+  e = &stack->entries[stack->used++];
+  e->node    = node;
+  e->depth   = depth;
+  e->chained = chained;
+
+  return error_OK;
+}
+
+int datastruct_depth_stack_pop(datastruct_depth_stack_t *stack,
+                               datastruct_depth_entry_t *entry)
+{
+  if (stack->used == 0)
+    return 0;
+
+  *entry = stack->entries[--stack->used];
+
+  return 1;
+}
+
+void datastruct_depth_stack_fini(datastruct_depth_stack_t *stack)
+{
+  free(stack->entries);
+  datastruct_depth_stack_init(stack);
+}
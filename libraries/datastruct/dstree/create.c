@@ -26,13 +26,19 @@ error dstree_create(const void            *default_value,
   if (t == NULL)
     return error_OOM;
 
-  t->root          = NULL;
+  t->root          = NIL;
   t->default_value = default_value;
   t->destroy_key   = destroy_key;
   t->destroy_value = destroy_value;
 
   t->count         = 0;
 
+#ifdef DATASTRUCT_COMPACT
+  datastruct_pool_init(&t->pool, sizeof(dstree__node_t));
+#endif
+
+  INSTRUMENT_INIT(t);
+
   *pt = t;
 
   return error_OK;
@@ -17,7 +17,12 @@ static error dstree__destroy_node(dstree__node_t *n, int level, void *opaque)
 {
   NOT_USED(level);
 
+#ifdef DATASTRUCT_COMPACT
+  /* the pool is released in one go below */
+  dstree__node_clear(opaque, n);
+#else
   dstree__node_destroy(opaque, n);
+#endif
 
   return error_OK;
 }
@@ -26,6 +31,10 @@ void dstree_destroy(dstree_t *t)
 {
   (void) dstree__walk_internal_post(t, dstree__destroy_node, t);
 
+#ifdef DATASTRUCT_COMPACT
+  datastruct_pool_fini(&t->pool);
+#endif
+
   free(t);
 }
 
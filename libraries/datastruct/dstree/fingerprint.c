@@ -0,0 +1,28 @@
+/* --------------------------------------------------------------------------
+ *    Name: fingerprint.c
+ * Purpose: Associative array implemented as a digital search tree
+ * ----------------------------------------------------------------------- */
+
+#include <stddef.h>
+
+#include "datastruct/dstree.h"
+
+#include "impl.h"
+
+/* Fowler/Noll/Vo FNV-1a. A hash rather than the key's leading bytes since
+ * every node on a descent shares a growing prefix with the key sought. */
+unsigned int dstree__fingerprint(const void *key, size_t keylen)
+{
+  const unsigned char *s   = key;
+  const unsigned char *end = s + keylen;
+  unsigned int         h;
+
+  h = 0x811c9dc5;
+  while (s < end)
+  {
+    h ^= *s++;
+    h *= 0x01000193;
+  }
+
+  return h;
+}
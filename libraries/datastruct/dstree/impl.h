@@ -10,24 +10,31 @@
 
 #include "base/types.h"
 
+#include "datastruct/instrument.h"
 #include "datastruct/item.h"
+#include "datastruct/pool.h"
 
 #include "datastruct/dstree.h"
 
 /* ----------------------------------------------------------------------- */
 
+/* Nodes link to one another by pointer, or by pool index when built with
+ * DATASTRUCT_COMPACT. See pool.h. */
+typedef POOL_LINK(struct dstree__node) dstree__link_t;
+
 typedef struct dstree__node
 {
   /* using an array here rather than separate left,right elements makes some
    * operations more convenient */
-  struct dstree__node  *child[2]; /* left, right children */
+  dstree__link_t        child[2]; /* left, right children */
+  unsigned int          fingerprint; /* hash of the key */
   item_t                item;
 }
 dstree__node_t;
 
 struct dstree
 {
-  dstree__node_t       *root;
+  dstree__link_t        root;
 
   int                   count;
 
@@ -35,22 +42,45 @@ struct dstree
 
   dstree_destroy_key   *destroy_key;
   dstree_destroy_value *destroy_value;
+
+#ifdef DATASTRUCT_COMPACT
+  datastruct_pool_t     pool;
+#endif
+
+#ifdef DATASTRUCT_INSTRUMENT
+  datastruct_instrument_t instrument;
+#endif
 };
 
 /* ----------------------------------------------------------------------- */
 
-#define IS_LEAF(n) ((n)->child[0] == NULL && (n)->child[1] == NULL)
+#define NIL POOL_NIL
+
+/* Returns the node 'l' links to. 'l' must not be NIL. */
+#define NODE(t, l) POOL_NODE(t, dstree__node_t, l)
+
+/* As NODE, but maps NIL to NULL. */
+#define NODE_OR_NULL(t, l) ((l) == NIL ? NULL : NODE(t, l))
+
+#define IS_LEAF(n) ((n)->child[0] == NIL && (n)->child[1] == NIL)
 
 /* ----------------------------------------------------------------------- */
 
-dstree__node_t *dstree__node_create(dstree_t   *t,
-                                    const void *key,
-                                    const void *value,
-                                    size_t      keylen);
+/* Returns NIL if out of memory. */
+dstree__link_t dstree__node_create(dstree_t     *t,
+                                   const void   *key,
+                                   const void   *value,
+                                   size_t        keylen,
+                                   unsigned int  fingerprint);
+
+/* Hash a key for storing in its node. Descents compare the fingerprint
+ * first and only compare keys, which means fetching the key from wherever
+ * it lives, when the fingerprint and length match. */
+unsigned int dstree__fingerprint(const void *key, size_t keylen);
 
 void dstree__node_clear(dstree_t *t, dstree__node_t *n);
 
-void dstree__node_destroy(dstree_t *t, dstree__node_t *n);
+void dstree__node_destroy(dstree_t *t, dstree__link_t l);
 
 /* ----------------------------------------------------------------------- */
 
@@ -63,7 +93,8 @@ typedef error (dstree__walk_internal_callback)(dstree__node_t *n,
 error dstree__walk_internal_post(dstree_t                       *t,
                                  dstree__walk_internal_callback *cb,
                                  void                           *opaque);
-error dstree__walk_internal_post_node(dstree__node_t                 *root,
+error dstree__walk_internal_post_node(const dstree_t                 *t,
+                                      dstree__link_t                  root,
                                       int                             level,
                                       dstree__walk_internal_callback *cb,
                                       void                           *opaque);
@@ -19,24 +19,39 @@ error dstree_insert(dstree_t   *t,
 {
   const unsigned char *ukey    = key;
   const unsigned char *ukeyend = ukey + keylen;
+  unsigned int         fingerprint;
   int                  depth;
-  dstree__node_t     **pn;
+  dstree__link_t      *pl;
   dstree__node_t      *n;
   int                  dir;
   unsigned char        c = 0;
 
+  fingerprint = dstree__fingerprint(key, keylen);
+
   depth = 0;
 
-  for (pn = &t->root; (n = *pn); pn = &n->child[dir])
+  for (pl = &t->root; (n = NODE_OR_NULL(t, *pl)); pl = &n->child[dir])
   {
-    if (n->item.keylen == keylen && memcmp(n->item.key, key, keylen) == 0)
-      return error_EXISTS;
+    INSTRUMENT_VISIT(t);
+
+    if (n->fingerprint == fingerprint && n->item.keylen == keylen)
+    {
+      INSTRUMENT_COMPARE(t);
+      if (memcmp(n->item.key, key, keylen) == 0)
+        break;
+    }
 
     GET_NEXT_DIR(dir, ukey, ukeyend);
   }
 
-  *pn = dstree__node_create(t, key, value, keylen);
-  if (*pn == NULL)
+  INSTRUMENT_BITS(t, depth);
+  INSTRUMENT_END(t, INSERT);
+
+  if (n)
+    return error_EXISTS;
+
+  *pl = dstree__node_create(t, key, value, keylen, fingerprint);
+  if (*pl == NIL)
     return error_OOM;
 
   return error_OK;
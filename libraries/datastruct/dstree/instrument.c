@@ -0,0 +1,26 @@
+/* --------------------------------------------------------------------------
+ *    Name: instrument.c
+ * Purpose: Associative array implemented as a digital search tree
+ * ----------------------------------------------------------------------- */
+
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "datastruct/dstree.h"
+
+#include "impl.h"
+
+error dstree_instrument(const dstree_t          *t,
+                        datastruct_instrument_t *counts)
+{
+#ifdef DATASTRUCT_INSTRUMENT
+  *counts = t->instrument;
+
+  return error_OK;
+#else
+  NOT_USED(t);
+  NOT_USED(counts);
+
+  return error_NOT_IMPLEMENTED;
+#endif
+}
@@ -75,7 +75,7 @@ error dstree_lookup_prefix(const dstree_t        *t,
 
   depth = 0;
 
-  for (n = t->root; n; n = n->child[dir])
+  for (n = NODE_OR_NULL(t, t->root); n; n = NODE_OR_NULL(t, n->child[dir]))
   {
     if (n->item.keylen >= prefixlen &&
         memcmp(n->item.key, prefix, prefixlen) == 0)
@@ -104,7 +104,8 @@ error dstree_lookup_prefix(const dstree_t        *t,
 
   for (i = 0; i < 2; i++)
   {
-    err = dstree__walk_internal_post_node((dstree__node_t *) n->child[i],
+    err = dstree__walk_internal_post_node(t,
+                                          n->child[i],
                                           depth,
                                           dstree__lookup_prefix_node,
                                           &args);
@@ -13,21 +13,33 @@ const void *dstree_lookup(dstree_t *t, const void *key, size_t keylen)
 {
   const unsigned char  *ukey    = key;
   const unsigned char  *ukeyend = ukey + keylen;
+  unsigned int          fingerprint;
   int                   depth;
   const dstree__node_t *n;
   int                   dir;
   unsigned char         c = 0;
 
+  fingerprint = dstree__fingerprint(key, keylen);
+
   depth = 0;
 
-  for (n = t->root; n; n = n->child[dir])
+  for (n = NODE_OR_NULL(t, t->root); n; n = NODE_OR_NULL(t, n->child[dir]))
   {
-    if (n->item.keylen == keylen && memcmp(n->item.key, key, keylen) == 0)
-      return n->item.value; /* found */
+    INSTRUMENT_VISIT(t);
+
+    if (n->fingerprint == fingerprint && n->item.keylen == keylen)
+    {
+      INSTRUMENT_COMPARE(t);
+      if (memcmp(n->item.key, key, keylen) == 0)
+        break; /* found */
+    }
 
     GET_NEXT_DIR(dir, ukey, ukeyend);
   }
 
-  return t->default_value; /* not found */
+  INSTRUMENT_BITS(t, depth);
+  INSTRUMENT_END(t, LOOKUP);
+
+  return n ? n->item.value : t->default_value;
 }
 
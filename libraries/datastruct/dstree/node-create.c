@@ -12,25 +12,36 @@
 
 #include "impl.h"
 
-dstree__node_t *dstree__node_create(dstree_t   *t,
-                                    const void *key,
-                                    const void *value,
-                                    size_t      keylen)
+dstree__link_t dstree__node_create(dstree_t     *t,
+                                   const void   *key,
+                                   const void   *value,
+                                   size_t        keylen,
+                                   unsigned int  fingerprint)
 {
+  dstree__link_t  l;
   dstree__node_t *n;
 
-  n = malloc(sizeof(*n));
-  if (n == NULL)
-    return NULL;
+#ifdef DATASTRUCT_COMPACT
+  l = datastruct_pool_alloc(&t->pool);
+#else
+  l = malloc(sizeof(*l));
+#endif
+  if (l == NIL)
+    return NIL;
 
-  n->child[0]    = NULL;
-  n->child[1]    = NULL;
+  n = NODE(t, l);
+
+  n->child[0]    = NIL;
+  n->child[1]    = NIL;
+  n->fingerprint = fingerprint;
   n->item.key    = key;
   n->item.keylen = keylen;
   n->item.value  = value;
 
+  INSTRUMENT_ALLOC(t);
+
   t->count++;
 
-  return n;
+  return l;
 }
 
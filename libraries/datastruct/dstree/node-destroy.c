@@ -11,11 +11,17 @@
 
 #include "impl.h"
 
-void dstree__node_destroy(dstree_t *t, dstree__node_t *n)
+void dstree__node_destroy(dstree_t *t, dstree__link_t l)
 {
-  dstree__node_clear(t, n);
+  dstree__node_clear(t, NODE(t, l));
 
-  free(n);
+#ifdef DATASTRUCT_COMPACT
+  datastruct_pool_free(&t->pool, l);
+#else
+  free(l);
+#endif
+
+  INSTRUMENT_FREE(t);
 
   t->count--;
 }
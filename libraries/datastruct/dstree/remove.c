@@ -16,35 +16,50 @@ void dstree_remove(dstree_t *t, const void *key, size_t keylen)
 {
   const unsigned char *ukey    = key;
   const unsigned char *ukeyend = ukey + keylen;
+  unsigned int         fingerprint;
   int                  depth;
-  dstree__node_t     **pn;
+  dstree__link_t      *pl;
   dstree__node_t      *n;
   int                  dir;
   unsigned char        c;
-  dstree__node_t     **pm;
+  dstree__link_t      *pm;
   dstree__node_t      *m;
+  dstree__link_t       doomed;
+
+  fingerprint = dstree__fingerprint(key, keylen);
 
   depth = 0;
   c     = 0;
 
-  for (pn = &t->root; (n = *pn); pn = &n->child[dir])
+  for (pl = &t->root; (n = NODE_OR_NULL(t, *pl)); pl = &n->child[dir])
   {
-    if (n->item.keylen == keylen && memcmp(n->item.key, key, keylen) == 0)
-      break; /* found */
+    INSTRUMENT_VISIT(t);
+
+    if (n->fingerprint == fingerprint && n->item.keylen == keylen)
+    {
+      INSTRUMENT_COMPARE(t);
+      if (memcmp(n->item.key, key, keylen) == 0)
+        break; /* found */
+    }
 
     GET_NEXT_DIR(dir, ukey, ukeyend);
   }
 
+  INSTRUMENT_BITS(t, depth);
+  INSTRUMENT_END(t, REMOVE);
+
   if (n == NULL)
     return; /* doesn't exist */
 
-  /* pn now points to pointer to the doomed node */
+  /* pl now points to the link to the doomed node */
+
+  doomed = *pl;
 
   /* if the doomed node is a leaf node we just delete the parent pointer */
   if (IS_LEAF(n))
   {
-    *pn = NULL;
-    dstree__node_destroy(t, n);
+    *pl = NIL;
+    dstree__node_destroy(t, doomed);
     return;
   }
 
@@ -66,9 +81,9 @@ void dstree_remove(dstree_t *t, const void *key, size_t keylen)
      * if both are present, fetch a 'random' value from GET_NEXT_DIR() and
      * choose. this means that we only call it when necessary. */
 
-    if (m->child[1] == NULL)
+    if (m->child[1] == NIL)
       pm = &m->child[0];
-    else if (m->child[0] == NULL)
+    else if (m->child[0] == NIL)
       pm = &m->child[1];
     else
     {
@@ -77,18 +92,18 @@ void dstree_remove(dstree_t *t, const void *key, size_t keylen)
       depth--; /* GET_NEXT_DIR increments depth, which we must compensate for */
     }
 
-    m = *pm;
+    m = NODE(t, *pm);
     depth++;
   }
   while (!IS_LEAF(m));
 
   /* found leaf node */
 
-  *pm = NULL; /* detach */
+  *pl = *pm; /* reattach */
+  *pm = NIL; /* detach */
   m->child[0] = n->child[0];
   m->child[1] = n->child[1];
-  *pn = m; /* reattach */
 
-  dstree__node_destroy(t, n);
+  dstree__node_destroy(t, doomed);
 }
 
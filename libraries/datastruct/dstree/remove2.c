@@ -16,19 +16,24 @@ void dstree_remove2(dstree_t *t, const void *key, size_t keylen)
 {
   const unsigned char *ukey    = key;
   const unsigned char *ukeyend = ukey + keylen;
+  unsigned int         fingerprint;
   int                  depth;
-  dstree__node_t     **pn;
+  dstree__link_t      *pl;
   dstree__node_t      *n;
   unsigned char        c = 0;
   int                  dir;
-  dstree__node_t      *root;
-  dstree__node_t      *side;
+  dstree__link_t       doomed;
+  dstree__link_t       root;
+  dstree__link_t       side;
+
+  fingerprint = dstree__fingerprint(key, keylen);
 
   depth = 0;
 
-  for (pn = &t->root; (n = *pn); pn = &n->child[dir])
+  for (pl = &t->root; (n = NODE_OR_NULL(t, *pl)); pl = &n->child[dir])
   {
-    if (n->item.keylen == keylen && memcmp(n->item.key, key, keylen) == 0)
+    if (n->fingerprint == fingerprint &&
+        n->item.keylen == keylen && memcmp(n->item.key, key, keylen) == 0)
       break; /* found */
 
     GET_NEXT_DIR(dir, ukey, ukeyend);
@@ -39,35 +44,39 @@ void dstree_remove2(dstree_t *t, const void *key, size_t keylen)
 
   /* pick a random child. if that child's absent then pick the other */
   GET_NEXT_DIR(dir, ukey, ukeyend);
-  if (n->child[dir] == NULL)
+  if (n->child[dir] == NIL)
     dir = !dir;
 
   root = n->child[dir];  /* new tree root */
   side = n->child[!dir]; /* detached other side */
 
   /* detach root node */
-  *pn = NULL;
+  doomed = *pl;
+  *pl = NIL;
 
-  while (root)
+  while (root != NIL)
   {
     int             newdir;
-    dstree__node_t *nextroot, *nextside;
+    dstree__node_t *r;
+    dstree__link_t  nextroot, nextside;
+
+    r = NODE(t, root);
 
     GET_NEXT_DIR(newdir, ukey, ukeyend);
-    if (n->child[newdir] == NULL)
+    if (n->child[newdir] == NIL)
       newdir = !newdir;
 
-    nextroot = root->child[newdir];
-    nextside = root->child[!newdir];
+    nextroot = r->child[newdir];
+    nextside = r->child[!newdir];
 
-    root->child[dir]  = nextroot;
-    root->child[!dir] = side;
+    r->child[dir]  = nextroot;
+    r->child[!dir] = side;
 
     dir = newdir;
     root = nextroot;
     side = nextside;
   }
 
-  dstree__node_destroy(t, n);
+  dstree__node_destroy(t, doomed);
 }
 
@@ -16,6 +16,7 @@
 
 typedef struct dstree__show_viz_args
 {
+  const dstree_t      *t;
   dstree_show_key     *key;
   dstree_show_destroy *key_destroy;
   dstree_show_value   *value;
@@ -68,10 +69,12 @@ static error dstree__node_show_viz_link(dstree__node_t *n, int level, void *opaq
   value = args->value && n->item.value ? args->value(n->item.value) : NULL;
 
   (void) fprintf(args->f, "\t\"%p\" [shape=record, label=\"%s|%s\"];\n", n, key, value);
-  if (n->child[0] != NULL)
-    (void) fprintf(args->f, "\t\"%p\":sw -> \"%p\":n;\n", n, n->child[0]);
-  if (n->child[1] != NULL)
-    (void) fprintf(args->f, "\t\"%p\":se -> \"%p\":n;\n", n, n->child[1]);
+  if (n->child[0] != NIL)
+    (void) fprintf(args->f, "\t\"%p\":sw -> \"%p\":n;\n",
+                   (void *) n, (void *) NODE(args->t, n->child[0]));
+  if (n->child[1] != NIL)
+    (void) fprintf(args->f, "\t\"%p\":se -> \"%p\":n;\n",
+                   (void *) n, (void *) NODE(args->t, n->child[1]));
 
   if (args->key_destroy   && key)   args->key_destroy((char *) key);
   if (args->value_destroy && value) args->value_destroy((char *) value);
@@ -89,6 +92,7 @@ error dstree_show_viz(const dstree_t      *t,
   error                    err;
   dstree__show_viz_args_t args;
 
+  args.t             = t;
   args.key           = key;
   args.key_destroy   = key_destroy;
   args.value         = value;
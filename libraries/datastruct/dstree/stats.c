@@ -0,0 +1,27 @@
+/* --------------------------------------------------------------------------
+ *    Name: stats.c
+ * Purpose: Associative array implemented as a digital search tree
+ * ----------------------------------------------------------------------- */
+
+#include <string.h>
+
+#include "datastruct/dstree.h"
+
+#include "impl.h"
+
+void dstree_stats(const dstree_t *t, datastruct_stats_t *stats)
+{
+  memset(stats, 0, sizeof(*stats));
+
+  stats->elements    = t->count;
+  stats->leaves      = t->count;
+  stats->node_bytes  = t->count * sizeof(dstree__node_t);
+#ifdef DATASTRUCT_COMPACT
+  /* the pool's unused elements and its array of segments */
+  stats->table_bytes = datastruct_pool_bytes(&t->pool) - stats->node_bytes;
+  stats->slack_bytes = stats->table_bytes;
+#endif
+  stats->other_bytes = sizeof(*t);
+  stats->total_bytes = stats->node_bytes + stats->table_bytes +
+                       stats->other_bytes;
+}
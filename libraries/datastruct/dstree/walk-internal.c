@@ -13,19 +13,24 @@
 #include "impl.h"
 
 /* post-order (which allows for deletions) */
-static error dstree__node_walk_internal_post(dstree__node_t                 *n,
+static error dstree__node_walk_internal_post(const dstree_t                 *t,
+                                             dstree__link_t                  l,
                                              int                             level,
                                              dstree__walk_internal_callback *cb,
                                              void                           *opaque)
 {
-  error err;
+  error           err;
+  dstree__node_t *n;
 
-  if (n == NULL)
+  if (l == NIL)
     return error_OK;
 
-  err = dstree__node_walk_internal_post(n->child[0], level + 1, cb, opaque);
+  n = NODE(t, l);
+
+  err = dstree__node_walk_internal_post(t, n->child[0], level + 1, cb, opaque);
   if (!err)
-    err = dstree__node_walk_internal_post(n->child[1], level + 1, cb, opaque);
+    err = dstree__node_walk_internal_post(t, n->child[1], level + 1,
+                                          cb, opaque);
   if (!err)
     err = cb(n, level, opaque);
 
@@ -39,35 +44,40 @@ error dstree__walk_internal_post(dstree_t                       *t,
   if (t == NULL)
     return error_OK;
 
-  return dstree__node_walk_internal_post(t->root, 0, cb, opaque);
+  return dstree__node_walk_internal_post(t, t->root, 0, cb, opaque);
 }
 
-error dstree__walk_internal_post_node(dstree__node_t                 *root,
+error dstree__walk_internal_post_node(const dstree_t                 *t,
+                                      dstree__link_t                  root,
                                       int                             level,
                                       dstree__walk_internal_callback *cb,
                                       void                           *opaque)
 {
-  if (root == NULL)
+  if (root == NIL)
     return error_OK;
 
-  return dstree__node_walk_internal_post(root, level, cb, opaque);
+  return dstree__node_walk_internal_post(t, root, level, cb, opaque);
 }
 
-static error dstree__node_walk_internal(dstree__node_t                 *n,
+static error dstree__node_walk_internal(const dstree_t                 *t,
+                                        dstree__link_t                  l,
                                         int                             level,
                                         dstree__walk_internal_callback *cb,
                                         void                           *opaque)
 {
-  error err;
+  error           err;
+  dstree__node_t *n;
 
-  if (n == NULL)
+  if (l == NIL)
     return error_OK;
 
-  err = dstree__node_walk_internal(n->child[0], level + 1, cb, opaque);
+  n = NODE(t, l);
+
+  err = dstree__node_walk_internal(t, n->child[0], level + 1, cb, opaque);
   if (!err)
     err = cb(n, level, opaque);
   if (!err)
-    err = dstree__node_walk_internal(n->child[1], level + 1, cb, opaque);
+    err = dstree__node_walk_internal(t, n->child[1], level + 1, cb, opaque);
 
   return err;
 }
@@ -80,6 +90,6 @@ error dstree__walk_internal(dstree_t                       *t,
   if (t == NULL)
     return error_OK;
 
-  return dstree__node_walk_internal(t->root, 0, cb, opaque);
+  return dstree__node_walk_internal(t, t->root, 0, cb, opaque);
 }
 
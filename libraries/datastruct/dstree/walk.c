@@ -11,21 +11,25 @@
 
 #include "impl.h"
 
-static error dstree__node_walk(const dstree__node_t *n,
+static error dstree__node_walk(const dstree_t       *t,
+                               dstree__link_t        l,
                                int                   level,
                                dstree_walk_callback *cb,
                                void                 *opaque)
 {
-  error err;
+  error                 err;
+  const dstree__node_t *n;
 
-  if (n == NULL)
+  if (l == NIL)
     return error_OK;
 
-  err = dstree__node_walk(n->child[0], level + 1, cb, opaque);
+  n = NODE(t, l);
+
+  err = dstree__node_walk(t, n->child[0], level + 1, cb, opaque);
   if (!err)
     err = cb(&n->item, level, opaque);
   if (!err)
-    err = dstree__node_walk(n->child[1], level + 1, cb, opaque);
+    err = dstree__node_walk(t, n->child[1], level + 1, cb, opaque);
 
   return err;
 }
@@ -38,6 +42,6 @@ error dstree_walk(const dstree_t       *t,
   if (t == NULL)
     return error_OK;
 
-  return dstree__node_walk(t->root, 0, cb, opaque);
+  return dstree__node_walk(t, t->root, 0, cb, opaque);
 }
 
@@ -0,0 +1,131 @@
+/* --------------------------------------------------------------------------
+ *    Name: bloom.c
+ * Purpose: Approximate membership filters
+ * ----------------------------------------------------------------------- */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/memento/memento.h"
+
+#include "base/errors.h"
+
+#include "datastruct/filter.h"
+
+/* ----------------------------------------------------------------------- */
+
+/* A "split block" Bloom filter, as used by Apache Parquet and Impala. Each
+ * block is eight 32-bit words and a key sets one bit in each word. The
+ * bits are chosen by multiplying the low half of the hash by a different
+ * odd constant per word and taking the top five bits. The high half of the
+ * hash chooses the block. */
+
+#define BITS_PER_KEY 12
+
+typedef uint32_t filter_bloom__block_t[8];
+
+struct filter_bloom
+{
+  void                  *alloc;   /* as returned by malloc */
+  filter_bloom__block_t *blocks;  /* 'alloc' aligned to a block */
+  uint32_t               nblocks;
+  int                    count;
+};
+
+static const uint32_t filter_bloom__salts[8] =
+{
+  0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+  0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u
+};
+
+#define BLOCK(b, h) (&(b)->blocks[((h) >> 32) * (b)->nblocks >> 32])
+
+/* ----------------------------------------------------------------------- */
+
+error filter_bloom_create(int capacity, filter_bloom_t **pbloom)
+{
+  filter_bloom_t *bloom;
+  uint64_t        nblocks;
+
+  bloom = malloc(sizeof(*bloom));
+  if (bloom == NULL)
+    return error_OOM;
+
+  nblocks = ((uint64_t) (capacity > 0 ? capacity : 1) * BITS_PER_KEY +
+             sizeof(filter_bloom__block_t) * 8 - 1) /
+            (sizeof(filter_bloom__block_t) * 8);
+  if (nblocks > 0xffffffffu)
+    nblocks = 0xffffffffu;
+
+  /* over-allocate so that no block straddles two cache lines */
+  bloom->alloc = malloc((nblocks + 1) * sizeof(filter_bloom__block_t));
+  if (bloom->alloc == NULL)
+  {
+    free(bloom);
+    return error_OOM;
+  }
+
+  bloom->blocks  = (filter_bloom__block_t *)
+                   (((uintptr_t) bloom->alloc +
+                     sizeof(filter_bloom__block_t) - 1) &
+                    ~(uintptr_t) (sizeof(filter_bloom__block_t) - 1));
+  bloom->nblocks = (uint32_t) nblocks;
+
+  filter_bloom_clear(bloom);
+
+  *pbloom = bloom;
+
+  return error_OK;
+}
+
+void filter_bloom_destroy(filter_bloom_t *doomed)
+{
+  if (doomed == NULL)
+    return;
+
+  free(doomed->alloc);
+  free(doomed);
+}
+
+void filter_bloom_add(filter_bloom_t *bloom, uint64_t hash)
+{
+  uint32_t *block = *BLOCK(bloom, hash);
+  uint32_t  lo    = (uint32_t) hash;
+  int       i;
+
+  for (i = 0; i < 8; i++)
+    block[i] |= 1u << ((lo * filter_bloom__salts[i]) >> 27);
+
+  bloom->count++;
+}
+
+int filter_bloom_contains(const filter_bloom_t *bloom, uint64_t hash)
+{
+  const uint32_t *block = *BLOCK(bloom, hash);
+  uint32_t        lo    = (uint32_t) hash;
+  int             i;
+
+  for (i = 0; i < 8; i++)
+    if ((block[i] & (1u << ((lo * filter_bloom__salts[i]) >> 27))) == 0)
+      return 0;
+
+  return 1;
+}
+
+void filter_bloom_clear(filter_bloom_t *bloom)
+{
+  memset(bloom->blocks, 0, bloom->nblocks * sizeof(*bloom->blocks));
+  bloom->count = 0;
+}
+
+void filter_bloom_stats(const filter_bloom_t *bloom, datastruct_stats_t *stats)
+{
+  memset(stats, 0, sizeof(*stats));
+
+  stats->elements    = bloom->count;
+  stats->table_bytes = (bloom->nblocks + 1) * sizeof(*bloom->blocks);
+  stats->slack_bytes = sizeof(*bloom->blocks);
+  stats->other_bytes = sizeof(*bloom);
+  stats->total_bytes = stats->table_bytes + stats->other_bytes;
+}
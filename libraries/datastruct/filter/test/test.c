@@ -0,0 +1,203 @@
+/* test.c */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "base/memento/memento.h"
+
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "datastruct/filter.h"
+
+error filtertest(void);
+
+/* ----------------------------------------------------------------------- */
+
+#define NKEYS   100000
+#define NABSENT 100000
+
+static uint64_t hashes[NKEYS + NABSENT];
+
+/* The SplitMix64 generator: distinct, well mixed hashes. */
+static void filtertest_make_hashes(void)
+{
+  uint64_t state = 0;
+  int      i;
+
+  for (i = 0; i < NKEYS + NABSENT; i++)
+  {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    hashes[i] = z ^ (z >> 31);
+  }
+}
+
+/* ----------------------------------------------------------------------- */
+
+static error filtertest1(void)
+{
+  error              err;
+  filter_bloom_t    *bloom;
+  datastruct_stats_t stats;
+  int                i;
+  int                fp;
+
+  printf("> filter test 1 - Bloom filter\n");
+
+  err = filter_bloom_create(NKEYS, &bloom);
+  if (err)
+    return err;
+
+  for (i = 0; i < NKEYS; i++)
+    filter_bloom_add(bloom, hashes[i]);
+
+  for (i = 0; i < NKEYS; i++)
+    if (!filter_bloom_contains(bloom, hashes[i]))
+    {
+      printf("key %d missing\n", i);
+      err = error_TEST_FAILED;
+      goto exit;
+    }
+
+  fp = 0;
+  for (i = NKEYS; i < NKEYS + NABSENT; i++)
+    fp += filter_bloom_contains(bloom, hashes[i]);
+
+  filter_bloom_stats(bloom, &stats);
+
+  printf("false positives: %.2f%%, %.1f bits per key\n",
+         100.0 * fp / NABSENT, stats.total_bytes * 8.0 / NKEYS);
+
+  if (fp > NABSENT / 50 || stats.elements != NKEYS)
+  {
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+  filter_bloom_clear(bloom);
+
+  fp = 0;
+  for (i = 0; i < NKEYS; i++)
+    fp += filter_bloom_contains(bloom, hashes[i]);
+  if (fp)
+  {
+    printf("cleared filter isn't empty\n");
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+exit:
+
+  filter_bloom_destroy(bloom);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+static error filtertest_xor(int n)
+{
+  error              err;
+  filter_xor_t      *xf;
+  datastruct_stats_t stats;
+  int                i;
+  int                fp;
+
+  err = filter_xor_create(hashes, n, &xf);
+  if (err)
+    return err;
+
+  for (i = 0; i < n; i++)
+    if (!filter_xor_contains(xf, hashes[i]))
+    {
+      printf("key %d of %d missing\n", i, n);
+      err = error_TEST_FAILED;
+      goto exit;
+    }
+
+  fp = 0;
+  for (i = NKEYS; i < NKEYS + NABSENT; i++)
+    fp += filter_xor_contains(xf, hashes[i]);
+
+  filter_xor_stats(xf, &stats);
+
+  if (n == NKEYS)
+    printf("false positives: %.2f%%, %.1f bits per key\n",
+           100.0 * fp / NABSENT, stats.total_bytes * 8.0 / n);
+
+  if (fp > NABSENT / 50 || stats.elements != n)
+    err = error_TEST_FAILED;
+
+exit:
+
+  filter_xor_destroy(xf);
+
+  return err;
+}
+
+static error filtertest2(void)
+{
+  static const int sizes[] = { 0, 1, 2, 10, 1000, NKEYS };
+
+  error         err;
+  filter_xor_t *xf;
+  uint64_t      dups[4];
+  int           i;
+
+  printf("> filter test 2 - XOR filter\n");
+
+  for (i = 0; i < NELEMS(sizes); i++)
+  {
+    err = filtertest_xor(sizes[i]);
+    if (err)
+    {
+      printf("failed with %d keys\n", sizes[i]);
+      return err;
+    }
+  }
+
+  /* duplicates are tolerated */
+  dups[0] = dups[1] = dups[2] = hashes[0];
+  dups[3] = hashes[1];
+
+  err = filter_xor_create(dups, NELEMS(dups), &xf);
+  if (err)
+    return err;
+
+  if (!filter_xor_contains(xf, hashes[0]) ||
+      !filter_xor_contains(xf, hashes[1]))
+    err = error_TEST_FAILED;
+
+  filter_xor_destroy(xf);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+error filtertest(void)
+{
+  error err;
+
+  printf(">> filter test\n");
+
+  filtertest_make_hashes();
+
+  err = filtertest1();
+  if (!err)
+    err = filtertest2();
+  if (err)
+  {
+    printf("unexpected error: %lx\n", err);
+    return err;
+  }
+
+  printf("<< filter tests ok\n");
+
+  return error_OK;
+}
@@ -0,0 +1,280 @@
+/* --------------------------------------------------------------------------
+ *    Name: xor.c
+ * Purpose: Approximate membership filters
+ * ----------------------------------------------------------------------- */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/memento/memento.h"
+
+#include "base/errors.h"
+
+#include "datastruct/filter.h"
+
+/* ----------------------------------------------------------------------- */
+
+/* An 8-bit XOR filter, as described in "Xor Filters: Faster and Smaller
+ * Than Bloom and Cuckoo Filters", Graf and Lemire, 2020.
+ *
+ * The slots are split into three equal segments and each key maps to one
+ * slot in each. Building assigns fingerprints so that the XOR of a key's
+ * three slots equals the key's fingerprint. It finds an order in which to
+ * assign them by "peeling": repeatedly taking a slot which only one
+ * remaining key maps to, which succeeds with high probability once there
+ * are 1.23 slots per key. Otherwise it tries another seed. */
+
+#define MAXSEEDS 64
+
+struct filter_xor
+{
+  uint64_t  seed;
+  uint32_t  segment;  /* slots per segment */
+  uint8_t  *fingerprints;
+  int       count;
+};
+
+/* Slots of the peeling: the XOR of the keys mapped to it and their count. */
+typedef struct filter_xor__set
+{
+  uint64_t  keys;
+  uint32_t  count;
+}
+filter_xor__set_t;
+
+/* A key peeled from a slot. */
+typedef struct filter_xor__peeled
+{
+  uint64_t  key;
+  uint32_t  slot;
+}
+filter_xor__peeled_t;
+
+/* ----------------------------------------------------------------------- */
+
+/* The SplitMix64 finaliser. */
+static uint64_t filter_xor__mix(uint64_t h)
+{
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ull;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebull;
+  h ^= h >> 31;
+
+  return h;
+}
+
+#define ROTL(x, n)        (((x) << (n)) | ((x) >> (64 - (n))))
+#define REDUCE(x, n)      ((uint32_t) (((uint64_t) (uint32_t) (x) * (n)) >> 32))
+#define FINGERPRINT(h)    ((uint8_t) ((h) ^ ((h) >> 32)))
+
+/* Return slot 'i' of the three for mixed hash 'h'. */
+static uint32_t filter_xor__slot(const filter_xor_t *xf, uint64_t h, int i)
+{
+  return REDUCE(i ? ROTL(h, 21 * i) : h, xf->segment) + i * xf->segment;
+}
+
+/* ----------------------------------------------------------------------- */
+
+static int filter_xor__compare(const void *a_, const void *b_)
+{
+  uint64_t a = *(const uint64_t *) a_;
+  uint64_t b = *(const uint64_t *) b_;
+
+  return (a > b) - (a < b);
+}
+
+/* Try to peel under the filter's current seed. Returns non-zero on success
+ * with 'stack' holding the keys in peeling order. */
+static int filter_xor__peel(filter_xor_t         *xf,
+                            const uint64_t       *keys,
+                            int                   n,
+                            filter_xor__set_t    *sets,
+                            uint32_t             *queue,
+                            filter_xor__peeled_t *stack)
+{
+  uint32_t nslots = 3 * xf->segment;
+  uint32_t head, tail;
+  uint32_t s;
+  int      npeeled;
+  int      i, j;
+
+  memset(sets, 0, nslots * sizeof(*sets));
+
+  for (i = 0; i < n; i++)
+  {
+    uint64_t h = filter_xor__mix(keys[i] + xf->seed);
+
+    for (j = 0; j < 3; j++)
+    {
+      s = filter_xor__slot(xf, h, j);
+      sets[s].keys ^= h;
+      sets[s].count++;
+    }
+  }
+
+  tail = 0;
+  for (s = 0; s < nslots; s++)
+    if (sets[s].count == 1)
+      queue[tail++] = s;
+
+  npeeled = 0;
+  for (head = 0; head < tail; head++)
+  {
+    uint64_t h;
+
+    s = queue[head];
+    if (sets[s].count != 1)
+      continue; /* emptied since it was queued */
+
+    h = sets[s].keys;
+
+    stack[npeeled].key  = h;
+    stack[npeeled].slot = s;
+    npeeled++;
+
+    for (j = 0; j < 3; j++)
+    {
+      uint32_t t = filter_xor__slot(xf, h, j);
+
+      sets[t].keys ^= h;
+      if (--sets[t].count == 1)
+        queue[tail++] = t;
+    }
+  }
+
+  return npeeled == n;
+}
+
+error filter_xor_create(const uint64_t *hashes, int n, filter_xor_t **pxf)
+{
+  error                 err;
+  filter_xor_t         *xf;
+  uint64_t             *keys     = NULL;
+  filter_xor__set_t    *sets     = NULL;
+  uint32_t             *queue    = NULL;
+  filter_xor__peeled_t *stack    = NULL;
+  uint32_t              nslots;
+  int                   nkeys;
+  int                   seed;
+  int                   i, j;
+
+  xf = malloc(sizeof(*xf));
+  if (xf == NULL)
+    return error_OOM;
+
+  xf->fingerprints = NULL;
+
+  /* peeling can't separate equal keys, so drop duplicates */
+  keys = malloc((n ? n : 1) * sizeof(*keys));
+  if (keys == NULL)
+  {
+    err = error_OOM;
+    goto failure;
+  }
+
+  memcpy(keys, hashes, n * sizeof(*keys));
+  qsort(keys, n, sizeof(*keys), filter_xor__compare);
+
+  nkeys = 0;
+  for (i = 0; i < n; i++)
+    if (nkeys == 0 || keys[i] != keys[nkeys - 1])
+      keys[nkeys++] = keys[i];
+
+  xf->segment      = (uint32_t) ((32 + 1.23 * nkeys) / 3) + 1;
+  xf->count        = nkeys;
+  nslots           = 3 * xf->segment;
+
+  xf->fingerprints = calloc(nslots, sizeof(*xf->fingerprints));
+  sets             = malloc(nslots * sizeof(*sets));
+  queue            = malloc(3 * (nkeys + 1) * sizeof(*queue) +
+                            nslots * sizeof(*queue));
+  stack            = malloc((nkeys ? nkeys : 1) * sizeof(*stack));
+  if (xf->fingerprints == NULL || sets == NULL || queue == NULL ||
+      stack == NULL)
+  {
+    err = error_OOM;
+    goto failure;
+  }
+
+  for (seed = 0; seed < MAXSEEDS; seed++)
+  {
+    xf->seed = filter_xor__mix(seed + 1);
+    if (filter_xor__peel(xf, keys, nkeys, sets, queue, stack))
+      break;
+  }
+
+  if (seed == MAXSEEDS)
+  {
+    err = error_FILTER_FAILED;
+    goto failure;
+  }
+
+  /* assign in reverse peeling order: each key's own slot is the last of
+   * its three to be assigned */
+  for (i = nkeys - 1; i >= 0; i--)
+  {
+    uint64_t h = stack[i].key;
+    uint8_t  f = FINGERPRINT(h);
+
+    for (j = 0; j < 3; j++)
+    {
+      uint32_t t = filter_xor__slot(xf, h, j);
+
+      if (t != stack[i].slot)
+        f ^= xf->fingerprints[t];
+    }
+
+    xf->fingerprints[stack[i].slot] = f;
+  }
+
+  free(stack);
+  free(queue);
+  free(sets);
+  free(keys);
+
+  *pxf = xf;
+
+  return error_OK;
+
+
+failure:
+
+  free(stack);
+  free(queue);
+  free(sets);
+  free(keys);
+  free(xf->fingerprints);
+  free(xf);
+
+  return err;
+}
+
+void filter_xor_destroy(filter_xor_t *doomed)
+{
+  if (doomed == NULL)
+    return;
+
+  free(doomed->fingerprints);
+  free(doomed);
+}
+
+int filter_xor_contains(const filter_xor_t *xf, uint64_t hash)
+{
+  uint64_t h = filter_xor__mix(hash + xf->seed);
+
+  return FINGERPRINT(h) == (xf->fingerprints[filter_xor__slot(xf, h, 0)] ^
+                            xf->fingerprints[filter_xor__slot(xf, h, 1)] ^
+                            xf->fingerprints[filter_xor__slot(xf, h, 2)]);
+}
+
+void filter_xor_stats(const filter_xor_t *xf, datastruct_stats_t *stats)
+{
+  memset(stats, 0, sizeof(*stats));
+
+  stats->elements    = xf->count;
+  stats->table_bytes = 3 * xf->segment * sizeof(*xf->fingerprints);
+  stats->other_bytes = sizeof(*xf);
+  stats->total_bytes = stats->table_bytes + stats->other_bytes;
+}
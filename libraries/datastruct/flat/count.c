@@ -0,0 +1,18 @@
+/* --------------------------------------------------------------------------
+ *    Name: count.c
+ * Purpose: Read-only associative array held in a flat, mappable file
+ * ----------------------------------------------------------------------- */
+
+#include "datastruct/flat.h"
+
+#include "impl.h"
+
+int flat_count(const flat_t *f)
+{
+  return (int) f->header->nentries;
+}
+
+flat_kind_t flat_kind(const flat_t *f)
+{
+  return (flat_kind_t) f->header->kind;
+}
@@ -0,0 +1,76 @@
+/* --------------------------------------------------------------------------
+ *    Name: impl.h
+ * Purpose: Read-only associative array held in a flat, mappable file
+ * ----------------------------------------------------------------------- */
+
+#ifndef FLAT_IMPL_H
+#define FLAT_IMPL_H
+
+#include <stddef.h>
+
+#include "base/types.h"
+
+#include "datastruct/flat.h"
+
+/* ----------------------------------------------------------------------- */
+
+/* The file layout. All offsets are from the start of the file. The fields
+ * are ordered so that no padding is needed. */
+
+#define FLAT_MAGIC     "DSFLAT1"
+#define FLAT_BYTEORDER 0x01020304u
+
+typedef struct flat__header
+{
+  char                  magic[8];  /* FLAT_MAGIC, NUL-terminated */
+  uint32_t              byteorder; /* FLAT_BYTEORDER as the writer saw it */
+  uint32_t              kind;      /* flat_kind_t */
+  uint64_t              nentries;
+  uint64_t              nbins;     /* zero for sorted files */
+  uint64_t              entries;   /* offset of flat__entry_t[nentries] */
+  uint64_t              bins;      /* offset of uint32_t[nbins + 1] */
+  uint64_t              blob;      /* offset of key and value bytes */
+  uint64_t              size;      /* of the whole file */
+}
+flat__header_t;
+
+typedef struct flat__entry
+{
+  uint64_t              key;       /* offset of key */
+  uint64_t              value;     /* offset of value */
+  uint32_t              keylen;
+  uint32_t              valuelen;
+}
+flat__entry_t;
+
+/* Bin 'b' of a hashed file holds entries bins[b] to bins[b + 1] - 1. */
+
+struct flat
+{
+  const unsigned char  *base;      /* the mapping */
+  size_t                size;
+  int                   mapped;    /* base was mmap'd rather than malloc'd */
+
+  const flat__header_t *header;
+  const flat__entry_t  *entries;
+  const uint32_t       *bins;
+};
+
+/* ----------------------------------------------------------------------- */
+
+/* Hash 'keylen' bytes of 'key'. Fowler/Noll/Vo FNV-1, as stringkv_hash. */
+unsigned int flat__hash(const void *key, size_t keylen);
+
+/* Compare keys in the order of sorted files. */
+int flat__compare(const void *a, size_t alen, const void *b, size_t blen);
+
+/* Returns the index of the first entry of a sorted file whose key is not
+ * less than 'key'. */
+int flat__lower_bound(const flat_t *f, const void *key, size_t keylen);
+
+#define ENTRY_KEY(f, e)   ((const void *) ((f)->base + (e)->key))
+#define ENTRY_VALUE(f, e) ((const void *) ((f)->base + (e)->value))
+
+/* ----------------------------------------------------------------------- */
+
+#endif /* FLAT_IMPL_H */
@@ -0,0 +1,54 @@
+/* --------------------------------------------------------------------------
+ *    Name: lookup-prefix.c
+ * Purpose: Read-only associative array held in a flat, mappable file
+ * ----------------------------------------------------------------------- */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "base/errors.h"
+
+#include "datastruct/flat.h"
+
+#include "impl.h"
+
+error flat_lookup_prefix(const flat_t        *f,
+                         const void          *prefix,
+                         size_t               prefixlen,
+                         flat_found_callback *cb,
+                         void                *opaque)
+{
+  error err;
+  int   n;
+  int   i;
+  int   found;
+
+  if (f->header->kind != flat_KIND_SORTED)
+    return error_NOT_IMPLEMENTED;
+
+  n = (int) f->header->nentries;
+
+  /* keys sharing a prefix are adjacent and begin where the prefix would */
+  found = 0;
+  for (i = flat__lower_bound(f, prefix, prefixlen); i < n; i++)
+  {
+    const flat__entry_t *e = &f->entries[i];
+    item_t               item;
+
+    if (e->keylen < prefixlen ||
+        memcmp(ENTRY_KEY(f, e), prefix, prefixlen) != 0)
+      break;
+
+    item.key    = ENTRY_KEY(f, e);
+    item.keylen = e->keylen;
+    item.value  = ENTRY_VALUE(f, e);
+
+    err = cb(&item, opaque);
+    if (err)
+      return err;
+
+    found = 1;
+  }
+
+  return found ? error_OK : error_NOT_FOUND;
+}
@@ -0,0 +1,108 @@
+/* --------------------------------------------------------------------------
+ *    Name: lookup.c
+ * Purpose: Read-only associative array held in a flat, mappable file
+ * ----------------------------------------------------------------------- */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "datastruct/flat.h"
+
+#include "impl.h"
+
+/* ----------------------------------------------------------------------- */
+
+unsigned int flat__hash(const void *key, size_t keylen)
+{
+  const unsigned char *s    = key;
+  const unsigned char *end  = s + keylen;
+  unsigned int         h;
+
+  h = 0x811c9dc5;
+  while (s < end)
+  {
+    h += (h << 1) + (h << 4) + (h << 7) + (h << 8) + (h << 24);
+    h ^= *s++;
+  }
+
+  return h;
+}
+
+int flat__compare(const void *a, size_t alen, const void *b, size_t blen)
+{
+  int r;
+
+  r = memcmp(a, b, MIN(alen, blen));
+  if (r)
+    return r;
+
+  return (alen > blen) - (alen < blen);
+}
+
+int flat__lower_bound(const flat_t *f, const void *key, size_t keylen)
+{
+  int lo, hi;
+
+  lo = 0;
+  hi = (int) f->header->nentries;
+  while (lo < hi)
+  {
+    int                  mid = lo + (hi - lo) / 2;
+    const flat__entry_t *e   = &f->entries[mid];
+
+    if (flat__compare(ENTRY_KEY(f, e), e->keylen, key, keylen) < 0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return lo;
+}
+
+/* ----------------------------------------------------------------------- */
+
+const void *flat_lookup(const flat_t *f,
+                        const void   *key,
+                        size_t        keylen,
+                        size_t       *valuelen)
+{
+  const flat__entry_t *e;
+
+  if (f->header->kind == flat_KIND_HASHED)
+  {
+    unsigned int b;
+    uint32_t     i;
+
+    b = flat__hash(key, keylen) & (f->header->nbins - 1);
+    for (i = f->bins[b]; i < f->bins[b + 1]; i++)
+    {
+      e = &f->entries[i];
+      if (e->keylen == keylen && memcmp(ENTRY_KEY(f, e), key, keylen) == 0)
+        goto found;
+    }
+  }
+  else
+  {
+    int i;
+
+    i = flat__lower_bound(f, key, keylen);
+    if (i < (int) f->header->nentries)
+    {
+      e = &f->entries[i];
+      if (e->keylen == keylen && memcmp(ENTRY_KEY(f, e), key, keylen) == 0)
+        goto found;
+    }
+  }
+
+  return NULL;
+
+found:
+
+  if (valuelen)
+    *valuelen = e->valuelen;
+
+  return ENTRY_VALUE(f, e);
+}
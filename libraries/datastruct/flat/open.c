@@ -0,0 +1,208 @@
+/* --------------------------------------------------------------------------
+ *    Name: open.c
+ * Purpose: Read-only associative array held in a flat, mappable file
+ * ----------------------------------------------------------------------- */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "base/memento/memento.h"
+
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "datastruct/flat.h"
+
+#include "impl.h"
+
+/* ----------------------------------------------------------------------- */
+
+#ifdef _WIN32
+
+/* No mmap here so read the whole file into memory instead. */
+static error flat__map(const char           *filename,
+                       const unsigned char **pbase,
+                       size_t               *psize,
+                       int                  *pmapped)
+{
+  error          err;
+  FILE          *fp;
+  long           size;
+  unsigned char *base = NULL;
+
+  fp = fopen(filename, "rb");
+  if (fp == NULL)
+    return error_IO;
+
+  if (fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) < 0 ||
+      fseek(fp, 0, SEEK_SET) != 0)
+  {
+    err = error_IO;
+    goto exit;
+  }
+
+  base = malloc(size ? size : 1);
+  if (base == NULL)
+  {
+    err = error_OOM;
+    goto exit;
+  }
+
+  if (fread(base, 1, size, fp) != (size_t) size)
+  {
+    free(base);
+    err = error_IO;
+    goto exit;
+  }
+
+  *pbase   = base;
+  *psize   = size;
+  *pmapped = 0;
+
+  err = error_OK;
+
+exit:
+
+  fclose(fp);
+
+  return err;
+}
+
+#else
+
+static error flat__map(const char           *filename,
+                       const unsigned char **pbase,
+                       size_t               *psize,
+                       int                  *pmapped)
+{
+  int         fd;
+  struct stat st;
+  void       *base;
+
+  fd = open(filename, O_RDONLY);
+  if (fd < 0)
+    return error_IO;
+
+  if (fstat(fd, &st) != 0 || st.st_size == 0)
+  {
+    close(fd);
+    return error_IO;
+  }
+
+  base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); /* the mapping holds its own reference */
+  if (base == MAP_FAILED)
+    return error_IO;
+
+  *pbase   = base;
+  *psize   = st.st_size;
+  *pmapped = 1;
+
+  return error_OK;
+}
+
+#endif
+
+static void flat__unmap(flat_t *f)
+{
+#ifndef _WIN32
+  if (f->mapped)
+  {
+    munmap((void *) f->base, f->size);
+    return;
+  }
+#endif
+
+  free((void *) f->base);
+}
+
+/* ----------------------------------------------------------------------- */
+
+/* Check that the header describes sections which lie within the file. */
+static int flat__valid(const flat_t *f)
+{
+  const flat__header_t *h = f->header;
+
+  if (f->size < sizeof(*h)                               ||
+      memcmp(h->magic, FLAT_MAGIC, sizeof(h->magic)) != 0 ||
+      h->byteorder != FLAT_BYTEORDER                     ||
+      h->size != f->size)
+    return 0;
+
+  if (h->nentries > 0x7fffffff                         ||
+      h->entries % 8 != 0                              ||
+      h->entries > h->size                             ||
+      h->nentries > (h->size - h->entries) / sizeof(flat__entry_t))
+    return 0;
+
+  switch (h->kind)
+  {
+  case flat_KIND_SORTED:
+    if (h->nbins != 0)
+      return 0;
+    break;
+
+  case flat_KIND_HASHED:
+    if (h->nbins == 0 || (h->nbins & (h->nbins - 1)) != 0 ||
+        h->bins % 4 != 0                                  ||
+        h->bins > h->size                                 ||
+        h->nbins >= (h->size - h->bins) / sizeof(uint32_t))
+      return 0;
+    break;
+
+  default:
+    return 0;
+  }
+
+  return h->blob <= h->size;
+}
+
+error flat_open(const char *filename, flat_t **pf)
+{
+  error   err;
+  flat_t *f;
+
+  f = malloc(sizeof(*f));
+  if (f == NULL)
+    return error_OOM;
+
+  err = flat__map(filename, &f->base, &f->size, &f->mapped);
+  if (err)
+  {
+    free(f);
+    return err;
+  }
+
+  f->header = (const flat__header_t *) f->base;
+
+  if (!flat__valid(f))
+  {
+    flat__unmap(f);
+    free(f);
+    return error_FLAT_BAD_FORMAT;
+  }
+
+  f->entries = (const flat__entry_t *) (f->base + f->header->entries);
+  f->bins    = (const uint32_t *) (f->base + f->header->bins);
+
+  *pf = f;
+
+  return error_OK;
+}
+
+void flat_close(flat_t *f)
+{
+  if (f == NULL)
+    return;
+
+  flat__unmap(f);
+  free(f);
+}
@@ -0,0 +1,383 @@
+/* test.c */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/memento/memento.h"
+
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "datastruct/critbit.h"
+#include "datastruct/flat.h"
+#include "datastruct/hash.h"
+#include "datastruct/orderedarray.h"
+#include "datastruct/patricia.h"
+
+#include "keyval/string.h"
+
+error flattest(void);
+
+/* ----------------------------------------------------------------------- */
+
+#define NKEYS    300
+#define FILENAME "flattest.dat"
+
+/* Keys "k0" to "k299". Each key's value is its own string. */
+static char keys[NKEYS][8];
+
+static void flattest_make_keys(void)
+{
+  int i;
+
+  for (i = 0; i < NKEYS; i++)
+    sprintf(keys[i], "k%d", i);
+}
+
+static void flattest_no_destroy(void *doomed)
+{
+  NOT_USED(doomed);
+}
+
+typedef struct flattest_walk_state
+{
+  const item_t *prev;   /* sorted files only */
+  int           count;
+  int           failures;
+}
+flattest_walk_state_t;
+
+static error flattest_check_item(const item_t *item, void *opaque)
+{
+  flattest_walk_state_t *state = opaque;
+
+  if (item->keylen != strlen(item->key) || strcmp(item->key, item->value))
+    state->failures++;
+
+  if (state->prev && strcmp(state->prev->key, item->key) >= 0)
+    state->failures++;
+
+  state->count++;
+
+  return error_OK;
+}
+
+static error flattest_check_sorted(const item_t *item, void *opaque)
+{
+  flattest_walk_state_t *state = opaque;
+  static item_t          prev;
+  error                  err;
+
+  err = flattest_check_item(item, opaque);
+
+  prev        = *item;
+  state->prev = &prev;
+
+  return err;
+}
+
+/* Open FILENAME and check that it holds exactly the keys. */
+static error flattest_check_file(flat_kind_t kind)
+{
+  error                 err;
+  flat_t               *f;
+  flattest_walk_state_t state;
+  int                   i;
+
+  err = flat_open(FILENAME, &f);
+  if (err)
+    return err;
+
+  err = error_TEST_FAILED;
+
+  if (flat_kind(f) != kind || flat_count(f) != NKEYS)
+  {
+    printf("wrong kind or count\n");
+    goto exit;
+  }
+
+  for (i = 0; i < NKEYS; i++)
+  {
+    const char *value;
+    size_t      valuelen;
+
+    value = flat_lookup(f, keys[i], strlen(keys[i]), &valuelen);
+    if (value == NULL || valuelen != strlen(keys[i]) ||
+        strcmp(value, keys[i]) != 0)
+    {
+      printf("lookup of '%s' failed\n", keys[i]);
+      goto exit;
+    }
+  }
+
+  /* misses, including a prefix of a present key */
+  if (flat_lookup(f, "k", 1, NULL) != NULL ||
+      flat_lookup(f, "k3000", 5, NULL) != NULL ||
+      flat_lookup(f, "", 0, NULL) != NULL)
+  {
+    printf("found a key which isn't present\n");
+    goto exit;
+  }
+
+  memset(&state, 0, sizeof(state));
+  (void) flat_walk(f,
+                   kind == flat_KIND_SORTED ? flattest_check_sorted
+                                            : flattest_check_item,
+                   &state);
+  if (state.count != NKEYS || state.failures)
+  {
+    printf("walk saw %d items, %d bad\n", state.count, state.failures);
+    goto exit;
+  }
+
+  if (kind == flat_KIND_SORTED)
+  {
+    /* "k2" and "k20".."k29" and "k200".."k299" */
+    memset(&state, 0, sizeof(state));
+    if (flat_lookup_prefix(f, "k2", 2, flattest_check_sorted, &state) ||
+        state.count != 111 || state.failures)
+    {
+      printf("prefix lookup saw %d items, %d bad\n",
+             state.count, state.failures);
+      goto exit;
+    }
+
+    if (flat_lookup_prefix(f, "x", 1, flattest_check_item, &state) !=
+        error_NOT_FOUND)
+    {
+      printf("prefix lookup of an absent prefix succeeded\n");
+      goto exit;
+    }
+  }
+
+  err = error_OK;
+
+exit:
+
+  flat_close(f);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+static error flattest1(void)
+{
+  static const flat_kind_t kinds[] = { flat_KIND_SORTED, flat_KIND_HASHED };
+
+  error          err;
+  int            k;
+  int            i;
+  flat_writer_t *w;
+  flat_t        *f;
+  FILE          *fp;
+
+  printf("> flat test 1 - writer\n");
+
+  for (k = 0; k < NELEMS(kinds); k++)
+  {
+    err = flat_writer_create(kinds[k], NULL, &w);
+    if (err)
+      return err;
+
+    /* add in reverse so that the writer has to order them */
+    for (i = NKEYS - 1; i >= 0; i--)
+    {
+      err = flat_writer_add(w, keys[i], strlen(keys[i]), keys[i]);
+      if (err)
+        break;
+    }
+
+    if (!err)
+      err = flat_writer_save(w, FILENAME);
+
+    flat_writer_destroy(w);
+
+    if (!err)
+      err = flattest_check_file(kinds[k]);
+    if (err)
+      goto exit;
+  }
+
+  /* saving over a file which is open leaves the open copy intact */
+  err = flat_open(FILENAME, &f);
+  if (err)
+    goto exit;
+  err = flat_writer_create(flat_KIND_SORTED, NULL, &w);
+  if (!err)
+  {
+    err = flat_writer_add(w, "new", 3, "file");
+    if (!err)
+      err = flat_writer_save(w, FILENAME);
+    flat_writer_destroy(w);
+  }
+  if (!err && (flat_count(f) != NKEYS ||
+               flat_lookup(f, keys[0], strlen(keys[0]), NULL) == NULL))
+  {
+    printf("saving over an open file changed it\n");
+    err = error_TEST_FAILED;
+  }
+  flat_close(f);
+  if (err)
+    goto exit;
+
+  err = flat_open(FILENAME, &f);
+  if (err)
+    goto exit;
+  if (flat_count(f) != 1 || flat_lookup(f, "new", 3, NULL) == NULL)
+  {
+    printf("the new file wasn't saved\n");
+    err = error_TEST_FAILED;
+  }
+  flat_close(f);
+  if (err)
+    goto exit;
+
+  /* a sorted writer refuses duplicates */
+  err = flat_writer_create(flat_KIND_SORTED, NULL, &w);
+  if (err)
+    return err;
+  (void) flat_writer_add(w, "dup", 3, "a");
+  (void) flat_writer_add(w, "dup", 3, "b");
+  if (flat_writer_save(w, FILENAME) != error_EXISTS)
+  {
+    printf("duplicate keys were saved\n");
+    err = error_TEST_FAILED;
+  }
+  flat_writer_destroy(w);
+  if (err)
+    goto exit;
+
+  /* something which isn't a flat file is refused */
+  fp = fopen(FILENAME, "wb");
+  if (fp == NULL)
+  {
+    err = error_IO;
+    goto exit;
+  }
+  fputs("not a flat file, but long enough to hold a header if it were one",
+        fp);
+  fclose(fp);
+
+  err = flat_open(FILENAME, &f);
+  if (err != error_FLAT_BAD_FORMAT)
+  {
+    if (err == error_OK)
+      flat_close(f);
+    printf("opened a bad file\n");
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+  err = error_OK;
+
+exit:
+
+  remove(FILENAME);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+static error flattest2(void)
+{
+  error           err;
+  critbit_t      *critbit      = NULL;
+  patricia_t     *patricia     = NULL;
+  orderedarray_t *orderedarray = NULL;
+  hash_t         *hash         = NULL;
+  int             i;
+
+  printf("> flat test 2 - save and reopen\n");
+
+  err = critbit_create(NULL,
+                       flattest_no_destroy, flattest_no_destroy,
+                       &critbit);
+  if (!err)
+    err = patricia_create(NULL,
+                          flattest_no_destroy, flattest_no_destroy,
+                          &patricia);
+  if (!err)
+    err = orderedarray_create(NULL, stringkv_compare,
+                              flattest_no_destroy, flattest_no_destroy,
+                              &orderedarray);
+  if (!err)
+    err = hash_create(NULL, 16, stringkv_hash, stringkv_compare,
+                      flattest_no_destroy, flattest_no_destroy,
+                      &hash);
+  if (err)
+    goto exit;
+
+  for (i = 0; i < NKEYS && !err; i++)
+  {
+    size_t keylen = strlen(keys[i]);
+
+    err = critbit_insert(critbit, keys[i], keylen, keys[i]);
+    if (!err)
+      err = patricia_insert(patricia, keys[i], keylen, keys[i]);
+    if (!err)
+      err = orderedarray_insert(orderedarray, keys[i], keylen, keys[i]);
+    if (!err)
+      err = hash_insert(hash, keys[i], keylen, keys[i]);
+  }
+  if (err)
+    goto exit;
+
+  err = critbit_save(critbit, NULL, FILENAME);
+  if (!err)
+    err = flattest_check_file(flat_KIND_SORTED);
+  if (!err)
+    err = patricia_save(patricia, NULL, FILENAME);
+  if (!err)
+    err = flattest_check_file(flat_KIND_SORTED);
+  if (!err)
+    err = orderedarray_save(orderedarray, NULL, FILENAME);
+  if (!err)
+    err = flattest_check_file(flat_KIND_SORTED);
+  if (!err)
+    err = hash_save(hash, NULL, FILENAME);
+  if (!err)
+    err = flattest_check_file(flat_KIND_HASHED);
+
+exit:
+
+  remove(FILENAME);
+
+  if (hash)
+    hash_destroy(hash);
+  if (orderedarray)
+    orderedarray_destroy(orderedarray);
+  if (patricia)
+    patricia_destroy(patricia);
+  if (critbit)
+    critbit_destroy(critbit);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+error flattest(void)
+{
+  error err;
+
+  printf(">> flat test\n");
+
+  flattest_make_keys();
+
+  err = flattest1();
+  if (!err)
+    err = flattest2();
+  if (err)
+  {
+    printf("unexpected error: %lx\n", err);
+    return err;
+  }
+
+  printf("<< flat tests ok\n");
+
+  return error_OK;
+}
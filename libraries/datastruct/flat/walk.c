@@ -0,0 +1,37 @@
+/* --------------------------------------------------------------------------
+ *    Name: walk.c
+ * Purpose: Read-only associative array held in a flat, mappable file
+ * ----------------------------------------------------------------------- */
+
+#include "base/errors.h"
+
+#include "datastruct/flat.h"
+
+#include "impl.h"
+
+error flat_walk(const flat_t *f, flat_walk_callback *cb, void *opaque)
+{
+  error err;
+  int   n;
+  int   i;
+
+  if (f == NULL)
+    return error_OK;
+
+  n = (int) f->header->nentries;
+  for (i = 0; i < n; i++)
+  {
+    const flat__entry_t *e = &f->entries[i];
+    item_t               item;
+
+    item.key    = ENTRY_KEY(f, e);
+    item.keylen = e->keylen;
+    item.value  = ENTRY_VALUE(f, e);
+
+    err = cb(&item, opaque);
+    if (err)
+      return err;
+  }
+
+  return error_OK;
+}
@@ -0,0 +1,373 @@
+/* --------------------------------------------------------------------------
+ *    Name: writer.c
+ * Purpose: Read-only associative array held in a flat, mappable file
+ * ----------------------------------------------------------------------- */
+
+/* open, fdopen, fileno, fsync and getpid are not part of C99 */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "base/memento/memento.h"
+
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "datastruct/flat.h"
+
+#include "impl.h"
+
+/* ----------------------------------------------------------------------- */
+
+typedef struct flat__pending
+{
+  const void      *key;
+  size_t           keylen;
+  const void      *value;
+  size_t           valuelen;
+  unsigned int     bin;       /* hashed writers only */
+}
+flat__pending_t;
+
+struct flat_writer
+{
+  flat_kind_t      kind;
+  flat_value_len  *value_len;
+
+  flat__pending_t *pending;
+  int              npending;
+  int              maxpending;
+};
+
+/* ----------------------------------------------------------------------- */
+
+static size_t flat__string_len(const void *value)
+{
+  return strlen(value);
+}
+
+error flat_writer_create(flat_kind_t      kind,
+                         flat_value_len  *value_len,
+                         flat_writer_t  **pw)
+{
+  flat_writer_t *w;
+
+  w = malloc(sizeof(*w));
+  if (w == NULL)
+    return error_OOM;
+
+  w->kind       = kind;
+  w->value_len  = value_len ? value_len : flat__string_len;
+  w->pending    = NULL;
+  w->npending   = 0;
+  w->maxpending = 0;
+
+  *pw = w;
+
+  return error_OK;
+}
+
+void flat_writer_destroy(flat_writer_t *w)
+{
+  if (w == NULL)
+    return;
+
+  free(w->pending);
+  free(w);
+}
+
+error flat_writer_add(flat_writer_t *w,
+                      const void    *key,
+                      size_t         keylen,
+                      const void    *value)
+{
+  flat__pending_t *p;
+  size_t           valuelen;
+
+  valuelen = w->value_len(value);
+
+  /* lengths are stored in 32 bits */
+  if (keylen > 0xffffffffu || valuelen > 0xffffffffu)
+    return error_FLAT_BAD_FORMAT;
+
+  if (w->npending == w->maxpending)
+  {
+    int              maxpending;
+    flat__pending_t *pending;
+
+    maxpending = w->maxpending ? w->maxpending * 2 : 16;
+    pending = realloc(w->pending, maxpending * sizeof(*pending));
+    if (pending == NULL)
+      return error_OOM;
+
+    w->pending    = pending;
+    w->maxpending = maxpending;
+  }
+
+  p = &w->pending[w->npending++];
+
+  p->key      = key;
+  p->keylen   = keylen;
+  p->value    = value;
+  p->valuelen = valuelen;
+  p->bin      = 0;
+
+  return error_OK;
+}
+
+/* ----------------------------------------------------------------------- */
+
+static int flat__pending_compare_key(const void *a_, const void *b_)
+{
+  const flat__pending_t *a = a_;
+  const flat__pending_t *b = b_;
+
+  return flat__compare(a->key, a->keylen, b->key, b->keylen);
+}
+
+static int flat__pending_compare_bin(const void *a_, const void *b_)
+{
+  const flat__pending_t *a = a_;
+  const flat__pending_t *b = b_;
+
+  return (a->bin > b->bin) - (a->bin < b->bin);
+}
+
+/* Put the pending entries into file order and, for hashed writers, build
+ * the bins. */
+static error flat__writer_order(flat_writer_t *w,
+                                uint64_t      *pnbins,
+                                uint32_t     **pbins)
+{
+  int       n = w->npending;
+  uint64_t  nbins;
+  uint32_t *bins;
+  int       i;
+
+  *pnbins = 0;
+  *pbins  = NULL;
+
+  if (w->kind == flat_KIND_SORTED)
+  {
+    qsort(w->pending, n, sizeof(*w->pending), flat__pending_compare_key);
+
+    for (i = 1; i < n; i++)
+      if (flat__pending_compare_key(&w->pending[i - 1], &w->pending[i]) == 0)
+        return error_EXISTS;
+
+    return error_OK;
+  }
+
+  /* a power of two no smaller than the number of entries */
+  for (nbins = 1; nbins < (uint64_t) n; nbins <<= 1)
+    ;
+
+  bins = calloc(nbins + 1, sizeof(*bins));
+  if (bins == NULL)
+    return error_OOM;
+
+  for (i = 0; i < n; i++)
+  {
+    flat__pending_t *p = &w->pending[i];
+
+    p->bin = flat__hash(p->key, p->keylen) & (nbins - 1);
+    bins[p->bin + 1]++;
+  }
+
+  /* counts to starting indices */
+  for (i = 0; (uint64_t) i < nbins; i++)
+    bins[i + 1] += bins[i];
+
+  qsort(w->pending, n, sizeof(*w->pending), flat__pending_compare_bin);
+
+  *pnbins = nbins;
+  *pbins  = bins;
+
+  return error_OK;
+}
+
+static error flat__write(FILE *fp, const void *data, size_t size)
+{
+  return fwrite(data, 1, size, fp) == size ? error_OK : error_IO;
+}
+
+/* Files are written under a temporary name alongside the target then
+ * renamed over it. Readers which have the old file mapped keep their view
+ * of it, and a crash part way through leaves the old file intact. */
+
+/* Create a new temporary file next to 'filename', returning its name in
+ * 'tmpname', which must be freed. */
+static error flat__create_temp(const char  *filename,
+                               char       **ptmpname,
+                               FILE       **pfp)
+{
+  size_t len;
+  char  *tmpname;
+  FILE  *fp;
+
+  len = strlen(filename) + 32;
+  tmpname = malloc(len);
+  if (tmpname == NULL)
+    return error_OOM;
+
+#ifdef _WIN32
+  sprintf(tmpname, "%s.tmp", filename);
+  fp = fopen(tmpname, "wb");
+#else
+  {
+    int fd;
+
+    /* O_EXCL so that we never write through someone else's file, and
+     * creating it with open gives it the same permissions as fopen would */
+    sprintf(tmpname, "%s.%ld.tmp", filename, (long) getpid());
+    fd = open(tmpname, O_WRONLY | O_CREAT | O_EXCL, 0666);
+    fp = (fd >= 0) ? fdopen(fd, "wb") : NULL;
+    if (fp == NULL && fd >= 0)
+    {
+      close(fd);
+      remove(tmpname);
+    }
+  }
+#endif
+  if (fp == NULL)
+  {
+    free(tmpname);
+    return error_IO;
+  }
+
+  *ptmpname = tmpname;
+  *pfp      = fp;
+
+  return error_OK;
+}
+
+/* Flush the temporary file to disc then rename it over 'filename'. Removes
+ * the temporary file if that fails. */
+static error flat__commit_temp(FILE       *fp,
+                               const char *tmpname,
+                               const char *filename)
+{
+  error err = error_OK;
+
+  if (fflush(fp) != 0)
+    err = error_IO;
+#ifndef _WIN32
+  if (!err && fsync(fileno(fp)) != 0)
+    err = error_IO;
+#endif
+  if (fclose(fp) != 0 && !err)
+    err = error_IO;
+
+#ifdef _WIN32
+  /* rename won't replace an existing file here */
+  if (!err)
+    remove(filename);
+#endif
+  if (!err && rename(tmpname, filename) != 0)
+    err = error_IO;
+
+  if (err)
+    remove(tmpname);
+
+  return err;
+}
+
+error flat_writer_save(flat_writer_t *w, const char *filename)
+{
+  static const char nul = '\0';
+
+  error          err;
+  int            n = w->npending;
+  uint64_t       nbins;
+  uint32_t      *bins    = NULL;
+  flat__entry_t *entries = NULL;
+  flat__header_t header;
+  uint64_t       offset;
+  char          *tmpname = NULL;
+  FILE          *fp      = NULL;
+  int            i;
+
+  err = flat__writer_order(w, &nbins, &bins);
+  if (err)
+    goto exit;
+
+  memset(&header, 0, sizeof(header));
+  strcpy(header.magic, FLAT_MAGIC);
+  header.byteorder = FLAT_BYTEORDER;
+  header.kind      = w->kind;
+  header.nentries  = n;
+  header.nbins     = nbins;
+  header.entries   = sizeof(header);
+  header.bins      = header.entries + n * sizeof(*entries);
+  header.blob      = header.bins + (nbins ? (nbins + 1) * sizeof(*bins) : 0);
+
+  entries = malloc(n ? n * sizeof(*entries) : 1);
+  if (entries == NULL)
+  {
+    err = error_OOM;
+    goto exit;
+  }
+
+  offset = header.blob;
+  for (i = 0; i < n; i++)
+  {
+    const flat__pending_t *p = &w->pending[i];
+
+    entries[i].key      = offset;
+    offset += p->keylen + 1;
+    entries[i].value    = offset;
+    offset += p->valuelen + 1;
+    entries[i].keylen   = (uint32_t) p->keylen;
+    entries[i].valuelen = (uint32_t) p->valuelen;
+  }
+
+  header.size = offset;
+
+  err = flat__create_temp(filename, &tmpname, &fp);
+  if (err)
+    goto exit;
+
+  err = flat__write(fp, &header, sizeof(header));
+  if (!err)
+    err = flat__write(fp, entries, n * sizeof(*entries));
+  if (!err && nbins)
+    err = flat__write(fp, bins, (nbins + 1) * sizeof(*bins));
+
+  for (i = 0; i < n && !err; i++)
+  {
+    const flat__pending_t *p = &w->pending[i];
+
+    err = flat__write(fp, p->key, p->keylen);
+    if (!err)
+      err = flat__write(fp, &nul, 1);
+    if (!err)
+      err = flat__write(fp, p->value, p->valuelen);
+    if (!err)
+      err = flat__write(fp, &nul, 1);
+  }
+
+  if (err)
+  {
+    fclose(fp);
+    remove(tmpname); /* don't leave a truncated file behind */
+  }
+  else
+  {
+    err = flat__commit_temp(fp, tmpname, filename);
+  }
+
+exit:
+
+  free(tmpname);
+  free(entries);
+  free(bins);
+
+  return err;
+}
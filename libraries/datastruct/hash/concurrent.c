@@ -0,0 +1,206 @@
+/* --------------------------------------------------------------------------
+ *    Name: concurrent.c
+ * Purpose: Associative array implemented as a hash
+ * ----------------------------------------------------------------------- */
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "base/memento/memento.h"
+
+#include "base/atomic.h"
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "utils/epoch.h"
+#include "utils/primes.h"
+
+#include "datastruct/hash.h"
+
+#include "impl.h"
+
+/* ----------------------------------------------------------------------- */
+
+pthread_mutex_t *hash__lock_key(hash_t *h, const void *key)
+{
+  unsigned int hash;
+
+  if (h->epoch == NULL)
+    return NULL;
+
+  hash = h->hash_fn(key);
+
+  /* the stripe depends on the table size, so if the table was resized
+   * while we waited for the lock then try again */
+  for (;;)
+  {
+    const hash__table_t *t;
+    int                  token;
+    int                  s;
+
+    /* another writer may replace and retire the table as we read it, so
+     * read it as a reader does. Don't wait for the lock inside the epoch:
+     * a writer short of memory waits in epoch_retire for readers to leave
+     * while holding every stripe. */
+    token = hash_read_begin(h);
+    t = ATOMIC_LOAD_ACQUIRE(&h->table);
+    s = (hash % t->nbins) % HASH_NSTRIPES;
+    hash_read_end(h, token);
+
+    pthread_mutex_lock(&h->stripes[s]);
+
+    /* resizing holds every stripe, so the current table can't be replaced
+     * or freed now */
+    if ((hash % h->table->nbins) % HASH_NSTRIPES == (unsigned int) s)
+      return &h->stripes[s];
+
+    pthread_mutex_unlock(&h->stripes[s]);
+  }
+}
+
+void hash__unlock_key(hash_t *h, pthread_mutex_t *stripe)
+{
+  NOT_USED(h);
+
+  if (stripe)
+    pthread_mutex_unlock(stripe);
+}
+
+void hash__lock_all(const hash_t *h)
+{
+  int i;
+
+  if (h->epoch == NULL)
+    return;
+
+  for (i = 0; i < HASH_NSTRIPES; i++)
+    pthread_mutex_lock(&h->stripes[i]);
+}
+
+void hash__unlock_all(const hash_t *h)
+{
+  int i;
+
+  if (h->epoch == NULL)
+    return;
+
+  for (i = HASH_NSTRIPES - 1; i >= 0; i--)
+    pthread_mutex_unlock(&h->stripes[i]);
+}
+
+/* ----------------------------------------------------------------------- */
+
+/* Free a replaced table along with its nodes, but not their keys or values
+ * which the nodes of the new table now hold. */
+static void hash__table_free(void *block, void *opaque)
+{
+  hash__table_t *t = block;
+  int            i;
+
+  NOT_USED(opaque);
+
+  for (i = 0; i < t->nbins; i++)
+  {
+    hash__node_t *n;
+    hash__node_t *next;
+
+    for (n = t->bins[i]; n; n = next)
+    {
+      next = n->next;
+      free(n);
+    }
+  }
+
+  free(t);
+}
+
+/* Readers may be traversing the old chains so they cannot be relinked.
+ * Instead we build a new table holding copies of the nodes, publish it, then
+ * retire the old one. Readers carry on through whichever table they loaded
+ * and are never blocked. */
+void hash__grow(hash_t *h)
+{
+  hash__table_t *old;
+  hash__table_t *t;
+  int            token;
+  int            overloaded;
+  int            nbins;
+  int            i;
+
+  /* a quick check without the locks, in an epoch since another writer may
+   * be retiring the table */
+  token = hash_read_begin(h);
+  old = ATOMIC_LOAD_ACQUIRE(&h->table);
+  overloaded = ATOMIC_LOAD_RELAXED(&h->count) > old->nbins * HASH_MAX_LOAD;
+  hash_read_end(h, token);
+  if (!overloaded)
+    return;
+
+  hash__lock_all(h);
+
+  /* another writer may have grown the table while we waited */
+  old = h->table;
+  if (h->count <= old->nbins * HASH_MAX_LOAD)
+    goto exit;
+
+  nbins = prime_nearest(old->nbins * 2);
+  if (nbins <= old->nbins)
+    goto exit; /* at the maximum size */
+
+  t = hash__table_create(nbins);
+  if (t == NULL)
+    goto exit; /* not fatal: carry on with the old table */
+
+  for (i = 0; i < old->nbins; i++)
+  {
+    hash__node_t *n;
+
+    for (n = old->bins[i]; n; n = n->next)
+    {
+      hash__node_t *m;
+      int           bin;
+
+      m = hash__node_copy(h, n);
+      if (m == NULL)
+      {
+        /* discard the partial copy */
+        for (i = 0; i < t->nbins; i++)
+          while ((m = t->bins[i]) != NULL)
+          {
+            t->bins[i] = m->next;
+            free(m);
+          }
+        free(t);
+        goto exit;
+      }
+
+      bin = h->hash_fn(n->item.key) % nbins;
+
+      m->next       = t->bins[bin];
+      t->bins[bin]  = m;
+    }
+  }
+
+  PUBLISH(&h->table, t);
+
+  hash__index_invalidate(h);
+
+  epoch_retire(h->epoch, old, hash__table_free, NULL);
+
+exit:
+
+  hash__unlock_all(h);
+}
+
+/* ----------------------------------------------------------------------- */
+
+int hash_read_begin(const hash_t *h)
+{
+  return h->epoch ? epoch_enter(h->epoch) : 0;
+}
+
+void hash_read_end(const hash_t *h, int token)
+{
+  if (h->epoch)
+    epoch_leave(h->epoch, token);
+}
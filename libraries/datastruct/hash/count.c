@@ -9,5 +9,5 @@
 
 int hash_count(hash_t *hash)
 {
-  return hash->count;
+  return ATOMIC_LOAD_RELAXED(&hash->count);
 }
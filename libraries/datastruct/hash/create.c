@@ -3,6 +3,8 @@
  * Purpose: Associative array implemented as a hash
  * ----------------------------------------------------------------------- */
 
+#include <assert.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -18,6 +20,22 @@
 
 /* ----------------------------------------------------------------------- */
 
+hash__table_t *hash__table_create(int nbins)
+{
+  hash__table_t *t;
+  int            i;
+
+  t = malloc(offsetof(hash__table_t, bins) + nbins * sizeof(t->bins[0]));
+  if (t == NULL)
+    return NULL;
+
+  t->nbins = nbins;
+  for (i = 0; i < nbins; i++)
+    t->bins[i] = NULL;
+
+  return t;
+}
+
 error hash_create(const void         *default_value,
                   int                 nbins,
                   hash_fn            *fn,
@@ -27,34 +45,117 @@ error hash_create(const void         *default_value,
                   hash_t            **ph)
 {
   hash_t        *h;
-  hash__node_t **bins;
+  hash__table_t *table;
 
   h = malloc(sizeof(*h));
   if (h == NULL)
     return error_OOM;
 
-  nbins = prime_nearest(nbins);
+  table = hash__table_create(prime_nearest(nbins));
+  if (table == NULL)
+  {
+    free(h);
+    return error_OOM;
+  }
 
-  bins = calloc(nbins, sizeof(*h->bins));
-  if (bins == NULL)
+  if (pthread_mutex_init(&h->index.lock, NULL) != 0)
   {
+    free(table);
     free(h);
     return error_OOM;
   }
 
-  h->bins          = bins;
-  h->nbins         = nbins;
+  h->table         = table;
 
   h->count         = 0;
 
+  INSTRUMENT_INIT(h);
+
   h->default_value = default_value;
+  h->inline_keys   = 0;
+  h->inline_bytes  = 0;
+
+  h->order         = hash_ORDER_NONE;
+  h->oldest        = NULL;
+  h->newest        = NULL;
 
   h->hash_fn       = fn;
   h->compare       = compare;
   h->destroy_key   = destroy_key;
   h->destroy_value = destroy_value;
 
+  h->index.nodes     = NULL;
+  h->index.nsorted   = 0;
+  h->index.n         = 0;
+  h->index.nremoved  = 0;
+  h->index.allocated = 0;
+  h->index.stale     = 1;
+
+  h->epoch         = NULL;
+  h->stripes       = NULL;
+
+  *ph = h;
+
+  return error_OK;
+}
+
+error hash_create_concurrent(const void         *default_value,
+                             int                 nbins,
+                             hash_fn            *fn,
+                             hash_compare       *compare,
+                             hash_destroy_key   *destroy_key,
+                             hash_destroy_value *destroy_value,
+                             hash_t            **ph)
+{
+  error   err;
+  hash_t *h;
+  int     i;
+
+  err = hash_create(default_value, nbins, fn, compare, destroy_key,
+                    destroy_value, &h);
+  if (err)
+    return err;
+
+  h->stripes = malloc(HASH_NSTRIPES * sizeof(*h->stripes));
+  if (h->stripes == NULL)
+  {
+    err = error_OOM;
+    goto failure;
+  }
+
+  for (i = 0; i < HASH_NSTRIPES; i++)
+    if (pthread_mutex_init(&h->stripes[i], NULL) != 0)
+      break;
+
+  if (i < HASH_NSTRIPES)
+  {
+    while (--i >= 0)
+      pthread_mutex_destroy(&h->stripes[i]);
+    free(h->stripes);
+    h->stripes = NULL;
+    err = error_OOM;
+    goto failure;
+  }
+
+  err = epoch_create(&h->epoch);
+  if (err)
+    goto failure;
+
   *ph = h;
 
   return error_OK;
+
+
+failure:
+
+  hash_destroy(h);
+
+  return err;
+}
+
+void hash_set_inline_keys(hash_t *h)
+{
+  assert(h->count == 0);
+
+  h->inline_keys = 1;
 }
@@ -0,0 +1,80 @@
+/* --------------------------------------------------------------------------
+ *    Name: cursor.c
+ * Purpose: Associative array implemented as a hash
+ * ----------------------------------------------------------------------- */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/errors.h"
+
+#include "datastruct/hash.h"
+
+#include "impl.h"
+
+/* The cursor holds the node it will return next, loaded before the previous
+ * one was handed out, so the caller may remove that previous one. In
+ * concurrent mode the cursor is a reader: its read-side critical section
+ * keeps the table it loaded, and any nodes unlinked from it, alive. It
+ * can't leave and re-enter the epoch part way through, since a grow could
+ * then free that table, and the cursor has no other way to see each key
+ * exactly once. So it blocks reclamation until hash_cursor_end. */
+
+void hash_cursor_init(const hash_t *h, hash_cursor_t *c)
+{
+  c->token = hash_read_begin(h);
+  c->bin   = 0;
+
+  if (h->order)
+  {
+    /* follow the order list instead. ordered hashes aren't concurrent. */
+    c->table = NULL;
+    c->node  = h->oldest;
+  }
+  else
+  {
+    c->table = LOAD_NODE(&h->table);
+    c->node  = NULL;
+  }
+}
+
+error hash_cursor_next(hash_cursor_t *c, const item_t **item)
+{
+  const hash__table_t *t = c->table;
+  const hash__node_t  *n = c->node;
+
+  if (t == NULL)
+  {
+    if (n == NULL)
+      return error_HASH_END;
+
+    *item = &n->item;
+
+    c->node = LINKS(n)->next;
+
+    return error_OK;
+  }
+
+  /* scan forward to the next occupied bin */
+  while (n == NULL)
+  {
+    if (c->bin >= (uint64_t) t->nbins)
+      return error_HASH_END;
+
+    n = LOAD_NODE(&t->bins[c->bin++]);
+  }
+
+  *item = &n->item;
+
+  c->node = LOAD_NODE(&n->next);
+
+  return error_OK;
+}
+
+void hash_cursor_end(const hash_t *h, hash_cursor_t *c)
+{
+  hash_read_end(h, c->token);
+
+  c->table = NULL;
+  c->node  = NULL;
+}
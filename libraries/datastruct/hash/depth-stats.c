@@ -0,0 +1,41 @@
+/* --------------------------------------------------------------------------
+ *    Name: depth-stats.c
+ * Purpose: Associative array implemented as a hash
+ * ----------------------------------------------------------------------- */
+
+#include <stddef.h>
+
+#include "base/errors.h"
+
+#include "datastruct/hash.h"
+
+#include "impl.h"
+
+error hash_depth_stats(const hash_t *h, datastruct_depth_stats_t *stats)
+{
+  const hash__table_t *t;
+  int                  i;
+
+  datastruct_depth_init(stats);
+
+  hash__lock_all(h);
+
+  t = h->table;
+  for (i = 0; i < t->nbins; i++)
+  {
+    const hash__node_t *n;
+    int                 length;
+
+    length = 0;
+    for (n = t->bins[i]; n != NULL; n = n->next)
+      length++;
+
+    datastruct_depth_add_chain(stats, length);
+  }
+
+  hash__unlock_all(h);
+
+  datastruct_depth_finish(stats);
+
+  return error_OK;
+}
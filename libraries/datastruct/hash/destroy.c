@@ -13,13 +13,34 @@
 
 void hash_destroy(hash_t *h)
 {
-  int i;
-
-  for (i = 0; i < h->nbins; i++)
-    while (h->bins[i])
-      hash_remove_node(h, &h->bins[i]);
-
-  free(h->bins);
+  hash__table_t *t;
+  int            i;
+
+  if (h->epoch)
+  {
+    /* nothing can be reading now: free any retired nodes then revert to
+     * freeing nodes immediately */
+    epoch_destroy(h->epoch);
+    h->epoch = NULL;
+  }
+
+  if (h->stripes)
+  {
+    for (i = 0; i < HASH_NSTRIPES; i++)
+      pthread_mutex_destroy(&h->stripes[i]);
+    free(h->stripes);
+  }
+
+  t = h->table;
+
+  for (i = 0; i < t->nbins; i++)
+    while (t->bins[i])
+      hash_remove_node(h, &t->bins[i]);
+
+  free(t);
+
+  free(h->index.nodes);
+  pthread_mutex_destroy(&h->index.lock);
 
   free(h);
 }
@@ -6,8 +6,14 @@
 #ifndef HASH_IMPL_H
 #define HASH_IMPL_H
 
+#include <pthread.h>
 #include <stdlib.h>
 
+#include "base/atomic.h"
+
+#include "utils/epoch.h"
+
+#include "datastruct/instrument.h"
 #include "datastruct/item.h"
 
 #include "datastruct/hash.h"
@@ -18,22 +24,96 @@ typedef struct hash__node
 {
   struct hash__node *next;
   item_t             item;
+  unsigned char      key[]; /* the key, if inline_keys */
 }
 hash__node_t;
 
-struct hash
+/* In an ordered hash each node is preceded in its allocation by links
+ * placing it on a list in insertion or access order, and a pointer to the
+ * link in its chain which points at it, so that hash_pop_oldest can unlink
+ * it without searching the chain. Ordered hashes are never concurrent, so
+ * that link only changes when its node's predecessor in the chain is
+ * removed. */
+typedef struct hash__links
+{
+  hash__node_t  *prev; /* towards the oldest */
+  hash__node_t  *next; /* towards the newest */
+  hash__node_t **link; /* the link in its chain which points at it */
+}
+hash__links_t;
+
+#define LINKS(n) ((hash__links_t *) (n) - 1)
+
+/* The start of node 'n''s allocation, to pass to free. */
+#define NODE_BLOCK(h, n) ((h)->order ? (void *) LINKS(n) : (void *) (n))
+
+typedef struct hash__table
 {
-  hash__node_t      **bins;
   int                 nbins;
+  hash__node_t       *bins[1]; /* nbins entries */
+}
+hash__table_t;
+
+/* Every node in key byte order (as memcmp, shorter keys first), for prefix
+ * lookups. Built by the first hash_lookup_prefix. Nodes inserted since are
+ * appended unsorted and merged in by the next prefix lookup. A removed
+ * node's entry is set to NULL, and closed up by the next prefix lookup; a
+ * node replaced by a copy has its entry pointed at the copy. Only growing a
+ * concurrent hash, which copies every node, or running out of memory marks
+ * the index stale so that the next prefix lookup rebuilds it.
+ *
+ * Since prefix lookups modify the index, but may run alongside each other
+ * as any other lookup can, each one holds 'lock' throughout. Writers in
+ * concurrent mode take it too, as writers to other stripes may be updating
+ * the index at the same time. */
+typedef struct hash__index
+{
+  pthread_mutex_t     lock;
+  hash__node_t      **nodes;
+  int                 nsorted;   /* nodes[0..nsorted) are in key order */
+  int                 n;         /* nodes[nsorted..n) have been appended */
+  int                 nremoved;  /* NULL entries left by removals */
+  int                 allocated;
+  int                 stale;     /* non-zero until built */
+}
+hash__index_t;
+
+/* Number of locks used by concurrent hashes. Bin 'b' is guarded by stripe
+ * 'b % HASH_NSTRIPES'. */
+#define HASH_NSTRIPES 64
+
+/* Concurrent hashes grow once they hold this many items per bin. */
+#define HASH_MAX_LOAD 2
+
+struct hash
+{
+  hash__table_t      *table;
 
   int                 count;
 
   const void         *default_value;
 
+  int                 inline_keys; /* keys are copied into nodes */
+  size_t              inline_bytes; /* bytes they occupy, with terminators */
+
+  hash_order_t        order;
+  hash__node_t       *oldest;      /* ordered hashes only */
+  hash__node_t       *newest;
+
   hash_fn            *hash_fn;
   hash_compare       *compare;
   hash_destroy_key   *destroy_key;
   hash_destroy_value *destroy_value;
+
+  hash__index_t       index;
+
+  /* concurrent mode - 'epoch' is NULL otherwise */
+  epoch_t            *epoch;
+  pthread_mutex_t    *stripes;
+
+#ifdef DATASTRUCT_INSTRUMENT
+  datastruct_instrument_t instrument;
+#endif
 };
 
 /* ----------------------------------------------------------------------- */
@@ -51,9 +131,97 @@ error hash__walk_internal(const hash_t                 *hash,
 
 /* ----------------------------------------------------------------------- */
 
+hash__table_t *hash__table_create(int nbins);
+
+/* Allocate a node. With inline keys the key's bytes are copied into it. */
+hash__node_t *hash__node_create(hash_t     *h,
+                                const void *key,
+                                size_t      keylen,
+                                const void *value);
+
+/* Allocate a copy of node 'n', including any inline key. */
+hash__node_t *hash__node_copy(hash_t *h, const hash__node_t *n);
+
 hash__node_t **hash_lookup_node(hash_t *h, const void *key);
 void hash_remove_node(hash_t *h, hash__node_t **n);
 
+/* Unlink the node at 'n' from its chain, and any list, and uncount it. */
+hash__node_t *hash__node_unlink(hash_t *h, hash__node_t **n);
+
+/* Maintain the order list of an ordered hash. hash__order_touch moves a node
+ * to the newest end. */
+void hash__order_append(hash_t *h, hash__node_t *n);
+void hash__order_remove(hash_t *h, hash__node_t *n);
+void hash__order_touch(hash_t *h, hash__node_t *n);
+
+/* ----------------------------------------------------------------------- */
+
+/* Note that node 'n' has been added to the hash, that 'old' has been
+ * replaced by its copy 'n', or that 'n' has been removed. Call with the
+ * node's stripe locked. Each is a relaxed load when there's no index. */
+void hash__index_add(hash_t *h, hash__node_t *n);
+void hash__index_replace(hash_t             *h,
+                         const hash__node_t *old,
+                         hash__node_t       *n);
+void hash__index_remove(hash_t *h, const hash__node_t *n);
+
+/* Note that every node has been replaced. A relaxed load when there's no
+ * index, or it's already stale. */
+#define hash__index_invalidate(h)                                 \
+  do                                                              \
+  {                                                               \
+    if (!ATOMIC_LOAD_RELAXED(&(h)->index.stale))                  \
+      ATOMIC_STORE_RELAXED(&(h)->index.stale, 1);                 \
+  }                                                               \
+  while (0)
+
+/* Adjust the count by 'delta'. Writers to different stripes of a
+ * concurrent hash update it at once, so only they need an atomic add. */
+#define hash__count_add(h, delta)                                 \
+  do                                                              \
+  {                                                               \
+    if ((h)->epoch)                                               \
+      ATOMIC_FETCH_ADD(&(h)->count, (delta));                     \
+    else                                                          \
+      (h)->count += (delta);                                      \
+  }                                                               \
+  while (0)
+
+/* Adjust the total bytes of inline keys for node 'n' being added ('sign'
+ * 1) or removed (-1), as hash__count_add adjusts the count. */
+#define hash__inline_bytes_add(h, n, sign)                        \
+  do                                                              \
+  {                                                               \
+    size_t bytes__ = (size_t) (sign) * ((n)->item.keylen + 1);    \
+                                                                  \
+    if (!(h)->inline_keys)                                        \
+      break;                                                      \
+    if ((h)->epoch)                                               \
+      ATOMIC_FETCH_ADD(&(h)->inline_bytes, bytes__);              \
+    else                                                          \
+      (h)->inline_bytes += bytes__;                               \
+  }                                                               \
+  while (0)
+
+/* ----------------------------------------------------------------------- */
+
+/* In concurrent mode these lock the stripe guarding 'key' or all stripes.
+ * Otherwise they do nothing. */
+pthread_mutex_t *hash__lock_key(hash_t *h, const void *key);
+void hash__unlock_key(hash_t *h, pthread_mutex_t *stripe);
+void hash__lock_all(const hash_t *h);
+void hash__unlock_all(const hash_t *h);
+
+/* Grow the table if it is overloaded. Concurrent mode only. */
+void hash__grow(hash_t *h);
+
+/* Readers in concurrent mode traverse chains while writers modify them.
+ * Writers initialise a node fully before publishing a pointer to it with a
+ * release store. Readers load every pointer which a writer may change with
+ * acquire semantics so that they see the node's contents. */
+#define LOAD_NODE(p)  ATOMIC_LOAD_ACQUIRE(p)
+#define PUBLISH(p, n) ATOMIC_STORE_RELEASE(p, n)
+
 /* ----------------------------------------------------------------------- */
 
 #endif /* HASH_IMPL_H */
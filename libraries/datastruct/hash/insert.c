@@ -13,15 +13,56 @@
 
 #include "impl.h"
 
-error hash_insert(hash_t     *h,
-                  const void *key,
-                  size_t      keylen,
-                  const void *value)
+static void hash__node_free_value(void *block, void *opaque)
+{
+  hash__node_t *doomed = block;
+  hash_t       *h      = opaque;
+
+  h->destroy_value((void *) doomed->item.value); /* must cast away const */
+
+  free(NODE_BLOCK(h, doomed));
+}
+
+static error hash__insert(hash_t     *h,
+                          const void *key,
+                          size_t      keylen,
+                          const void *value)
 {
   hash__node_t **n;
 
   n = hash_lookup_node(h, key); /* must cast away const */
-  if (*n)
+
+  INSTRUMENT_END(h, INSERT);
+
+  if (*n && h->epoch)
+  {
+    hash__node_t *m;
+    hash__node_t *old;
+
+    /* already exists: readers may be looking at the node so replace it
+     * rather than update it in place */
+
+    m = hash__node_copy(h, *n);
+    if (m == NULL)
+      return error_OOM;
+
+    INSTRUMENT_ALLOC(h);
+
+    m->item.value = value;
+
+    old = *n;
+
+    PUBLISH(n, m);
+
+    hash__index_replace(h, old, m);
+
+    epoch_retire(h->epoch, old, hash__node_free_value, h);
+    INSTRUMENT_FREE(h);
+
+    if (!h->inline_keys)
+      h->destroy_key((void *) key); /* must cast away const */
+  }
+  else if (*n)
   {
     /* already exists: update the value */
 
@@ -29,7 +70,11 @@ error hash_insert(hash_t     *h,
 
     (*n)->item.value = value;
 
-    h->destroy_key((void *) key); /* must cast away const */
+    if (h->order == hash_ORDER_ACCESS)
+      hash__order_touch(h, *n);
+
+    if (!h->inline_keys)
+      h->destroy_key((void *) key); /* must cast away const */
   }
   else
   {
@@ -37,19 +82,43 @@ error hash_insert(hash_t     *h,
 
     /* not found: create new node */
 
-    m = malloc(sizeof(*m));
+    m = hash__node_create(h, key, keylen, value);
     if (m == NULL)
       return error_OOM;
 
-    m->next        = NULL;
-    m->item.key    = key;
-    m->item.keylen = keylen;
-    m->item.value  = value;
+    INSTRUMENT_ALLOC(h);
+
+    hash__count_add(h, 1);
+    hash__inline_bytes_add(h, m, 1);
 
-    h->count++;
+    PUBLISH(n, m);
 
-    *n = m;
+    if (h->order)
+    {
+      LINKS(m)->link = n;
+      hash__order_append(h, m);
+    }
+
+    hash__index_add(h, m);
   }
 
   return error_OK;
 }
+
+error hash_insert(hash_t     *h,
+                  const void *key,
+                  size_t      keylen,
+                  const void *value)
+{
+  error            err;
+  pthread_mutex_t *stripe;
+
+  stripe = hash__lock_key(h, key);
+  err = hash__insert(h, key, keylen, value);
+  hash__unlock_key(h, stripe);
+
+  if (h->epoch)
+    hash__grow(h);
+
+  return err;
+}
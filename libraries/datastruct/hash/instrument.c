@@ -0,0 +1,26 @@
+/* --------------------------------------------------------------------------
+ *    Name: instrument.c
+ * Purpose: Associative array implemented as a hash
+ * ----------------------------------------------------------------------- */
+
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "datastruct/hash.h"
+
+#include "impl.h"
+
+error hash_instrument(const hash_t            *h,
+                      datastruct_instrument_t *counts)
+{
+#ifdef DATASTRUCT_INSTRUMENT
+  *counts = h->instrument;
+
+  return error_OK;
+#else
+  NOT_USED(h);
+  NOT_USED(counts);
+
+  return error_NOT_IMPLEMENTED;
+#endif
+}
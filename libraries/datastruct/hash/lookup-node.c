@@ -11,13 +11,19 @@
 
 hash__node_t **hash_lookup_node(hash_t *h, const void *key)
 {
+  hash__table_t *t = h->table;
   int            hash;
   hash__node_t **n;
 
-  hash = h->hash_fn(key) % h->nbins;
-  for (n = &h->bins[hash]; *n != NULL; n = &(*n)->next)
+  hash = h->hash_fn(key) % t->nbins;
+  for (n = &t->bins[hash]; *n != NULL; n = &(*n)->next)
+  {
+    INSTRUMENT_VISIT(h);
+    INSTRUMENT_COMPARE(h);
+
     if (h->compare(key, (*n)->item.key) == 0)
       break;
+  }
 
   return n;
 }
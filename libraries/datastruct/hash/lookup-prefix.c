@@ -0,0 +1,373 @@
+/* --------------------------------------------------------------------------
+ *    Name: lookup-prefix.c
+ * Purpose: Associative array implemented as a hash
+ * ----------------------------------------------------------------------- */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/memento/memento.h"
+
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "datastruct/hash.h"
+
+#include "impl.h"
+
+/* ----------------------------------------------------------------------- */
+
+/* Order keys as memcmp, shorter keys first. */
+static int hash__index_compare_keys(const void *a, size_t alen,
+                                    const void *b, size_t blen)
+{
+  int d;
+
+  d = memcmp(a, b, MIN(alen, blen));
+  if (d)
+    return d;
+
+  return (alen > blen) - (alen < blen);
+}
+
+static int hash__index_compare(const void *a_, const void *b_)
+{
+  const hash__node_t *a = *(const hash__node_t **) a_;
+  const hash__node_t *b = *(const hash__node_t **) b_;
+
+  return hash__index_compare_keys(a->item.key, a->item.keylen,
+                                  b->item.key, b->item.keylen);
+}
+
+static error hash__index_reserve(hash_t *h, int n)
+{
+  hash__node_t **nodes;
+  int            allocated;
+
+  if (n <= h->index.allocated)
+    return error_OK;
+
+  allocated = h->index.allocated ? h->index.allocated : 8;
+  while (allocated < n)
+    allocated *= 2;
+
+  nodes = realloc(h->index.nodes, allocated * sizeof(*nodes));
+  if (nodes == NULL)
+    return error_OOM;
+
+  h->index.nodes = nodes;
+  ATOMIC_STORE_RELAXED(&h->index.allocated, allocated);
+
+  return error_OK;
+}
+
+/* ----------------------------------------------------------------------- */
+
+/* Return the index of the first node whose key is not less than 'key',
+ * among nodes[0..nsorted). Removals may have left NULL entries: a probe
+ * landing on one moves right to the next node. */
+static int hash__index_lower_bound(const hash_t *h,
+                                   const void   *key,
+                                   size_t        keylen)
+{
+  int lo;
+  int hi;
+
+  lo = 0;
+  hi = h->index.nsorted;
+  while (lo < hi)
+  {
+    int                 mid = lo + (hi - lo) / 2;
+    int                 probe;
+    const hash__node_t *n;
+
+    for (probe = mid; probe < hi; probe++)
+      if (h->index.nodes[probe])
+        break;
+    if (probe == hi)
+    {
+      hi = mid; /* nothing but removed entries from mid onwards */
+      continue;
+    }
+
+    n = h->index.nodes[probe];
+
+    INSTRUMENT_COMPARE(h);
+
+    if (hash__index_compare_keys(n->item.key, n->item.keylen,
+                                 key, keylen) < 0)
+      lo = probe + 1;
+    else
+      hi = mid;
+  }
+
+  return lo;
+}
+
+/* Return the index entry for node 'n', or NULL if it's not there. The
+ * sorted run is searched by key, the few appended nodes one by one. */
+static hash__node_t **hash__index_find(hash_t *h, const hash__node_t *n)
+{
+  int i;
+
+  for (i = hash__index_lower_bound(h, n->item.key, n->item.keylen);
+       i < h->index.nsorted;
+       i++)
+  {
+    if (h->index.nodes[i] == n)
+      return &h->index.nodes[i];
+    if (h->index.nodes[i])
+      break; /* keys are unique so it can only be the first node found */
+  }
+
+  for (i = h->index.nsorted; i < h->index.n; i++)
+    if (h->index.nodes[i] == n)
+      return &h->index.nodes[i];
+
+  return NULL;
+}
+
+/* In concurrent mode writers to different stripes update the index at
+ * once, so they serialise on its lock. Prefix lookups lock every stripe,
+ * so never contend with them for it. */
+static void hash__index_lock(hash_t *h)
+{
+  if (h->epoch)
+    pthread_mutex_lock(&h->index.lock);
+}
+
+static void hash__index_unlock(hash_t *h)
+{
+  if (h->epoch)
+    pthread_mutex_unlock(&h->index.lock);
+}
+
+void hash__index_add(hash_t *h, hash__node_t *n)
+{
+  if (ATOMIC_LOAD_RELAXED(&h->index.stale))
+    return; /* there's no index to maintain */
+
+  hash__index_lock(h);
+
+  if (!h->index.stale)
+  {
+    if (hash__index_reserve(h, h->index.n + 1))
+      hash__index_invalidate(h);
+    else
+      h->index.nodes[h->index.n++] = n;
+  }
+
+  hash__index_unlock(h);
+}
+
+void hash__index_replace(hash_t             *h,
+                         const hash__node_t *old,
+                         hash__node_t       *n)
+{
+  hash__node_t **entry;
+
+  if (ATOMIC_LOAD_RELAXED(&h->index.stale))
+    return;
+
+  hash__index_lock(h);
+
+  if (!h->index.stale)
+  {
+    entry = hash__index_find(h, old);
+    if (entry)
+      *entry = n; /* same key, so it stays in order */
+    else
+      hash__index_invalidate(h);
+  }
+
+  hash__index_unlock(h);
+}
+
+void hash__index_remove(hash_t *h, const hash__node_t *n)
+{
+  hash__node_t **entry;
+
+  if (ATOMIC_LOAD_RELAXED(&h->index.stale))
+    return;
+
+  hash__index_lock(h);
+
+  if (!h->index.stale)
+  {
+    entry = hash__index_find(h, n);
+    if (entry)
+    {
+      *entry = NULL;
+      h->index.nremoved++;
+    }
+    else
+    {
+      hash__index_invalidate(h);
+    }
+  }
+
+  hash__index_unlock(h);
+}
+
+/* Gather every node from the table then sort them. */
+static error hash__index_rebuild(hash_t *h)
+{
+  error          err;
+  hash__table_t *t;
+  int            n;
+  int            i;
+
+  err = hash__index_reserve(h, h->count);
+  if (err)
+    return err;
+
+  t = h->table;
+
+  n = 0;
+  for (i = 0; i < t->nbins; i++)
+  {
+    hash__node_t *m;
+
+    for (m = t->bins[i]; m != NULL; m = m->next)
+      h->index.nodes[n++] = m;
+  }
+
+  qsort(h->index.nodes, n, sizeof(*h->index.nodes), hash__index_compare);
+
+  h->index.nsorted  = n;
+  h->index.n        = n;
+  h->index.nremoved = 0;
+  ATOMIC_STORE_RELAXED(&h->index.stale, 0);
+
+  return error_OK;
+}
+
+/* Close up the entries left NULL by removals, keeping both runs in order. */
+static void hash__index_compact(hash_t *h)
+{
+  hash__node_t **nodes = h->index.nodes;
+  int            nsorted;
+  int            i;
+  int            k;
+
+  k = 0;
+  for (i = 0; i < h->index.nsorted; i++)
+    if (nodes[i])
+      nodes[k++] = nodes[i];
+
+  nsorted = k;
+
+  for (; i < h->index.n; i++)
+    if (nodes[i])
+      nodes[k++] = nodes[i];
+
+  h->index.nsorted  = nsorted;
+  h->index.n        = k;
+  h->index.nremoved = 0;
+}
+
+/* Sort the appended nodes then merge them into the sorted run, working
+ * backwards from the end so that the merge can happen in place. */
+static error hash__index_merge(hash_t *h)
+{
+  hash__node_t **nodes = h->index.nodes;
+  hash__node_t **added;
+  int            nadded;
+  int            i;
+  int            j;
+  int            k;
+
+  nadded = h->index.n - h->index.nsorted;
+
+  added = malloc(nadded * sizeof(*added));
+  if (added == NULL)
+    return error_OOM;
+
+  memcpy(added, nodes + h->index.nsorted, nadded * sizeof(*added));
+  qsort(added, nadded, sizeof(*added), hash__index_compare);
+
+  i = h->index.nsorted - 1;
+  j = nadded - 1;
+  k = h->index.n - 1;
+  while (j >= 0)
+  {
+    if (i >= 0 && hash__index_compare(&nodes[i], &added[j]) > 0)
+      nodes[k--] = nodes[i--];
+    else
+      nodes[k--] = added[j--];
+  }
+
+  free(added);
+
+  h->index.nsorted = h->index.n;
+
+  return error_OK;
+}
+
+/* ----------------------------------------------------------------------- */
+
+static error hash__lookup_prefix(hash_t              *h,
+                                 const void          *prefix,
+                                 size_t               prefixlen,
+                                 hash_found_callback *cb,
+                                 void                *opaque)
+{
+  error err;
+  int   i;
+  int   found;
+
+  if (h->index.stale)
+  {
+    err = hash__index_rebuild(h);
+  }
+  else
+  {
+    if (h->index.nremoved)
+      hash__index_compact(h);
+    if (h->index.n > h->index.nsorted)
+      err = hash__index_merge(h);
+    else
+      err = error_OK;
+  }
+  if (err)
+    return err;
+
+  /* keys sharing a prefix are adjacent and begin where the prefix would */
+  found = 0;
+  for (i = hash__index_lower_bound(h, prefix, prefixlen);
+       i < h->index.nsorted;
+       i++)
+  {
+    const hash__node_t *n = h->index.nodes[i];
+
+    if (n->item.keylen < prefixlen ||
+        memcmp(n->item.key, prefix, prefixlen) != 0)
+      break;
+
+    err = cb(&n->item, opaque);
+    if (err)
+      return err;
+
+    found = 1;
+  }
+
+  return found ? error_OK : error_NOT_FOUND;
+}
+
+error hash_lookup_prefix(hash_t              *h,
+                         const void          *prefix,
+                         size_t               prefixlen,
+                         hash_found_callback *cb,
+                         void                *opaque)
+{
+  error err;
+
+  hash__lock_all(h);
+  pthread_mutex_lock(&h->index.lock);
+  err = hash__lookup_prefix(h, prefix, prefixlen, cb, opaque);
+  pthread_mutex_unlock(&h->index.lock);
+  hash__unlock_all(h);
+
+  return err;
+}
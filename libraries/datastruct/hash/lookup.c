@@ -9,11 +9,38 @@
 
 #include "impl.h"
 
+/* This duplicates hash_lookup_node but loads pointers atomically so that it
+ * is safe in concurrent mode. */
 const void *hash_lookup(hash_t *h, const void *key)
 {
-  hash__node_t **n;
+  int                  token;
+  unsigned int         hash;
+  const hash__table_t *t;
+  const hash__node_t  *n;
+  const void          *value;
 
-  n = hash_lookup_node(h, key);
+  token = hash_read_begin(h);
 
-  return (*n != NULL) ? (*n)->item.value : h->default_value;
+  hash = h->hash_fn(key);
+
+  t = LOAD_NODE(&h->table);
+  for (n = LOAD_NODE(&t->bins[hash % t->nbins]); n; n = LOAD_NODE(&n->next))
+  {
+    INSTRUMENT_VISIT(h);
+    INSTRUMENT_COMPARE(h);
+
+    if (h->compare(key, n->item.key) == 0)
+      break;
+  }
+
+  value = (n != NULL) ? LOAD_NODE(&n->item.value) : h->default_value;
+
+  if (n != NULL && h->order == hash_ORDER_ACCESS)
+    hash__order_touch(h, (hash__node_t *) n); /* must cast away const */
+
+  INSTRUMENT_END(h, LOOKUP);
+
+  hash_read_end(h, token);
+
+  return value;
 }
@@ -0,0 +1,69 @@
+/* --------------------------------------------------------------------------
+ *    Name: node-create.c
+ * Purpose: Associative array implemented as a hash
+ * ----------------------------------------------------------------------- */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/memento/memento.h"
+
+#include "datastruct/hash.h"
+
+#include "impl.h"
+
+hash__node_t *hash__node_create(hash_t     *h,
+                                const void *key,
+                                size_t      keylen,
+                                const void *value)
+{
+  size_t        links;
+  hash__node_t *n;
+
+  /* an ordered hash's links precede the node */
+  links = h->order ? sizeof(hash__links_t) : 0;
+
+  if (h->inline_keys)
+  {
+    /* the key's bytes follow the node so short keys share its cache line.
+     * a terminator is added so that string keys remain strings. */
+    n = malloc(links + offsetof(hash__node_t, key) + keylen + 1);
+    if (n == NULL)
+      return NULL;
+
+    n = (hash__node_t *) ((char *) n + links);
+
+    memcpy(n->key, key, keylen);
+    n->key[keylen] = '\0';
+    key = n->key;
+  }
+  else
+  {
+    n = malloc(links + sizeof(*n));
+    if (n == NULL)
+      return NULL;
+
+    n = (hash__node_t *) ((char *) n + links);
+  }
+
+  n->next        = NULL;
+  n->item.key    = key;
+  n->item.keylen = keylen;
+  n->item.value  = value;
+
+  return n;
+}
+
+hash__node_t *hash__node_copy(hash_t *h, const hash__node_t *n)
+{
+  hash__node_t *m;
+
+  m = hash__node_create(h, n->item.key, n->item.keylen, n->item.value);
+  if (m == NULL)
+    return NULL;
+
+  m->next = n->next;
+
+  return m;
+}
@@ -0,0 +1,101 @@
+/* --------------------------------------------------------------------------
+ *    Name: order.c
+ * Purpose: Associative array implemented as a hash
+ * ----------------------------------------------------------------------- */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "base/memento/memento.h"
+
+#include "base/errors.h"
+
+#include "datastruct/hash.h"
+
+#include "impl.h"
+
+void hash_set_order(hash_t *h, hash_order_t order)
+{
+  assert(h->count == 0);
+  assert(h->epoch == NULL); /* lookups would have to write */
+
+  h->order = order;
+}
+
+/* ----------------------------------------------------------------------- */
+
+void hash__order_append(hash_t *h, hash__node_t *n)
+{
+  LINKS(n)->prev = h->newest;
+  LINKS(n)->next = NULL;
+
+  if (h->newest)
+    LINKS(h->newest)->next = n;
+  else
+    h->oldest = n;
+
+  h->newest = n;
+}
+
+void hash__order_remove(hash_t *h, hash__node_t *n)
+{
+  hash__links_t *l = LINKS(n);
+
+  if (l->prev)
+    LINKS(l->prev)->next = l->next;
+  else
+    h->oldest = l->next;
+
+  if (l->next)
+    LINKS(l->next)->prev = l->prev;
+  else
+    h->newest = l->prev;
+}
+
+void hash__order_touch(hash_t *h, hash__node_t *n)
+{
+  if (h->newest == n)
+    return;
+
+  hash__order_remove(h, n);
+  hash__order_append(h, n);
+}
+
+/* ----------------------------------------------------------------------- */
+
+error hash_pop_oldest(hash_t *h, const void **key, const void **value)
+{
+  hash__node_t  *oldest;
+  hash__node_t **n;
+
+  assert(h->order != hash_ORDER_NONE);
+  assert(key == NULL || !h->inline_keys);
+
+  oldest = h->oldest;
+  if (oldest == NULL)
+    return error_NOT_FOUND;
+
+  n = LINKS(oldest)->link;
+  assert(*n == oldest);
+
+  INSTRUMENT_END(h, REMOVE);
+
+  hash__node_unlink(h, n);
+
+  if (key)
+    *key = oldest->item.key;
+  else if (!h->inline_keys)
+    h->destroy_key((void *) oldest->item.key); /* must cast away const */
+
+  if (value)
+    *value = oldest->item.value;
+  else
+    h->destroy_value((void *) oldest->item.value); /* must cast away const */
+
+  free(NODE_BLOCK(h, oldest));
+
+  INSTRUMENT_FREE(h);
+
+  return error_OK;
+}
@@ -11,26 +11,69 @@
 
 #include "impl.h"
 
-void hash_remove_node(hash_t *h, hash__node_t **n)
+static void hash__node_free(void *block, void *opaque)
+{
+  hash__node_t *doomed = block;
+  hash_t       *h      = opaque;
+
+  if (!h->inline_keys)
+    h->destroy_key((void *) doomed->item.key); /* must cast away const */
+  h->destroy_value((void *) doomed->item.value); /* must cast away const */
+
+  free(NODE_BLOCK(h, doomed));
+}
+
+hash__node_t *hash__node_unlink(hash_t *h, hash__node_t **n)
 {
   hash__node_t *doomed;
 
   doomed = *n;
 
-  *n = doomed->next;
+  PUBLISH(n, doomed->next);
 
-  h->destroy_key((void *) doomed->item.key); /* must cast away const */
-  h->destroy_value((void *) doomed->item.value); /* must cast away const */
+  hash__index_remove(h, doomed);
+
+  if (h->order)
+  {
+    /* its successor in the chain is now pointed at by its link */
+    if (doomed->next)
+      LINKS(doomed->next)->link = n;
+    hash__order_remove(h, doomed);
+  }
 
-  free(doomed);
+  hash__count_add(h, -1);
+  hash__inline_bytes_add(h, doomed, -1);
 
-  h->count--;
+  return doomed;
+}
+
+void hash_remove_node(hash_t *h, hash__node_t **n)
+{
+  hash__node_t *doomed;
+
+  doomed = hash__node_unlink(h, n);
+
+  if (h->epoch)
+    epoch_retire(h->epoch, doomed, hash__node_free, h);
+  else
+    hash__node_free(doomed, h);
+
+  INSTRUMENT_FREE(h);
 }
 
 void hash_remove(hash_t *h, const void *key)
 {
-  hash__node_t **n;
+  pthread_mutex_t *stripe;
+  hash__node_t   **n;
+
+  stripe = hash__lock_key(h, key);
 
   n = hash_lookup_node(h, key);
-  hash_remove_node(h, n);
+
+  INSTRUMENT_END(h, REMOVE);
+
+  if (*n)
+    hash_remove_node(h, n);
+
+  hash__unlock_key(h, stripe);
 }
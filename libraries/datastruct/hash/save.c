@@ -0,0 +1,39 @@
+/* --------------------------------------------------------------------------
+ *    Name: save.c
+ * Purpose: Associative array implemented as a hash
+ * ----------------------------------------------------------------------- */
+
+#include <stdlib.h>
+
+#include "base/errors.h"
+
+#include "datastruct/flat.h"
+
+#include "datastruct/hash.h"
+
+#include "impl.h"
+
+static error hash__save_item(const item_t *item, void *opaque)
+{
+  return flat_writer_add(opaque, item->key, item->keylen, item->value);
+}
+
+error hash_save(const hash_t   *h,
+                flat_value_len *value_len,
+                const char     *filename)
+{
+  error          err;
+  flat_writer_t *w;
+
+  err = flat_writer_create(flat_KIND_HASHED, value_len, &w);
+  if (err)
+    return err;
+
+  err = hash_walk(h, hash__save_item, w);
+  if (!err)
+    err = flat_writer_save(w, filename);
+
+  flat_writer_destroy(w);
+
+  return err;
+}
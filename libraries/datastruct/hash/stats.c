@@ -0,0 +1,49 @@
+/* --------------------------------------------------------------------------
+ *    Name: stats.c
+ * Purpose: Associative array implemented as a hash
+ * ----------------------------------------------------------------------- */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "datastruct/hash.h"
+
+#include "impl.h"
+
+void hash_stats(const hash_t *h, datastruct_stats_t *stats)
+{
+  int                  token;
+  const hash__table_t *table;
+  int                  count;
+
+  memset(stats, 0, sizeof(*stats));
+
+  /* a concurrent hash may replace its table while we look at it */
+  token = hash_read_begin(h);
+
+  table = LOAD_NODE(&h->table);
+  count = ATOMIC_LOAD_RELAXED(&h->count);
+
+  stats->elements    = count;
+  stats->leaves      = count;
+  /* inline keys extend the node past its key member */
+  if (h->inline_keys)
+    stats->node_bytes = count * offsetof(hash__node_t, key) +
+                        ATOMIC_LOAD_RELAXED(&h->inline_bytes);
+  else
+    stats->node_bytes = count * sizeof(hash__node_t);
+  if (h->order)
+    stats->node_bytes += count * sizeof(hash__links_t);
+  stats->table_bytes = offsetof(hash__table_t, bins) +
+                       table->nbins * sizeof(table->bins[0]);
+  stats->other_bytes = sizeof(*h);
+  stats->other_bytes += ATOMIC_LOAD_RELAXED(&h->index.allocated) *
+                        sizeof(*h->index.nodes);
+  if (h->stripes)
+    stats->other_bytes += HASH_NSTRIPES * sizeof(*h->stripes);
+
+  hash_read_end(h, token);
+
+  stats->total_bytes = stats->node_bytes + stats->table_bytes +
+                       stats->other_bytes;
+}
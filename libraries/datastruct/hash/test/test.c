@@ -0,0 +1,1023 @@
+/* test.c */
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/memento/memento.h"
+
+#include "base/atomic.h"
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "datastruct/hash.h"
+#include "datastruct/hash-template.h"
+
+#include "keyval/string.h"
+
+error hashtest(void);
+
+/* ----------------------------------------------------------------------- */
+
+#define NKEYS    4096
+#define NWRITERS 2
+#define NREADERS 4
+#define NROUNDS  20
+
+static int keys[NKEYS];
+
+static unsigned int hashtest_hash(const void *a)
+{
+  return *(const int *) a * 2654435761u;
+}
+
+static int hashtest_compare(const void *a, const void *b)
+{
+  int ia = *(const int *) a;
+  int ib = *(const int *) b;
+
+  return (ia > ib) - (ia < ib);
+}
+
+static void hashtest_destroy_nothing(void *doomed)
+{
+  NOT_USED(doomed);
+}
+
+/* A specialised hash of ints to ints. The identity hash suffices as the
+ * hash scrambles it. */
+#define hashtest_int_hash(k)  ((unsigned int) (k))
+#define hashtest_int_eq(a, b) ((a) == (b))
+
+DEFINE_HASH(hashtest_ints, int, int, hashtest_int_hash, hashtest_int_eq)
+
+typedef struct hashtest_state
+{
+  hash_t *h;
+  int     writers;  /* count of writers still running */
+  int     failures; /* count of bad lookups seen by readers */
+}
+hashtest_state_t;
+
+typedef struct hashtest_writer
+{
+  hashtest_state_t *state;
+  int               first; /* writer owns keys first, first+step, ... */
+  int               step;
+  error             err;
+}
+hashtest_writer_t;
+
+/* Writers churn the odd keys and update the even ones, which are always
+ * present, while the table grows beneath them. */
+static void *hashtest_writer(void *opaque)
+{
+  hashtest_writer_t *w = opaque;
+  hash_t            *h = w->state->h;
+  int                round;
+  int                i;
+
+  w->err = error_OK;
+
+  for (round = 0; round < NROUNDS && !w->err; round++)
+  {
+    for (i = w->first; i < NKEYS && !w->err; i += w->step)
+      w->err = hash_insert(h, &keys[i], sizeof(int), &keys[i]);
+
+    for (i = w->first; i < NKEYS; i += w->step)
+      if (i & 1)
+        hash_remove(h, &keys[i]);
+  }
+
+  ATOMIC_FETCH_ADD(&w->state->writers, -1);
+
+  return NULL;
+}
+
+static void *hashtest_reader(void *opaque)
+{
+  hashtest_state_t *state = opaque;
+  int               i;
+
+  while (ATOMIC_LOAD(&state->writers) > 0)
+  {
+    for (i = 0; i < NKEYS; i += 2)
+    {
+      const int *value;
+
+      value = hash_lookup(state->h, &keys[i]);
+      if (value != NULL && *value != i)
+        ATOMIC_FETCH_ADD(&state->failures, 1);
+    }
+  }
+
+  return NULL;
+}
+
+static error hashtest1(void)
+{
+  error             err;
+  hashtest_state_t  state;
+  hashtest_writer_t writers[NWRITERS];
+  pthread_t         threads[NWRITERS + NREADERS];
+  int               nthreads;
+  int               i;
+
+  printf("> hash test 1 - concurrent readers and writers\n");
+
+  for (i = 0; i < NKEYS; i++)
+    keys[i] = i;
+
+  /* start small so that the table grows during the test */
+  err = hash_create_concurrent(NULL, 17,
+                               hashtest_hash, hashtest_compare,
+                               hashtest_destroy_nothing,
+                               hashtest_destroy_nothing,
+                               &state.h);
+  if (err)
+    return err;
+
+  state.writers  = NWRITERS;
+  state.failures = 0;
+
+  nthreads = 0;
+  for (i = 0; i < NWRITERS; i++)
+  {
+    writers[i].state = &state;
+    writers[i].first = i;
+    writers[i].step  = NWRITERS;
+    if (pthread_create(&threads[nthreads], NULL, hashtest_writer, &writers[i]) != 0)
+    {
+      writers[i].err = error_OOM;
+      ATOMIC_FETCH_ADD(&state.writers, -1);
+      continue;
+    }
+    nthreads++;
+  }
+
+  for (i = 0; i < NREADERS; i++)
+    if (pthread_create(&threads[nthreads], NULL, hashtest_reader, &state) == 0)
+      nthreads++;
+
+  for (i = 0; i < nthreads; i++)
+    pthread_join(threads[i], NULL);
+
+  for (i = 0; i < NWRITERS; i++)
+    if (writers[i].err && !err)
+      err = writers[i].err;
+  if (err)
+    goto exit;
+
+  printf("%d failures, %d items remain\n", state.failures, hash_count(state.h));
+
+  if (state.failures != 0 || hash_count(state.h) != NKEYS / 2)
+  {
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+  for (i = 0; i < NKEYS; i++)
+    if ((hash_lookup(state.h, &keys[i]) != NULL) != ((i & 1) == 0))
+    {
+      printf("key %d in wrong state\n", i);
+      err = error_TEST_FAILED;
+      goto exit;
+    }
+
+exit:
+
+  hash_destroy(state.h);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+#define NPREFIXKEYS 400
+
+static char prefixkeys[NPREFIXKEYS][8];
+
+typedef struct hashtest_prefix_state
+{
+  const char *prev;
+  int         count;
+  int         failures;
+}
+hashtest_prefix_state_t;
+
+static error hashtest_prefix_found(const item_t *item, void *opaque)
+{
+  hashtest_prefix_state_t *state = opaque;
+
+  if (item->keylen != strlen(item->key) || strcmp(item->key, item->value))
+    state->failures++;
+
+  /* matches arrive in key order */
+  if (state->prev && strcmp(state->prev, item->key) >= 0)
+    state->failures++;
+
+  state->prev = item->key;
+  state->count++;
+
+  return error_OK;
+}
+
+/* Look up 'prefix' and check that 'expected' keys, in order, are found. */
+static error hashtest_prefix_check(hash_t *h, const char *prefix, int expected)
+{
+  error                   err;
+  hashtest_prefix_state_t state;
+
+  memset(&state, 0, sizeof(state));
+
+  err = hash_lookup_prefix(h, prefix, strlen(prefix),
+                           hashtest_prefix_found, &state);
+  if (err == error_NOT_FOUND && expected == 0)
+    err = error_OK;
+  if (err)
+    return err;
+
+  if (state.count != expected || state.failures)
+  {
+    printf("prefix '%s' saw %d items (expected %d), %d bad\n",
+           prefix, state.count, expected, state.failures);
+    return error_TEST_FAILED;
+  }
+
+  return error_OK;
+}
+
+/* Prefix lookups on a plain hash may run concurrently, as other lookups
+ * may, although they update its index. */
+static void *hashtest_prefix_reader(void *opaque)
+{
+  return hashtest_prefix_check(opaque, "k3", 111) ? opaque : NULL;
+}
+
+static error hashtest2(void)
+{
+  error     err;
+  hash_t   *h;
+  pthread_t threads[NREADERS];
+  int       nthreads;
+  int       i;
+
+  printf("> hash test 2 - prefix lookup\n");
+
+  for (i = 0; i < NPREFIXKEYS; i++)
+    sprintf(prefixkeys[i], "k%d", i);
+
+  err = hash_create(NULL, 97, stringkv_hash, stringkv_compare,
+                    hashtest_destroy_nothing, hashtest_destroy_nothing,
+                    &h);
+  if (err)
+    return err;
+
+  for (i = 0; i < 300 && !err; i++)
+    err = hash_insert(h, prefixkeys[i], strlen(prefixkeys[i]), prefixkeys[i]);
+  if (err)
+    goto exit;
+
+  /* builds the index. "k2", "k20".."k29" and "k200".."k299". */
+  err = hashtest_prefix_check(h, "k2", 111);
+  if (!err)
+    err = hashtest_prefix_check(h, "k", 300);
+  if (!err)
+    err = hashtest_prefix_check(h, "x", 0);
+  if (!err)
+    err = hashtest_prefix_check(h, "k2000", 0);
+  if (err)
+    goto exit;
+
+  /* keys added now are merged into the index by whichever of several
+   * concurrent readers gets there first */
+  for (i = 300; i < NPREFIXKEYS && !err; i++)
+    err = hash_insert(h, prefixkeys[i], strlen(prefixkeys[i]), prefixkeys[i]);
+  if (err)
+    goto exit;
+
+  nthreads = 0;
+  for (i = 0; i < NREADERS; i++)
+    if (pthread_create(&threads[nthreads], NULL, hashtest_prefix_reader, h) == 0)
+      nthreads++;
+
+  for (i = 0; i < nthreads; i++)
+  {
+    void *failed;
+
+    pthread_join(threads[i], &failed);
+    if (failed)
+      err = error_TEST_FAILED;
+  }
+
+  if (!err)
+    err = hashtest_prefix_check(h, "k3", 111);
+  if (err)
+    goto exit;
+
+  /* removals clear their entries in the index */
+  for (i = 20; i < 30; i++)
+    hash_remove(h, prefixkeys[i]);
+  err = hashtest_prefix_check(h, "k2", 101);
+  if (!err)
+    err = hashtest_prefix_check(h, "k", NPREFIXKEYS - 10);
+  if (err)
+    goto exit;
+
+  /* including those of keys appended since the last prefix lookup */
+  for (i = 20; i < 30 && !err; i++)
+    err = hash_insert(h, prefixkeys[i], strlen(prefixkeys[i]), prefixkeys[i]);
+  if (err)
+    goto exit;
+  for (i = 25; i < 30; i++)
+    hash_remove(h, prefixkeys[i]);
+  hash_remove(h, prefixkeys[200]);
+  err = hashtest_prefix_check(h, "k2", 105);
+  if (!err)
+    err = hashtest_prefix_check(h, "k", NPREFIXKEYS - 6);
+
+exit:
+
+  hash_destroy(h);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+static int seen[NKEYS];
+
+/* Step 'cursor' through to the end, counting the keys seen. Removes each
+ * key as it goes if 'h' is given. */
+static void hashtest_cursor_drain(hash_cursor_t *cursor, hash_t *h)
+{
+  const item_t *item;
+
+  while (hash_cursor_next(cursor, &item) == error_OK)
+  {
+    seen[*(const int *) item->key]++;
+    if (h)
+      hash_remove(h, item->key);
+  }
+}
+
+/* Check that keys [0..n) were seen once and later ones at most once. */
+static error hashtest_cursor_check(int n)
+{
+  int i;
+
+  for (i = 0; i < NKEYS; i++)
+    if (seen[i] > 1 || (i < n && seen[i] == 0))
+    {
+      printf("key %d seen %d times\n", i, seen[i]);
+      return error_TEST_FAILED;
+    }
+
+  return error_OK;
+}
+
+static void *hashtest_cursor_writer(void *opaque)
+{
+  hashtest_writer_t *w = opaque;
+  int                i;
+
+  w->err = error_OK;
+  for (i = w->first; i < NKEYS && !w->err; i += w->step)
+    w->err = hash_insert(w->state->h, &keys[i], sizeof(int), &keys[i]);
+
+  return NULL;
+}
+
+static error hashtest3(void)
+{
+  error             err;
+  hash_t           *h;
+  hash_cursor_t     cursor;
+  hashtest_state_t  state;
+  hashtest_writer_t writer;
+  pthread_t         thread;
+  const item_t     *item;
+  int               i;
+
+  printf("> hash test 3 - cursors\n");
+
+  for (i = 0; i < NKEYS; i++)
+    keys[i] = i;
+
+  /* few bins, so long chains */
+  err = hash_create(NULL, 7, hashtest_hash, hashtest_compare,
+                    hashtest_destroy_nothing, hashtest_destroy_nothing,
+                    &h);
+  if (err)
+    return err;
+
+  for (i = 0; i < NKEYS && !err; i++)
+    err = hash_insert(h, &keys[i], sizeof(int), &keys[i]);
+  if (err)
+    goto exit;
+
+  memset(seen, 0, sizeof(seen));
+  hash_cursor_init(h, &cursor);
+  hashtest_cursor_drain(&cursor, NULL);
+  hash_cursor_end(h, &cursor);
+  err = hashtest_cursor_check(NKEYS);
+  if (err)
+    goto exit;
+
+  /* the item just returned may be removed */
+  memset(seen, 0, sizeof(seen));
+  hash_cursor_init(h, &cursor);
+  hashtest_cursor_drain(&cursor, h);
+  hash_cursor_end(h, &cursor);
+  err = hashtest_cursor_check(NKEYS);
+  if (!err && hash_count(h) != 0)
+  {
+    printf("%d items remain\n", hash_count(h));
+    err = error_TEST_FAILED;
+  }
+  if (err)
+    goto exit;
+
+  hash_destroy(h);
+
+  /* a concurrent hash grows beneath the cursor */
+  err = hash_create_concurrent(NULL, 17, hashtest_hash, hashtest_compare,
+                               hashtest_destroy_nothing,
+                               hashtest_destroy_nothing,
+                               &h);
+  if (err)
+    return err;
+
+  for (i = 0; i < NKEYS / 2 && !err; i++)
+    err = hash_insert(h, &keys[i], sizeof(int), &keys[i]);
+  if (err)
+    goto exit;
+
+  memset(seen, 0, sizeof(seen));
+  hash_cursor_init(h, &cursor);
+
+  for (i = 0; i < 10 && hash_cursor_next(&cursor, &item) == error_OK; i++)
+    seen[*(const int *) item->key]++;
+
+  state.h       = h;
+  writer.state  = &state;
+  writer.first  = NKEYS / 2;
+  writer.step   = 1;
+  if (pthread_create(&thread, NULL, hashtest_cursor_writer, &writer) != 0)
+  {
+    hash_cursor_end(h, &cursor);
+    err = error_OOM;
+    goto exit;
+  }
+  pthread_join(thread, NULL);
+
+  hashtest_cursor_drain(&cursor, NULL);
+  hash_cursor_end(h, &cursor);
+
+  err = writer.err;
+  if (!err)
+    err = hashtest_cursor_check(NKEYS / 2);
+
+exit:
+
+  hash_destroy(h);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+#define NORDERKEYS 100
+
+typedef struct hashtest_order_state
+{
+  int order[NORDERKEYS]; /* keys in the order seen */
+  int n;
+}
+hashtest_order_state_t;
+
+static error hashtest_order_record(const item_t *item, void *opaque)
+{
+  hashtest_order_state_t *state = opaque;
+
+  if (state->n < NORDERKEYS)
+    state->order[state->n] = *(const int *) item->key;
+  state->n++;
+
+  return error_OK;
+}
+
+/* Check that both a walk and a cursor visit 'expected', in order. */
+static error hashtest_order_check(hash_t *h, const int *expected, int n)
+{
+  hashtest_order_state_t state;
+  hash_cursor_t          cursor;
+  const item_t          *item;
+  int                    i;
+
+  state.n = 0;
+  (void) hash_walk(h, hashtest_order_record, &state);
+
+  hash_cursor_init(h, &cursor);
+  i = 0;
+  while (hash_cursor_next(&cursor, &item) == error_OK)
+    if (i >= n || *(const int *) item->key != expected[i++])
+      i = n + 1;
+  hash_cursor_end(h, &cursor);
+
+  if (state.n != n || i != n ||
+      memcmp(state.order, expected, n * sizeof(*expected)) != 0)
+  {
+    printf("elements out of order\n");
+    return error_TEST_FAILED;
+  }
+
+  return error_OK;
+}
+
+static error hashtest4(void)
+{
+  error       err;
+  hash_t     *h;
+  int         expected[NORDERKEYS];
+  int         i;
+  const void *key;
+  const void *value;
+
+  printf("> hash test 4 - ordered hashes\n");
+
+  for (i = 0; i < NKEYS; i++)
+    keys[i] = i;
+
+  /* insertion order: updates keep their place */
+  err = hash_create(NULL, 7, hashtest_hash, hashtest_compare,
+                    hashtest_destroy_nothing, hashtest_destroy_nothing,
+                    &h);
+  if (err)
+    return err;
+
+  hash_set_order(h, hash_ORDER_INSERTION);
+
+  for (i = 0; i < NORDERKEYS && !err; i++)
+  {
+    expected[i] = (i * 37) % NORDERKEYS;
+    err = hash_insert(h, &keys[expected[i]], sizeof(int), &keys[expected[i]]);
+  }
+  if (!err)
+    err = hash_insert(h, &keys[expected[0]], sizeof(int), &keys[1]);
+  if (!err)
+    err = hashtest_order_check(h, expected, NORDERKEYS);
+  if (err)
+    goto exit;
+
+  /* removing from the middle; popping the oldest */
+  hash_remove(h, &keys[expected[1]]);
+  if (hash_pop_oldest(h, &key, &value) != error_OK ||
+      *(const int *) key != expected[0] || value != &keys[1])
+  {
+    printf("popped the wrong element\n");
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+  err = hashtest_order_check(h, expected + 2, NORDERKEYS - 2);
+  if (err)
+    goto exit;
+
+  /* with seven bins each chain holds many elements, so removing some
+   * relinks the chains around others still to be popped */
+  for (i = 2; i < NORDERKEYS; i += 3)
+    hash_remove(h, &keys[expected[i]]);
+
+  for (i = 3; i < NORDERKEYS; i++)
+  {
+    if (i % 3 == 2)
+      continue;
+
+    if (hash_pop_oldest(h, &key, NULL) != error_OK ||
+        *(const int *) key != expected[i])
+    {
+      printf("popped the wrong element\n");
+      err = error_TEST_FAILED;
+      goto exit;
+    }
+  }
+
+  if (hash_pop_oldest(h, NULL, NULL) != error_NOT_FOUND ||
+      hash_count(h) != 0)
+  {
+    printf("%d items remain\n", hash_count(h));
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+  hash_destroy(h);
+
+  /* access order, with inline keys: lookups and updates move elements to
+   * the newest end */
+  err = hash_create(NULL, 7, hashtest_hash, hashtest_compare,
+                    hashtest_destroy_nothing, hashtest_destroy_nothing,
+                    &h);
+  if (err)
+    return err;
+
+  hash_set_inline_keys(h);
+  hash_set_order(h, hash_ORDER_ACCESS);
+
+  for (i = 0; i < 10 && !err; i++)
+    err = hash_insert(h, &keys[i], sizeof(int), &keys[i]);
+  if (err)
+    goto exit;
+
+  (void) hash_lookup(h, &keys[0]);
+  err = hash_insert(h, &keys[2], sizeof(int), &keys[2]);
+  if (err)
+    goto exit;
+
+  if (hash_pop_oldest(h, NULL, &value) != error_OK || value != &keys[1])
+  {
+    printf("popped the wrong element\n");
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+  for (i = 0; i < 7; i++)
+    expected[i] = 3 + i;
+  expected[7] = 0;
+  expected[8] = 2;
+  err = hashtest_order_check(h, expected, 9);
+
+exit:
+
+  hash_destroy(h);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+static error hashtest5(void)
+{
+  error           err;
+  hashtest_ints_t h;
+  int            *value;
+  int             i;
+
+  printf("> hash test 5 - specialised hash\n");
+
+  hashtest_ints_init(&h);
+
+  if (hashtest_ints_lookup(&h, 0) != NULL || hashtest_ints_remove(&h, 0))
+  {
+    printf("empty hash found a key\n");
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+  /* insert enough keys to grow it several times, then update them all */
+
+  err = error_OK;
+  for (i = 0; i < NKEYS && !err; i++)
+    err = hashtest_ints_insert(&h, i * 1024, i);
+  for (i = 0; i < NKEYS && !err; i++)
+    err = hashtest_ints_insert(&h, i * 1024, -i);
+  if (err)
+    goto exit;
+
+  if (hashtest_ints_count(&h) != NKEYS)
+  {
+    printf("unexpected count %d\n", hashtest_ints_count(&h));
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+  for (i = 0; i < NKEYS; i += 2)
+    if (!hashtest_ints_remove(&h, i * 1024))
+    {
+      printf("key %d: not removed\n", i * 1024);
+      err = error_TEST_FAILED;
+      goto exit;
+    }
+
+  for (i = 0; i < NKEYS; i++)
+  {
+    value = hashtest_ints_lookup(&h, i * 1024);
+    if ((i & 1) ? (value == NULL || *value != -i) : (value != NULL))
+    {
+      printf("key %d: wrong lookup result\n", i * 1024);
+      err = error_TEST_FAILED;
+      goto exit;
+    }
+  }
+
+  if (hashtest_ints_lookup(&h, 1) != NULL ||
+      hashtest_ints_count(&h) != NKEYS / 2)
+  {
+    printf("absent key found or unexpected count\n");
+    err = error_TEST_FAILED;
+  }
+
+exit:
+
+  hashtest_ints_fini(&h);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+#define NGROWERS 8
+
+/* Each grower inserts its share of the keys, so every insert may find the
+ * table overloaded and grow it while the others are locking their keys'
+ * stripes. */
+static void *hashtest_grower(void *opaque)
+{
+  hashtest_writer_t *w = opaque;
+  int                i;
+
+  w->err = error_OK;
+
+  for (i = w->first; i < NKEYS && !w->err; i += w->step)
+    w->err = hash_insert(w->state->h, &keys[i], sizeof(int), &keys[i]);
+
+  for (i = w->first; i < NKEYS; i += w->step)
+    if (i & 1)
+      hash_remove(w->state->h, &keys[i]);
+
+  return NULL;
+}
+
+static error hashtest6(void)
+{
+  error             err;
+  hashtest_state_t  state;
+  hashtest_writer_t growers[NGROWERS];
+  pthread_t         threads[NGROWERS];
+  int               nthreads;
+  int               round;
+  int               i;
+
+  printf("> hash test 6 - concurrent writers growing the table\n");
+
+  err = error_OK;
+
+  for (round = 0; round < NROUNDS && !err; round++)
+  {
+    /* start with the fewest bins so that the table grows many times */
+    err = hash_create_concurrent(NULL, 2,
+                                 hashtest_hash, hashtest_compare,
+                                 hashtest_destroy_nothing,
+                                 hashtest_destroy_nothing,
+                                 &state.h);
+    if (err)
+      return err;
+
+    nthreads = 0;
+    for (i = 0; i < NGROWERS; i++)
+    {
+      growers[i].state = &state;
+      growers[i].first = i;
+      growers[i].step  = NGROWERS;
+      growers[i].err   = error_OK;
+      if (pthread_create(&threads[nthreads], NULL, hashtest_grower, &growers[i]) != 0)
+      {
+        growers[i].err = error_OOM;
+        continue;
+      }
+      nthreads++;
+    }
+
+    for (i = 0; i < nthreads; i++)
+      pthread_join(threads[i], NULL);
+
+    for (i = 0; i < NGROWERS; i++)
+      if (growers[i].err && !err)
+        err = growers[i].err;
+
+    if (!err && hash_count(state.h) != NKEYS / 2)
+    {
+      printf("round %d: %d items remain\n", round, hash_count(state.h));
+      err = error_TEST_FAILED;
+    }
+
+    for (i = 0; i < NKEYS && !err; i++)
+      if ((hash_lookup(state.h, &keys[i]) != NULL) != ((i & 1) == 0))
+      {
+        printf("round %d: key %d in wrong state\n", round, i);
+        err = error_TEST_FAILED;
+      }
+
+    hash_destroy(state.h);
+  }
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+#define NSTATSKEYS 100
+#define STATSPAD   32 /* bytes by which long keys exceed short ones */
+
+static char statskeys[2][NSTATSKEYS][8 + STATSPAD];
+
+/* Inline keys are held within their nodes, so node_bytes must grow by each
+ * byte of key and shrink back as keys are removed. */
+static error hashtest7(void)
+{
+  error              err;
+  hash_t            *h[2];
+  datastruct_stats_t empty;
+  datastruct_stats_t stats[2];
+  int                i;
+  int                j;
+
+  printf("> hash test 7 - stats with inline keys\n");
+
+  for (i = 0; i < NSTATSKEYS; i++)
+  {
+    sprintf(statskeys[0][i], "k%d", i);
+    sprintf(statskeys[1][i], "k%d%0*d", i, STATSPAD, 0);
+  }
+
+  h[0] = h[1] = NULL;
+
+  for (j = 0; j < 2; j++)
+  {
+    err = hash_create(NULL, 97, stringkv_hash, stringkv_compare,
+                      hashtest_destroy_nothing, hashtest_destroy_nothing,
+                      &h[j]);
+    if (err)
+      goto exit;
+
+    hash_set_inline_keys(h[j]);
+  }
+
+  hash_stats(h[0], &empty);
+
+  for (j = 0; j < 2; j++)
+  {
+    for (i = 0; i < NSTATSKEYS && !err; i++)
+      err = hash_insert(h[j], statskeys[j][i], strlen(statskeys[j][i]), NULL);
+    if (err)
+      goto exit;
+
+    hash_stats(h[j], &stats[j]);
+  }
+
+  if (stats[0].node_bytes <= empty.node_bytes ||
+      stats[1].node_bytes - stats[0].node_bytes != NSTATSKEYS * STATSPAD)
+  {
+    printf("node bytes %lu for short keys, %lu for long\n",
+           (unsigned long) stats[0].node_bytes,
+           (unsigned long) stats[1].node_bytes);
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+  for (j = 0; j < 2; j++)
+  {
+    for (i = 0; i < NSTATSKEYS; i++)
+      hash_remove(h[j], statskeys[j][i]);
+
+    hash_stats(h[j], &stats[j]);
+    if (stats[j].node_bytes != empty.node_bytes)
+    {
+      printf("node bytes %lu once emptied\n",
+             (unsigned long) stats[j].node_bytes);
+      err = error_TEST_FAILED;
+    }
+  }
+
+exit:
+
+  for (j = 0; j < 2; j++)
+    if (h[j])
+      hash_destroy(h[j]);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+typedef struct hashtest_index_writer
+{
+  hash_t *h;
+  int     first; /* writer owns keys first, first+NWRITERS, ... */
+  error   err;
+}
+hashtest_index_writer_t;
+
+/* Writers remove their odd keys then replace their even keys' nodes, each
+ * updating the index alongside writers to other stripes. */
+static void *hashtest_index_writer(void *opaque)
+{
+  hashtest_index_writer_t *w = opaque;
+  int                      i;
+
+  w->err = error_OK;
+
+  for (i = w->first; i < NPREFIXKEYS; i += NWRITERS)
+    if (i & 1)
+      hash_remove(w->h, prefixkeys[i]);
+
+  for (i = w->first; i < NPREFIXKEYS && !w->err; i += NWRITERS)
+    if ((i & 1) == 0)
+      w->err = hash_insert(w->h, prefixkeys[i], strlen(prefixkeys[i]),
+                           prefixkeys[i]);
+
+  return NULL;
+}
+
+static error hashtest8(void)
+{
+  error                   err;
+  hash_t                 *h;
+  hashtest_index_writer_t writers[NWRITERS];
+  pthread_t               threads[NWRITERS];
+  int                     nthreads;
+  int                     i;
+
+  printf("> hash test 8 - concurrent writers maintaining the prefix index\n");
+
+  /* big enough not to grow, which would have the index rebuilt */
+  err = hash_create_concurrent(NULL, 1021, stringkv_hash, stringkv_compare,
+                               hashtest_destroy_nothing,
+                               hashtest_destroy_nothing,
+                               &h);
+  if (err)
+    return err;
+
+  for (i = 0; i < NPREFIXKEYS && !err; i++)
+    err = hash_insert(h, prefixkeys[i], strlen(prefixkeys[i]), prefixkeys[i]);
+  if (!err)
+    err = hashtest_prefix_check(h, "k", NPREFIXKEYS); /* builds the index */
+  if (err)
+    goto exit;
+
+  nthreads = 0;
+  for (i = 0; i < NWRITERS; i++)
+  {
+    writers[i].h     = h;
+    writers[i].first = i;
+    if (pthread_create(&threads[nthreads], NULL, hashtest_index_writer,
+                       &writers[i]) == 0)
+      nthreads++;
+  }
+
+  for (i = 0; i < nthreads; i++)
+  {
+    pthread_join(threads[i], NULL);
+    if (writers[i].err)
+      err = writers[i].err;
+  }
+  if (err)
+    goto exit;
+
+  /* "k2", even keys of "k20".."k29" and "k200".."k299" */
+  err = hashtest_prefix_check(h, "k2", 56);
+  if (!err)
+    err = hashtest_prefix_check(h, "k", NPREFIXKEYS / 2);
+
+exit:
+
+  hash_destroy(h);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+error hashtest(void)
+{
+  error err;
+
+  printf(">> hash test\n");
+
+  err = hashtest1();
+  if (!err)
+    err = hashtest2();
+  if (!err)
+    err = hashtest3();
+  if (!err)
+    err = hashtest4();
+  if (!err)
+    err = hashtest5();
+  if (!err)
+    err = hashtest6();
+  if (!err)
+    err = hashtest7();
+  if (!err)
+    err = hashtest8();
+  if (err)
+  {
+    printf("unexpected error: %lx\n", err);
+    return err;
+  }
+
+  printf("<< hash tests ok\n");
+
+  return error_OK;
+}
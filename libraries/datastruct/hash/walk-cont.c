@@ -14,11 +14,11 @@
 
 #include "impl.h"
 
-error hash_walk_continuation(hash_t      *h,
-                             int          continuation,
-                             int         *nextcontinuation,
-                             const void **key,
-                             const void **value)
+static error hash__walk_continuation(const hash__table_t *t,
+                                    int                  continuation,
+                                    int                 *nextcontinuation,
+                                    const void         **key,
+                                    const void         **value)
 {
   unsigned int  bin;
   unsigned int  item;
@@ -35,23 +35,23 @@ error hash_walk_continuation(hash_t      *h,
   bin  = ((unsigned int) continuation & 0xffff0000) >> 16;
   item = ((unsigned int) continuation & 0x0000ffff) >> 0;
 
-  if (bin >= (unsigned int) h->nbins)
+  if (bin >= (unsigned int) t->nbins)
     return error_HASH_BAD_CONT; /* invalid continuation value */
 
   /* if we're starting off, scan forward to the first occupied bin */
 
   if (continuation == 0)
   {
-    while (h->bins[bin] == NULL)
+    while (t->bins[bin] == NULL)
       bin++;
 
-    if (bin == (unsigned int) h->nbins)
+    if (bin == (unsigned int) t->nbins)
       return error_HASH_END; /* all bins were empty */
   }
 
   i = 0; /* node counter */
 
-  for (n = h->bins[bin]; n; n = next)
+  for (n = t->bins[bin]; n; n = next)
   {
     next = n->next;
 
@@ -80,8 +80,8 @@ error hash_walk_continuation(hash_t      *h,
 
   /* scan forward to the next occupied bin */
 
-  while (++bin < (unsigned int) h->nbins)
-    if (h->bins[bin])
+  while (++bin < (unsigned int) t->nbins)
+    if (t->bins[bin])
     {
       *nextcontinuation = bin << 16; /* next occupied bin, first node */
       return error_OK;
@@ -91,3 +91,19 @@ error hash_walk_continuation(hash_t      *h,
 
   return error_OK;
 }
+
+error hash_walk_continuation(hash_t      *h,
+                             int          continuation,
+                             int         *nextcontinuation,
+                             const void **key,
+                             const void **value)
+{
+  error err;
+
+  hash__lock_all(h);
+  err = hash__walk_continuation(h->table, continuation, nextcontinuation,
+                                key, value);
+  hash__unlock_all(h);
+
+  return err;
+}
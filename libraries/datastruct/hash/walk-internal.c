@@ -17,30 +17,38 @@ error hash__walk_internal(const hash_t                 *hash,
                           hash__walk_internal_callback *cb,
                           void                         *opaque)
 {
-  error err;
-  int   i;
+  hash__table_t *t;
+  error          err;
+  int            i;
 
   if (hash == NULL)
     return error_OK;
 
-  for (i = 0; i < hash->nbins; i++)
+  hash__lock_all(hash);
+
+  t = hash->table;
+
+  err = error_OK;
+  for (i = 0; i < t->nbins && !err; i++)
   {
     int           j;
     hash__node_t *n;
     hash__node_t *next;
 
     j = 0;
-    for (n = hash->bins[i]; n != NULL; n = next)
+    for (n = t->bins[i]; n != NULL; n = next)
     {
       next = n->next;
 
       err = cb(n, i, j, opaque);
       if (err)
-        return err;
+        break;
 
       j++;
     }
   }
 
-  return error_OK;
+  hash__unlock_all(hash);
+
+  return err;
 }
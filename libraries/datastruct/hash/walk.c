@@ -15,25 +15,50 @@
 
 error hash_walk(const hash_t *h, hash_walk_callback *cb, void *cbarg)
 {
-  int i;
+  hash__table_t *t;
+  error          r;
+  int            i;
 
-  for (i = 0; i < h->nbins; i++)
+  hash__lock_all(h);
+
+  t = h->table;
+
+  r = error_OK;
+
+  if (h->order)
   {
     hash__node_t *n;
     hash__node_t *next;
 
-    for (n = h->bins[i]; n != NULL; n = next)
+    for (n = h->oldest; n != NULL && !r; n = next)
     {
-      error r;
+      next = LINKS(n)->next;
+
+      r = cb(&n->item, cbarg);
+    }
+
+    goto exit;
+  }
 
+  for (i = 0; i < t->nbins && !r; i++)
+  {
+    hash__node_t *n;
+    hash__node_t *next;
+
+    for (n = t->bins[i]; n != NULL; n = next)
+    {
       next = n->next;
 
       r = cb(&n->item, cbarg);
       if (r)
-        return r;
+        break;
     }
   }
 
-  return error_OK;
+exit:
+
+  hash__unlock_all(h);
+
+  return r;
 }
 
@@ -0,0 +1,50 @@
+/* --------------------------------------------------------------------------
+ *    Name: instrument.c
+ * Purpose: Operation counters for data structures
+ * ----------------------------------------------------------------------- */
+
+#include "datastruct/instrument.h"
+
+void datastruct_instrument_add(datastruct_instrument_t       *dst,
+                               const datastruct_instrument_t *src)
+{
+  int op;
+  int i;
+
+  for (op = 0; op < datastruct_OP__LIMIT; op++)
+  {
+    datastruct_op_counts_t       *d = &dst->op[op];
+    const datastruct_op_counts_t *s = &src->op[op];
+
+    d->calls    += s->calls;
+    d->compares += s->compares;
+    d->visits   += s->visits;
+    d->bits     += s->bits;
+
+    for (i = 0; i < datastruct_HISTOGRAM_BUCKETS; i++)
+      d->histogram[i] += s->histogram[i];
+  }
+
+  dst->allocs += src->allocs;
+  dst->frees  += src->frees;
+}
+
+void datastruct_instrument_end(datastruct_instrument_t *i, datastruct_op_t op)
+{
+  datastruct_op_counts_t *c = &i->op[op];
+  unsigned long           bucket;
+
+  bucket = i->visits;
+  if (bucket >= datastruct_HISTOGRAM_BUCKETS)
+    bucket = datastruct_HISTOGRAM_BUCKETS - 1;
+
+  c->calls++;
+  c->compares += i->compares;
+  c->visits   += i->visits;
+  c->bits     += i->bits;
+  c->histogram[bucket]++;
+
+  i->compares = 0;
+  i->visits   = 0;
+  i->bits     = 0;
+}
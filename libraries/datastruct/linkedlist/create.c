@@ -36,6 +36,8 @@ error linkedlist_create(const void                *default_value,
 
   t->count         = 0;
 
+  INSTRUMENT_INIT(t);
+
   *pt = t;
 
   return error_OK;
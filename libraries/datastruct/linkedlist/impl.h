@@ -8,6 +8,7 @@
 
 #include "base/types.h"
 
+#include "datastruct/instrument.h"
 #include "datastruct/item.h"
 
 #include "datastruct/linkedlist.h"
@@ -32,6 +33,10 @@ struct linkedlist
   linkedlist_compare       *compare;
   linkedlist_destroy_key   *destroy_key;
   linkedlist_destroy_value *destroy_value;
+
+#ifdef DATASTRUCT_INSTRUMENT
+  datastruct_instrument_t   instrument;
+#endif
 };
 
 /* ----------------------------------------------------------------------- */
@@ -18,10 +18,19 @@ error linkedlist_insert(linkedlist_t *t,
   linkedlist__node_t  *n;
   int                  c;
 
+  c = 0; /* only examined if the loop below runs */
+
   /* locate an element to go in front */
   for (pn = &t->anchor; *pn; pn = &(*pn)->next)
+  {
+    INSTRUMENT_VISIT(t);
+    INSTRUMENT_COMPARE(t);
+
     if ((c = t->compare(key, (*pn)->item.key)) <= 0)
       break;
+  }
+
+  INSTRUMENT_END(t, INSERT);
 
   if (*pn && c == 0)
     return error_EXISTS;
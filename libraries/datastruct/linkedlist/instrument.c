@@ -0,0 +1,26 @@
+/* --------------------------------------------------------------------------
+ *    Name: instrument.c
+ * Purpose: Associative array implemented as a linked list
+ * ----------------------------------------------------------------------- */
+
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "datastruct/linkedlist.h"
+
+#include "impl.h"
+
+error linkedlist_instrument(const linkedlist_t      *t,
+                            datastruct_instrument_t *counts)
+{
+#ifdef DATASTRUCT_INSTRUMENT
+  *counts = t->instrument;
+
+  return error_OK;
+#else
+  NOT_USED(t);
+  NOT_USED(counts);
+
+  return error_NOT_IMPLEMENTED;
+#endif
+}
@@ -16,8 +16,15 @@ const void *linkedlist_lookup(linkedlist_t *t,
   linkedlist__node_t *n;
 
   for (n = t->anchor; n; n = n->next)
+  {
+    INSTRUMENT_VISIT(t);
+    INSTRUMENT_COMPARE(t);
+
     if (n->item.keylen == keylen && memcmp(n->item.key, key, keylen) == 0)
       break;
+  }
+
+  INSTRUMENT_END(t, LOOKUP);
 
   return n ? n->item.value : t->default_value;
 }
@@ -27,6 +27,8 @@ linkedlist__node_t *linkedlist__node_create(linkedlist_t *t,
   n->item.keylen = keylen;
   n->item.value  = value;
 
+  INSTRUMENT_ALLOC(t);
+
   t->count++;
 
   return n;
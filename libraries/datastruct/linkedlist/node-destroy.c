@@ -21,6 +21,8 @@ void linkedlist__node_destroy(linkedlist_t       *t,
 
   free(n);
 
+  INSTRUMENT_FREE(t);
+
   t->count--;
 }
 
@@ -15,8 +15,15 @@ void linkedlist_remove(linkedlist_t *t, const void *key, size_t keylen)
   linkedlist__node_t  *n;
 
   for (pn = &t->anchor; (n = *pn); pn = &(*pn)->next)
+  {
+    INSTRUMENT_VISIT(t);
+    INSTRUMENT_COMPARE(t);
+
     if (n->item.keylen == keylen && memcmp(n->item.key, key, keylen) == 0)
       break;
+  }
+
+  INSTRUMENT_END(t, REMOVE);
 
   if (n == NULL)
     return; /* not found */
@@ -0,0 +1,21 @@
+/* --------------------------------------------------------------------------
+ *    Name: stats.c
+ * Purpose: Associative array implemented as a linked list
+ * ----------------------------------------------------------------------- */
+
+#include <string.h>
+
+#include "datastruct/linkedlist.h"
+
+#include "impl.h"
+
+void linkedlist_stats(const linkedlist_t *t, datastruct_stats_t *stats)
+{
+  memset(stats, 0, sizeof(*stats));
+
+  stats->elements    = t->count;
+  stats->leaves      = t->count;
+  stats->node_bytes  = t->count * sizeof(linkedlist__node_t);
+  stats->other_bytes = sizeof(*t);
+  stats->total_bytes = stats->node_bytes + stats->other_bytes;
+}
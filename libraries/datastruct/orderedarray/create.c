@@ -36,6 +36,8 @@ error orderedarray_create(const void                  *default_value,
   t->destroy_key   = destroy_key;
   t->destroy_value = destroy_value;
 
+  INSTRUMENT_INIT(t);
+
   *pt = t;
 
   return error_OK;
@@ -8,6 +8,7 @@
 
 #include "base/types.h"
 
+#include "datastruct/instrument.h"
 #include "datastruct/item.h"
 
 #include "datastruct/orderedarray.h"
@@ -31,6 +32,10 @@ struct orderedarray
   orderedarray_compare       *compare;
   orderedarray_destroy_key   *destroy_key;
   orderedarray_destroy_value *destroy_value;
+
+#ifdef DATASTRUCT_INSTRUMENT
+  datastruct_instrument_t     instrument;
+#endif
 };
 
 /* ----------------------------------------------------------------------- */
@@ -62,6 +62,9 @@ error orderedarray_insert(orderedarray_t *t,
     return err;
 
   found = orderedarray__lookup_internal(t, key, &n);
+
+  INSTRUMENT_END(t, INSERT);
+
   if (found)
     return error_EXISTS;
 
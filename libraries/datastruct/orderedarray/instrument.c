@@ -0,0 +1,26 @@
+/* --------------------------------------------------------------------------
+ *    Name: instrument.c
+ * Purpose: Associative array implemented as an ordered array
+ * ----------------------------------------------------------------------- */
+
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "datastruct/orderedarray.h"
+
+#include "impl.h"
+
+error orderedarray_instrument(const orderedarray_t    *t,
+                              datastruct_instrument_t *counts)
+{
+#ifdef DATASTRUCT_INSTRUMENT
+  *counts = t->instrument;
+
+  return error_OK;
+#else
+  NOT_USED(t);
+  NOT_USED(counts);
+
+  return error_NOT_IMPLEMENTED;
+#endif
+}
@@ -29,6 +29,9 @@ int orderedarray__lookup_internal(orderedarray_t        *t,
       orderedarray__node_t *m;
       int                   r;
 
+      INSTRUMENT_VISIT(t);
+      INSTRUMENT_COMPARE(t);
+
       m = s + (e - s) / 2;
       r = t->compare(key, m->item.key);
       if (r == 0)
@@ -59,8 +62,12 @@ int orderedarray__lookup_internal(orderedarray_t        *t,
 const void *orderedarray_lookup(orderedarray_t *t, const void *key)
 {
   orderedarray__node_t *n;
+  int                   found;
+
+  found = orderedarray__lookup_internal(t, key, &n);
+
+  INSTRUMENT_END(t, LOOKUP);
 
-  return orderedarray__lookup_internal(t, key, &n) ? n->item.value :
-                                                     t->default_value;
+  return found ? n->item.value : t->default_value;
 }
 
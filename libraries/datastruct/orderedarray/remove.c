@@ -10,8 +10,13 @@
 void orderedarray_remove(orderedarray_t *t, const void *key)
 {
   orderedarray__node_t *n;
+  int                   found;
 
-  if (!orderedarray__lookup_internal(t, key, &n))
+  found = orderedarray__lookup_internal(t, key, &n);
+
+  INSTRUMENT_END(t, REMOVE);
+
+  if (!found)
     return; /* not found */
 
   orderedarray__node_destroy(t, n);
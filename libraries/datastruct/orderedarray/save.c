@@ -0,0 +1,39 @@
+/* --------------------------------------------------------------------------
+ *    Name: save.c
+ * Purpose: Associative array implemented as an ordered array
+ * ----------------------------------------------------------------------- */
+
+#include <stdlib.h>
+
+#include "base/errors.h"
+
+#include "datastruct/flat.h"
+
+#include "datastruct/orderedarray.h"
+
+#include "impl.h"
+
+static error orderedarray__save_item(const item_t *item, void *opaque)
+{
+  return flat_writer_add(opaque, item->key, item->keylen, item->value);
+}
+
+error orderedarray_save(const orderedarray_t *t,
+                        flat_value_len       *value_len,
+                        const char           *filename)
+{
+  error          err;
+  flat_writer_t *w;
+
+  err = flat_writer_create(flat_KIND_SORTED, value_len, &w);
+  if (err)
+    return err;
+
+  err = orderedarray_walk(t, orderedarray__save_item, w);
+  if (!err)
+    err = flat_writer_save(w, filename);
+
+  flat_writer_destroy(w);
+
+  return err;
+}
@@ -0,0 +1,21 @@
+/* --------------------------------------------------------------------------
+ *    Name: stats.c
+ * Purpose: Associative array implemented as an ordered array
+ * ----------------------------------------------------------------------- */
+
+#include <string.h>
+
+#include "datastruct/orderedarray.h"
+
+#include "impl.h"
+
+void orderedarray_stats(const orderedarray_t *t, datastruct_stats_t *stats)
+{
+  memset(stats, 0, sizeof(*stats));
+
+  stats->elements    = t->nelems;
+  stats->table_bytes = t->maxelems * sizeof(orderedarray__node_t);
+  stats->slack_bytes = (t->maxelems - t->nelems) * sizeof(orderedarray__node_t);
+  stats->other_bytes = sizeof(*t);
+  stats->total_bytes = stats->table_bytes + stats->other_bytes;
+}
@@ -3,6 +3,7 @@
  * Purpose: Associative array implemented as a PATRICIA tree
  * ----------------------------------------------------------------------- */
 
+#include <assert.h>
 #include <stddef.h>
 #include <stdlib.h>
 
@@ -25,6 +26,14 @@ error patricia_create(const void              *default_value,
   if (t == NULL)
     return error_OOM;
 
+  INSTRUMENT_INIT(t);
+
+  /* read by patricia__node_create */
+  t->inline_keys  = 0;
+  t->inline_bytes = 0;
+  t->spare        = NULL;
+  t->nspare       = 0;
+
   /* the root node is only used for an all-zero-bits key */
   t->root = patricia__node_create(t, NULL, 0, NULL);
   if (t->root == NULL)
@@ -44,3 +53,10 @@ error patricia_create(const void              *default_value,
   return error_OK;
 }
 
+
+void patricia_set_inline_keys(patricia_t *t)
+{
+  assert(t->count == 0);
+
+  t->inline_keys = 1;
+}
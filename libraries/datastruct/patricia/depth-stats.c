@@ -0,0 +1,67 @@
+/* --------------------------------------------------------------------------
+ *    Name: depth-stats.c
+ * Purpose: Associative array implemented as a PATRICIA tree
+ * ----------------------------------------------------------------------- */
+
+#include <stddef.h>
+
+#include "base/errors.h"
+
+#include "datastruct/patricia.h"
+
+#include "impl.h"
+
+error patricia_depth_stats(const patricia_t         *t,
+                           datastruct_depth_stats_t *stats)
+{
+  error                    err;
+  datastruct_depth_stack_t stack;
+  datastruct_depth_entry_t e;
+
+  datastruct_depth_init(stats);
+  datastruct_depth_stack_init(&stack);
+
+  err = error_OK;
+  if (t->root)
+    err = datastruct_depth_stack_push(&stack, t->root, 0, 0);
+
+  while (!err && datastruct_depth_stack_pop(&stack, &e))
+  {
+    const patricia__node_t *n = e.node;
+    int                     children;
+    int                     chained;
+    int                     i;
+
+    /* an upward link (to a node with an equal or lower critical bit)
+     * reaches an element. the root holds no element unless the
+     * all-zero-bits key was inserted. */
+    children = 0;
+    for (i = 0; i < 2; i++)
+    {
+      const patricia__node_t *c = n->child[i];
+
+      if (c == NULL || (c->bit <= n->bit && c->item.key == NULL))
+        continue;
+
+      children++;
+      if (c->bit <= n->bit)
+        datastruct_depth_add(stats, e.depth + 1);
+    }
+
+    chained = datastruct_depth_branch(stats, children, e.chained);
+
+    for (i = 0; i < 2 && !err; i++)
+    {
+      const patricia__node_t *c = n->child[i];
+
+      if (c != NULL && c->bit > n->bit)
+        err = datastruct_depth_stack_push(&stack, c, e.depth + 1, chained);
+    }
+  }
+
+  datastruct_depth_stack_fini(&stack);
+
+  datastruct_depth_finish(stats);
+
+  return err;
+}
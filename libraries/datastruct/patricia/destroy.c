@@ -19,7 +19,9 @@ static error patricia__destroy_node(patricia__node_t *n,
 {
   NOT_USED(level);
 
-  patricia__node_destroy(opaque, n);
+  /* free rather than destroy since the walk has yet to leave the node */
+  patricia__node_clear(opaque, n);
+  free(n);
 
   return error_OK;
 }
@@ -32,6 +34,15 @@ void patricia_destroy(patricia_t *t)
                                  patricia__destroy_node,
                                  t);
 
+  while (t->spare)
+  {
+    patricia__node_t *next;
+
+    next = t->spare->child[0];
+    free(t->spare);
+    t->spare = next;
+  }
+
   free(t);
 }
 
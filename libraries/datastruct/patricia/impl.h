@@ -10,6 +10,7 @@
 
 #include "base/types.h"
 
+#include "datastruct/instrument.h"
 #include "datastruct/item.h"
 
 #include "datastruct/patricia.h"
@@ -23,6 +24,7 @@ typedef struct patricia__node
   struct patricia__node    *child[2];  /* left, right children */
   int                       bit;       /* critical bit */
   item_t                    item;
+  unsigned char             key[];     /* the key, if inline_keys */
 }
 patricia__node_t;
 
@@ -34,8 +36,20 @@ struct patricia
 
   const void               *default_value;
 
+  int                       inline_keys; /* keys are copied into nodes */
+  size_t                    inline_bytes; /* bytes they occupy, with terminators */
+
+  /* removed nodes kept for reuse, linked through child[0]. nodes with
+   * inline keys vary in size so are freed instead. */
+  patricia__node_t         *spare;
+  int                       nspare;
+
   patricia_destroy_key     *destroy_key;
   patricia_destroy_value   *destroy_value;
+
+#ifdef DATASTRUCT_INSTRUMENT
+  datastruct_instrument_t   instrument;
+#endif
 };
 
 /* ----------------------------------------------------------------------- */
@@ -47,9 +61,15 @@ patricia__node_t *patricia__node_create(patricia_t *t,
 
 void patricia__node_clear(patricia_t *t, patricia__node_t *n);
 
+/* Bytes of inline key held by node 'n' (or by the root's copy), or zero. */
+#define patricia__inline_bytes(t, n) \
+  ((t)->inline_keys && (n)->item.key ? (n)->item.keylen + 1 : 0)
+
+/* Clear the node then keep it for reuse, or free it. */
 void patricia__node_destroy(patricia_t *t, patricia__node_t *n);
 
-const patricia__node_t *patricia__lookup(const patricia__node_t *n,
+const patricia__node_t *patricia__lookup(const patricia_t       *t,
+                                         const patricia__node_t *n,
                                          const void             *key,
                                          size_t                  keylen);
 
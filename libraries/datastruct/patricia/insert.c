@@ -5,8 +5,10 @@
 
 #include <assert.h>
 #include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include "base/memento/memento.h"
 #include "base/errors.h"
 #include "base/types.h"
 
@@ -38,9 +40,11 @@ error patricia_insert(patricia_t *t,
       goto update;
 
     /* find closest node */
-    q = (patricia__node_t *) patricia__lookup(q, key, keylen); /* we cast away const */
+    q = (patricia__node_t *) patricia__lookup(t, q, key, keylen); /* we cast away const */
     assert(q != NULL);
 
+    INSTRUMENT_COMPARE(t);
+
     if (q->item.keylen == keylen && memcmp(q->item.key, key, keylen) == 0)
     {
 update:
@@ -53,11 +57,34 @@ update:
       {
         patricia__node_clear(t, q);
 
+        if (t->inline_keys)
+        {
+          /* an inline key stays put: it's the same bytes. the root node
+           * has no room for one so holds a copy (of all zero bits). */
+          if (q == t->root)
+          {
+            key = calloc(1, keylen + 1);
+            if (key == NULL)
+            {
+              q->item.key   = NULL;
+              q->item.value = NULL;
+              return error_OOM;
+            }
+            t->inline_bytes += keylen + 1;
+          }
+          else
+          {
+            key = q->item.key;
+          }
+        }
+
         q->item.key    = key;
         q->item.keylen = keylen;
         q->item.value  = value;
       }
 
+      INSTRUMENT_END(t, INSERT);
+
       return error_OK;
     }
 
@@ -95,6 +122,9 @@ update:
     nbit = n->bit;
     do
     {
+      INSTRUMENT_VISIT(t);
+      INSTRUMENT_BITS(t, 1);
+
       parbit = nbit;
       pn     = &n->child[GET_DIR(ukey, ukeyend, nbit)];
       n      = *pn;
@@ -118,6 +148,8 @@ update:
     *pn = newnode;
   }
 
+  INSTRUMENT_END(t, INSERT);
+
   return error_OK;
 }
 
@@ -15,7 +15,8 @@
 
 #include "impl.h"
 
-const patricia__node_t *patricia__lookup(const patricia__node_t *n,
+const patricia__node_t *patricia__lookup(const patricia_t       *t,
+                                         const patricia__node_t *n,
                                          const void             *key,
                                          size_t                  keylen)
 {
@@ -30,6 +31,9 @@ const patricia__node_t *patricia__lookup(const patricia__node_t *n,
 
   do
   {
+    INSTRUMENT_VISIT(t);
+    INSTRUMENT_BITS(t, 1);
+
     i = n->bit;
     n = n->child[GET_DIR(ukey, ukeyend, i)];
     assert(n != NULL);
@@ -57,7 +61,10 @@ const void *patricia_lookup(const patricia_t *t,
   if (unlikely(iszero(key, keylen)))
     return n->item.value; /* found */
 
-  n = patricia__lookup(n, key, keylen);
+  n = patricia__lookup(t, n, key, keylen);
+
+  INSTRUMENT_COMPARE(t);
+  INSTRUMENT_END(t, LOOKUP);
 
   assert(n != NULL);
   if (n->item.keylen == keylen && memcmp(n->item.key, key, keylen) == 0)
@@ -3,14 +3,29 @@
  * Purpose: Associative array implemented as a PATRICIA tree
  * ----------------------------------------------------------------------- */
 
-#include "datastruct/critbit.h"
+#include <stdlib.h>
+
+#include "base/memento/memento.h"
+
+#include "datastruct/patricia.h"
 
 #include "impl.h"
 
 void patricia__node_clear(patricia_t *t, patricia__node_t *n)
 {
-  if (t->destroy_key && n->item.key)
+  if (t->inline_keys)
+  {
+    /* the root node has no room for a key so holds a separate copy */
+    if (n == t->root)
+    {
+      t->inline_bytes -= patricia__inline_bytes(t, n);
+      free((void *) n->item.key); /* must cast away const */
+    }
+  }
+  else if (t->destroy_key && n->item.key)
+  {
     t->destroy_key((void *) n->item.key); /* must cast away const */
+  }
   if (t->destroy_value && n->item.value)
     t->destroy_value((void *) n->item.value);
 }
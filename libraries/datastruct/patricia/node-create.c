@@ -5,6 +5,7 @@
 
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "base/memento/memento.h"
 
@@ -19,9 +20,30 @@ patricia__node_t *patricia__node_create(patricia_t *t,
 {
   patricia__node_t *n;
 
-  n = malloc(sizeof(*n));
-  if (n == NULL)
-    return NULL;
+  if (t->inline_keys && key)
+  {
+    /* the key's bytes follow the node so short keys share its cache line.
+     * a terminator is added so that string keys remain strings. */
+    n = malloc(offsetof(patricia__node_t, key) + keylen + 1);
+    if (n == NULL)
+      return NULL;
+
+    memcpy(n->key, key, keylen);
+    n->key[keylen] = '\0';
+    key = n->key;
+  }
+  else if (t->spare)
+  {
+    n = t->spare;
+    t->spare = n->child[0];
+    t->nspare--;
+  }
+  else
+  {
+    n = malloc(sizeof(*n));
+    if (n == NULL)
+      return NULL;
+  }
 
   n->child[0]    = NULL;
   n->child[1]    = NULL;
@@ -30,7 +52,10 @@ patricia__node_t *patricia__node_create(patricia_t *t,
   n->item.value  = value;
   n->bit         = 0xdeadbeef; /* expected to be overwritten subsequently */
 
+  INSTRUMENT_ALLOC(t);
+
   t->count++;
+  t->inline_bytes += patricia__inline_bytes(t, n);
 
   return n;
 }
@@ -15,7 +15,19 @@ void patricia__node_destroy(patricia_t *t, patricia__node_t *n)
 {
   patricia__node_clear(t, n);
 
-  free(n);
+  if (t->inline_keys)
+  {
+    t->inline_bytes -= patricia__inline_bytes(t, n);
+    free(n);
+  }
+  else
+  {
+    n->child[0] = t->spare;
+    t->spare = n;
+    t->nspare++;
+  }
+
+  INSTRUMENT_FREE(t);
 
   t->count--;
 }
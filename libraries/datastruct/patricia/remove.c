@@ -3,15 +3,105 @@
  * Purpose: Associative array implemented as a PATRICIA tree
  * ----------------------------------------------------------------------- */
 
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
 #include "base/types.h"
 
+#include "utils/utils.h"
+
 #include "datastruct/patricia.h"
 
-/* NYI */
+#include "impl.h"
+
+/* Every node both tests a bit and holds an element, which is reached by the
+ * single upward link pointing at the node. Removing element 'x' therefore
+ * means removing a bit test too: the one in 'p', the node whose upward link
+ * led us to 'x'. 'p' is spliced out of the tree and, unless it's 'x'
+ * itself, then takes over x's place, bit and children so that its element
+ * remains reachable. Nodes move rather than elements since inline keys live
+ * within their node. */
 void patricia_remove(patricia_t *t, const void *key, size_t keylen)
 {
-  NOT_USED(t);
-  NOT_USED(key);
-  NOT_USED(keylen);
-}
+  const unsigned char *ukey    = key;
+  const unsigned char *ukeyend = ukey + keylen;
+  patricia__node_t    *gp;
+  int                  gpdir;
+  patricia__node_t    *p;
+  int                  pdir;
+  patricia__node_t    *x;
+
+  assert(key != NULL);
+  assert(keylen > 0);
+
+  /* keys consisting of all zero bits always live in the root node */
+  if (unlikely(iszero(key, keylen)))
+  {
+    x = t->root;
+    if (x->item.key)
+    {
+      patricia__node_clear(t, x);
+      x->item.key    = NULL;
+      x->item.keylen = 0;
+      x->item.value  = NULL;
+    }
+    return;
+  }
+
+  /* descend as for lookup, remembering the last two nodes */
+
+  gp    = NULL;
+  gpdir = 0;
+  p     = t->root;
+  pdir  = GET_DIR(ukey, ukeyend, p->bit);
+  x     = p->child[pdir];
+  while (x->bit > p->bit)
+  {
+    INSTRUMENT_VISIT(t);
+    INSTRUMENT_BITS(t, 1);
+
+    gp    = p;
+    gpdir = pdir;
+    p     = x;
+    pdir  = GET_DIR(ukey, ukeyend, p->bit);
+    x     = p->child[pdir];
+  }
 
+  INSTRUMENT_COMPARE(t);
+  INSTRUMENT_END(t, REMOVE);
+
+  if (x == t->root ||
+      x->item.keylen != keylen || memcmp(x->item.key, key, keylen) != 0)
+    return; /* not found */
+
+  assert(gp != NULL);
+
+  /* splice out p's bit test, keeping its other side */
+  gp->child[gpdir] = p->child[!pdir];
+
+  if (p != x)
+  {
+    patricia__node_t *xp;
+    int               xdir;
+
+    /* find x's parent. x lies on the path we took. */
+    xp   = t->root;
+    xdir = GET_DIR(ukey, ukeyend, xp->bit);
+    while (xp->child[xdir] != x)
+    {
+      xp   = xp->child[xdir];
+      xdir = GET_DIR(ukey, ukeyend, xp->bit);
+    }
+
+    /* p replaces x. if p's other side linked back up to p itself that link
+     * now lies below p's new position, so remains valid. */
+    p->bit      = x->bit;
+    p->child[0] = x->child[0];
+    p->child[1] = x->child[1];
+
+    xp->child[xdir] = p;
+  }
+
+  patricia__node_destroy(t, x);
+}
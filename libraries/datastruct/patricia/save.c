@@ -0,0 +1,51 @@
+/* --------------------------------------------------------------------------
+ *    Name: save.c
+ * Purpose: Associative array implemented as a PATRICIA tree
+ * ----------------------------------------------------------------------- */
+
+#include <stdlib.h>
+
+#include "base/errors.h"
+
+#include "datastruct/flat.h"
+
+#include "datastruct/patricia.h"
+
+#include "impl.h"
+
+static error patricia__save_node(patricia__node_t *n, int level, void *opaque)
+{
+  flat_writer_t *w = opaque;
+
+  NOT_USED(level);
+
+  /* the root node holds no element unless the all-zero-bits key was
+   * inserted */
+  if (n->item.key == NULL)
+    return error_OK;
+
+  return flat_writer_add(w, n->item.key, n->item.keylen, n->item.value);
+}
+
+error patricia_save(const patricia_t *t,
+                    flat_value_len   *value_len,
+                    const char       *filename)
+{
+  error          err;
+  flat_writer_t *w;
+
+  err = flat_writer_create(flat_KIND_SORTED, value_len, &w);
+  if (err)
+    return err;
+
+  err = patricia__walk_internal((patricia_t *) t, /* cast away const */
+                                patricia_WALK_LEAVES,
+                                patricia__save_node,
+                                w);
+  if (!err)
+    err = flat_writer_save(w, filename);
+
+  flat_writer_destroy(w);
+
+  return err;
+}
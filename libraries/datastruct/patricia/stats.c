@@ -0,0 +1,34 @@
+/* --------------------------------------------------------------------------
+ *    Name: stats.c
+ * Purpose: Associative array implemented as a PATRICIA tree
+ * ----------------------------------------------------------------------- */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "datastruct/patricia.h"
+
+#include "impl.h"
+
+void patricia_stats(const patricia_t *t, datastruct_stats_t *stats)
+{
+  memset(stats, 0, sizeof(*stats));
+
+  /* the root node is always present but holds no element */
+  stats->elements    = t->count;
+  stats->branches    = 1;
+  stats->leaves      = t->count;
+  if (t->inline_keys)
+    /* inline keys extend the node past its key member. the root's is a
+     * separate copy. */
+    stats->node_bytes = sizeof(patricia__node_t) +
+                        t->count * offsetof(patricia__node_t, key) +
+                        t->inline_bytes;
+  else
+    stats->node_bytes = (t->count + 1) * sizeof(patricia__node_t);
+  stats->table_bytes = t->nspare * sizeof(patricia__node_t);
+  stats->slack_bytes = stats->table_bytes; /* spare nodes */
+  stats->other_bytes = sizeof(*t);
+  stats->total_bytes = stats->node_bytes + stats->table_bytes +
+                       stats->other_bytes;
+}
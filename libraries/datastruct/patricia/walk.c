@@ -30,6 +30,11 @@ static error patricia__walk_in_order(patricia__node_t       *n,
 
     if (n->child[i]->bit <= n->bit)
     {
+      /* the root node holds no element unless the all-zero-bits key was
+       * inserted */
+      if (n->child[i]->item.key == NULL)
+        continue;
+
       err = cb(n->child[i]->item.key, n->child[i]->item.value, level, opaque);
       if (err)
         return err;
@@ -0,0 +1,332 @@
+/* --------------------------------------------------------------------------
+ *    Name: build.c
+ * Purpose: Read-only associative array indexed by a minimal perfect hash
+ * ----------------------------------------------------------------------- */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/memento/memento.h"
+
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "datastruct/perfecthash.h"
+
+#include "impl.h"
+
+/* ----------------------------------------------------------------------- */
+
+/* Seeds to try in turn. Each failure is improbable, so few are needed. */
+#define MAXSEEDS 8
+#define SEED(i)  (0x5851f42d4c957f2dull * ((uint64_t) (i) + 1))
+
+/* Give up on a seed if a bucket has tried this many pilots. A bucket of
+ * one key looking for the last free slot needs 'n' tries on average. */
+#define MAXPILOT(n) ((uint32_t) MIN((uint64_t) (n) * 64 + 1024, 0xffffffffu))
+
+typedef struct perfecthash__work
+{
+  uint32_t *start;    /* bucket b's keys are order[start[b]..start[b+1]) */
+  uint32_t *order;    /* pending indices grouped by bucket */
+  uint32_t *sorted;   /* buckets, largest first */
+  uint32_t *slotof;   /* the slot of each pending key */
+  uint8_t  *taken;    /* whether each slot is taken */
+  uint32_t  maxsize;  /* keys in the largest bucket */
+}
+perfecthash__work_t;
+
+/* ----------------------------------------------------------------------- */
+
+/* Hash every key under 'seed' and group the keys by bucket, then list the
+ * buckets largest first. */
+static error perfecthash__group(perfecthash_t       *ph,
+                                perfecthash__work_t *w,
+                                uint64_t             seed)
+{
+  uint32_t *count;
+  uint32_t  nb = ph->nbuckets;
+  uint32_t  b;
+  uint32_t  s;
+  int       i;
+
+  memset(w->start, 0, (nb + 1) * sizeof(*w->start));
+
+  for (i = 0; i < ph->npending; i++)
+  {
+    perfecthash__pending_t *p = &ph->pending[i];
+
+    p->hash = perfecthash__hash(p->key, p->keylen, seed);
+    w->start[BUCKET(ph, p->hash) + 1]++;
+  }
+
+  w->maxsize = 0;
+  for (b = 0; b < nb; b++)
+  {
+    w->maxsize = MAX(w->maxsize, w->start[b + 1]);
+    w->start[b + 1] += w->start[b];
+  }
+
+  /* distribute, using 'slotof' as a cursor per bucket for now */
+  memcpy(w->slotof, w->start, nb * sizeof(*w->start));
+  for (i = 0; i < ph->npending; i++)
+    w->order[w->slotof[BUCKET(ph, ph->pending[i].hash)]++] = i;
+
+  /* counting sort of the buckets by descending size */
+  count = calloc(w->maxsize + 2, sizeof(*count));
+  if (count == NULL)
+    return error_OOM;
+
+  for (b = 0; b < nb; b++)
+    count[w->maxsize - (w->start[b + 1] - w->start[b]) + 1]++;
+  for (s = 0; s <= w->maxsize; s++)
+    count[s + 1] += count[s];
+  for (b = 0; b < nb; b++)
+    w->sorted[count[w->maxsize - (w->start[b + 1] - w->start[b])]++] = b;
+
+  free(count);
+
+  return error_OK;
+}
+
+/* Find a pilot for bucket 'b' which sends all of its keys to distinct free
+ * slots, then take them. */
+static error perfecthash__place(perfecthash_t       *ph,
+                                perfecthash__work_t *w,
+                                uint32_t             b,
+                                uint32_t            *slots)
+{
+  const uint32_t *keys = &w->order[w->start[b]];
+  uint32_t        size = w->start[b + 1] - w->start[b];
+  uint32_t        limit = MAXPILOT(ph->npending);
+  uint32_t        pilot;
+  uint32_t        i, j;
+
+  /* keys which share a hash share every slot: no pilot can part them */
+  for (i = 0; i < size; i++)
+    for (j = i + 1; j < size; j++)
+    {
+      const perfecthash__pending_t *p = &ph->pending[keys[i]];
+      const perfecthash__pending_t *q = &ph->pending[keys[j]];
+
+      if (p->hash != q->hash)
+        continue;
+
+      if (p->keylen == q->keylen && memcmp(p->key, q->key, p->keylen) == 0)
+        return error_EXISTS;
+
+      return error_PERFECTHASH_FAILED; /* try another seed */
+    }
+
+  for (pilot = 0; pilot < limit; pilot++)
+  {
+    for (i = 0; i < size; i++)
+    {
+      slots[i] = perfecthash__slot(ph->pending[keys[i]].hash, pilot,
+                                   ph->npending);
+      if (w->taken[slots[i]])
+        break;
+
+      for (j = 0; j < i; j++)
+        if (slots[j] == slots[i])
+          break;
+      if (j < i)
+        break;
+    }
+
+    if (i == size)
+      break;
+  }
+
+  if (pilot == limit)
+    return error_PERFECTHASH_FAILED;
+
+  for (i = 0; i < size; i++)
+  {
+    w->taken[slots[i]] = 1;
+    w->slotof[keys[i]] = slots[i];
+  }
+
+  ph->pilots[b] = pilot;
+
+  return error_OK;
+}
+
+/* Try to find pilots for every bucket under 'seed'. */
+static error perfecthash__search(perfecthash_t       *ph,
+                                 perfecthash__work_t *w,
+                                 uint64_t             seed)
+{
+  error     err;
+  uint32_t *slots;
+  uint32_t  i;
+
+  err = perfecthash__group(ph, w, seed);
+  if (err)
+    return err;
+
+  slots = malloc(w->maxsize * sizeof(*slots));
+  if (slots == NULL)
+    return error_OOM;
+
+  memset(w->taken, 0, ph->npending * sizeof(*w->taken));
+  memset(ph->pilots, 0, ph->nbuckets * sizeof(*ph->pilots));
+
+  for (i = 0; i < ph->nbuckets; i++)
+  {
+    uint32_t b = w->sorted[i];
+
+    if (w->start[b + 1] == w->start[b])
+      break; /* the rest are empty */
+
+    err = perfecthash__place(ph, w, b, slots);
+    if (err)
+      break;
+  }
+
+  free(slots);
+
+  return err;
+}
+
+/* Copy the keys and values into their slots, key bytes in slot order. */
+static error perfecthash__lay_out(perfecthash_t             *ph,
+                                  const perfecthash__work_t *w)
+{
+  uint32_t      *keyat;
+  size_t         keybytes;
+  size_t         offset;
+  int            i;
+
+  keyat = malloc(ph->npending * sizeof(*keyat));
+  if (keyat == NULL)
+    return error_OOM;
+
+  keybytes = 0;
+  for (i = 0; i < ph->npending; i++)
+  {
+    keyat[w->slotof[i]] = i;
+    keybytes += ph->pending[i].keylen;
+  }
+
+  /* slots hold 32-bit offsets */
+  if (keybytes > 0xffffffffu)
+  {
+    free(keyat);
+    return error_OOM;
+  }
+
+  ph->slots = malloc(ph->npending * sizeof(*ph->slots));
+  ph->keys  = malloc(keybytes ? keybytes : 1);
+  if (ph->slots == NULL || ph->keys == NULL)
+  {
+    free(keyat);
+    return error_OOM;
+  }
+
+  offset = 0;
+  for (i = 0; i < ph->npending; i++)
+  {
+    const perfecthash__pending_t *p = &ph->pending[keyat[i]];
+    perfecthash__slot_t          *s = &ph->slots[i];
+
+    memcpy(ph->keys + offset, p->key, p->keylen);
+
+    s->value  = p->value;
+    s->key    = (uint32_t) offset;
+    s->keylen = (uint32_t) p->keylen;
+
+    offset += p->keylen;
+  }
+
+  ph->keybytes = keybytes;
+
+  free(keyat);
+
+  return error_OK;
+}
+
+/* ----------------------------------------------------------------------- */
+
+error perfecthash_build(perfecthash_t *ph)
+{
+  error               err;
+  perfecthash__work_t w;
+  uint32_t            n;
+  int                 i;
+
+  if (ph->built)
+    return error_READ_ONLY;
+
+  n = ph->npending;
+  if (n == 0)
+    goto built;
+
+  ph->nbuckets = n / LAMBDA + 1;
+  ph->pilots   = malloc(ph->nbuckets * sizeof(*ph->pilots));
+
+  w.start  = malloc((ph->nbuckets + 1) * sizeof(*w.start));
+  w.order  = malloc(n * sizeof(*w.order));
+  w.sorted = malloc(ph->nbuckets * sizeof(*w.sorted));
+  w.slotof = malloc(MAX(n, ph->nbuckets) * sizeof(*w.slotof));
+  w.taken  = malloc(n * sizeof(*w.taken));
+  if (ph->pilots == NULL || w.start == NULL || w.order == NULL ||
+      w.sorted == NULL || w.slotof == NULL || w.taken == NULL)
+  {
+    err = error_OOM;
+    goto failure;
+  }
+
+  err = error_PERFECTHASH_FAILED;
+  for (i = 0; i < MAXSEEDS && err == error_PERFECTHASH_FAILED; i++)
+  {
+    ph->seed = SEED(i);
+    err = perfecthash__search(ph, &w, ph->seed);
+  }
+  if (err)
+    goto failure;
+
+  err = perfecthash__lay_out(ph, &w);
+  if (err)
+    goto failure;
+
+  free(w.start);
+  free(w.order);
+  free(w.sorted);
+  free(w.slotof);
+  free(w.taken);
+
+  ph->n = n;
+
+built:
+
+  free(ph->pending);
+  ph->pending    = NULL;
+  ph->npending   = 0;
+  ph->maxpending = 0;
+
+  ph->built = 1;
+
+  return error_OK;
+
+
+failure:
+
+  free(w.start);
+  free(w.order);
+  free(w.sorted);
+  free(w.slotof);
+  free(w.taken);
+
+  /* leave it unbuilt, holding its pending keys */
+  free(ph->pilots);
+  free(ph->slots);
+  free(ph->keys);
+  ph->pilots   = NULL;
+  ph->slots    = NULL;
+  ph->keys     = NULL;
+  ph->nbuckets = 0;
+
+  return err;
+}
@@ -0,0 +1,13 @@
+/* --------------------------------------------------------------------------
+ *    Name: count.c
+ * Purpose: Read-only associative array indexed by a minimal perfect hash
+ * ----------------------------------------------------------------------- */
+
+#include "datastruct/perfecthash.h"
+
+#include "impl.h"
+
+int perfecthash_count(const perfecthash_t *ph)
+{
+  return ph->built ? ph->n : ph->npending;
+}
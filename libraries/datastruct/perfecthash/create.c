@@ -0,0 +1,80 @@
+/* --------------------------------------------------------------------------
+ *    Name: create.c
+ * Purpose: Read-only associative array indexed by a minimal perfect hash
+ * ----------------------------------------------------------------------- */
+
+#include <stdlib.h>
+
+#include "base/memento/memento.h"
+
+#include "base/errors.h"
+
+#include "datastruct/perfecthash.h"
+
+#include "impl.h"
+
+error perfecthash_create(const void *default_value, perfecthash_t **pph)
+{
+  perfecthash_t *ph;
+
+  ph = calloc(1, sizeof(*ph));
+  if (ph == NULL)
+    return error_OOM;
+
+  ph->default_value = default_value;
+
+  *pph = ph;
+
+  return error_OK;
+}
+
+void perfecthash_destroy(perfecthash_t *doomed)
+{
+  if (doomed == NULL)
+    return;
+
+  free(doomed->pending);
+  free(doomed->pilots);
+  free(doomed->slots);
+  free(doomed->keys);
+  free(doomed);
+}
+
+error perfecthash_add(perfecthash_t *ph,
+                      const void    *key,
+                      size_t         keylen,
+                      const void    *value)
+{
+  perfecthash__pending_t *p;
+
+  if (ph->built)
+    return error_READ_ONLY;
+
+  if (ph->npending == ph->maxpending)
+  {
+    int                     maxpending;
+    perfecthash__pending_t *pending;
+
+    maxpending = ph->maxpending ? ph->maxpending * 2 : 16;
+    pending = realloc(ph->pending, maxpending * sizeof(*pending));
+    if (pending == NULL)
+      return error_OOM;
+
+    ph->pending    = pending;
+    ph->maxpending = maxpending;
+  }
+
+  p = &ph->pending[ph->npending++];
+
+  p->key    = key;
+  p->keylen = keylen;
+  p->value  = value;
+  p->hash   = 0;
+
+  return error_OK;
+}
+
+error perfecthash_add_item(const item_t *item, void *opaque)
+{
+  return perfecthash_add(opaque, item->key, item->keylen, item->value);
+}
@@ -0,0 +1,73 @@
+/* --------------------------------------------------------------------------
+ *    Name: impl.h
+ * Purpose: Read-only associative array indexed by a minimal perfect hash
+ * ----------------------------------------------------------------------- */
+
+#ifndef PERFECTHASH_IMPL_H
+#define PERFECTHASH_IMPL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "datastruct/perfecthash.h"
+
+/* ----------------------------------------------------------------------- */
+
+/* Average keys per bucket. Larger buckets need fewer pilots but take
+ * longer to place once the slots are mostly full. */
+#define LAMBDA 3
+
+typedef struct perfecthash__pending
+{
+  const void     *key;
+  size_t          keylen;
+  const void     *value;
+  uint64_t        hash;
+}
+perfecthash__pending_t;
+
+/* Sixteen bytes. Keys are limited to a total of 4GiB. */
+typedef struct perfecthash__slot
+{
+  const void             *value;
+  uint32_t                key;      /* offset into 'keys' */
+  uint32_t                keylen;
+}
+perfecthash__slot_t;
+
+struct perfecthash
+{
+  const void             *default_value;
+  int                     built;
+
+  /* gathered ahead of the build, then freed */
+  perfecthash__pending_t *pending;
+  int                     npending;
+  int                     maxpending;
+
+  /* the built perfect hash */
+  int                     n;        /* number of keys and of slots */
+  uint32_t                nbuckets;
+  uint64_t                seed;
+  uint32_t               *pilots;   /* one per bucket */
+  perfecthash__slot_t    *slots;
+  unsigned char          *keys;     /* key bytes in slot order */
+  size_t                  keybytes;
+};
+
+/* ----------------------------------------------------------------------- */
+
+/* A key's hash picks its bucket by its low half and, mixed with the
+ * bucket's pilot, its slot. */
+#define BUCKET(ph, h) ((uint32_t) (((h) & 0xffffffffu) * (ph)->nbuckets >> 32))
+
+/* Hash 'keylen' bytes of 'key' to 64 bits under 'seed'. */
+uint64_t perfecthash__hash(const void *key, size_t keylen, uint64_t seed);
+
+/* Return the slot, of 'n', for a key with hash 'h' in a bucket with pilot
+ * 'pilot'. */
+uint32_t perfecthash__slot(uint64_t h, uint32_t pilot, uint32_t n);
+
+/* ----------------------------------------------------------------------- */
+
+#endif /* PERFECTHASH_IMPL_H */
@@ -0,0 +1,74 @@
+/* --------------------------------------------------------------------------
+ *    Name: lookup.c
+ * Purpose: Read-only associative array indexed by a minimal perfect hash
+ * ----------------------------------------------------------------------- */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "datastruct/perfecthash.h"
+
+#include "impl.h"
+
+/* ----------------------------------------------------------------------- */
+
+/* The SplitMix64 finaliser. */
+static uint64_t perfecthash__mix(uint64_t h)
+{
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ull;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebull;
+  h ^= h >> 31;
+
+  return h;
+}
+
+uint64_t perfecthash__hash(const void *key, size_t keylen, uint64_t seed)
+{
+  const unsigned char *s   = key;
+  const unsigned char *end = s + keylen;
+  uint64_t             h;
+
+  /* FNV-1a, seeded through its offset basis, then mixed so that every bit
+   * of the result depends on every byte */
+  h = 0xcbf29ce484222325ull ^ seed;
+  while (s < end)
+  {
+    h ^= *s++;
+    h *= 0x100000001b3ull;
+  }
+
+  return perfecthash__mix(h);
+}
+
+uint32_t perfecthash__slot(uint64_t h, uint32_t pilot, uint32_t n)
+{
+  h = perfecthash__mix(h + pilot * 0x9e3779b97f4a7c15ull);
+
+  /* scale the top half into [0, n) without a division */
+  return (uint32_t) ((h >> 32) * n >> 32);
+}
+
+/* ----------------------------------------------------------------------- */
+
+const void *perfecthash_lookup(const perfecthash_t *ph,
+                               const void          *key,
+                               size_t               keylen)
+{
+  uint64_t                   h;
+  const perfecthash__slot_t *s;
+
+  if (ph->n == 0)
+    return ph->default_value;
+
+  h = perfecthash__hash(key, keylen, ph->seed);
+  s = &ph->slots[perfecthash__slot(h, ph->pilots[BUCKET(ph, h)], ph->n)];
+
+  /* the slot holds some key: check it's this one */
+  if (s->keylen != keylen || memcmp(ph->keys + s->key, key, keylen) != 0)
+    return ph->default_value;
+
+  return s->value;
+}
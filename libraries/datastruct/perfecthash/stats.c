@@ -0,0 +1,25 @@
+/* --------------------------------------------------------------------------
+ *    Name: stats.c
+ * Purpose: Read-only associative array indexed by a minimal perfect hash
+ * ----------------------------------------------------------------------- */
+
+#include <string.h>
+
+#include "datastruct/perfecthash.h"
+
+#include "impl.h"
+
+void perfecthash_stats(const perfecthash_t *ph, datastruct_stats_t *stats)
+{
+  memset(stats, 0, sizeof(*stats));
+
+  stats->elements    = perfecthash_count(ph);
+  stats->table_bytes = ph->n * sizeof(*ph->slots) +
+                       ph->nbuckets * sizeof(*ph->pilots) +
+                       ph->keybytes;
+  stats->other_bytes = sizeof(*ph) +
+                       ph->maxpending * sizeof(*ph->pending);
+
+  stats->total_bytes = stats->node_bytes + stats->table_bytes +
+                       stats->other_bytes;
+}
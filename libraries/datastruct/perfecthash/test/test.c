@@ -0,0 +1,281 @@
+/* test.c */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/memento/memento.h"
+
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "datastruct/hash.h"
+#include "datastruct/perfecthash.h"
+
+error perfecthashtest(void);
+
+/* ----------------------------------------------------------------------- */
+
+#define NKEYS 100000
+
+static int keys[NKEYS];
+
+static const char *words[] =
+{
+  "apple", "banana", "cherry", "damson", "elderberry", "fig", "grape",
+  "huckleberry", "", "a", "ab", "abc"
+};
+
+/* ----------------------------------------------------------------------- */
+
+static error perfecthashtest_count(const item_t *item, void *opaque)
+{
+  NOT_USED(item);
+
+  (*(int *) opaque)++;
+
+  return error_OK;
+}
+
+/* Add 'n' integer keys, each valued by a pointer to itself, build, then
+ * check every key is found, absent keys aren't and walks see every key. */
+static error perfecthashtest_ints(int n)
+{
+  error          err;
+  perfecthash_t *ph;
+  int            i;
+  int            missing = -1;
+  int            seen;
+
+  err = perfecthash_create(NULL, &ph);
+  if (err)
+    return err;
+
+  for (i = 0; i < n && !err; i++)
+    err = perfecthash_add(ph, &keys[i], sizeof(int), &keys[i]);
+  if (!err)
+    err = perfecthash_build(ph);
+  if (err)
+    goto exit;
+
+  for (i = 0; i < n; i++)
+    if (perfecthash_lookup(ph, &keys[i], sizeof(int)) != &keys[i])
+    {
+      printf("key %d not found\n", i);
+      err = error_TEST_FAILED;
+      goto exit;
+    }
+
+  if (perfecthash_lookup(ph, &missing, sizeof(int)) != NULL ||
+      perfecthash_lookup(ph, &keys[0], sizeof(int) - 1) != NULL)
+  {
+    printf("absent key found\n");
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+  seen = 0;
+  err = perfecthash_walk(ph, perfecthashtest_count, &seen);
+  if (err)
+    goto exit;
+
+  if (perfecthash_count(ph) != n || seen != n)
+  {
+    printf("count %d, walk saw %d, expected %d\n",
+           perfecthash_count(ph), seen, n);
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+  if (perfecthash_add(ph, &missing, sizeof(int), NULL) != error_READ_ONLY)
+  {
+    printf("added to a built perfect hash\n");
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+exit:
+
+  perfecthash_destroy(ph);
+
+  return err;
+}
+
+static error perfecthashtest1(void)
+{
+  static const int sizes[] = { 0, 1, 2, 3, 10, 1000, NKEYS };
+
+  error err;
+  int   i;
+
+  printf("> perfect hash test 1 - build and look up\n");
+
+  for (i = 0; i < NELEMS(sizes); i++)
+  {
+    err = perfecthashtest_ints(sizes[i]);
+    if (err)
+    {
+      printf("failed with %d keys\n", sizes[i]);
+      return err;
+    }
+  }
+
+  return error_OK;
+}
+
+/* ----------------------------------------------------------------------- */
+
+static error perfecthashtest2(void)
+{
+  error          err;
+  perfecthash_t *ph;
+  int            i;
+
+  printf("> perfect hash test 2 - duplicate keys\n");
+
+  err = perfecthash_create(NULL, &ph);
+  if (err)
+    return err;
+
+  for (i = 0; i < 100 && !err; i++)
+    err = perfecthash_add(ph, &keys[i], sizeof(int), NULL);
+  if (!err)
+    err = perfecthash_add(ph, &keys[50], sizeof(int), NULL);
+  if (!err)
+  {
+    err = perfecthash_build(ph);
+    if (err == error_EXISTS)
+    {
+      err = error_OK;
+    }
+    else
+    {
+      printf("duplicate not detected\n");
+      err = error_TEST_FAILED;
+    }
+  }
+
+  perfecthash_destroy(ph);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+static unsigned int perfecthashtest_hash(const void *a)
+{
+  const unsigned char *s = a;
+  unsigned int         h = 0x811c9dc5;
+
+  while (*s)
+    h = (h ^ *s++) * 0x01000193;
+
+  return h;
+}
+
+static int perfecthashtest_compare(const void *a, const void *b)
+{
+  return strcmp(a, b);
+}
+
+static void perfecthashtest_destroy(void *doomed)
+{
+  NOT_USED(doomed);
+}
+
+/* Freeze a hash of strings by walking it into a perfect hash, then look
+ * the keys up by copies of them. */
+static error perfecthashtest3(void)
+{
+  error              err;
+  hash_t            *h;
+  perfecthash_t     *ph = NULL;
+  char               copy[16];
+  datastruct_stats_t stats;
+  int                i;
+
+  printf("> perfect hash test 3 - freeze a hash\n");
+
+  err = hash_create(NULL, 16,
+                    perfecthashtest_hash, perfecthashtest_compare,
+                    perfecthashtest_destroy, perfecthashtest_destroy,
+                    &h);
+  if (err)
+    return err;
+
+  for (i = 0; i < NELEMS(words) && !err; i++)
+    err = hash_insert(h, words[i], strlen(words[i]) + 1, words[i]);
+  if (!err)
+    err = perfecthash_create("default", &ph);
+  if (!err)
+    err = hash_walk(h, perfecthash_add_item, ph);
+
+  hash_destroy(h);
+
+  if (!err)
+    err = perfecthash_build(ph);
+  if (err)
+    goto exit;
+
+  for (i = 0; i < NELEMS(words); i++)
+  {
+    strcpy(copy, words[i]);
+    if (perfecthash_lookup(ph, copy, strlen(copy) + 1) != words[i])
+    {
+      printf("'%s' not found\n", words[i]);
+      err = error_TEST_FAILED;
+      goto exit;
+    }
+  }
+
+  if (strcmp(perfecthash_lookup(ph, "grapefruit", 11), "default") != 0)
+  {
+    printf("absent key not defaulted\n");
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+  perfecthash_stats(ph, &stats);
+  if (stats.elements != NELEMS(words) ||
+      stats.total_bytes != stats.table_bytes + stats.other_bytes)
+  {
+    printf("stats are wrong\n");
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+exit:
+
+  perfecthash_destroy(ph);
+
+  return err;
+}
+
+/* ----------------------------------------------------------------------- */
+
+error perfecthashtest(void)
+{
+  error err;
+  int   i;
+
+  printf(">> perfect hash test\n");
+
+  for (i = 0; i < NKEYS; i++)
+    keys[i] = i;
+
+  err = perfecthashtest1();
+  if (!err)
+    err = perfecthashtest2();
+  if (!err)
+    err = perfecthashtest3();
+  if (err)
+  {
+    printf("unexpected error: %lx\n", err);
+    return err;
+  }
+
+  printf("<< perfect hash tests ok\n");
+
+  return error_OK;
+}
@@ -0,0 +1,34 @@
+/* --------------------------------------------------------------------------
+ *    Name: walk.c
+ * Purpose: Read-only associative array indexed by a minimal perfect hash
+ * ----------------------------------------------------------------------- */
+
+#include "base/errors.h"
+
+#include "datastruct/perfecthash.h"
+
+#include "impl.h"
+
+error perfecthash_walk(const perfecthash_t       *ph,
+                       perfecthash_walk_callback *cb,
+                       void                      *opaque)
+{
+  error err;
+  int   i;
+
+  for (i = 0; i < ph->n; i++)
+  {
+    const perfecthash__slot_t *s = &ph->slots[i];
+    item_t                     item;
+
+    item.key    = ph->keys + s->key;
+    item.keylen = s->keylen;
+    item.value  = s->value;
+
+    err = cb(&item, opaque);
+    if (err)
+      return err;
+  }
+
+  return error_OK;
+}
@@ -0,0 +1,107 @@
+/* --------------------------------------------------------------------------
+ *    Name: pool.c
+ * Purpose: Pool of fixed-size elements addressed by 32-bit index
+ * ----------------------------------------------------------------------- */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "base/memento/memento.h"
+
+#include "datastruct/pool.h"
+
+/* ----------------------------------------------------------------------- */
+
+#define SEGMENT_ELEMS (1u << datastruct_POOL_LOG2_SEGMENT)
+
+void datastruct_pool_init(datastruct_pool_t *pool, size_t size)
+{
+  /* a free element holds the index of the next */
+  assert(size >= sizeof(datastruct_pool_index_t));
+
+  pool->size      = size;
+  pool->segments  = NULL;
+  pool->nsegments = 0;
+  pool->allocated = 0;
+  pool->next      = 1; /* index zero is the null link */
+  pool->free      = datastruct_POOL_NIL;
+  pool->used      = 0;
+}
+
+void datastruct_pool_fini(datastruct_pool_t *pool)
+{
+  unsigned int i;
+
+  for (i = 0; i < pool->nsegments; i++)
+    free(pool->segments[i]);
+  free(pool->segments);
+
+  datastruct_pool_init(pool, pool->size);
+}
+
+datastruct_pool_index_t datastruct_pool_alloc(datastruct_pool_t *pool)
+{
+  datastruct_pool_index_t index;
+
+  index = pool->free;
+  if (index != datastruct_POOL_NIL)
+  {
+    pool->free = *(datastruct_pool_index_t *) datastruct_pool_get(pool, index);
+  }
+  else
+  {
+    /* 'next' wraps to zero once every index has been handed out */
+    if (pool->next == datastruct_POOL_NIL)
+      return datastruct_POOL_NIL;
+
+    /* 'next' lies in the first segment not yet allocated */
+    if ((pool->next >> datastruct_POOL_LOG2_SEGMENT) == pool->nsegments)
+    {
+      unsigned char *segment;
+
+      if (pool->nsegments == pool->allocated)
+      {
+        unsigned int    allocated;
+        unsigned char **segments;
+
+        allocated = pool->allocated ? pool->allocated * 2 : 8;
+        segments = realloc(pool->segments, allocated * sizeof(*segments));
+        if (segments == NULL)
+          return datastruct_POOL_NIL;
+
+        pool->segments  = segments;
+        pool->allocated = allocated;
+      }
+
+      segment = malloc(SEGMENT_ELEMS * pool->size);
+      if (segment == NULL)
+        return datastruct_POOL_NIL;
+
+      pool->segments[pool->nsegments++] = segment;
+    }
+
+    index = pool->next++;
+  }
+
+  pool->used++;
+
+  return index;
+}
+
+void datastruct_pool_free(datastruct_pool_t       *pool,
+                          datastruct_pool_index_t  index)
+{
+  assert(index != datastruct_POOL_NIL);
+
+  *(datastruct_pool_index_t *) datastruct_pool_get(pool, index) = pool->free;
+  pool->free = index;
+
+  pool->used--;
+}
+
+size_t datastruct_pool_bytes(const datastruct_pool_t *pool)
+{
+  return (size_t) pool->nsegments * SEGMENT_ELEMS * pool->size +
+         pool->allocated * sizeof(*pool->segments);
+}
@@ -0,0 +1,136 @@
+/* test.c */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "base/memento/memento.h"
+
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "datastruct/pool.h"
+
+error pooltest(void);
+
+typedef struct pooltest_elem
+{
+  datastruct_pool_index_t self;
+  int                     value;
+}
+pooltest_elem_t;
+
+/* allocate across several segments, free every other element, then check
+ * that the freed indices are reused and the survivors are intact */
+static error pooltest1(void)
+{
+  const int                max = 1000;
+
+  error                    err;
+  datastruct_pool_t        pool;
+  datastruct_pool_index_t *indices;
+  int                      i;
+  int                      reused;
+
+  printf("> pool test 1 - alloc, free, reuse\n");
+
+  indices = malloc(max * sizeof(*indices));
+  if (indices == NULL)
+    return error_OOM;
+
+  datastruct_pool_init(&pool, sizeof(pooltest_elem_t));
+
+  for (i = 0; i < max; i++)
+  {
+    pooltest_elem_t *e;
+
+    indices[i] = datastruct_pool_alloc(&pool);
+    if (indices[i] == datastruct_POOL_NIL)
+    {
+      err = error_OOM;
+      goto exit;
+    }
+
+    e = datastruct_pool_get(&pool, indices[i]);
+    e->self  = indices[i];
+    e->value = i;
+  }
+
+  printf("%lu elements in %lu bytes\n",
+         pool.used, (unsigned long) datastruct_pool_bytes(&pool));
+
+  for (i = 0; i < max; i += 2)
+    datastruct_pool_free(&pool, indices[i]);
+
+  if (pool.used != (unsigned long) max / 2)
+  {
+    printf("wrong number of elements in use\n");
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+  /* every new allocation should come off the free list */
+  reused = 0;
+  for (i = 0; i < max; i += 2)
+  {
+    datastruct_pool_index_t index;
+
+    index = datastruct_pool_alloc(&pool);
+    if (index == datastruct_POOL_NIL)
+    {
+      err = error_OOM;
+      goto exit;
+    }
+
+    if (index < (datastruct_pool_index_t) max + 1)
+      reused++;
+
+    ((pooltest_elem_t *) datastruct_pool_get(&pool, index))->value = -1;
+  }
+
+  if (reused != max / 2)
+  {
+    printf("freed elements weren't reused (%d of %d)\n", reused, max / 2);
+    err = error_TEST_FAILED;
+    goto exit;
+  }
+
+  for (i = 1; i < max; i += 2)
+  {
+    const pooltest_elem_t *e = datastruct_pool_get(&pool, indices[i]);
+
+    if (e->self != indices[i] || e->value != i)
+    {
+      printf("element %d was corrupted\n", i);
+      err = error_TEST_FAILED;
+      goto exit;
+    }
+  }
+
+  err = error_OK;
+
+exit:
+
+  datastruct_pool_fini(&pool);
+  free(indices);
+
+  return err;
+}
+
+error pooltest(void)
+{
+  error err;
+
+  printf(">> pool test\n");
+
+  err = pooltest1();
+  if (err)
+  {
+    printf("unexpected error: %lx\n", err);
+    return err;
+  }
+
+  printf("<< pool tests ok\n");
+
+  return error_OK;
+}
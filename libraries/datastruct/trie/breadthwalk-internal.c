@@ -8,12 +8,15 @@
 
 #include "base/errors.h"
 
-#include "datastruct/queue.h"
+#include "datastruct/chunkqueue.h"
 
 #include "datastruct/trie.h"
 
 #include "impl.h"
 
+/* Number of queue entries to allocate at a time. */
+#define CHUNKELEMS 64
+
 error trie__breadthwalk_internal(trie_t                       *t,
                                  trie_walk_flags               flags,
                                  trie__walk_internal_callback *cb,
@@ -26,34 +29,34 @@ error trie__breadthwalk_internal(trie_t                       *t,
   }
   nodedepth;
 
-  error     err;
-  queue_t  *queue;
-  nodedepth nd;
+  error         err;
+  chunkqueue_t *queue;
+  nodedepth     nd;
 
   if (t == NULL)
     return error_OK;
 
-  queue = queue_create(100, sizeof(nodedepth)); /* FIXME: 100 constant */
+  queue = chunkqueue_create(CHUNKELEMS, sizeof(nodedepth));
   if (queue == NULL)
     return error_OOM;
 
-  assert(t->root);
+  assert(t->root != NIL);
 
-  nd.node  = t->root;
+  nd.node  = NODE(t, t->root);
   nd.depth = 0;
 
-  err = queue_enqueue(queue, &nd);
+  err = chunkqueue_enqueue(queue, &nd);
   if (err)
-    return err;
+    goto exit;
 
-  while (!queue_empty(queue))
+  while (!chunkqueue_empty(queue))
   {
     int       leaf;
     nodedepth ndc;
 
-    err = queue_dequeue(queue, &nd);
+    err = chunkqueue_dequeue(queue, &nd);
     if (err)
-      return err;
+      goto exit;
 
     leaf = IS_LEAF(nd.node);
 
@@ -64,28 +67,32 @@ error trie__breadthwalk_internal(trie_t                       *t,
     {
       err = cb(nd.node, nd.depth, opaque);
       if (err)
-        return err;
+        goto exit;
     }
 
     ndc.depth = nd.depth + 1;
 
-    if (nd.node->child[0])
+    if (nd.node->child[0] != NIL)
     {
-      ndc.node = nd.node->child[0];
-      err = queue_enqueue(queue, &ndc);
+      ndc.node = NODE(t, nd.node->child[0]);
+      err = chunkqueue_enqueue(queue, &ndc);
       if (err)
-        return err;
+        goto exit;
     }
-    if (nd.node->child[1])
+    if (nd.node->child[1] != NIL)
     {
-      ndc.node = nd.node->child[1];
-      err = queue_enqueue(queue, &ndc);
+      ndc.node = NODE(t, nd.node->child[1]);
+      err = chunkqueue_enqueue(queue, &ndc);
       if (err)
-        return err;
+        goto exit;
     }
   }
 
-  queue_destroy(queue);
+  err = error_OK;
+
+exit:
+
+  chunkqueue_destroy(queue);
 
-  return error_OK;
+  return err;
 }
@@ -0,0 +1,52 @@
+/* --------------------------------------------------------------------------
+ *    Name: depth-stats.c
+ * Purpose: Associative array implemented as a trie
+ * ----------------------------------------------------------------------- */
+
+#include <stddef.h>
+
+#include "base/errors.h"
+
+#include "datastruct/trie.h"
+
+#include "impl.h"
+
+error trie_depth_stats(const trie_t *t, datastruct_depth_stats_t *stats)
+{
+  error                    err;
+  datastruct_depth_stack_t stack;
+  datastruct_depth_entry_t e;
+
+  datastruct_depth_init(stats);
+  datastruct_depth_stack_init(&stack);
+
+  err = error_OK;
+  if (t->root != NIL)
+    err = datastruct_depth_stack_push(&stack, NODE(t, t->root), 0, 0);
+
+  while (!err && datastruct_depth_stack_pop(&stack, &e))
+  {
+    const trie__node_t *n = e.node;
+    int                children;
+    int                chained;
+    int                i;
+
+    /* only leaves hold elements */
+    if (IS_LEAF(n))
+      datastruct_depth_add(stats, e.depth);
+
+    children = (n->child[0] != NIL) + (n->child[1] != NIL);
+    chained  = datastruct_depth_branch(stats, children, e.chained);
+
+    for (i = 0; i < 2 && !err; i++)
+      if (n->child[i] != NIL)
+        err = datastruct_depth_stack_push(&stack, NODE(t, n->child[i]),
+                                          e.depth + 1, chained);
+  }
+
+  datastruct_depth_stack_fini(&stack);
+
+  datastruct_depth_finish(stats);
+
+  return err;
+}
@@ -17,7 +17,12 @@ static error trie__destroy_node(trie__node_t *n, int level, void *opaque)
 {
   NOT_USED(level);
 
+#ifdef DATASTRUCT_COMPACT
+  /* the pool is released in one go below */
+  trie__node_clear(opaque, n);
+#else
   trie__node_destroy(opaque, n);
+#endif
 
   return error_OK;
 }
@@ -26,5 +31,9 @@ void trie_destroy(trie_t *t)
 {
   (void) trie__walk_internal(t, trie_WALK_POST_ORDER, trie__destroy_node, t);
 
+#ifdef DATASTRUCT_COMPACT
+  datastruct_pool_fini(&t->pool);
+#endif
+
   free(t);
 }
@@ -5,47 +5,71 @@
 
 #include "base/types.h"
 
+#include "datastruct/instrument.h"
 #include "datastruct/item.h"
+#include "datastruct/pool.h"
 
 #include "datastruct/trie.h"
 
 /* ----------------------------------------------------------------------- */
 
+/* Nodes link to one another by pointer, or by pool index when built with
+ * DATASTRUCT_COMPACT. See pool.h. */
+typedef POOL_LINK(struct trie__node) trie__link_t;
+
 typedef struct trie__node
 {
   /* using an array here rather than separate left,right elements makes some
    * operations more convenient */
-  struct trie__node  *child[2]; /* left, right children */
+  trie__link_t        child[2]; /* left, right children */
   item_t              item;
 }
 trie__node_t;
 
 struct trie
 {
-  trie__node_t       *root;
+  trie__link_t        root;
 
-  int                 count;
+  int                 count;    /* all nodes */
+  int                 branches; /* nodes without a key */
 
   const void         *default_value;
 
   trie_destroy_key   *destroy_key;
   trie_destroy_value *destroy_value;
+
+#ifdef DATASTRUCT_COMPACT
+  datastruct_pool_t   pool;
+#endif
+
+#ifdef DATASTRUCT_INSTRUMENT
+  datastruct_instrument_t instrument;
+#endif
 };
 
 /* ----------------------------------------------------------------------- */
 
-#define IS_LEAF(n) ((n)->child[0] == NULL && (n)->child[1] == NULL)
+#define NIL POOL_NIL
+
+/* Returns the node 'l' links to. 'l' must not be NIL. */
+#define NODE(t, l) POOL_NODE(t, trie__node_t, l)
+
+/* As NODE, but maps NIL to NULL. */
+#define NODE_OR_NULL(t, l) ((l) == NIL ? NULL : NODE(t, l))
+
+#define IS_LEAF(n) ((n)->child[0] == NIL && (n)->child[1] == NIL)
 
 /* ----------------------------------------------------------------------- */
 
-trie__node_t *trie__node_create(trie_t     *t,
-                                const void *key,
-                                size_t      keylen,
-                                const void *value);
+/* Returns NIL if out of memory. */
+trie__link_t trie__node_create(trie_t     *t,
+                               const void *key,
+                               size_t      keylen,
+                               const void *value);
 
 void trie__node_clear(trie_t *t, trie__node_t *n);
 
-void trie__node_destroy(trie_t *t, trie__node_t *n);
+void trie__node_destroy(trie_t *t, trie__link_t l);
 
 /* ----------------------------------------------------------------------- */
 
@@ -13,12 +13,15 @@
 
 #include "impl.h"
 
-static trie__node_t *trie__insert_split(trie_t       *t,
-                                        trie__node_t *m,
-                                        trie__node_t *n,
-                                        int           depth)
+static trie__link_t trie__insert_split(trie_t       *t,
+                                       trie__link_t  m,
+                                       trie__link_t  n,
+                                       int           depth)
 {
-  trie__node_t        *x;
+  trie__link_t         x;
+  trie__node_t        *xn;
+  const trie__node_t  *mn;
+  const trie__node_t  *nn;
   const unsigned char *ukeym;
   const unsigned char *ukeymend;
   const unsigned char *ukeyn;
@@ -27,18 +30,22 @@ static trie__node_t *trie__insert_split(trie_t       *t,
   int                  ndir;
 
   x = trie__node_create(t, NULL, 0L, NULL);
-  if (x == NULL)
-    return NULL; /* OOM */
+  if (x == NIL)
+    return NIL; /* OOM */
 
-  ukeym    = m->item.key;
-  ukeymend = ukeym + m->item.keylen;
+  xn = NODE(t, x);
+  mn = NODE(t, m);
+  nn = NODE(t, n);
+
+  ukeym    = mn->item.key;
+  ukeymend = ukeym + mn->item.keylen;
 
   mdir = 0;
   if (ukeym + (depth >> 3) < ukeymend)
     mdir = (ukeym[depth >> 3] >> (7 - (depth & 7))) & 1;
 
-  ukeyn    = n->item.key;
-  ukeynend = ukeyn + n->item.keylen;
+  ukeyn    = nn->item.key;
+  ukeynend = ukeyn + nn->item.keylen;
 
   ndir = 0;
   if (ukeyn + (depth >> 3) < ukeynend)
@@ -47,18 +54,18 @@ static trie__node_t *trie__insert_split(trie_t       *t,
   switch (mdir * 2 + ndir)
   {
   case 0:
-    x->child[0] = trie__insert_split(t, m, n, depth + 1);
+    xn->child[0] = trie__insert_split(t, m, n, depth + 1);
     break;
   case 3:
-    x->child[1] = trie__insert_split(t, m, n, depth + 1);
+    xn->child[1] = trie__insert_split(t, m, n, depth + 1);
     break;
   case 1:
-    x->child[0] = m;
-    x->child[1] = n;
+    xn->child[0] = m;
+    xn->child[1] = n;
     break;
   case 2:
-    x->child[0] = n;
-    x->child[1] = m;
+    xn->child[0] = n;
+    xn->child[1] = m;
     break;
   }
 
@@ -75,48 +82,55 @@ error trie_insert(trie_t     *t,
   const unsigned char *ukey    = key;
   const unsigned char *ukeyend = ukey + keylen;
   int                  depth;
-  trie__node_t       **pn;
+  trie__link_t        *pl;
   trie__node_t        *n;
   int                  dir;
   unsigned char        c = 0;
-  trie__node_t        *m;
+  trie__link_t         m;
 
   /* search, but save the parent pointer too */
 
   depth = 0;
 
-  for (pn = &t->root; (n = *pn); pn = &n->child[dir])
+  for (pl = &t->root; (n = NODE_OR_NULL(t, *pl)); pl = &n->child[dir])
   {
+    INSTRUMENT_VISIT(t);
+
     if (IS_LEAF(n))
       break;
 
     GET_NEXT_DIR(dir, ukey, ukeyend);
   }
 
+  INSTRUMENT_BITS(t, depth);
+  if (n)
+    INSTRUMENT_COMPARE(t);
+  INSTRUMENT_END(t, INSERT);
+
   if (n && n->item.keylen == keylen && memcmp(n->item.key, key, keylen) == 0)
     return error_EXISTS;
 
   m = trie__node_create(t, key, keylen, value);
-  if (m == NULL)
+  if (m == NIL)
     return error_OOM;
 
   if (n)
   {
     /* leaf node: need to split */
 
-    trie__node_t *m2 = m;
+    trie__link_t m2 = m;
 
     assert(IS_LEAF(n));
 
-    m = trie__insert_split(t, m, n, depth);
-    if (m == NULL)
+    m = trie__insert_split(t, m, *pl, depth);
+    if (m == NIL)
     {
       trie__node_destroy(t, m2);
       return error_OOM;
     }
   }
 
-  *pn = m;
+  *pl = m;
 
   return error_OK;
 }
@@ -13,24 +13,28 @@
 
 /* This is similar to trie__walk_in_order, but returns items as an item_t
  * pointer. */
-static error trie__lookup_prefix_walk(const trie__node_t  *n,
+static error trie__lookup_prefix_walk(const trie_t        *t,
+                                      trie__link_t         l,
                                       trie_found_callback *cb,
                                       void                *opaque)
 {
-  error err;
+  error               err;
+  const trie__node_t *n;
 
-  if (n == NULL)
+  if (l == NIL)
     return error_OK;
 
+  n = NODE(t, l);
+
   if (IS_LEAF(n))
   {
     return cb(&n->item, opaque);
   }
   else
   {
-    err = trie__lookup_prefix_walk(n->child[0], cb, opaque);
+    err = trie__lookup_prefix_walk(t, n->child[0], cb, opaque);
     if (!err)
-      err = trie__lookup_prefix_walk(n->child[1], cb, opaque);
+      err = trie__lookup_prefix_walk(t, n->child[1], cb, opaque);
     return err;
   }
 }
@@ -44,16 +48,17 @@ error trie_lookup_prefix(const trie_t        *t,
   const unsigned char *uprefix    = prefix;
   const unsigned char *uprefixend = uprefix + prefixlen;
   int                  depth;
-  trie__node_t        *n;
+  const trie__link_t  *pl;
+  const trie__node_t  *n;
   unsigned char        c = 0;
   int                  dir;
 
-  if (t->root == NULL)
+  if (t->root == NIL)
     return error_OK; /* empty tree */
 
   depth = 0;
 
-  for (n = t->root; n; n = n->child[dir])
+  for (pl = &t->root; (n = NODE_OR_NULL(t, *pl)); pl = &n->child[dir])
   {
     if (IS_LEAF(n) || (size_t) depth == prefixlen * 8)
       break;
@@ -78,6 +83,6 @@ error trie_lookup_prefix(const trie_t        *t,
   }
   else
   {
-    return trie__lookup_prefix_walk(n, cb, opaque);
+    return trie__lookup_prefix_walk(t, *pl, cb, opaque);
   }
 }
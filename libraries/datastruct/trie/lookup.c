@@ -20,14 +20,21 @@ const void *trie_lookup(trie_t *t, const void *key, size_t keylen)
 
   depth = 0;
 
-  for (n = t->root; n; n = n->child[dir])
+  for (n = NODE_OR_NULL(t, t->root); n; n = NODE_OR_NULL(t, n->child[dir]))
   {
+    INSTRUMENT_VISIT(t);
+
     if (IS_LEAF(n))
       break;
 
     GET_NEXT_DIR(dir, ukey, ukeyend);
   }
 
+  INSTRUMENT_BITS(t, depth);
+  if (n)
+    INSTRUMENT_COMPARE(t);
+  INSTRUMENT_END(t, LOOKUP);
+
   if (n && n->item.keylen == keylen && memcmp(n->item.key, key, keylen) == 0)
     return n->item.value; /* found */
   else
@@ -11,11 +11,24 @@
 
 #include "impl.h"
 
-void trie__node_destroy(trie_t *t, trie__node_t *n)
+void trie__node_destroy(trie_t *t, trie__link_t l)
 {
+  trie__node_t *n;
+
+  n = NODE(t, l);
+
+  if (n->item.key == NULL)
+    t->branches--;
+
   trie__node_clear(t, n);
 
-  free(n);
+#ifdef DATASTRUCT_COMPACT
+  datastruct_pool_free(&t->pool, l);
+#else
+  free(l);
+#endif
+
+  INSTRUMENT_FREE(t);
 
   t->count--;
 }
@@ -25,54 +25,62 @@
  *
  * A tree with a valid structure can terminate immediately and returns -2.
  */
-static int trie__remove_node(trie_t        *t,
-                             trie__node_t **pn,
-                             const void    *key,
-                             size_t         keylen,
-                             int            depth)
+static int trie__remove_node(trie_t       *t,
+                             trie__link_t *pl,
+                             const void   *key,
+                             size_t        keylen,
+                             int           depth)
 {
   const unsigned char *ukey    = key;
   const unsigned char *ukeyend = ukey + keylen;
-  trie__node_t        *n = *pn;
-  trie__node_t        *m;
+  trie__node_t        *n;
+  trie__link_t         m;
 
-  assert(n != NULL);
+  assert(*pl != NIL);
+
+  n = NODE(t, *pl);
+
+  INSTRUMENT_VISIT(t);
 
   if (IS_LEAF(n))
   {
+    INSTRUMENT_COMPARE(t);
+
     if (!(n->item.keylen == keylen && memcmp(n->item.key, key, keylen) == 0))
       return -1; /* not found */
 
-    m = NULL; /* delete link from parent */
+    m = NIL; /* delete link from parent */
   }
   else
   {
     int           dir;
     int           rc;
-    trie__node_t *left, *right;
+    trie__link_t  left, right;
     int           leafleft, leafright;
 
     dir = 0;
     if (ukey + (depth >> 3) < ukeyend)
       dir = (ukey[depth >> 3] >> (7 - (depth & 7))) & 1;
 
+    INSTRUMENT_BITS(t, 1);
+
     if ((rc = trie__remove_node(t, &n->child[dir], key, keylen, depth + 1)) <= 0)
       return rc;
 
     left  = n->child[0];
     right = n->child[1];
 
-    leafleft  = (right == NULL) && IS_LEAF(left);
-    leafright = (left  == NULL) && IS_LEAF(right);
+    leafleft  = (right == NIL) && IS_LEAF(NODE(t, left));
+    leafright = (left  == NIL) && IS_LEAF(NODE(t, right));
     if (!leafleft && !leafright)
       return -2; /* subtree is in a valid state */
 
     m = leafleft ? left : right;
-    assert(m);
+    assert(m != NIL);
   }
 
-  trie__node_destroy(t, n);
-  *pn = m;
+  trie__node_destroy(t, *pl);
+  *pl = m;
 
   return 1;
 }
@@ -80,4 +88,6 @@ static int trie__remove_node(trie_t        *t,
 void trie_remove(trie_t *t, const void *key, size_t keylen)
 {
   (void) trie__remove_node(t, &t->root, key, keylen, 0);
+
+  INSTRUMENT_END(t, REMOVE);
 }
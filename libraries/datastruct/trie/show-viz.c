@@ -15,6 +15,7 @@
 
 typedef struct trie__show_viz_args
 {
+  const trie_t      *t;
   trie_show_key     *key;
   trie_show_destroy *key_destroy;
   trie_show_value   *value;
@@ -72,10 +73,12 @@ static error trie__node_show_viz_link(trie__node_t *n, int level, void *opaque)
   }
   else
   {
-    if (n->child[0] != NULL)
-      (void) fprintf(args->f, "\t\"%p\":sw -> \"%p\":n;\n", n, n->child[0]);
-    if (n->child[1] != NULL)
-      (void) fprintf(args->f, "\t\"%p\":se -> \"%p\":n;\n", n, n->child[1]);
+    if (n->child[0] != NIL)
+      (void) fprintf(args->f, "\t\"%p\":sw -> \"%p\":n;\n",
+                     (void *) n, (void *) NODE(args->t, n->child[0]));
+    if (n->child[1] != NIL)
+      (void) fprintf(args->f, "\t\"%p\":se -> \"%p\":n;\n",
+                     (void *) n, (void *) NODE(args->t, n->child[1]));
   }
 
   if (args->key_destroy   && key)   args->key_destroy((char *) key);
@@ -94,6 +97,7 @@ error trie_show_viz(const trie_t      *t,
   error                 err;
   trie__show_viz_args_t args;
 
+  args.t             = t;
   args.key           = key;
   args.key_destroy   = key_destroy;
   args.value         = value;
@@ -15,6 +15,7 @@
 
 typedef struct trie__show_args
 {
+  const trie_t      *t;
   trie_show_key     *key;
   trie_show_destroy *key_destroy;
   trie_show_value   *value;
@@ -38,7 +39,8 @@ static error trie__node_show(trie__node_t *n, int level, void *opaque)
                  n, level + 1, stars,
                  key   ? key   : "(null)",
                  value ? value : "(null)",
-                 n->child[0], n->child[1]);
+                 (void *) NODE_OR_NULL(args->t, n->child[0]),
+                 (void *) NODE_OR_NULL(args->t, n->child[1]));
 
   if (args->key_destroy   && key)   args->key_destroy((char *) key);
   if (args->value_destroy && value) args->value_destroy((char *) value);
@@ -55,6 +57,7 @@ error trie_show(const trie_t      *t,
 {
   trie__show_args_t args;
 
+  args.t             = t;
   args.key           = key;
   args.key_destroy   = key_destroy;
   args.value         = value;
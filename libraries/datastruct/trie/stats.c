@@ -0,0 +1,29 @@
+/* --------------------------------------------------------------------------
+ *    Name: stats.c
+ * Purpose: Associative array implemented as a trie
+ * ----------------------------------------------------------------------- */
+
+#include <string.h>
+
+#include "datastruct/trie.h"
+
+#include "impl.h"
+
+void trie_stats(const trie_t *t, datastruct_stats_t *stats)
+{
+  memset(stats, 0, sizeof(*stats));
+
+  /* 'count' includes the branch nodes */
+  stats->elements    = t->count - t->branches;
+  stats->branches    = t->branches;
+  stats->leaves      = t->count - t->branches;
+  stats->node_bytes  = t->count * sizeof(trie__node_t);
+#ifdef DATASTRUCT_COMPACT
+  /* the pool's unused elements and its array of segments */
+  stats->table_bytes = datastruct_pool_bytes(&t->pool) - stats->node_bytes;
+  stats->slack_bytes = stats->table_bytes;
+#endif
+  stats->other_bytes = sizeof(*t);
+  stats->total_bytes = stats->node_bytes + stats->table_bytes +
+                       stats->other_bytes;
+}
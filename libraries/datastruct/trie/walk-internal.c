@@ -12,18 +12,23 @@
 
 #include "impl.h"
 
-static error trie__walk_internal_in_order(trie__node_t                 *n,
+static error trie__walk_internal_in_order(const trie_t                 *t,
+                                          trie__link_t                  l,
                                           trie_walk_flags               flags,
                                           int                           level,
                                           trie__walk_internal_callback *cb,
                                           void                         *opaque)
 {
-  error err;
+  error         err;
+  trie__node_t *n;
 
-  if (n == NULL)
+  if (l == NIL)
     return error_OK;
 
-  err = trie__walk_internal_in_order(n->child[0], flags, level + 1, cb, opaque);
+  n = NODE(t, l);
+
+  err = trie__walk_internal_in_order(t, n->child[0], flags, level + 1,
+                                     cb, opaque);
   if (!err)
   {
     int leaf;
@@ -35,22 +40,27 @@ static error trie__walk_internal_in_order(trie__node_t                 *n,
       err = cb(n, level, opaque);
   }
   if (!err)
-    err = trie__walk_internal_in_order(n->child[1], flags, level + 1, cb, opaque);
+    err = trie__walk_internal_in_order(t, n->child[1], flags, level + 1,
+                                       cb, opaque);
 
   return err;
 }
 
-static error trie__walk_internal_pre_order(trie__node_t                 *n,
+static error trie__walk_internal_pre_order(const trie_t                 *t,
+                                           trie__link_t                  l,
                                            trie_walk_flags               flags,
                                            int                           level,
                                            trie__walk_internal_callback *cb,
                                            void                         *opaque)
 {
-  error err;
+  error         err;
+  trie__node_t *n;
 
-  if (n == NULL)
+  if (l == NIL)
     return error_OK;
 
+  n = NODE(t, l);
+
   {
     int leaf;
 
@@ -63,27 +73,35 @@ static error trie__walk_internal_pre_order(trie__node_t                 *n,
       err = error_OK;
   }
   if (!err)
-    err = trie__walk_internal_pre_order(n->child[0], flags, level + 1, cb, opaque);
+    err = trie__walk_internal_pre_order(t, n->child[0], flags, level + 1,
+                                        cb, opaque);
   if (!err)
-    err = trie__walk_internal_pre_order(n->child[1], flags, level + 1, cb, opaque);
+    err = trie__walk_internal_pre_order(t, n->child[1], flags, level + 1,
+                                        cb, opaque);
 
   return err;
 }
 
-static error trie__walk_internal_post_order(trie__node_t                 *n,
+static error trie__walk_internal_post_order(const trie_t                 *t,
+                                            trie__link_t                  l,
                                             trie_walk_flags               flags,
                                             int                           level,
                                             trie__walk_internal_callback *cb,
                                             void                         *opaque)
 {
-  error err;
+  error         err;
+  trie__node_t *n;
 
-  if (n == NULL)
+  if (l == NIL)
     return error_OK;
 
-  err = trie__walk_internal_post_order(n->child[0], flags, level + 1, cb, opaque);
+  n = NODE(t, l);
+
+  err = trie__walk_internal_post_order(t, n->child[0], flags, level + 1,
+                                       cb, opaque);
   if (!err)
-    err = trie__walk_internal_post_order(n->child[1], flags, level + 1, cb, opaque);
+    err = trie__walk_internal_post_order(t, n->child[1], flags, level + 1,
+                                         cb, opaque);
   if (!err)
   {
     int leaf;
@@ -103,7 +121,8 @@ error trie__walk_internal(trie_t                       *t,
                           trie__walk_internal_callback *cb,
                           void                         *opaque)
 {
-  error (*walker)(trie__node_t                 *n,
+  error (*walker)(const trie_t                 *t,
+                  trie__link_t                  l,
                   trie_walk_flags               flags,
                   int                           level,
                   trie__walk_internal_callback *cb,
@@ -128,5 +147,5 @@ error trie__walk_internal(trie_t                       *t,
     break;
   }
 
-  return walker(t->root, flags, 0, cb, opaque);
+  return walker(t, t->root, flags, 0, cb, opaque);
 }
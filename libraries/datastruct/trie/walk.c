@@ -11,24 +11,28 @@
 
 #include "impl.h"
 
-static error trie__walk_in_order(const trie__node_t *n,
+static error trie__walk_in_order(const trie_t       *t,
+                                 trie__link_t        l,
                                  int                 level,
                                  trie_walk_callback *cb,
                                  void               *opaque)
 {
-  error err;
+  error               err;
+  const trie__node_t *n;
 
-  if (n == NULL)
+  if (l == NIL)
     return error_OK;
 
-  err = trie__walk_in_order(n->child[0], level + 1, cb, opaque);
+  n = NODE(t, l);
+
+  err = trie__walk_in_order(t, n->child[0], level + 1, cb, opaque);
   if (!err)
   {
     if (IS_LEAF(n))
       err = cb(&n->item, level, opaque);
   }
   if (!err)
-    err = trie__walk_in_order(n->child[1], level + 1, cb, opaque);
+    err = trie__walk_in_order(t, n->child[1], level + 1, cb, opaque);
 
   return err;
 }
@@ -40,5 +44,5 @@ error trie_walk(const trie_t       *t,
   if (t == NULL)
     return error_OK;
 
-  return trie__walk_in_order(t->root, 0, cb, opaque);
+  return trie__walk_in_order(t, t->root, 0, cb, opaque);
 }
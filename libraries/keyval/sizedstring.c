@@ -0,0 +1,50 @@
+/* --------------------------------------------------------------------------
+ *    Name: sizedstring.c
+ * Purpose: Functions for keys or values which are strings of known length
+ * ----------------------------------------------------------------------- */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/memento/memento.h"
+
+#include "base/types.h"
+
+#include "keyval/sizedstring.h"
+
+/* The length sits immediately before the string. It's copied in and out
+ * with memcpy rather than through a cast to keep -Wcast-align quiet. */
+#define HEADER sizeof(size_t)
+
+char *sizedstring_create(const char *s, size_t len)
+{
+  char *block;
+
+  block = malloc(HEADER + len + 1);
+  if (block == NULL)
+    return NULL;
+
+  memcpy(block, &len, HEADER);
+  memcpy(block + HEADER, s, len);
+  block[HEADER + len] = '\0';
+
+  return block + HEADER;
+}
+
+void sizedstring_destroy(void *doomed)
+{
+  if (doomed == NULL)
+    return;
+
+  free((char *) doomed - HEADER);
+}
+
+size_t sizedstringkv_len(const void *key_)
+{
+  const char *key = key_;
+  size_t      len;
+
+  memcpy(&len, key - HEADER, HEADER);
+
+  return len;
+}
@@ -0,0 +1,254 @@
+/* --------------------------------------------------------------------------
+ *    Name: epoch.c
+ * Purpose: Epoch-based memory reclamation
+ * ----------------------------------------------------------------------- */
+
+/* sched_yield is not part of C99 */
+#define _POSIX_C_SOURCE 200112L
+
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "base/memento/memento.h"
+#include "base/atomic.h"
+#include "base/errors.h"
+#include "base/types.h"
+
+#include "utils/epoch.h"
+
+/* ----------------------------------------------------------------------- */
+
+/* Number of concurrent readers supported. Further readers wait for a slot. */
+#define NSLOTS 64
+
+/* A block retired in epoch E may still be seen by readers in E-1 and E, so
+ * it can be freed once the global epoch reaches E+2. Three retire lists
+ * therefore suffice. */
+#define NEPOCHS 3
+
+/* A slot value is zero when free, or the reader's epoch shifted up with the
+ * bottom bit set when in use. */
+#define SLOT_EPOCH(s) ((s) >> 1)
+#define SLOT_MAKE(g)  (((g) << 1) | 1)
+#define EPOCH_MASK    (~0u >> 1)
+
+/* Slots are padded out to a cache line so that readers on different cores
+ * don't contend. */
+#define CACHE_LINE 64
+
+typedef struct epoch__slot
+{
+  unsigned int           value;
+  char                   pad[CACHE_LINE - sizeof(unsigned int)];
+}
+epoch__slot_t;
+
+typedef struct epoch__retired
+{
+  struct epoch__retired *next;
+  void                  *block;
+  epoch_free            *fn;
+  void                  *opaque;
+}
+epoch__retired_t;
+
+struct epoch
+{
+  unsigned int           global; /* current epoch */
+  char                   pad[CACHE_LINE - sizeof(unsigned int)];
+  epoch__slot_t          slots[NSLOTS];
+
+  pthread_mutex_t        lock;   /* protects all of the following */
+  int                    index;  /* retire list for the current epoch */
+  epoch__retired_t      *retired[NEPOCHS];
+};
+
+/* ----------------------------------------------------------------------- */
+
+static void epoch__free_list(epoch__retired_t *r)
+{
+  epoch__retired_t *next;
+
+  for (; r; r = next)
+  {
+    next = r->next;
+    r->fn(r->block, r->opaque);
+    free(r);
+  }
+}
+
+/* Advance the global epoch if every active reader has observed the current
+ * one, then free the blocks which are now unreachable. Returns non-zero if
+ * the epoch advanced. Called with the lock held. */
+static int epoch__try_advance(epoch_t *e)
+{
+  unsigned int      g;
+  int               i;
+  epoch__retired_t *r;
+
+  g = ATOMIC_LOAD(&e->global);
+
+  for (i = 0; i < NSLOTS; i++)
+  {
+    unsigned int s;
+
+    s = ATOMIC_LOAD(&e->slots[i].value);
+    if (s != 0 && SLOT_EPOCH(s) != g)
+      return 0; /* a reader lags behind */
+  }
+
+  ATOMIC_STORE(&e->global, (g + 1) & EPOCH_MASK);
+
+  e->index = (e->index + 1) % NEPOCHS;
+
+  /* the list we now reuse holds blocks retired two epochs ago */
+  r = e->retired[e->index];
+  e->retired[e->index] = NULL;
+
+  epoch__free_list(r);
+
+  return 1;
+}
+
+/* ----------------------------------------------------------------------- */
+
+error epoch_create(epoch_t **pe)
+{
+  epoch_t *e;
+  int      i;
+
+  *pe = NULL;
+
+  e = malloc(sizeof(*e));
+  if (e == NULL)
+    return error_OOM;
+
+  if (pthread_mutex_init(&e->lock, NULL) != 0)
+  {
+    free(e);
+    return error_OOM;
+  }
+
+  e->global = 0;
+  for (i = 0; i < NSLOTS; i++)
+    e->slots[i].value = 0;
+
+  e->index = 0;
+  for (i = 0; i < NEPOCHS; i++)
+    e->retired[i] = NULL;
+
+  *pe = e;
+
+  return error_OK;
+}
+
+void epoch_destroy(epoch_t *doomed)
+{
+  int i;
+
+  if (doomed == NULL)
+    return;
+
+  for (i = 0; i < NSLOTS; i++)
+    assert(doomed->slots[i].value == 0);
+
+  for (i = 0; i < NEPOCHS; i++)
+    epoch__free_list(doomed->retired[i]);
+
+  pthread_mutex_destroy(&doomed->lock);
+
+  free(doomed);
+}
+
+/* ----------------------------------------------------------------------- */
+
+int epoch_enter(epoch_t *e)
+{
+  int i;
+  int start;
+
+  /* start searching at a position derived from the stack address so that
+   * threads tend to settle on different slots */
+  start = (int) (((uintptr_t) &i >> 12) % NSLOTS);
+
+  for (;;)
+  {
+    for (i = 0; i < NSLOTS; i++)
+    {
+      int          j = (start + i) % NSLOTS;
+      unsigned int g;
+
+      if (ATOMIC_LOAD_RELAXED(&e->slots[j].value) != 0)
+        continue;
+
+      g = ATOMIC_LOAD(&e->global);
+      if (ATOMIC_CAS(&e->slots[j].value, 0u, SLOT_MAKE(g)))
+        return j;
+    }
+
+    (void) sched_yield(); /* all slots in use */
+  }
+}
+
+void epoch_leave(epoch_t *e, int token)
+{
+  assert(token >= 0 && token < NSLOTS);
+
+  ATOMIC_STORE_RELEASE(&e->slots[token].value, 0u);
+}
+
+/* ----------------------------------------------------------------------- */
+
+void epoch_retire(epoch_t *e, void *block, epoch_free *fn, void *opaque)
+{
+  epoch__retired_t *r;
+
+  r = malloc(sizeof(*r));
+  if (r == NULL)
+  {
+    epoch_synchronize(e);
+    fn(block, opaque);
+    return;
+  }
+
+  r->block  = block;
+  r->fn     = fn;
+  r->opaque = opaque;
+
+  pthread_mutex_lock(&e->lock);
+
+  r->next = e->retired[e->index];
+  e->retired[e->index] = r;
+
+  (void) epoch__try_advance(e);
+
+  pthread_mutex_unlock(&e->lock);
+}
+
+void epoch_synchronize(epoch_t *e)
+{
+  int advances;
+
+  pthread_mutex_lock(&e->lock);
+
+  /* two advances free everything retired up to and including the current
+   * epoch */
+  for (advances = 0; advances < 2; )
+  {
+    if (epoch__try_advance(e))
+    {
+      advances++;
+    }
+    else
+    {
+      pthread_mutex_unlock(&e->lock);
+      (void) sched_yield();
+      pthread_mutex_lock(&e->lock);
+    }
+  }
+
+  pthread_mutex_unlock(&e->lock);
+}
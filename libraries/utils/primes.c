@@ -7,10 +7,13 @@
 
 #include "utils/primes.h"
 
-/* A selection of primes. */
+/* A selection of primes. Beyond 983 each is roughly double the last. */
 static const int primes[] =
 {
   17, 97, 173, 251, 337, 421, 503, 601, 683, 787, 881, 983,
+  1543, 3079, 6151, 12289, 24593, 49157, 98317, 196613, 393241, 786433,
+  1572869, 3145739, 6291469, 12582917, 25165843, 50331653, 100663319,
+  201326611, 402653189, 805306457, 1610612741,
 };
 
 int prime_nearest(int x)